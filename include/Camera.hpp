@@ -25,6 +25,10 @@ class Camera : public SDLKeyboardEventListener, public CoffeeMaker::Editor::ImGu
   void SetCameraDimensions(uint32_t extentWidth, uint32_t extentHeight);
 
   glm::mat4 ScreenSpaceMatrix(glm::mat4 model);
+  /**
+   * @brief Projection * view without touching the camera, safe to call from recording threads.
+   */
+  glm::mat4 ViewProjection() const;
 
   void OnKeyboardEvent(const SDL_KeyboardEvent& event) override;
 
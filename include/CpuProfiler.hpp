@@ -0,0 +1,95 @@
+#ifndef _coffeemaker_cpuprofiler_hpp
+#define _coffeemaker_cpuprofiler_hpp
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace CoffeeMaker {
+
+  /**
+   * CPU scope timings across threads. Every thread writes its scopes into its own ring buffer, so recording takes no
+   * lock; the rings keep the most recent scopes and older ones are overwritten. Scopes are stamped with
+   * steady_clock, the same clock the GPU profiler places its frames on, so both can be exported onto one timeline.
+   *
+   * CPU_SCOPE expands to nothing unless the build defines COFFEEMAKER_PROFILING.
+   */
+  class CpuProfiler {
+    public:
+    // NOTE: per thread, a power of two
+    static constexpr size_t RingCapacity{1 << 15};
+
+    struct Event {
+      // NOTE: string literals only, the name outlives the ring
+      const char* name{nullptr};
+      int64_t startNs{0};
+      int64_t endNs{0};
+    };
+
+    struct ThreadInfo {
+      std::string name{};
+      uint32_t id{0};
+      uint64_t recorded{0};
+    };
+
+    static int64_t NowNs();
+    /**
+     * @brief Names the calling thread in the trace.
+     */
+    static void SetThreadName(const std::string& name);
+    static void Record(const char* name, int64_t startNs, int64_t endNs);
+    static std::vector<ThreadInfo> Threads();
+    /**
+     * @brief Writes every CPU scope still in the rings and every GPU frame the GPU profiler still keeps as a
+     * chrome://tracing / Perfetto JSON file.
+     */
+    static bool ExportChromeTrace(const std::string& path);
+
+    static std::atomic<bool> Enabled;
+
+    private:
+    struct ThreadRing {
+      std::string name{};
+      uint32_t id{0};
+      // NOTE: only the owning thread writes, readers copy and then drop what was overwritten meanwhile
+      std::atomic<uint64_t> head{0};
+      std::array<Event, RingCapacity> events{};
+    };
+
+    static ThreadRing& LocalRing();
+    static std::vector<Event> Snapshot(const ThreadRing& ring);
+
+    static std::mutex gThreadsMutex;
+    static std::vector<std::unique_ptr<ThreadRing>> gThreads;
+  };
+
+  /**
+   * @brief Records the time from construction to the end of the enclosing block.
+   */
+  class CpuScope {
+    public:
+    explicit CpuScope(const char* name);
+    ~CpuScope();
+    CpuScope(const CpuScope&) = delete;
+    CpuScope& operator=(const CpuScope&) = delete;
+
+    private:
+    const char* name;
+    int64_t startNs;
+  };
+
+}  // namespace CoffeeMaker
+
+#ifdef COFFEEMAKER_PROFILING
+#define COFFEEMAKER_CPU_SCOPE_JOIN_INNER(a, b) a##b
+#define COFFEEMAKER_CPU_SCOPE_JOIN(a, b) COFFEEMAKER_CPU_SCOPE_JOIN_INNER(a, b)
+#define CPU_SCOPE(name) CoffeeMaker::CpuScope COFFEEMAKER_CPU_SCOPE_JOIN(cpuScope, __LINE__) { name }
+#else
+#define CPU_SCOPE(name)
+#endif
+
+#endif
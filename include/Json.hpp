@@ -0,0 +1,17 @@
+#ifndef _coffeemaker_json_hpp
+#define _coffeemaker_json_hpp
+
+#include <string>
+#include <string_view>
+
+namespace CoffeeMaker {
+
+  /**
+   * @brief Escapes text for a JSON string literal: quotes, backslashes and every control character, the ones
+   * without a short form as \u00XX.
+   */
+  std::string EscapeJson(std::string_view text);
+
+}  // namespace CoffeeMaker
+
+#endif
@@ -3,9 +3,12 @@
 
 #include <vulkan/vulkan.h>
 
+#include <glm/glm.hpp>
+#include <memory>
+
 #include "Camera.hpp"
+#include "Renderer/Material.hpp"
 #include "Renderer/Vertex.hpp"
-#include "Renderer/Vulkan/Pipeline.hpp"
 
 namespace CoffeeMaker::Primitives {
 
@@ -19,9 +22,11 @@ namespace CoffeeMaker::Primitives {
     ~Rectangle();
 
     Mesh mesh{};
-    PushConstants pushConstants{};
 
-    void Draw();
+    /**
+     * @brief The rectangle, drawn through a DrawList.
+     */
+    CoffeeMaker::Renderer::RenderObject Object() const;
 
     void MakeMeshPipeline();
 
@@ -30,7 +35,7 @@ namespace CoffeeMaker::Primitives {
     float w{0.0f};
     float h{0.0f};
 
-    Pipeline pipelineBuilder;
+    CoffeeMaker::Renderer::Material material{};
     std::shared_ptr<Camera> _mainCamera;
   };
 
@@ -0,0 +1,71 @@
+#ifndef _coffeemaker_renderer_drawlist_hpp
+#define _coffeemaker_renderer_drawlist_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Renderer/Material.hpp"
+#include "Renderer/Vulkan/CommandEncoder.hpp"
+
+namespace CoffeeMaker::Renderer {
+
+  /**
+   * The frame's individual draws. Every submitted RenderObject gets a 64 bit sort key and the list is radix sorted
+   * before recording, so draws sharing a pipeline, material and mesh end up next to each other. Those are told
+   * apart by their ObjectIds, whose pools are sized to the key's fields.
+   *
+   * Opaque:      layer (2) | pipeline (12) | material (12) | mesh (14) | depth (24), front to back within a state
+   * Transparent: layer (2) | ~depth (24) | pipeline (12) | material (12) | mesh (14), back to front
+   */
+  class DrawList {
+    public:
+    struct SortItem {
+      uint64_t key{0};
+      uint32_t index{0};
+    };
+
+    struct BenchmarkResult {
+      size_t count{0};
+      double radixMs{0.0};
+      double stdSortMs{0.0};
+    };
+
+    /**
+     * @brief Clears the list for a new frame, depths are measured with the view projection.
+     */
+    void Begin(const glm::mat4& viewProjection);
+    void Submit(const RenderObject& object);
+    void Sort();
+    /**
+     * @brief Records items [begin, end) of the sorted list. Only reads the list, so it is safe to call from several
+     * recording threads at once.
+     */
+    void Draw(Vulkan::CommandEncoder& encoder, size_t begin, size_t end) const;
+    size_t Size() const;
+
+    static uint64_t MakeKey(RenderLayer layer, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth);
+    /**
+     * @brief LSD radix sort on the keys, 8 bits per pass. Passes whose digit is the same for every key are skipped,
+     * so the cost follows the bits that actually vary. Stable.
+     */
+    static void RadixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch);
+    /**
+     * @brief Sorts count random keys with RadixSort and with std::sort.
+     */
+    static BenchmarkResult Benchmark(size_t count);
+
+    double LastSortMs{0.0};
+
+    private:
+    glm::mat4 viewProjection{1.0f};
+    std::vector<RenderObject> objects{};
+    std::vector<SortItem> items{};
+    std::vector<SortItem> scratch{};
+  };
+
+}  // namespace CoffeeMaker::Renderer
+
+#endif
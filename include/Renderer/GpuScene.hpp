@@ -0,0 +1,144 @@
+#ifndef _coffeemaker_renderer_gpuscene_hpp
+#define _coffeemaker_renderer_gpuscene_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "Renderer/Material.hpp"
+#include "Renderer/RenderGraph.hpp"
+#include "Renderer/Vertex.hpp"
+#include "Renderer/Vulkan/CommandEncoder.hpp"
+#include "Renderer/Vulkan/ComputePipeline.hpp"
+#include "Renderer/Vulkan/MemoryAllocator.hpp"
+
+namespace CoffeeMaker::Renderer {
+
+  /**
+   * GPU driven objects. Transforms, bounds and mesh ranges live in storage buffers, a compute pass frustum culls
+   * every object and writes the draw commands of the visible ones, and each group (a mesh and a material) is then
+   * drawn with a single indirect count draw. Per frame CPU work does not depend on the number of objects, buffers
+   * are only rewritten on frames after objects changed.
+   */
+  class GpuScene {
+    public:
+    // NOTE: layouts match cull.comp (std430)
+    struct ObjectData {
+      glm::vec4 sphere{0.0f};
+      uint32_t group{0};
+      uint32_t padding[3]{};
+    };
+
+    struct DrawGroup {
+      uint32_t firstCommand{0};
+      uint32_t indexCount{0};
+      uint32_t firstIndex{0};
+      int32_t vertexOffset{0};
+    };
+
+    struct CullConstants {
+      glm::vec4 planes[6]{};
+      uint32_t objectCount{0};
+    };
+
+    /**
+     * @brief What the culling passes write for Draw, invalid when there is nothing to draw.
+     */
+    struct CullOutputs {
+      RenderGraph::ResourceHandle commands{};
+      RenderGraph::ResourceHandle counts{};
+    };
+
+    /**
+     * @brief Builds the culling pipeline. Needs IndirectDraw::Supported.
+     */
+    void Create(size_t framesInFlight);
+    void Destroy();
+    /**
+     * @brief Registers a mesh and material pair. The mesh must be indexed and the material built with MeshInstanced,
+     * the transform of an object is read from the instance binding.
+     */
+    uint32_t AddGroup(const Mesh* mesh, const Material* material);
+    /**
+     * @param radius of a sphere around the mesh's origin that bounds it
+     */
+    uint32_t AddObject(uint32_t group, const glm::mat4& transform, float radius);
+    void SetTransform(uint32_t object, const glm::mat4& transform);
+    /**
+     * @brief Removes every group and object.
+     */
+    void Clear();
+    /**
+     * @brief Uploads the objects if they changed since the frame's buffers were last written. Render thread only,
+     * after the frame's fence has signaled.
+     */
+    void Prepare(size_t frame);
+    /**
+     * @brief Adds the passes that clear the draw counts, cull and copy the visible counts back. A pass calling Draw
+     * has to read both outputs with ResourceAccess::IndirectRead.
+     */
+    CullOutputs AddCullPasses(RenderGraph& graph, const glm::mat4& viewProjection);
+    /**
+     * @brief One indirect draw per group. Only reads the scene, so it is safe from recording threads.
+     */
+    void Draw(Vulkan::CommandEncoder& encoder, const glm::mat4& viewProjection) const;
+    size_t ObjectCount() const;
+    size_t GroupCount() const;
+    /**
+     * @brief Objects that passed culling, read back from the last time this frame slot was drawn.
+     */
+    uint32_t VisibleCount() const;
+    /**
+     * @brief Triangles of the objects that passed culling, as old as VisibleCount.
+     */
+    uint64_t VisibleTriangles() const;
+
+    private:
+    struct Group {
+      const Mesh* mesh{nullptr};
+      const Material* material{nullptr};
+      uint32_t objectCount{0};
+      uint32_t firstCommand{0};
+    };
+
+    struct FrameResources {
+      Vulkan::AllocatedBuffer transforms{};
+      Vulkan::AllocatedBuffer objects{};
+      Vulkan::AllocatedBuffer groups{};
+      Vulkan::AllocatedBuffer commands{};
+      Vulkan::AllocatedBuffer counts{};
+      Vulkan::AllocatedBuffer readback{};
+      size_t objectCapacity{0};
+      size_t groupCapacity{0};
+      // NOTE: version of the objects the buffers hold
+      uint64_t version{0};
+      // NOTE: groups whose counts were copied to readback by the last Cull
+      size_t readbackGroups{0};
+      VkDescriptorSet descriptorSet{VK_NULL_HANDLE};
+    };
+
+    /**
+     * @brief Grows the frame's buffers to fit the scene and points its descriptor set at them.
+     */
+    void Reserve(FrameResources& resources);
+    static ObjectData MakeObject(uint32_t group, const glm::mat4& transform, float radius);
+
+    std::vector<Group> groups{};
+    std::vector<InstanceData> transforms{};
+    std::vector<ObjectData> objects{};
+    std::vector<float> radii{};
+    std::vector<FrameResources> frames{};
+    size_t frame{0};
+    uint64_t version{1};
+    uint32_t visibleCount{0};
+    uint64_t visibleTriangles{0};
+    VkDescriptorPool descriptorPool{VK_NULL_HANDLE};
+    std::unique_ptr<Vulkan::ComputePipeline> cullPipeline{nullptr};
+  };
+
+}  // namespace CoffeeMaker::Renderer
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef _coffeemaker_renderer_instancebatcher_hpp
+#define _coffeemaker_renderer_instancebatcher_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Renderer/Material.hpp"
+#include "Renderer/Vertex.hpp"
+#include "Renderer/Vulkan/CommandEncoder.hpp"
+#include "Renderer/Vulkan/MemoryAllocator.hpp"
+
+namespace CoffeeMaker::Renderer {
+
+  /**
+   * Collects the render objects of a frame and draws every group that shares a mesh and a material with a single
+   * instanced draw. Transforms are written to a per frame instance buffer that the material's pipeline reads on
+   * binding 1, so the material must be built with MeshInstanced and Vertex::InstancedDescription().
+   */
+  class InstanceBatcher {
+    public:
+    struct Batch {
+      const Mesh* mesh{nullptr};
+      const Material* material{nullptr};
+      uint32_t firstInstance{0};
+      uint32_t instanceCount{0};
+    };
+
+    void Create(size_t framesInFlight);
+    void Destroy();
+    void Submit(const RenderObject& object);
+    /**
+     * @brief Groups what was submitted and uploads the transforms into the frame's instance buffer, then starts
+     * collecting the next frame. Render thread only, after the frame's fence has signaled.
+     */
+    void Prepare(size_t frame);
+    /**
+     * @brief Records batches [begin, end) of the prepared frame. Only reads the batcher, so it is safe to call from
+     * several recording threads at once.
+     */
+    void Draw(Vulkan::CommandEncoder& encoder, const glm::mat4& viewProjection, size_t begin, size_t end) const;
+    size_t BatchCount() const;
+    size_t InstanceCount() const;
+
+    private:
+    std::vector<RenderObject> objects{};
+    std::vector<Batch> batches{};
+    std::vector<InstanceData> instances{};
+    // NOTE: one per frame in flight, a buffer is only rewritten once the GPU is done reading it
+    std::vector<Vulkan::AllocatedBuffer> instanceBuffers{};
+    std::vector<size_t> capacities{};
+    size_t frame{0};
+  };
+
+}  // namespace CoffeeMaker::Renderer
+
+#endif
@@ -3,20 +3,57 @@
 
 #include <vulkan/vulkan.h>
 
+#include <cstdint>
 #include <glm/glm.hpp>
+#include <memory>
 
+#include "Renderer/ObjectId.hpp"
 #include "Renderer/Vertex.hpp"
+#include "Renderer/Vulkan/Pipeline.hpp"
+#include "Renderer/Vulkan/ShaderPermutation.hpp"
 
 namespace CoffeeMaker::Renderer {
 
+  /**
+   * Coarsest part of a draw's sort key, layers are drawn in order. See DrawList.
+   */
+  enum class RenderLayer : uint8_t {
+    Opaque = 0,
+    // NOTE: drawn back to front after everything opaque
+    Transparent = 1,
+  };
+
   struct Material {
-    VkPipeline pipeline{VK_NULL_HANDLE};
-    VkPipelineLayout layout{VK_NULL_HANDLE};
+    std::shared_ptr<Vulkan::Pipeline> pipeline{nullptr};
+    Vulkan::RenderState renderState{};
+    RenderLayer layer{RenderLayer::Opaque};
+
+    // NOTE: width of the material field of the DrawList sort key
+    static constexpr uint32_t IdBits = 12;
+    static IdPool Ids;
+    ObjectId id{Ids};
   };
 
+  /**
+   * Features of the default mesh shaders, bits of a ShaderPermutation mask.
+   */
+  enum MeshShaderFeature : uint64_t {
+    // NOTE: compiled in, colors vertices by their normal
+    MeshShowNormals = 1ull << 0,
+    // NOTE: specialization constant, the same fragment module for both values
+    MeshGrayscale = 1ull << 1,
+    // NOTE: compiled in, the model matrix comes from the instance binding, see InstanceData
+    MeshInstanced = 1ull << 2,
+  };
+
+  /**
+   * @brief triangleMesh.vert and shader.frag with the MeshShaderFeature bits, shared by the primitives.
+   */
+  const Vulkan::ShaderPermutation& MeshShaders();
+
   struct RenderObject {
-    Mesh* mesh;
-    Material* material{nullptr};
+    const Mesh* mesh{nullptr};
+    const Material* material{nullptr};
     glm::mat4 transform{0.0f};
   };
 
@@ -0,0 +1,56 @@
+#ifndef _coffeemaker_renderer_objectid_hpp
+#define _coffeemaker_renderer_objectid_hpp
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace CoffeeMaker::Renderer {
+
+  /**
+   * Hands out small ids for one kind of object. Released ids are reused first, so the ids in use stay below the
+   * number of live objects and fit the bits a sort key gives them.
+   */
+  class IdPool {
+    public:
+    /**
+     * @param bits width of the ids, running out of them is a fatal error
+     */
+    IdPool(const char* name, uint32_t bits);
+
+    IdPool(const IdPool& p) = delete;
+    IdPool& operator=(const IdPool& p) = delete;
+
+    uint32_t Acquire();
+    void Release(uint32_t id);
+
+    private:
+    const char* name;
+    uint32_t limit;
+    uint32_t next{0};
+    std::vector<uint32_t> released{};
+    std::mutex mutex{};
+  };
+
+  /**
+   * Id of an object for sorting and batching, held from creation until the object is destroyed. Unlike the
+   * object's address it is never handed to another object while this one is alive, and it orders the same way on
+   * every run. A copy is a different object and gets an id of its own.
+   */
+  class ObjectId {
+    public:
+    explicit ObjectId(IdPool& pool);
+    ObjectId(const ObjectId& other);
+    ObjectId& operator=(const ObjectId& other);
+    ~ObjectId();
+
+    uint32_t Value() const { return value; }
+
+    private:
+    IdPool* pool;
+    uint32_t value;
+  };
+
+}  // namespace CoffeeMaker::Renderer
+
+#endif
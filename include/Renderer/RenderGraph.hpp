@@ -0,0 +1,223 @@
+#ifndef _coffeemaker_renderer_rendergraph_hpp
+#define _coffeemaker_renderer_rendergraph_hpp
+
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace CoffeeMaker::Renderer {
+
+  /**
+   * How a pass uses a resource. Each access maps to the pipeline stages, memory accesses and image layout the
+   * graph synchronizes against.
+   */
+  enum class ResourceAccess : uint8_t {
+    None = 0,
+    ColorAttachment,
+    DepthAttachment,
+    DepthRead,
+    FragmentSampled,
+    ComputeSampled,
+    ComputeStorageRead,
+    ComputeStorageWrite,
+    IndirectRead,
+    VertexRead,
+    TransferRead,
+    TransferWrite,
+    HostRead,
+    Present
+  };
+
+  /**
+   * Frame graph. Every frame the passes are declared with the resources they read and write, then the graph
+   *  - culls passes whose results nothing uses,
+   *  - plans the barriers between passes, batched into one vkCmdPipelineBarrier2 per pass,
+   *  - places transient images whose lifetimes do not overlap in the same memory.
+   * Passes run in the order they were added. Compiling is skipped while the frame declares the same passes and
+   * resources as the last compiled one, imported resources may change handles without a recompile.
+   */
+  class RenderGraph {
+    public:
+    struct ResourceHandle {
+      uint32_t index{UINT32_MAX};
+
+      bool Valid() const { return index != UINT32_MAX; }
+    };
+
+    /**
+     * @brief Image owned by the graph. Usage is derived from the accesses, extra flags can be added. Images with
+     * VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT go into lazily allocated memory where the device has it.
+     */
+    struct ImageDesc {
+      VkFormat format{VK_FORMAT_UNDEFINED};
+      VkExtent2D extent{0, 0};
+      VkImageAspectFlags aspect{VK_IMAGE_ASPECT_COLOR_BIT};
+      VkImageUsageFlags usage{0};
+    };
+
+    /**
+     * @brief Image owned by someone else, e.g. the swapchain.
+     */
+    struct ImportedImage {
+      VkImage image{VK_NULL_HANDLE};
+      VkImageView view{VK_NULL_HANDLE};
+      VkImageAspectFlags aspect{VK_IMAGE_ASPECT_COLOR_BIT};
+      // NOTE: the last use before the graph, the first barrier waits on it
+      ResourceAccess previousAccess{ResourceAccess::None};
+      // NOTE: undefined discards the contents
+      VkImageLayout previousLayout{VK_IMAGE_LAYOUT_UNDEFINED};
+      // NOTE: the state the graph leaves the image in, None leaves it as the last pass did
+      ResourceAccess finalAccess{ResourceAccess::None};
+    };
+
+    struct Statistics {
+      size_t passes{0};
+      size_t culledPasses{0};
+      size_t barriers{0};
+      size_t barrierBatches{0};
+      size_t transientImages{0};
+      VkDeviceSize transientBytes{0};
+      VkDeviceSize allocatedBytes{0};
+      size_t compiles{0};
+      size_t cacheHits{0};
+      double compileMs{0.0};
+    };
+
+    /**
+     * Declares what a pass reads and writes. A resource is declared once per pass.
+     */
+    class PassBuilder {
+      public:
+      void Read(ResourceHandle resource, ResourceAccess access);
+      void Write(ResourceHandle resource, ResourceAccess access);
+      /**
+       * @brief The pass does something outside of the graph and is never culled.
+       */
+      void SideEffects();
+
+      private:
+      friend class RenderGraph;
+      PassBuilder(RenderGraph& graph, uint32_t pass);
+      void Use(ResourceHandle resource, ResourceAccess access, bool write);
+
+      RenderGraph& graph;
+      uint32_t pass;
+    };
+
+    using SetupFn = std::function<void(PassBuilder&)>;
+    using ExecuteFn = std::function<void(VkCommandBuffer)>;
+
+    void Destroy();
+    /**
+     * @brief Clears the passes and resources of the last frame. Compiled state and transient images are kept.
+     */
+    void BeginFrame();
+    ResourceHandle ImportImage(const std::string& name, const ImportedImage& image);
+    ResourceHandle ImportBuffer(const std::string& name, VkBuffer buffer,
+                                ResourceAccess finalAccess = ResourceAccess::None);
+    ResourceHandle CreateImage(const std::string& name, const ImageDesc& desc);
+    void AddPass(const std::string& name, const SetupFn& setup, ExecuteFn execute);
+    void Compile();
+    /**
+     * @brief Records the passes that survived culling, each after its barriers.
+     */
+    void Execute(VkCommandBuffer cmd);
+
+    VkImage Image(ResourceHandle resource) const;
+    VkImageView ImageView(ResourceHandle resource) const;
+    VkBuffer Buffer(ResourceHandle resource) const;
+    const Statistics& Stats() const;
+    /**
+     * @brief The compiled frame in dot format. Culled passes are dashed, transients list their memory block.
+     */
+    std::string Graphviz() const;
+    bool DumpGraphviz(const std::string& path) const;
+
+    static const char* AccessName(ResourceAccess access);
+
+    private:
+    struct Access {
+      uint32_t resource{0};
+      ResourceAccess access{ResourceAccess::None};
+      bool write{false};
+    };
+
+    struct Pass {
+      std::string name{};
+      std::vector<Access> accesses{};
+      ExecuteFn execute{};
+      bool sideEffects{false};
+    };
+
+    struct Resource {
+      std::string name{};
+      bool imported{false};
+      bool isImage{true};
+      ImageDesc desc{};
+      ImportedImage importedImage{};
+      VkBuffer buffer{VK_NULL_HANDLE};
+      ResourceAccess finalAccess{ResourceAccess::None};
+    };
+
+    struct Barrier {
+      uint32_t resource{0};
+      VkPipelineStageFlags2 srcStages{0};
+      VkAccessFlags2 srcAccess{0};
+      VkPipelineStageFlags2 dstStages{0};
+      VkAccessFlags2 dstAccess{0};
+      VkImageLayout oldLayout{VK_IMAGE_LAYOUT_UNDEFINED};
+      VkImageLayout newLayout{VK_IMAGE_LAYOUT_UNDEFINED};
+    };
+
+    struct CompiledPass {
+      uint32_t pass{0};
+      std::vector<Barrier> barriers{};
+    };
+
+    struct TransientImage {
+      VkImage image{VK_NULL_HANDLE};
+      VkImageView view{VK_NULL_HANDLE};
+      uint32_t block{UINT32_MAX};
+      VkMemoryRequirements requirements{};
+      // NOTE: first and last compiled pass using the image
+      uint32_t first{UINT32_MAX};
+      uint32_t last{0};
+    };
+
+    // NOTE: freed once the frame timeline reaches the value, see Vulkan::Synchronization
+    struct Retired {
+      uint64_t value{0};
+      std::vector<TransientImage> transients{};
+      std::vector<VmaAllocation> blocks{};
+    };
+
+    /**
+     * @brief Everything that decides the compiled result, compared to skip compiling.
+     */
+    std::string Signature() const;
+    void Cull();
+    void AllocateTransients();
+    void PlanBarriers();
+    void RetireTransients();
+    void DestroyRetired(bool all);
+
+    std::vector<Pass> passes{};
+    std::vector<Resource> resources{};
+
+    std::string compiledSignature{};
+    std::vector<bool> culled{};
+    std::vector<CompiledPass> compiled{};
+    std::vector<Barrier> finalBarriers{};
+    std::vector<TransientImage> transients{};
+    std::vector<VmaAllocation> blocks{};
+    std::vector<Retired> retired{};
+    Statistics stats{};
+  };
+
+}  // namespace CoffeeMaker::Renderer
+
+#endif
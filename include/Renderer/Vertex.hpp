@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 #include <string>
 
+#include "Renderer/ObjectId.hpp"
 #include "Renderer/Vulkan/MemoryAllocator.hpp"
 #include "Renderer/Vulkan/Pipeline.hpp"
 
@@ -20,6 +21,17 @@ namespace CoffeeMaker::Renderer {
      * description, which is why this method is static.
      */
     static CoffeeMaker::Renderer::Vulkan::VertexInputDescription Description();
+    /**
+     * Description() plus the per instance attributes of InstanceData on binding 1.
+     */
+    static CoffeeMaker::Renderer::Vulkan::VertexInputDescription InstancedDescription();
+  };
+
+  /**
+   * Per instance attributes, stepped once per instance by the INSTANCED mesh shaders.
+   */
+  struct InstanceData {
+    glm::mat4 model;  // locations 3 - 6, one per column
   };
 
   struct Mesh {
@@ -33,6 +45,11 @@ namespace CoffeeMaker::Renderer {
     void LoadObj(const std::string& filename);
     void CreateVertexBuffer();
     void CreateIndexBuffer();
+
+    // NOTE: width of the mesh field of the DrawList sort key
+    static constexpr uint32_t IdBits = 14;
+    static IdPool Ids;
+    ObjectId id{Ids};
   };
 
   struct MeshPushConstants {
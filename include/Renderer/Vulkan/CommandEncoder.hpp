@@ -0,0 +1,139 @@
+#ifndef _coffeemaker_renderer_vulkan_commandencoder_hpp
+#define _coffeemaker_renderer_vulkan_commandencoder_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "Renderer/Vulkan/Pipeline.hpp"
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  enum class EncodedCall : uint8_t {
+    Pipeline = 0,
+    VertexBuffers,
+    IndexBuffer,
+    DescriptorSets,
+    DynamicState,
+    PushConstants,
+    Count
+  };
+
+  enum class EncodedCounter : uint8_t {
+    DrawCalls = 0,
+    Instances,
+    Triangles,
+    // NOTE: upper bound, indirect draws are counted as if every command up to the maximum drew all its instances
+    IndirectTriangles,
+    PushConstantBytes,
+    Count
+  };
+
+  /**
+   * Thin wrapper around a command buffer that remembers the state it has bound and drops calls that would bind the
+   * same state again. An encoder belongs to one thread and one command buffer, state is not tracked across
+   * encoders. Per frame counts of issued and elided calls, and of what the draws submitted, are kept for the editor.
+   */
+  class CommandEncoder {
+    public:
+    explicit CommandEncoder(VkCommandBuffer cmd);
+    /**
+     * @brief Adds this encoder's counts to the frame's.
+     */
+    ~CommandEncoder();
+
+    CommandEncoder(const CommandEncoder& e) = delete;
+    CommandEncoder& operator=(const CommandEncoder& e) = delete;
+
+    void BindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline);
+    void BindVertexBuffers(uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* buffers,
+                           const VkDeviceSize* offsets);
+    void BindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType);
+    /**
+     * @brief Sets without dynamic offsets are skipped when the same sets are bound with the same layout.
+     */
+    void BindDescriptorSets(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t firstSet,
+                            uint32_t setCount, const VkDescriptorSet* sets, uint32_t dynamicOffsetCount = 0,
+                            const uint32_t* dynamicOffsets = nullptr);
+    /**
+     * @brief Records the render state through DynamicState when it differs from the last one set.
+     */
+    void SetRenderState(const RenderState& state);
+    /**
+     * @brief Skipped when the same bytes were already pushed to the same range with the same layout.
+     */
+    void PushConstants(VkPipelineLayout layout, VkShaderStageFlags stages, uint32_t offset, uint32_t size,
+                       const void* data);
+    void Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance);
+    void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset,
+                     uint32_t firstInstance);
+    /**
+     * @brief Records through IndirectDraw. The GPU picks the draws, indexCount is only used for the counters.
+     */
+    void DrawIndexedIndirectCount(VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer,
+                                  VkDeviceSize countOffset, uint32_t maxDrawCount, uint32_t stride,
+                                  uint32_t indexCount);
+
+    VkCommandBuffer Buffer() const;
+
+    /**
+     * @brief Moves the counts of the frame that just finished recording to LastIssued, LastElided and
+     * LastCounters. Render thread only, once every encoder of the frame is gone.
+     */
+    static void EndFrame();
+    static const char* CallName(EncodedCall call);
+    static size_t LastCounter(EncodedCounter counter);
+
+    static constexpr size_t CALL_COUNT = static_cast<size_t>(EncodedCall::Count);
+    static std::array<std::atomic<size_t>, CALL_COUNT> gIssued;
+    static std::array<std::atomic<size_t>, CALL_COUNT> gElided;
+    static std::array<size_t, CALL_COUNT> LastIssued;
+    static std::array<size_t, CALL_COUNT> LastElided;
+    static constexpr size_t COUNTER_COUNT = static_cast<size_t>(EncodedCounter::Count);
+    static std::array<std::atomic<size_t>, COUNTER_COUNT> gCounters;
+    static std::array<size_t, COUNTER_COUNT> LastCounters;
+
+    private:
+    // NOTE: the spec's guaranteed minimum, every layout in the renderer fits
+    static constexpr uint32_t MAX_PUSH_CONSTANT_BYTES = 128;
+    static constexpr uint32_t MAX_VERTEX_BINDINGS = 4;
+    static constexpr uint32_t MAX_DESCRIPTOR_SETS = 4;
+
+    struct BindPointState {
+      VkPipeline pipeline{VK_NULL_HANDLE};
+      VkPipelineLayout setLayout{VK_NULL_HANDLE};
+      std::array<VkDescriptorSet, MAX_DESCRIPTOR_SETS> sets{};
+    };
+
+    /**
+     * @brief Counts the call and returns true when it has to be recorded.
+     */
+    bool Issue(EncodedCall call, bool redundant);
+    void Count(EncodedCounter counter, size_t amount);
+    BindPointState& State(VkPipelineBindPoint bindPoint);
+
+    VkCommandBuffer cmd{VK_NULL_HANDLE};
+    BindPointState graphics{};
+    BindPointState compute{};
+    std::array<VkBuffer, MAX_VERTEX_BINDINGS> vertexBuffers{};
+    std::array<VkDeviceSize, MAX_VERTEX_BINDINGS> vertexOffsets{};
+    VkBuffer indexBuffer{VK_NULL_HANDLE};
+    VkDeviceSize indexOffset{0};
+    VkIndexType indexType{VK_INDEX_TYPE_UINT16};
+    RenderState renderState{};
+    bool hasRenderState{false};
+    VkPipelineLayout pushLayout{VK_NULL_HANDLE};
+    VkShaderStageFlags pushStages{0};
+    uint32_t pushOffset{0};
+    uint32_t pushSize{0};
+    std::array<uint8_t, MAX_PUSH_CONSTANT_BYTES> pushData{};
+    std::array<size_t, CALL_COUNT> issued{};
+    std::array<size_t, CALL_COUNT> elided{};
+    std::array<size_t, COUNTER_COUNT> counters{};
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef _coffeemaker_renderer_vulkan_commandrecorder_hpp
+#define _coffeemaker_renderer_vulkan_commandrecorder_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  /**
+   * Records a draw list across worker threads. The list is split into contiguous chunks, each chunk is recorded
+   * into a secondary command buffer on a worker and the render thread executes them, in order, from the primary.
+   * Buffers come from the calling thread's arena of the current FrameContext, so recording never takes a lock.
+   */
+  class CommandRecorder {
+    public:
+    using RecordFunction = std::function<void(VkCommandBuffer cmd, size_t begin, size_t end)>;
+
+    /**
+     * @brief Spins up the workers, 0 picks a count based on the number of hardware threads.
+     */
+    static void Start(size_t threadCount = 0);
+    static void Stop();
+    /**
+     * @brief Arenas a FrameContext needs, one per worker plus the render thread.
+     */
+    static size_t ThreadSlots();
+    /**
+     * @brief Render pass and framebuffer the secondaries continue, their viewport and scissor cover the extent.
+     */
+    static void SetTarget(VkRenderPass renderPass, VkFramebuffer framebuffer, VkExtent2D extent);
+    /**
+     * @brief Secondaries continue dynamic rendering instead, against the DynamicRendering attachment formats.
+     */
+    static void SetRenderingTarget(VkExtent2D extent, bool withDepth = true);
+    /**
+     * @brief Records items [0, count) in chunks and executes them into the primary, which must be inside a render
+     * pass begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS. The function is called from several threads
+     * at once. Returns once everything is recorded.
+     */
+    static void Record(VkCommandBuffer primary, size_t count, const RecordFunction& record);
+    /**
+     * @brief Begins a secondary command buffer for the render thread, e.g. for the UI. End it with
+     * vkEndCommandBuffer before executing it.
+     */
+    static VkCommandBuffer BeginSecondary();
+
+    static std::vector<std::thread> gWorkers;
+    static std::mutex gMutex;
+    static std::condition_variable gCondition;
+    static std::condition_variable gIdleCondition;
+    static bool gStopping;
+    // NOTE: off records the whole list into one secondary on the render thread
+    static bool Enabled;
+    static const size_t MinItemsPerChunk;
+    static size_t LastChunkCount;
+    static double LastRecordMs;
+
+    private:
+    struct Chunk {
+      size_t begin{0};
+      size_t end{0};
+      VkCommandBuffer* result{nullptr};
+    };
+
+    static void WorkerLoop(size_t slot);
+    /**
+     * @brief Records one chunk with the arena of the calling thread's slot.
+     */
+    static void RecordChunk(size_t slot, const Chunk& chunk);
+    /**
+     * @brief Begins a secondary from the slot's arena, the last slot belongs to the render thread.
+     */
+    static VkCommandBuffer Allocate(size_t slot);
+
+    static std::deque<Chunk> gQueue;
+    static const RecordFunction* gRecord;
+    static size_t gRemaining;
+    static VkCommandBufferInheritanceInfo gInheritance;
+    static VkCommandBufferInheritanceRenderingInfo gRenderingInheritance;
+    static VkExtent2D gExtent;
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
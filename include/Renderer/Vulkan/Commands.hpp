@@ -14,24 +14,46 @@ namespace CoffeeMaker::Renderer::Vulkan {
 
   VkCommandBufferBeginInfo CommandBufferBeginInfo(VkCommandBufferUsageFlags flags);
 
+  /**
+   * Recording of the frame's primary command buffer. The buffer itself comes from the FrameContext.
+   */
   class Commands {
     public:
     static void SetClearValues();
-    static void CreateCommandPool();
-    static void CreateCommandBuffers();
-    static void ResetCommandBuffers(size_t swapChainImageIndex);
-    static void BeginRecording(size_t swapchainImageIndex);
-    static void EndRecording(size_t swapchainImageIndex);
+    /**
+     * @brief Begins the buffer and the render pass. With VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS everything
+     * in the pass must come from secondaries, see CommandRecorder.
+     */
+    static void BeginRecording(VkCommandBuffer cmd, size_t swapchainImageIndex,
+                               VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE,
+                               VkImageView depthView = VK_NULL_HANDLE);
+    /**
+     * @brief Begins the buffer only, for work that has to be recorded before the render pass (e.g. compute).
+     */
+    static void BeginBuffer(VkCommandBuffer cmd);
+    /**
+     * @brief Begins dynamic rendering instead when the device supports it, the contents map to the rendering flags.
+     * @param depthView depth attachment of the dynamic rendering, the render pass path uses the framebuffer's
+     */
+    static void BeginRenderPass(size_t swapchainImageIndex, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE,
+                                VkImageView depthView = VK_NULL_HANDLE);
+    static void BeginRendering(size_t swapchainImageIndex, VkSubpassContents contents, VkImageView depthView);
+    /**
+     * @brief Dynamic rendering on the color attachment only, keeping what is already in it. Secondaries only.
+     */
+    static void BeginOverlayRendering(size_t swapchainImageIndex);
+    /**
+     * @brief Ends the render pass and the buffer.
+     */
+    static void EndRecording();
+    static void EndRenderPass();
+    static void EndBuffer();
     static VkCommandBuffer GetCurrentBuffer();
-    static void DestroyCommandPool();
-    static void FreeCommandBuffers();
 
-    static VkCommandPool commandPool;
     static VkClearValue clearColor;
     static VkClearValue depthClear;
     static std::array<VkClearValue, 2> clearValues;
-    static std::vector<VkCommandBuffer> CommandBuffers;
-    static size_t CurrentCmdBufferIndex;
+    static VkCommandBuffer CurrentBuffer;
   };
 
 }  // namespace CoffeeMaker::Renderer::Vulkan
@@ -0,0 +1,55 @@
+#ifndef _coffeemaker_renderer_vulkan_computepipeline_hpp
+#define _coffeemaker_renderer_vulkan_computepipeline_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Renderer/Vulkan/Pipeline.hpp"
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  struct ComputePipelineCreateInfo {
+    VkShaderModule computeShader{VK_NULL_HANDLE};
+    uint32_t pushConstantRangeCount = 0;
+    VkPushConstantRange pushConstants{};
+    // NOTE: bindings of each descriptor set, indexed by set number
+    std::vector<std::vector<VkDescriptorSetLayoutBinding>> descriptorSets{};
+    // NOTE: local_size_x/y/z of the shader, used to size dispatches
+    std::array<uint32_t, 3> localSize{1, 1, 1};
+  };
+
+  /**
+   * A compute shader and its layout. Layouts are shared with graphics pipelines through the PipelineRegistry,
+   * the pipeline itself is small enough to build on the render thread.
+   */
+  class ComputePipeline {
+    public:
+    void CreatePipeline(ComputePipelineCreateInfo info);
+    void Bind(VkCommandBuffer cmd) const;
+    /**
+     * @brief Workgroups needed to cover count invocations along x.
+     */
+    uint32_t GroupCount(uint32_t count) const;
+    ComputePipeline();
+    ~ComputePipeline();
+
+    ComputePipeline(const ComputePipeline& p) = delete;
+    ComputePipeline& operator=(const ComputePipeline& p) = delete;
+
+    VkPipeline pPipeline{VK_NULL_HANDLE};
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    VkPipelineLayout layout{VK_NULL_HANDLE};
+    std::shared_ptr<PipelineLayout> sharedLayout{nullptr};
+    std::vector<std::shared_ptr<DescriptorSetLayout>> sharedSetLayouts{};
+    std::vector<VkDescriptorSetLayout> setLayouts{};
+    ComputePipelineCreateInfo info;
+    double compileMs{0.0};
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
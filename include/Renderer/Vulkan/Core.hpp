@@ -9,16 +9,35 @@
 #include <string>
 #include <vector>
 
+#include "Renderer/Vulkan/CommandEncoder.hpp"
+#include "Renderer/Vulkan/CommandRecorder.hpp"
 #include "Renderer/Vulkan/Commands.hpp"
+#include "Renderer/Vulkan/ComputePipeline.hpp"
+#include "Renderer/Vulkan/DynamicRendering.hpp"
+#include "Renderer/Vulkan/DynamicState.hpp"
+#include "Renderer/Vulkan/FrameContext.hpp"
+#include "Renderer/Vulkan/FrameCounters.hpp"
+#include "Renderer/Vulkan/FramePacer.hpp"
 #include "Renderer/Vulkan/Framebuffer.hpp"
+#include "Renderer/Vulkan/GpuProfiler.hpp"
+#include "Renderer/Vulkan/IndirectDraw.hpp"
 #include "Renderer/Vulkan/LogicalDevice.hpp"
 #include "Renderer/Vulkan/MemoryAllocator.hpp"
 #include "Renderer/Vulkan/PhysicalDevice.hpp"
 #include "Renderer/Vulkan/Pipeline.hpp"
+#include "Renderer/Vulkan/PipelineCache.hpp"
+#include "Renderer/Vulkan/PipelineCompiler.hpp"
+#include "Renderer/Vulkan/PipelineLibrary.hpp"
+#include "Renderer/Vulkan/PipelineRegistry.hpp"
 #include "Renderer/Vulkan/RenderPass.hpp"
+#include "Renderer/Vulkan/ShaderCompiler.hpp"
+#include "Renderer/Vulkan/ShaderPermutation.hpp"
+#include "Renderer/Vulkan/ShaderReflection.hpp"
+#include "Renderer/Vulkan/ShaderWatcher.hpp"
 #include "Renderer/Vulkan/Surface.hpp"
 #include "Renderer/Vulkan/Swapchain.hpp"
 #include "Renderer/Vulkan/Synchronization.hpp"
+#include "Renderer/Vulkan/Synchronization2.hpp"
 #include "Renderer/Vulkan/Utilities.hpp"
 
 namespace CoffeeMaker::Renderer::Vulkan {
@@ -0,0 +1,55 @@
+#ifndef _coffeemaker_renderer_vulkan_dynamicrendering_hpp
+#define _coffeemaker_renderer_vulkan_dynamicrendering_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  /**
+   * VK_KHR_dynamic_rendering support. When available there is no VkRenderPass or VkFramebuffer, rendering begins
+   * on the attachment views directly and pipelines are created against the attachment formats only. Devices
+   * without the extension keep the render pass path.
+   */
+  class DynamicRendering {
+    public:
+    /**
+     * @brief Enables the extension and its dependencies when the selected device supports them. Call before
+     * creating the logical device.
+     */
+    static void EnableIfSupported(std::vector<const char*>& deviceExtensions);
+    static void LoadFunctions(VkDevice device);
+    /**
+     * @brief Formats pipelines and secondaries are created against. Pipelines keep working across a resize as long
+     * as the formats stay the same.
+     */
+    static void SetAttachmentFormats(VkFormat color, VkFormat depth);
+    /**
+     * @brief Chain into a pipeline's pNext in place of a render pass, points at static storage.
+     */
+    static VkPipelineRenderingCreateInfo PipelineRenderingInfo();
+    /**
+     * @brief Chain into the inheritance info of secondaries that continue rendering, points at static storage.
+     * @param withDepth false for rendering that only has the color attachment
+     */
+    static VkCommandBufferInheritanceRenderingInfo InheritanceRenderingInfo(bool withDepth = true);
+    static void Begin(VkCommandBuffer cmd, const VkRenderingInfo& renderingInfo);
+    static void End(VkCommandBuffer cmd);
+
+    // NOTE: off keeps the render pass path, only read when the logical device is created
+    static bool Requested;
+    static bool Supported;
+    static VkPhysicalDeviceDynamicRenderingFeatures gFeatures;
+
+    private:
+    static PFN_vkCmdBeginRenderingKHR gCmdBeginRendering;
+    static PFN_vkCmdEndRenderingKHR gCmdEndRendering;
+    static VkFormat gColorFormat;
+    static VkFormat gDepthFormat;
+    static VkFormat gStencilFormat;
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef _coffeemaker_renderer_vulkan_dynamicstate_hpp
+#define _coffeemaker_renderer_vulkan_dynamicstate_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+#include "Renderer/Vulkan/Pipeline.hpp"
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  /**
+   * VK_EXT_extended_dynamic_state support. When available cull mode, front face, topology and the
+   * depth state are no longer baked into pipelines, and with VK_EXT_extended_dynamic_state3 neither
+   * is polygon mode. Devices without the extensions keep using the static pipeline state.
+   */
+  class DynamicState {
+    public:
+    /**
+     * @brief Enables the extensions and features the selected device supports. Call before creating the logical
+     * device.
+     */
+    static void EnableIfSupported(std::vector<const char*>& deviceExtensions);
+    static void LoadFunctions(VkDevice device);
+    /**
+     * @brief Adds the states this device can set dynamically to a pipeline's dynamic state list.
+     */
+    static void AppendDynamicStates(std::vector<VkDynamicState>& dynamicStates);
+    /**
+     * @brief Records the render state for the next draw. Does nothing when the state is baked into the pipeline.
+     */
+    static void SetRenderState(VkCommandBuffer cmd, const RenderState& state);
+    /**
+     * @brief Dynamic topology may only change within a class (points, lines, triangles, patches).
+     */
+    static uint32_t TopologyClass(VkPrimitiveTopology topology);
+
+    static bool ExtendedDynamicState;
+    static bool ExtendedDynamicState3PolygonMode;
+    static VkPhysicalDeviceExtendedDynamicStateFeaturesEXT gExtendedDynamicStateFeatures;
+    static VkPhysicalDeviceExtendedDynamicState3FeaturesEXT gExtendedDynamicState3Features;
+
+    private:
+    static PFN_vkCmdSetCullModeEXT gCmdSetCullMode;
+    static PFN_vkCmdSetFrontFaceEXT gCmdSetFrontFace;
+    static PFN_vkCmdSetPrimitiveTopologyEXT gCmdSetPrimitiveTopology;
+    static PFN_vkCmdSetDepthTestEnableEXT gCmdSetDepthTestEnable;
+    static PFN_vkCmdSetDepthWriteEnableEXT gCmdSetDepthWriteEnable;
+    static PFN_vkCmdSetDepthCompareOpEXT gCmdSetDepthCompareOp;
+    static PFN_vkCmdSetPolygonModeEXT gCmdSetPolygonMode;
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
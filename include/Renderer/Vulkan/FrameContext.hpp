@@ -0,0 +1,72 @@
+#ifndef _coffeemaker_renderer_vulkan_framecontext_hpp
+#define _coffeemaker_renderer_vulkan_framecontext_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  /**
+   * Transient command pool used by a single thread for a single frame. Buffers are handed out linearly and all of
+   * them come back at once when the pool is reset, nothing is freed or reset one buffer at a time.
+   */
+  class CommandArena {
+    public:
+    void Create(uint32_t queueFamilyIndex);
+    void Destroy();
+    /**
+     * @brief Next unused buffer of the level, allocating more only the first time a frame needs them.
+     */
+    VkCommandBuffer Allocate(VkCommandBufferLevel level);
+    void Reset();
+
+    VkCommandPool pool{VK_NULL_HANDLE};
+    std::vector<VkCommandBuffer> primaries{};
+    size_t usedPrimaries{0};
+    std::vector<VkCommandBuffer> secondaries{};
+    size_t usedSecondaries{0};
+  };
+
+  /**
+   * Everything the CPU records for one frame in flight. A context is only reused once the timeline value of the
+   * frame that last used it has been reached, so its arenas can be reset wholesale. Arena i belongs to recording
+   * thread i, the last one to the render thread.
+   *
+   * Build with COFFEEMAKER_PER_BUFFER_RESET to reset every buffer on its own instead, for comparing the two.
+   */
+  class FrameContext {
+    public:
+    static void Create(size_t framesInFlight, size_t threadSlots);
+    static void Destroy();
+    /**
+     * @brief Resets the frame's arenas and makes it current. Call after Synchronization::WaitForFrame.
+     */
+    static FrameContext& Begin(size_t frame);
+    static FrameContext& Current();
+    /**
+     * @brief Adds the CPU time spent recording the current frame to the running average.
+     */
+    static void ReportRecording(double ms);
+
+    CommandArena& Arena(size_t slot);
+    CommandArena& RenderArena();
+    /**
+     * @brief Primary and secondary buffers handed out since the frame began.
+     */
+    size_t CommandBufferCount() const;
+
+    size_t index{0};
+    std::vector<CommandArena> arenas{};
+
+    static std::vector<FrameContext> gFrames;
+    static size_t gCurrent;
+    // NOTE: exponential moving averages, a single frame is too noisy to compare
+    static double ResetMs;
+    static double RecordMs;
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef _coffeemaker_renderer_vulkan_framecounters_hpp
+#define _coffeemaker_renderer_vulkan_framecounters_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  /**
+   * Per frame render counters. The CPU side is gathered from the command encoders, the allocator and the frame's
+   * command arenas once recording ends. Where pipelineStatisticsQuery and inheritedQueries are supported, a pipeline
+   * statistics query around the frame's passes adds what the GPU actually processed; like the GPU profiler, a slot's
+   * query is read once the frame timeline has passed its frame, so those numbers lag by the frames in flight.
+   */
+  class FrameCounters {
+    public:
+    struct Counters {
+      uint64_t frame{0};
+      uint64_t drawCalls{0};
+      uint64_t instances{0};
+      uint64_t triangles{0};
+      // NOTE: upper bound of the indirect draws, the GPU decides how many of them are drawn
+      uint64_t indirectTriangles{0};
+      // NOTE: direct draws plus the GPU culled objects read back from the last time the frame slot was drawn
+      uint64_t visibleTriangles{0};
+      uint64_t pipelineBinds{0};
+      uint64_t descriptorBinds{0};
+      uint64_t pushConstantBytes{0};
+      uint64_t uploadedBytes{0};
+      uint64_t commandBuffers{0};
+    };
+
+    struct Statistics {
+      // NOTE: frame the query was recorded in, 0 until the first one is read
+      uint64_t frame{0};
+      uint64_t inputPrimitives{0};
+      uint64_t vertexInvocations{0};
+      // NOTE: primitives left after clipping and culling
+      uint64_t clippingPrimitives{0};
+      uint64_t fragmentInvocations{0};
+    };
+
+    /**
+     * @brief Enables the features the selected device supports. Call before creating the logical device.
+     */
+    static void EnableIfSupported();
+    static void Create(size_t framesInFlight);
+    static void Destroy();
+    /**
+     * @brief Reads every slot the GPU has finished and resets the slot's query. Call right after beginning the
+     * frame's command buffer.
+     */
+    static void BeginFrame(VkCommandBuffer cmd, size_t frame);
+    /**
+     * @brief The query has to begin and end outside of any render pass.
+     */
+    static void BeginQuery(VkCommandBuffer cmd);
+    static void EndQuery(VkCommandBuffer cmd);
+    /**
+     * @brief Statistics secondary command buffers have to inherit, executed inside the query.
+     */
+    static VkQueryPipelineStatisticFlags InheritedStatistics();
+    /**
+     * @brief Gathers the CPU counters of the frame that just finished recording. Call after CommandEncoder::EndFrame.
+     */
+    static void EndFrame(uint64_t culledVisibleTriangles);
+    /**
+     * @brief Appends one row per frame, as CSV when the path ends in .csv and as JSON lines otherwise. An empty path
+     * stops logging.
+     */
+    static void SetLogPath(const std::string& path);
+
+    static bool Supported;
+    static bool Enabled;
+    static Counters Last;
+    static Statistics LastStatistics;
+    static std::string LogPath;
+
+    private:
+    struct Slot {
+      VkQueryPool pool{VK_NULL_HANDLE};
+      uint64_t value{0};
+      uint64_t frame{0};
+      bool pending{false};
+    };
+
+    static void Read(Slot& slot);
+    static void WriteRow();
+
+    static std::vector<Slot> gSlots;
+    static size_t gCurrent;
+    static uint64_t gFrame;
+    static bool gQueryOpen;
+    static bool gCsv;
+    static std::ofstream gLog;
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef _coffeemaker_renderer_vulkan_framepacer_hpp
+#define _coffeemaker_renderer_vulkan_framepacer_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  /**
+   * Decides when the CPU starts a frame. Normally that is as soon as fewer than FramesInFlight frames are queued on
+   * the GPU. In low latency mode the next frame waits for the previous one to finish on the GPU and, with
+   * VK_KHR_present_wait, to reach the screen. It then sleeps until just enough time is left for its CPU and GPU
+   * work before the next refresh, so input is sampled as late as possible. Without present wait the refresh phase
+   * is unknown and there is no sleep, only the single frame in flight.
+   *
+   * Input to present latency is measured with present ids when the device has them, otherwise up to GPU completion.
+   * Outside of low latency mode frames are only checked once per frame, so the measurement is an upper bound.
+   */
+  class FramePacer {
+    public:
+    // NOTE: per-frame resources are created for this many slots, FramesInFlight can change at runtime
+    static constexpr size_t MaxFramesInFlight{4};
+
+    /**
+     * @brief Enables present id and present wait when the selected device supports both. Call before creating the
+     * logical device.
+     */
+    static void EnableIfSupported(std::vector<const char*>& deviceExtensions);
+    static void LoadFunctions(VkDevice device);
+    static void SetRefreshRate(int hz);
+    /**
+     * @brief Blocks until the next frame may start. Call right before sampling input.
+     */
+    static void WaitForNextFrame();
+    /**
+     * @brief Call once the frame's work is submitted with the timeline value it signals.
+     */
+    static void FrameSubmitted(uint64_t value);
+    /**
+     * @brief Presents, tagging the present with the frame's value when present ids are available.
+     */
+    static VkResult Present(VkQueue queue, VkPresentInfoKHR presentInfo, uint64_t value);
+    /**
+     * @brief Presents still pending on the old swapchain can no longer be waited on.
+     */
+    static void SwapchainRecreated();
+
+    static size_t FramesInFlight;
+    static bool LowLatency;
+    static double SafetyMarginMs;
+
+    static bool PresentWaitSupported;
+    static VkPhysicalDevicePresentIdFeaturesKHR gPresentIdFeatures;
+    static VkPhysicalDevicePresentWaitFeaturesKHR gPresentWaitFeatures;
+
+    // NOTE: exponential moving averages, a single frame is too noisy to compare
+    static double LatencyMs;
+    static double LastLatencyMs;
+    static double CpuMs;
+    static double GpuMs;
+    static double RefreshIntervalMs;
+    static double LastSleepMs;
+    static double LastWaitMs;
+
+    private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Frame {
+      uint64_t value{0};
+      Clock::time_point input{};
+      Clock::time_point submit{};
+    };
+
+    /**
+     * @brief Records the latency of every tracked frame that has been presented (or completed) by now.
+     * @param block wait for the newest frame instead of only checking
+     */
+    static void Measure(bool block);
+    static void Report(const Frame& frame, Clock::time_point end);
+
+    static PFN_vkWaitForPresentKHR gWaitForPresent;
+    static std::deque<Frame> gFrames;
+    static Clock::time_point gInput;
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <vulkan/vulkan.h>
 
+#include <cstdint>
 #include <vector>
 
 namespace CoffeeMaker::Renderer::Vulkan {
@@ -11,8 +12,25 @@ namespace CoffeeMaker::Renderer::Vulkan {
     public:
     static void ClearFramebuffers();
     static void CreateFramebuffers();
+    /**
+     * @brief Moves the framebuffers aside, frames up to and including lastUse may still render to them.
+     */
+    static void RetireFramebuffers(uint64_t lastUse);
+    /**
+     * @brief Destroys retired framebuffers the frame timeline has passed, or all of them.
+     */
+    static void DestroyRetired(bool all);
 
     static std::vector<VkFramebuffer> framebuffers;
+
+    private:
+    // NOTE: freed once the frame timeline reaches the value, see Vulkan::Synchronization
+    struct Retired {
+      uint64_t value{0};
+      std::vector<VkFramebuffer> framebuffers{};
+    };
+
+    static std::vector<Retired> gRetired;
   };
 
 }  // namespace CoffeeMaker::Renderer::Vulkan
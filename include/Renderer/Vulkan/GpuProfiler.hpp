@@ -0,0 +1,147 @@
+#ifndef _coffeemaker_renderer_vulkan_gpuprofiler_hpp
+#define _coffeemaker_renderer_vulkan_gpuprofiler_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  /**
+   * GPU timings from timestamp queries. Every frame slot owns a query pool, scopes write a timestamp when they open
+   * and when they close, and scopes opened inside another one are nested under it. A slot's results are read once
+   * the frame timeline has passed its frame, so reading never waits on the GPU and the numbers are as many frames
+   * old as there are frames in flight.
+   *
+   * Scopes are only recorded into the frame's primary command buffer, from the thread recording it, and never
+   * inside a render pass that executes secondary command buffers.
+   */
+  class GpuProfiler {
+    public:
+    // NOTE: two queries per scope, scopes past the limit are not timed
+    static constexpr uint32_t MaxScopes{64};
+    // NOTE: read frames kept for the trace export
+    static constexpr size_t MaxHistory{240};
+
+    struct ScopeStats {
+      // NOTE: parent scope names joined by '/'
+      std::string path{};
+      std::string name{};
+      uint32_t depth{0};
+      double lastMs{0.0};
+      double averageMs{0.0};
+      double minMs{0.0};
+      double maxMs{0.0};
+      uint64_t samples{0};
+    };
+
+    struct ScopeTime {
+      uint32_t stats{0};
+      // NOTE: relative to the frame's first timestamp
+      double beginMs{0.0};
+      double endMs{0.0};
+    };
+
+    struct FrameTimes {
+      uint64_t frame{0};
+      // NOTE: steady_clock nanoseconds of the submit, the GPU cannot have started any earlier
+      int64_t submitNs{0};
+      std::vector<ScopeTime> scopes{};
+    };
+
+    static void Create(size_t framesInFlight);
+    static void Destroy();
+    /**
+     * @brief Reads every slot the GPU has finished and resets the slot's queries. Call right after beginning the
+     * frame's command buffer, before any scope.
+     */
+    static void BeginFrame(VkCommandBuffer cmd, size_t frame);
+    static void BeginScope(VkCommandBuffer cmd, const std::string& name);
+    static void EndScope(VkCommandBuffer cmd);
+    /**
+     * @brief Call right after submitting the frame, its scopes are placed at the submit time on the CPU clock.
+     */
+    static void FrameSubmitted(size_t frame);
+    /**
+     * @brief Clears the min, max and averages.
+     */
+    static void ResetStats();
+    /**
+     * @brief Appends one JSON object per read frame to the file, an empty path stops logging.
+     */
+    static void SetLogPath(const std::string& path);
+    /**
+     * @brief Scopes seen in the last read frame, in the order they were opened.
+     */
+    static std::vector<const ScopeStats*> LastFrameScopes();
+    static const std::deque<FrameTimes>& History();
+    static const std::string& ScopeName(uint32_t stats);
+
+    static bool Supported;
+    static bool Enabled;
+    static double FrameMs;
+    static std::string LogPath;
+
+    private:
+    struct Scope {
+      uint32_t stats{0};
+      uint32_t begin{0};
+      uint32_t end{UINT32_MAX};
+    };
+
+    struct Slot {
+      VkQueryPool pool{VK_NULL_HANDLE};
+      std::vector<Scope> scopes{};
+      uint32_t queries{0};
+      uint64_t value{0};
+      uint64_t frame{0};
+      int64_t submitNs{0};
+      bool pending{false};
+    };
+
+    static uint32_t StatsIndex(const std::string& path, const std::string& name, uint32_t depth);
+    static void Read(Slot& slot);
+    static void WriteTimestamp(VkCommandBuffer cmd, uint32_t query);
+
+    static std::vector<Slot> gSlots;
+    static size_t gCurrent;
+    // NOTE: indices into the current slot's scopes of the scopes still open
+    static std::vector<uint32_t> gOpen;
+    static std::vector<ScopeStats> gStats;
+    static std::unordered_map<std::string, uint32_t> gStatsIndex;
+    static uint64_t gFrame;
+    // NOTE: stats of the last read frame's scopes in the order they were opened
+    static std::vector<uint32_t> gLastFrame;
+    static std::deque<FrameTimes> gHistory;
+    static uint64_t gValidMask;
+    static double gPeriodNs;
+    static std::ofstream gLog;
+  };
+
+  /**
+   * @brief Times everything recorded into cmd until the end of the enclosing block.
+   */
+  class GpuScope {
+    public:
+    GpuScope(VkCommandBuffer cmd, const std::string& name);
+    ~GpuScope();
+    GpuScope(const GpuScope&) = delete;
+    GpuScope& operator=(const GpuScope&) = delete;
+
+    private:
+    VkCommandBuffer cmd;
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#define COFFEEMAKER_GPU_SCOPE_JOIN_INNER(a, b) a##b
+#define COFFEEMAKER_GPU_SCOPE_JOIN(a, b) COFFEEMAKER_GPU_SCOPE_JOIN_INNER(a, b)
+#define GPU_SCOPE(cmd, name) \
+  CoffeeMaker::Renderer::Vulkan::GpuScope COFFEEMAKER_GPU_SCOPE_JOIN(gpuScope, __LINE__) { cmd, name }
+
+#endif
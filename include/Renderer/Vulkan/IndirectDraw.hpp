@@ -0,0 +1,41 @@
+#ifndef _coffeemaker_renderer_vulkan_indirectdraw_hpp
+#define _coffeemaker_renderer_vulkan_indirectdraw_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  /**
+   * Indirect drawing support. GPU driven rendering needs drawIndirectFirstInstance, the draw's firstInstance picks
+   * the object. multiDrawIndirect and VK_KHR_draw_indirect_count are used when available, without the latter every
+   * command up to the maximum is drawn and the ones nothing wrote to must have an instanceCount of 0.
+   */
+  class IndirectDraw {
+    public:
+    /**
+     * @brief Enables the extension and features the selected device supports. Call before creating the logical
+     * device.
+     */
+    static void EnableIfSupported(std::vector<const char*>& deviceExtensions);
+    static void LoadFunctions(VkDevice device);
+    /**
+     * @brief Draws the VkDrawIndexedIndirectCommands at offset, as many as the uint32_t at countOffset says and
+     * never more than maxDrawCount.
+     */
+    static void DrawIndexedIndirectCount(VkCommandBuffer cmd, VkBuffer buffer, VkDeviceSize offset,
+                                         VkBuffer countBuffer, VkDeviceSize countOffset, uint32_t maxDrawCount,
+                                         uint32_t stride);
+
+    static bool Supported;
+    static bool MultiDraw;
+    static bool DrawCount;
+
+    private:
+    static PFN_vkCmdDrawIndexedIndirectCountKHR gCmdDrawIndexedIndirectCount;
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
@@ -16,6 +16,14 @@ namespace CoffeeMaker::Renderer::Vulkan {
     static bool IsValidationLayersEnabled();
     static void SetExentions(const std::vector<const char*>& e);
     static void SetLayers(const std::vector<const char*>& l);
+    /**
+     * @brief Chains a VkPhysicalDevice*Features struct into device creation. Must outlive CreateLogicalDevice.
+     */
+    static void AddFeatures(void* features);
+    /**
+     * @brief Core features to enable. Owners set theirs here, a device takes a single VkPhysicalDeviceFeatures2.
+     */
+    static VkPhysicalDeviceFeatures& CoreFeatures();
 
     static VkDevice gLogicalDevice;
     static VkQueue GraphicsQueue;
@@ -25,6 +33,8 @@ namespace CoffeeMaker::Renderer::Vulkan {
     static std::vector<const char*> Layers;
     static std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     static VkDeviceCreateInfo logicalDeviceCreateInfo;
+    static void* gFeatureChain;
+    static VkPhysicalDeviceFeatures2 gCoreFeatures;
 
     private:
     static void InitCreateQueueInfos();
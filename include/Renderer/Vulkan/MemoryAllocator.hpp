@@ -4,6 +4,9 @@
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan.h>
 
+#include <atomic>
+#include <cstddef>
+
 namespace CoffeeMaker::Renderer::Vulkan {
   class MemoryAllocator {
     public:
@@ -11,6 +14,9 @@ namespace CoffeeMaker::Renderer::Vulkan {
     static void DestroyAllocator();
     static VmaAllocator GetAllocator();
 
+    // NOTE: bytes written through MapMemory since the counters last took them, from any thread
+    static std::atomic<size_t> UploadedBytes;
+
     private:
     static VmaAllocator gAllocator;
     static VmaAllocatorCreateInfo gAllocatorCreateInfo;
@@ -35,6 +41,11 @@ namespace CoffeeMaker::Renderer::Vulkan {
   void UnmapMemory(VmaAllocation allocation);
 
   void FlushMemory(VmaAllocation allocation, VkDeviceSize offset, VkDeviceSize size);
+
+  /**
+   * @brief Copies size bytes the GPU wrote to a host visible allocation into pData.
+   */
+  void ReadMemory(void* pData, size_t size, VmaAllocation allocation);
 }  // namespace CoffeeMaker::Renderer::Vulkan
 
 #endif
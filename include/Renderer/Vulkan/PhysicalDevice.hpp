@@ -34,6 +34,19 @@ namespace CoffeeMaker::Renderer::Vulkan {
     void FindQueueFamilies();
     void QuerySwapchainSupport();
     bool AreExtensionsSupported(std::vector<const char*>& requestedExtensions);
+    bool IsExtensionSupported(const char* extension);
+    /**
+     * @brief vkGetPhysicalDeviceFeatures2 for the given features chain, false if the device is Vulkan 1.0 only.
+     */
+    bool QueryFeatures2(void* features);
+    bool QueryProperties2(void* properties);
+    /**
+     * @brief Returns the first format in candidates that supports the requested features for the
+     * given tiling, or VK_FORMAT_UNDEFINED if none of them do.
+     */
+    VkFormat FindSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling,
+                                 VkFormatFeatureFlags features);
+    bool SupportsLazilyAllocatedMemory();
 
     const char* Name();
 
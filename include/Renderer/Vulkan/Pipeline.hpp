@@ -3,8 +3,14 @@
 
 #include <vulkan/vulkan.h>
 
+#include <array>
+#include <atomic>
+#include <future>
+#include <memory>
 #include <vector>
 
+#include "Renderer/ObjectId.hpp"
+
 namespace CoffeeMaker::Renderer::Vulkan {
 
   struct VertexInputDescription {
@@ -40,7 +46,9 @@ namespace CoffeeMaker::Renderer::Vulkan {
    * VK_POLYGON_MODE_FILL_RECTANGLE_NV = 1000153000,
    * VK_POLYGON_MODE_MAX_ENUM = 0x7FFFFFFF
    */
-  VkPipelineRasterizationStateCreateInfo CreateRasterizer(VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL);
+  VkPipelineRasterizationStateCreateInfo CreateRasterizer(VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL,
+                                                          VkCullModeFlags cullMode = VK_CULL_MODE_NONE,
+                                                          VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE);
 
   VkPipelineColorBlendAttachmentState CreateColorBlendAttachState();
 
@@ -54,28 +62,123 @@ namespace CoffeeMaker::Renderer::Vulkan {
   VkPipelineLayoutCreateInfo CreatePipelineLayoutInfo(uint32_t pushConstantRangeCount = 0,
                                                       VkPushConstantRange* pushConstant = nullptr);
 
+  /**
+   * Fixed function state that is either baked into the pipeline or, with extended dynamic state,
+   * set on the command buffer for every draw. See DynamicState.
+   */
+  struct RenderState {
+    VkPrimitiveTopology topology{VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST};
+    VkPolygonMode polygonMode{VK_POLYGON_MODE_FILL};
+    VkCullModeFlags cullMode{VK_CULL_MODE_NONE};
+    VkFrontFace frontFace{VK_FRONT_FACE_CLOCKWISE};
+    bool depthTest{true};
+    bool depthWrite{true};
+    VkCompareOp depthCompareOp{VK_COMPARE_OP_LESS_OR_EQUAL};
+
+    bool operator==(const RenderState& other) const = default;
+  };
+
+  /**
+   * Value of a constant_id declared in the shaders, folded in by the driver when the pipeline is built.
+   * Constants are 32 bits wide, booleans are 0 or 1.
+   */
+  struct SpecializationConstant {
+    uint32_t id{0};
+    uint32_t value{0};
+    // NOTE: stages that declare the id, others never see it
+    VkShaderStageFlags stages{VK_SHADER_STAGE_ALL_GRAPHICS};
+  };
+
   struct PipelineCreateInfo {
     VkShaderModule vertexShader{VK_NULL_HANDLE};
     VkShaderModule fragmentShader{VK_NULL_HANDLE};
+    // NOTE: see VulkanShaderManager::ModuleId, keys use these since a destroyed module's handle may come back
+    uint64_t vertexShaderId{0};
+    uint64_t fragmentShaderId{0};
     VertexInputDescription vertexInputs;
     uint32_t pushConstantRangeCount = 0;
     VkPushConstantRange pushConstants{};
+    // NOTE: bindings of each descriptor set, indexed by set number
+    std::vector<std::vector<VkDescriptorSetLayoutBinding>> descriptorSets{};
+    std::vector<SpecializationConstant> specializationConstants{};
+    // NOTE: feature bits the shaders were selected by, see ShaderPermutation
+    uint64_t permutation{0};
+    RenderState renderState{};
+  };
+
+  /**
+   * Owns a VkDescriptorSetLayout that may be shared by many pipeline layouts, see PipelineRegistry.
+   */
+  class DescriptorSetLayout {
+    public:
+    DescriptorSetLayout() = default;
+    ~DescriptorSetLayout();
+
+    DescriptorSetLayout(const DescriptorSetLayout& p) = delete;
+    DescriptorSetLayout& operator=(const DescriptorSetLayout& p) = delete;
+
+    VkDescriptorSetLayout layout{VK_NULL_HANDLE};
+  };
+
+  /**
+   * Owns a VkPipelineLayout that may be shared by many pipelines, see PipelineRegistry.
+   */
+  class PipelineLayout {
+    public:
+    PipelineLayout() = default;
+    ~PipelineLayout();
+
+    PipelineLayout(const PipelineLayout& p) = delete;
+    PipelineLayout& operator=(const PipelineLayout& p) = delete;
+
+    VkPipelineLayout layout{VK_NULL_HANDLE};
   };
 
   class Pipeline {
     public:
+    /**
+     * @brief Prepares and compiles the pipeline on the calling thread.
+     */
     void CreatePipeline(PipelineCreateInfo info);
+    /**
+     * @brief Fills in every create info and resolves the shared layout. Render thread only.
+     */
+    void Prepare(PipelineCreateInfo info);
+    /**
+     * @brief Builds the VkPipeline from the prepared state, safe to call from a compiler thread.
+     */
+    void Compile();
+    /**
+     * @brief Builds the link time optimized pipeline into optimizedPipeline, see PipelineLibrary.
+     */
+    void Optimize();
+    bool IsReady() const;
+    /**
+     * @brief Blocks until a pipeline handed to the PipelineCompiler has finished compiling.
+     */
+    void Wait() const;
     Pipeline();
     ~Pipeline();
 
     Pipeline(const Pipeline& p) = delete;
     Pipeline& operator=(const Pipeline& p) = delete;
 
+    struct StageSpecialization {
+      std::vector<VkSpecializationMapEntry> entries{};
+      std::vector<uint32_t> data{};
+      VkSpecializationInfo info{};
+    };
+
     VkPipeline pPipeline{VK_NULL_HANDLE};
     VkPipelineLayoutCreateInfo layoutInfo{};
     VkPipelineLayout layout{};
+    std::shared_ptr<PipelineLayout> sharedLayout{nullptr};
+    std::vector<std::shared_ptr<DescriptorSetLayout>> sharedSetLayouts{};
+    std::vector<VkDescriptorSetLayout> setLayouts{};
     PipelineCreateInfo info;
     std::vector<VkPipelineShaderStageCreateInfo> shaderStages{};
+    // NOTE: one per entry of shaderStages, pointed to by pSpecializationInfo
+    std::array<StageSpecialization, 2> specializations{};
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
     VkViewport viewport{};
@@ -88,6 +191,26 @@ namespace CoffeeMaker::Renderer::Vulkan {
     VkPipelineDepthStencilStateCreateInfo depthStencil{};
     std::vector<VkDynamicState> dynamicStates{VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
     VkPipelineDynamicStateCreateInfo dynamicState{};
+
+    std::atomic<bool> ready{false};
+    std::shared_future<void> compiled{};
+    uint64_t key{0};
+    double compileMs{0.0};
+    VkPipeline optimizedPipeline{VK_NULL_HANDLE};
+    bool needsOptimization{false};
+    double optimizeMs{0.0};
+    // NOTE: PipelineCompiler jobs queued for this pipeline that the render thread has not collected yet
+    std::atomic<uint32_t> jobs{0};
+
+    // NOTE: width of the pipeline field of the DrawList sort key
+    static constexpr uint32_t IdBits = 12;
+    static IdPool Ids;
+    // NOTE: kept when a rebuild is swapped in, draws keep sorting the same way
+    ObjectId id{Ids};
+
+    private:
+    void CompileMonolithic();
+    void PrepareSpecialization(VkPipelineShaderStageCreateInfo& stage, StageSpecialization& specialization);
   };
 }  // namespace CoffeeMaker::Renderer::Vulkan
 
@@ -0,0 +1,81 @@
+#ifndef _coffeemaker_renderer_vulkan_pipelinecache_hpp
+#define _coffeemaker_renderer_vulkan_pipelinecache_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  /**
+   * Header written in front of the driver's cache blob. Vulkan's own header only carries the
+   * vendor, device and cache UUID, so the driver version is recorded here as well; a driver update
+   * invalidates the cache even when the UUID does not change.
+   */
+  struct PipelineCacheFileHeader {
+    uint32_t magic{0};
+    uint32_t version{0};
+    uint32_t vendorID{0};
+    uint32_t deviceID{0};
+    uint32_t driverVersion{0};
+    uint8_t pipelineCacheUUID[VK_UUID_SIZE]{};
+    uint64_t dataSize{0};
+  };
+
+  /**
+   * One VkPipelineCache shared by every pipeline creation, persisted to disk between runs.
+   */
+  class PipelineCache {
+    public:
+    static void CreatePipelineCache(const std::string& filename = "pipeline_cache.bin");
+    static VkPipelineCache GetPipelineCache();
+    static void Destroy();
+    /**
+     * @brief Writes the cache to disk, waiting for a save still running in the background first.
+     */
+    static void Save();
+    /**
+     * @brief Called once per frame, saves the cache every SaveIntervalMs if it has grown. The data is read on the
+     * render thread and written to disk on a worker, so the frame never waits on the file system.
+     */
+    static void Update();
+    static void RecordPipelineCreation(double milliseconds);
+    /**
+     * @brief Prints the warm/cold state, compile times and the time since the cache was created. Call once the
+     * pipelines queued at startup have compiled, otherwise the numbers are incomplete.
+     */
+    static void ReportStartup();
+    static bool IsWarm();
+
+    static VkPipelineCache gPipelineCache;
+    static std::string gFilePath;
+    static bool gWarm;
+    static size_t gLastSavedSize;
+    static uint32_t gLastSaveTicks;
+    static uint32_t gCreatedTicks;
+    // NOTE: background save in progress, false when it failed
+    static std::future<bool> gPendingSave;
+    static uint32_t gPipelinesCreated;
+    static double gPipelineCreationMs;
+    static const uint32_t SaveIntervalMs;
+
+    private:
+    /**
+     * @brief The driver's cache data with our header in front, empty when it could not be read.
+     */
+    static std::vector<char> ReadData();
+    /**
+     * @brief Data goes to a temporary file first which is then renamed over the real one, so a crash mid-write
+     * never leaves a truncated cache behind. Safe from any thread.
+     */
+    static bool WriteToDisk(const std::string& path, const std::vector<char>& data);
+    static std::vector<char> LoadFromDisk();
+    static bool IsValid(const std::vector<char>& fileData);
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef _coffeemaker_renderer_vulkan_pipelinecompiler_hpp
+#define _coffeemaker_renderer_vulkan_pipelinecompiler_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Renderer/Vulkan/Pipeline.hpp"
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  /**
+   * Pool of worker threads that build VkPipelines off the render thread. Pipelines are prepared on
+   * the render thread (layouts, create infos) and only the vkCreateGraphicsPipelines call is deferred.
+   */
+  class PipelineCompiler {
+    public:
+    /**
+     * @brief Spins up the workers, 0 picks a count based on the number of hardware threads.
+     */
+    static void Start(size_t threadCount = 0);
+    /**
+     * @brief Drops any queued work and joins the workers. Pipelines that never compiled stay not ready.
+     */
+    static void Stop();
+    /**
+     * @brief Queues a prepared pipeline for compilation. Compiles inline when the pool is not running.
+     */
+    static std::shared_future<void> Submit(std::shared_ptr<Pipeline> pipeline);
+    /**
+     * @brief Queues the link time optimized build of a fast linked pipeline, swapped in by Update when done.
+     */
+    static void SubmitOptimization(std::shared_ptr<Pipeline> pipeline);
+    /**
+     * @brief Compiles a prepared replacement for a live pipeline, e.g. after a shader reload. Once it is built and
+     * nothing else is queued for the target, Update moves the new VkPipeline into the target at the frame boundary.
+     */
+    static void SubmitRebuild(std::shared_ptr<Pipeline> target, std::shared_ptr<Pipeline> replacement);
+    /**
+     * @brief Destroys a pipeline once the frame timeline passes the frame being recorded, see Synchronization.
+     */
+    static void Retire(VkPipeline pipeline);
+    /**
+     * @brief Destroys every retired pipeline right away. Only once the device is idle, e.g. on shutdown.
+     */
+    static void DestroyRetired();
+    /**
+     * @brief Called once per frame on the render thread, logs and releases finished pipelines.
+     */
+    static void Update();
+    /**
+     * @brief Blocks until the queue is empty, compiles read the render pass so it must outlive them.
+     */
+    static void WaitIdle();
+    static size_t PendingCount();
+    /**
+     * @brief Nothing is queued or compiling and every finished rebuild has been swapped into its target.
+     */
+    static bool Idle();
+    /**
+     * @brief Logs a finished pipeline's compile time, slow ones are raised as warnings. Render thread only.
+     */
+    static void Record(const Pipeline& pipeline);
+
+    static std::vector<std::thread> gWorkers;
+    static std::mutex gMutex;
+    static std::condition_variable gCondition;
+    static std::condition_variable gIdleCondition;
+    static bool gStopping;
+    static size_t gPending;
+    static size_t PipelinesCompiled;
+    static size_t PipelinesOptimized;
+    static size_t PipelinesRebuilt;
+    static double SlowestCompileMs;
+    static const double SlowPipelineMs;
+
+    private:
+    struct Job {
+      std::shared_ptr<Pipeline> pipeline;
+      std::promise<void> promise;
+      bool optimize{false};
+      std::shared_ptr<Pipeline> target{nullptr};
+    };
+
+    struct Finished {
+      std::shared_ptr<Pipeline> pipeline;
+      bool optimize{false};
+      std::shared_ptr<Pipeline> target{nullptr};
+    };
+
+    struct Rebuild {
+      std::shared_ptr<Pipeline> target;
+      std::shared_ptr<Pipeline> replacement;
+    };
+
+    struct Retired {
+      VkPipeline pipeline{VK_NULL_HANDLE};
+      uint64_t value{0};
+    };
+
+    static void WorkerLoop();
+    /**
+     * @brief Swaps a finished optimized link in for the fast linked pipeline. Render thread only.
+     */
+    static void Promote(Pipeline& pipeline);
+    /**
+     * @brief Moves a rebuilt pipeline into the one it replaces, the old VkPipeline is retired. Render thread only.
+     */
+    static void Swap(const std::shared_ptr<Pipeline>& target, Pipeline& replacement);
+
+    static std::deque<Job> gQueue;
+    static std::vector<Finished> gCompleted;
+    static std::deque<Retired> gRetired;
+    static std::vector<Rebuild> gRebuilds;
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef _coffeemaker_renderer_vulkan_pipelinelibrary_hpp
+#define _coffeemaker_renderer_vulkan_pipelinelibrary_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Renderer/Vulkan/Pipeline.hpp"
+#include "Renderer/Vulkan/PipelineRegistry.hpp"
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  /**
+   * VK_EXT_graphics_pipeline_library support. A pipeline is split into its vertex input, pre-rasterization,
+   * fragment shader and fragment output parts; each part is compiled once and cached, and full pipelines
+   * are linked from the parts. The fast link is used right away, an optimized link replaces it later.
+   */
+  class PipelineLibrary {
+    public:
+    /**
+     * @brief Enables the extensions and features the selected device supports. Call before creating the logical
+     * device.
+     */
+    static void EnableIfSupported(std::vector<const char*>& deviceExtensions);
+    /**
+     * @brief Links a full pipeline from its cached parts, compiling missing parts first. Safe from any thread.
+     * @param optimize Link with link time optimization, much slower than the fast link.
+     */
+    static VkPipeline Link(const Pipeline& pipeline, bool optimize);
+    static size_t PartCount();
+    /**
+     * @brief Retires the parts compiled from a module that is being destroyed, see VulkanShaderManager::ModuleId.
+     * Render thread only, and only once no link can still ask for them.
+     */
+    static void ForgetModule(uint64_t moduleId);
+    static void Clear();
+
+    static bool Enabled;
+    static bool FastLinking;
+    static VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT gFeatures;
+
+    private:
+    struct Part {
+      VkPipeline pipeline{VK_NULL_HANDLE};
+      // NOTE: module of the part's shader stage, 0 for the parts without one
+      uint64_t moduleId{0};
+    };
+
+    static VkPipeline GetPart(const Pipeline& pipeline, VkGraphicsPipelineLibraryFlagsEXT part);
+    static VkPipeline CreatePart(const Pipeline& pipeline, VkGraphicsPipelineLibraryFlagsEXT part);
+    static PipelineKey MakePartKey(const Pipeline& pipeline, VkGraphicsPipelineLibraryFlagsEXT part);
+
+    static uint64_t PartModuleId(const Pipeline& pipeline, VkGraphicsPipelineLibraryFlagsEXT part);
+
+    static std::unordered_map<PipelineKey, Part, PipelineKeyHasher> gParts;
+    static std::mutex gMutex;
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
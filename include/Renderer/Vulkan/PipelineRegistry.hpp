@@ -0,0 +1,111 @@
+#ifndef _coffeemaker_renderer_vulkan_pipelineregistry_hpp
+#define _coffeemaker_renderer_vulkan_pipelineregistry_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Renderer/Vulkan/Pipeline.hpp"
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  /**
+   * Flattened description of everything that goes into a pipeline (or layout). The words are kept
+   * alongside the hash so that two keys are only equal when their contents are, not just their hashes.
+   */
+  struct PipelineKey {
+    std::vector<uint64_t> words{};
+    uint64_t hash{14695981039346656037ull};
+
+    void Add(uint64_t value);
+    void Append(const PipelineKey& other);
+    bool operator==(const PipelineKey& rhs) const;
+  };
+
+  struct PipelineKeyHasher {
+    size_t operator()(const PipelineKey& key) const { return static_cast<size_t>(key.hash); }
+  };
+
+  PipelineKey MakeVertexInputKey(const VertexInputDescription& inputs);
+
+  PipelineKey MakeRenderPassKey();
+
+  PipelineKey MakePipelineKey(const PipelineCreateInfo& info);
+
+  PipelineKey MakePipelineLayoutKey(const VkPipelineLayoutCreateInfo& layoutInfo);
+
+  PipelineKey MakeDescriptorSetLayoutKey(const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+
+  /**
+   * @brief Key of the specialization constants visible to the given stages.
+   */
+  PipelineKey MakeSpecializationKey(const std::vector<SpecializationConstant>& constants, VkShaderStageFlags stages);
+
+  /**
+   * Shares pipelines and pipeline layouts between every object that asks for the same state.
+   * Entries are held weakly, a pipeline is destroyed once the last object using it lets go.
+   */
+  class PipelineRegistry {
+    public:
+    /**
+     * @brief Builds new state on the calling thread. State already compiling in the background is returned without
+     * waiting for it, ResolveForDraw draws the fallback until it is ready.
+     */
+    static std::shared_ptr<Pipeline> GetPipeline(const PipelineCreateInfo& info);
+    /**
+     * @brief Returns immediately, new pipelines are compiled by the PipelineCompiler. Check IsReady() before use.
+     */
+    static std::shared_ptr<Pipeline> GetPipelineAsync(const PipelineCreateInfo& info);
+    /**
+     * @brief Builds the pipeline drawn with while the requested one is still compiling, on the calling thread. It
+     * is kept apart from the shared pipelines, so it is ready even when an object asks for the same state, and it
+     * must accept the same vertex layout as the objects it stands in for.
+     */
+    static void CreateFallbackPipeline(const PipelineCreateInfo& info);
+    /**
+     * @brief Picks the pipeline to bind this frame: the pipeline itself, the fallback, or nullptr to skip the draw.
+     * @param allowFallback false for draws whose vertex layout the fallback cannot read, e.g. instanced ones
+     */
+    static Pipeline* ResolveForDraw(const std::shared_ptr<Pipeline>& pipeline, bool allowFallback = true);
+    static std::shared_ptr<PipelineLayout> GetPipelineLayout(const VkPipelineLayoutCreateInfo& layoutInfo);
+    static std::shared_ptr<DescriptorSetLayout> GetDescriptorSetLayout(
+        const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+    struct ReplacedModule {
+      VkShaderModule module{VK_NULL_HANDLE};
+      uint64_t id{0};
+    };
+
+    /**
+     * @brief Rebuilds every live pipeline built from a shader module that was just reloaded, see
+     * PipelineCompiler::SubmitRebuild. Objects keep their pipelines, the new code is swapped in once it is built.
+     * @param previousId id of the reloaded module, see VulkanShaderManager::ModuleId
+     * @return number of pipelines queued for a rebuild
+     */
+    static size_t RebuildPipelinesUsing(uint64_t previousId, VkShaderModule module, uint64_t moduleId);
+    /**
+     * @brief Drops what the registry remembers about a module that is being destroyed.
+     */
+    static void ForgetModule(uint64_t id);
+    static void Clear();
+
+    static std::unordered_map<PipelineKey, std::weak_ptr<Pipeline>, PipelineKeyHasher> gPipelines;
+    static std::unordered_map<PipelineKey, std::weak_ptr<PipelineLayout>, PipelineKeyHasher> gPipelineLayouts;
+    static std::unordered_map<PipelineKey, std::weak_ptr<DescriptorSetLayout>, PipelineKeyHasher>
+        gDescriptorSetLayouts;
+    static std::shared_ptr<Pipeline> gFallbackPipeline;
+    // NOTE: id of a reloaded module -> its replacement, rebuilds in flight may still refer to the previous module
+    static std::unordered_map<uint64_t, ReplacedModule> gReplacedModules;
+    static size_t Hits;
+    static size_t Misses;
+    // NOTE: atomic, draws are resolved from recording threads
+    static std::atomic<size_t> FallbackDraws;
+    static std::atomic<size_t> SkippedDraws;
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef _coffeemaker_renderer_vulkan_shadercompiler_hpp
+#define _coffeemaker_renderer_vulkan_shadercompiler_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  struct ShaderDefine {
+    std::string name{};
+    std::string value{};
+  };
+
+  struct CompiledShader {
+    bool success{false};
+    bool fromCache{false};
+    std::vector<uint32_t> spirv{};
+    // NOTE: absolute paths of the source and everything it #includes, source first
+    std::vector<std::string> dependencies{};
+    std::string log{};
+    double compileMs{0.0};
+  };
+
+  /**
+   * Header of an entry in the SPIR-V cache. Entries are named after the key, which hashes the source,
+   * the defines, the compiler version and the options. Included files are listed with their own hashes
+   * so an edited include invalidates the entry even though the key does not change.
+   */
+  struct ShaderCacheFileHeader {
+    uint32_t magic{0};
+    uint32_t version{0};
+    uint64_t key{0};
+    uint32_t dependencyCount{0};
+    uint32_t wordCount{0};
+  };
+
+  /**
+   * Compiles GLSL to SPIR-V in process with shaderc on a pool of worker threads. Results are stored in a
+   * content addressed cache on disk, so unchanged shaders load without a compile step.
+   */
+  class ShaderCompiler {
+    public:
+    /**
+     * @brief Spins up the workers, 0 picks a count based on the number of hardware threads.
+     */
+    static void Start(size_t threadCount = 0);
+    /**
+     * @brief Drops any queued work and joins the workers. Dropped compiles resolve as failures.
+     */
+    static void Stop();
+    /**
+     * @brief Queues a compile, or a cache load, of a GLSL file. Runs inline when the pool is not running.
+     * @param path absolute path of the source
+     */
+    static std::shared_future<std::shared_ptr<const CompiledShader>> CompileAsync(
+        const std::string& path, const std::vector<ShaderDefine>& defines = {});
+    static std::shared_ptr<const CompiledShader> Compile(const std::string& path,
+                                                         const std::vector<ShaderDefine>& defines = {});
+    /**
+     * @brief True for GLSL sources, judged by their stage extension (.vert, .frag, ...).
+     */
+    static bool IsSource(std::string_view filename);
+
+    static std::vector<std::thread> gWorkers;
+    static std::mutex gMutex;
+    static std::condition_variable gCondition;
+    static bool gStopping;
+    static std::string gCacheDirectory;
+    static std::atomic<size_t> CacheHits;
+    static std::atomic<size_t> CacheMisses;
+    static std::atomic<size_t> CompileFailures;
+
+    private:
+    struct Job {
+      std::string path{};
+      std::vector<ShaderDefine> defines{};
+      std::promise<std::shared_ptr<const CompiledShader>> promise{};
+    };
+
+    static void WorkerLoop();
+    static const std::string& CacheDirectory();
+
+    static std::deque<Job> gQueue;
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
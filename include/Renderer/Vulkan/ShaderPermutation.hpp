@@ -0,0 +1,72 @@
+#ifndef _coffeemaker_renderer_vulkan_shaderpermutation_hpp
+#define _coffeemaker_renderer_vulkan_shaderpermutation_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Renderer/Vulkan/Pipeline.hpp"
+#include "Renderer/Vulkan/ShaderCompiler.hpp"
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  enum class ShaderFeatureBinding {
+    // NOTE: #define NAME 1 when set, the preprocessor strips the other branch before anything is compiled
+    Define,
+    // NOTE: boolean constant_id, one module for both values and the driver folds the branch at pipeline creation
+    SpecializationConstant,
+  };
+
+  struct ShaderFeature {
+    std::string name{};
+    ShaderFeatureBinding binding{ShaderFeatureBinding::Define};
+    uint32_t constantId{0};
+    // NOTE: stages a define is passed to, a stage that never reads it keeps sharing one module
+    VkShaderStageFlags stages{VK_SHADER_STAGE_ALL_GRAPHICS};
+  };
+
+  /**
+   * A vertex and fragment shader pair with a set of optional features, feature i is bit i of a mask. Every mask
+   * builds from the same sources: define features select which compiled module is used, specialization constant
+   * features are set on the pipeline. The mask is part of the pipeline key, so objects asking for the same
+   * features share a pipeline.
+   */
+  class ShaderPermutation {
+    public:
+    ShaderPermutation(std::string vertexShader, std::string fragmentShader, std::vector<ShaderFeature> features);
+
+    /**
+     * @brief Defines of the features set in the mask that apply to the stage, in feature order so equal masks name
+     * the same module.
+     */
+    std::vector<ShaderDefine> Defines(uint64_t mask, VkShaderStageFlagBits stage) const;
+    /**
+     * @brief Every specialization constant feature, set or not, so a cleared bit overrides the shader's default.
+     */
+    std::vector<SpecializationConstant> Constants(uint64_t mask) const;
+    /**
+     * @brief Compiles the permutation's shaders if needed and fills in the create info from their reflection.
+     */
+    PipelineCreateInfo MakePipelineCreateInfo(uint64_t mask, const VertexInputDescription& vertexLayout = {}) const;
+    /**
+     * @brief Queues the shaders of a permutation on the ShaderCompiler without waiting for them.
+     */
+    void Prefetch(uint64_t mask) const;
+    /**
+     * @brief Bit of a named feature, 0 if there is no such feature.
+     */
+    uint64_t Bit(std::string_view name) const;
+
+    std::string vertexShader;
+    std::string fragmentShader;
+    std::vector<ShaderFeature> features;
+    // NOTE: bits that map to a feature, anything else in a mask is ignored
+    uint64_t validMask{0};
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef _coffeemaker_renderer_vulkan_shaderreflection_hpp
+#define _coffeemaker_renderer_vulkan_shaderreflection_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Renderer/Vulkan/ComputePipeline.hpp"
+#include "Renderer/Vulkan/Pipeline.hpp"
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  struct ReflectedDescriptorBinding {
+    uint32_t set{0};
+    uint32_t binding{0};
+    VkDescriptorType type{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER};
+    uint32_t count{1};
+  };
+
+  struct ReflectedVertexInput {
+    uint32_t location{0};
+    VkFormat format{VK_FORMAT_UNDEFINED};
+    uint32_t size{0};
+  };
+
+  struct ReflectedSpecializationConstant {
+    uint32_t id{0};
+    uint32_t size{0};
+  };
+
+  /**
+   * Interface of a single SPIR-V module as seen by the pipeline: what it binds, what it pushes and what it reads
+   * from the vertex stream. Only the parts of SPIR-V that affect layouts are parsed.
+   */
+  struct ShaderReflection {
+    VkShaderStageFlagBits stage{VK_SHADER_STAGE_VERTEX_BIT};
+    std::string entryPoint{"main"};
+    std::vector<ReflectedDescriptorBinding> descriptorBindings{};
+    bool hasPushConstants{false};
+    VkPushConstantRange pushConstants{};
+    // NOTE: sorted by location
+    std::vector<ReflectedVertexInput> vertexInputs{};
+    std::vector<ReflectedSpecializationConstant> specializationConstants{};
+    // NOTE: workgroup size of a compute shader, local_size_x/y/z
+    std::array<uint32_t, 3> localSize{1, 1, 1};
+  };
+
+  /**
+   * @brief Parses a SPIR-V binary. Exits if the code is not valid SPIR-V.
+   */
+  ShaderReflection ReflectShader(const uint32_t* code, size_t wordCount);
+
+  /**
+   * @brief Builds the vertex description of the inputs the shader reads.
+   * @param layout Attributes of the C++ vertex, the shader's inputs are picked from it by location. When empty the
+   * inputs are packed tightly into a single binding in location order.
+   */
+  VertexInputDescription MakeVertexInputDescription(const ShaderReflection& vertex,
+                                                    const VertexInputDescription& layout = {});
+
+  /**
+   * @brief Fills in shaders, push constants, descriptor sets and vertex inputs of a pipeline from its shaders.
+   */
+  PipelineCreateInfo MakePipelineCreateInfo(VkShaderModule vertexShader, const ShaderReflection& vertex,
+                                            VkShaderModule fragmentShader, const ShaderReflection& fragment,
+                                            const VertexInputDescription& vertexLayout = {});
+
+  /**
+   * @brief Fills in the shader, push constants, descriptor sets and workgroup size of a compute pipeline.
+   */
+  ComputePipelineCreateInfo MakeComputePipelineCreateInfo(VkShaderModule computeShader,
+                                                          const ShaderReflection& compute);
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
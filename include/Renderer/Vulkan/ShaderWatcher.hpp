@@ -0,0 +1,46 @@
+#ifndef _coffeemaker_renderer_vulkan_shaderwatcher_hpp
+#define _coffeemaker_renderer_vulkan_shaderwatcher_hpp
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  /**
+   * Watches the shader directory for files that were written. Uses inotify on Linux; other platforms
+   * compare modification times every PollIntervalMs. Render thread only.
+   */
+  class ShaderWatcher {
+    public:
+    /**
+     * @brief Starts watching a directory and everything below it.
+     */
+    static void Start(const std::string& directory);
+    static void Stop();
+    /**
+     * @brief Normalized paths of the files written since the last call. Never blocks.
+     */
+    static std::vector<std::string> Poll();
+    static bool IsRunning();
+
+    static std::string gDirectory;
+    static const uint32_t PollIntervalMs;
+
+    private:
+#ifdef __linux__
+    static void AddWatch(const std::string& directory);
+
+    static int gFileDescriptor;
+    static std::unordered_map<int, std::string> gWatches;
+#else
+    static std::unordered_map<std::string, std::filesystem::file_time_type> gWriteTimes;
+    static uint32_t gLastPollTicks;
+#endif
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
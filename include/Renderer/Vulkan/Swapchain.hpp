@@ -3,19 +3,36 @@
 
 #include <vulkan/vulkan.h>
 
+#include <cstdint>
 #include <vector>
 
 #include "Renderer/Vulkan/MemoryAllocator.hpp"
+#include "Renderer/Vulkan/Utilities.hpp"
 
 namespace CoffeeMaker::Renderer::Vulkan {
 
   class Swapchain {
     public:
     static void CreateSwapchain();
+    /**
+     * @brief Creates the next swapchain with the current one as its oldSwapchain. The old one is retired, not
+     * destroyed, frames up to and including lastUse may still render to it.
+     */
+    static void Recreate(uint64_t lastUse);
+    /**
+     * @brief Destroys retired swapchains the frame timeline has passed, or all of them.
+     */
+    static void DestroyRetired(bool all);
     static VkSwapchainKHR GetVkpSwapchain();
     static Swapchain* GetSwapchain();
     static void Destroy();
     static void SetPresentMode(VkPresentModeKHR mode);
+    /**
+     * @brief Minimum number of depth bits the scene needs. The smallest supported depth format
+     * that satisfies it is used, so D16/D24 are preferred over D32 whenever precision allows.
+     * Takes effect on the next swapchain (re)creation.
+     */
+    static void SetDepthPrecision(uint32_t bits);
 
     Swapchain() = default;
     ~Swapchain() = default;
@@ -23,16 +40,26 @@ namespace CoffeeMaker::Renderer::Vulkan {
     Swapchain& operator=(const Swapchain&) = delete;
 
     private:
+    // NOTE: freed once the frame timeline reaches the value, see Vulkan::Synchronization
+    struct Retired {
+      uint64_t value{0};
+      Swapchain* swapchain{nullptr};
+    };
+
+    void Release();
     void InitChooseSwapSurfaceFormat();
     void InitChoosePresentMode();
     void InitChooseSwapExtent();
     void InitCreateImageViews();
+    void InitChooseDepthFormat();
     void InitCreateDepthImageView();
     void InitCreateSwapchainKHR();
 
     public:
     static Swapchain* gSwapchain;
     static Swapchain* gPrevSwapchain;
+    static uint32_t gDepthPrecisionBits;
+    static std::vector<Retired> gRetired;
 
     VkSwapchainKHR pSwapchain{VK_NULL_HANDLE};
     VkSurfaceFormatKHR surfaceFormat{};
@@ -41,11 +68,16 @@ namespace CoffeeMaker::Renderer::Vulkan {
     uint32_t imageCount{0};
     std::vector<VkImage> swapChainImages{};
     std::vector<VkImageView> swapChainImageViews{};
+    // NOTE: swapchain images are cleared every frame and presented afterwards
+    AttachmentUsage colorUsage{.clearOnLoad = true, .readsPreviousContents = false, .readAfterPass = true};
 
-    // NOTE: Set up for Depth
+    // NOTE: Set up for Depth. With dynamic rendering the render graph owns the image and these stay null
     VkImageView depthImageView{VK_NULL_HANDLE};
     CoffeeMaker::Renderer::Vulkan::AllocatedImage depthImage{};
     VkFormat depthFormat{VK_FORMAT_D32_SFLOAT};
+    // NOTE: depth is only consumed inside the render pass, so it never needs to reach memory
+    AttachmentUsage depthUsage{.clearOnLoad = true, .readsPreviousContents = false, .readAfterPass = false};
+    bool depthLazilyAllocated{false};
   };
 
 }  // namespace CoffeeMaker::Renderer::Vulkan
@@ -3,26 +3,65 @@
 
 #include <vulkan/vulkan.h>
 
+#include <cstdint>
 #include <vector>
 
 namespace CoffeeMaker::Renderer::Vulkan {
 
+  /**
+   * Frame synchronization on a timeline semaphore. Every frame submission signals the next value of one counter,
+   * the CPU waits for values instead of fences, and anything the GPU may still be using is released once the
+   * counter reaches the value it was retired at. Devices without VK_KHR_timeline_semaphore get one fence per frame
+   * in flight standing in for the counter.
+   */
   class Synchronization {
     public:
-    static void CreateSyncTools();
+    /**
+     * @brief Enables the extension and feature when the selected device supports them. Call before creating the
+     * logical device.
+     */
+    static void EnableIfSupported(std::vector<const char*>& deviceExtensions);
+    static void LoadFunctions(VkDevice device);
+    static void CreateSyncTools(size_t framesInFlight);
     static void DestroySyncTools();
-    static void WaitForFence(size_t currentFrame);
-    static void ResetFence(size_t currentFrame);
-    // static void WaitForImageAvailable(size_t imageIndex);
-    // static void WaitForImageRender(size_t imageIndex);
+    /**
+     * @brief Waits until the last submission of the frame slot is complete, its semaphores, command buffers and
+     * per-frame buffers can be reused afterwards.
+     */
+    static void WaitForFrame(size_t frame);
+    /**
+     * @brief Submits the frame's work, adding the signal of the next timeline value. Returns that value.
+     */
+    static uint64_t SubmitFrame(VkQueue queue, const VkSubmitInfo& submitInfo, size_t frame);
+    static void WaitForValue(uint64_t value);
+    /**
+     * @brief Every submission up to and including this value has completed.
+     */
+    static uint64_t CompletedValue();
+    /**
+     * @brief The value the frame being recorded will signal. Something retired now is unused once it completes.
+     */
+    static uint64_t PendingValue();
+
+    static bool TimelineSupported;
+    static VkPhysicalDeviceTimelineSemaphoreFeatures gFeatures;
 
     static VkSemaphoreCreateInfo semaphoreCreateInfo;
     static VkFenceCreateInfo fenceCreateInfo;
 
     static std::vector<VkSemaphore> imageAvailableSemaphores;
     static std::vector<VkSemaphore> imageRenderSemaphores;
+    // NOTE: only created without timeline semaphores, one per frame slot
     static std::vector<VkFence> inFlightFences;
-    static std::vector<VkFence> imagesInFlight;
+    static VkSemaphore gTimeline;
+    // NOTE: the value each frame slot signaled last
+    static std::vector<uint64_t> frameValues;
+    static uint64_t gSubmitted;
+    static uint64_t gCompleted;
+
+    private:
+    static PFN_vkWaitSemaphoresKHR gWaitSemaphores;
+    static PFN_vkGetSemaphoreCounterValueKHR gGetSemaphoreCounterValue;
   };
 
 }  // namespace CoffeeMaker::Renderer::Vulkan
@@ -0,0 +1,42 @@
+#ifndef _coffeemaker_renderer_vulkan_synchronization2_hpp
+#define _coffeemaker_renderer_vulkan_synchronization2_hpp
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+namespace CoffeeMaker::Renderer::Vulkan {
+
+  /**
+   * VK_KHR_synchronization2 support. Barriers are always described with the *2 structures, devices without the
+   * extension get them translated to a single vkCmdPipelineBarrier. Only stage and access bits that also exist in
+   * the original flags may be used.
+   */
+  class Synchronization2 {
+    public:
+    /**
+     * @brief Enables the extension and feature when the selected device supports them. Call before creating the
+     * logical device.
+     */
+    static void EnableIfSupported(std::vector<const char*>& deviceExtensions);
+    static void LoadFunctions(VkDevice device);
+    /**
+     * @brief Records every barrier of the dependency in one call.
+     */
+    static void PipelineBarrier(VkCommandBuffer cmd, const VkDependencyInfo& dependency);
+    /**
+     * @brief Writes a timestamp once the previous commands have reached the stage. Takes a single stage.
+     */
+    static void WriteTimestamp(VkCommandBuffer cmd, VkPipelineStageFlags2 stage, VkQueryPool pool, uint32_t query);
+
+    static bool Supported;
+    static VkPhysicalDeviceSynchronization2Features gFeatures;
+
+    private:
+    static PFN_vkCmdPipelineBarrier2KHR gCmdPipelineBarrier2;
+    static PFN_vkCmdWriteTimestamp2KHR gCmdWriteTimestamp2;
+  };
+
+}  // namespace CoffeeMaker::Renderer::Vulkan
+
+#endif
@@ -16,6 +16,31 @@ namespace CoffeeMaker::Renderer::Vulkan {
 
   VkImageViewCreateInfo CreateImageViewInfo(VkFormat format, VkImage image, VkImageAspectFlags aspectFlags);
 
+  /**
+   * Describes how an attachment is used by a render pass, so load/store ops can be derived
+   * from what actually happens to it rather than hardcoded per attachment.
+   */
+  struct AttachmentUsage {
+    // NOTE: attachment is cleared at the start of the pass
+    bool clearOnLoad{true};
+    // NOTE: contents written before the pass (previous pass/frame) are needed by this pass
+    bool readsPreviousContents{false};
+    // NOTE: contents are needed after the pass (presented, sampled, copied, etc.)
+    bool readAfterPass{false};
+  };
+
+  VkAttachmentLoadOp ChooseLoadOp(const AttachmentUsage& usage);
+
+  VkAttachmentStoreOp ChooseStoreOp(const AttachmentUsage& usage);
+
+  /**
+   * An attachment whose contents never leave the render pass can live entirely in tile memory
+   * and be backed by lazily allocated memory.
+   */
+  bool IsTransientAttachment(const AttachmentUsage& usage);
+
+  bool FormatHasStencil(VkFormat format);
+
   struct VulkanQueueFamilyIndices {
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
@@ -11,6 +11,7 @@
 #include "DeltaTime.hpp"
 #include "Editor/ImGuiEditorObject.hpp"
 #include "KeyboardEvent.hpp"
+#include "Renderer/Material.hpp"
 #include "Renderer/Vertex.hpp"
 #include "Renderer/Vulkan/Commands.hpp"
 #include "Renderer/Vulkan/Core.hpp"
@@ -29,7 +30,10 @@ class Triangle : public SDLKeyboardEventListener, public CoffeeMaker::Editor::Im
     MakeMeshPipeline();
   }
 
-  ~Triangle() { DestroyBuffer(mesh.vertexBuffer); }
+  ~Triangle() {
+    DestroyBuffer(mesh.vertexBuffer);
+    DestroyBuffer(mesh.indexBuffer);
+  }
 
   void EditorUpdate() override {
     ImGui::Begin("Triangle");
@@ -37,6 +41,11 @@ class Triangle : public SDLKeyboardEventListener, public CoffeeMaker::Editor::Im
     ImGui::InputFloat("xPos", &position.x, 1.0f, 5.0f);
     ImGui::InputFloat("yPos", &position.y, 1.0f, 5.0f);
     ImGui::InputFloat("zPos", &zIndex, 1.0f, 10.0f);
+    if (FeatureCheckbox("Show normals", CoffeeMaker::Renderer::MeshShowNormals) |
+        FeatureCheckbox("Grayscale", CoffeeMaker::Renderer::MeshGrayscale)) {
+      // NOTE: the fallback pipeline draws until the new permutation has compiled
+      MakeMeshPipeline();
+    }
     ImGui::End();
   }
 
@@ -63,33 +72,32 @@ class Triangle : public SDLKeyboardEventListener, public CoffeeMaker::Editor::Im
     position.y += movement.y;
   }
 
-  void Draw() {
-    using Commands = CoffeeMaker::Renderer::Vulkan::Commands;
-
-    VkCommandBuffer cmd = Commands::GetCurrentBuffer();
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.pPipeline);
-    VkDeviceSize offset = 0;
-    vkCmdBindVertexBuffers(cmd, 0, 1, &mesh.vertexBuffer.buffer, &offset);
+  glm::vec3 Position() const { return glm::vec3(position, zIndex); }
 
+  /**
+   * @brief The triangle at a translation, drawn through a DrawList.
+   */
+  CoffeeMaker::Renderer::RenderObject Object(const glm::vec3& translation) const {
     glm::mat4 model = glm::mat4{1.0f};
-    model = glm::translate(model, glm::vec3(position, zIndex));  // vec3 is the position of this object
+    model = glm::translate(model, translation);  // vec3 is the position of this object
     // model = glm::rotate(model, glm::radians(_framenumber * 0.4f), glm::vec3{0, 0, 1});
     // model = glm::scale(model, glm::vec3{10, 10, 10});
 
-    /**
-     * The camera abstract away the MVP multiplication that is need to create the screen space matrix.
-     * The camera object can be toggled to run either orthographic or perspective modes.
-     * Press keys to toggle between modes...
-     * O = orthographic
-     * P = perspective
-     */
-    glm::mat4 meshMatrix = _mainCamera->ScreenSpaceMatrix(model);
-    PushConstants constants;
-    constants.renderMatrix = meshMatrix;
-    vkCmdPushConstants(cmd, pipeline.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants), &constants);
-    vkCmdDraw(cmd, mesh.vertices.size(), 1, 0, 0);
+    return CoffeeMaker::Renderer::RenderObject{.mesh = &mesh, .material = &material, .transform = model};
   }
 
+  /**
+   * @brief A copy of the triangle at a translation, drawn through an InstanceBatcher with the instanced material.
+   */
+  CoffeeMaker::Renderer::RenderObject Instance(const glm::vec3& translation) const {
+    return CoffeeMaker::Renderer::RenderObject{
+        .mesh = &mesh, .material = &instancedMaterial, .transform = glm::translate(glm::mat4{1.0f}, translation)};
+  }
+
+  const Mesh* GetMesh() const { return &mesh; }
+
+  const CoffeeMaker::Renderer::Material* InstancedMaterial() const { return &instancedMaterial; }
+
   void OnKeyboardEvent(const SDL_KeyboardEvent& event) override {
     if (event.keysym.scancode == SDL_SCANCODE_RIGHT) {
       if (event.type == SDL_KEYDOWN) {
@@ -124,7 +132,39 @@ class Triangle : public SDLKeyboardEventListener, public CoffeeMaker::Editor::Im
     }
   }
 
+  /**
+   * @brief Requests the pipelines for the selected features, call again when the attachment formats change.
+   */
+  void MakeMeshPipeline() {
+    using Vertex = CoffeeMaker::Renderer::Vertex;
+    using PipelineCreateInfo = CoffeeMaker::Renderer::Vulkan::PipelineCreateInfo;
+    using PipelineRegistry = CoffeeMaker::Renderer::Vulkan::PipelineRegistry;
+
+    // NOTE: vertex inputs, push constants and descriptor sets all come from the shaders themselves
+    PipelineCreateInfo pipelineCreateInfo =
+        CoffeeMaker::Renderer::MeshShaders().MakePipelineCreateInfo(features, Vertex::Description());
+    pipelineCreateInfo.renderState = material.renderState;
+
+    material.pipeline = PipelineRegistry::GetPipelineAsync(pipelineCreateInfo);
+
+    PipelineCreateInfo instancedCreateInfo = CoffeeMaker::Renderer::MeshShaders().MakePipelineCreateInfo(
+        features | CoffeeMaker::Renderer::MeshInstanced, Vertex::InstancedDescription());
+    instancedCreateInfo.renderState = material.renderState;
+
+    instancedMaterial.pipeline = PipelineRegistry::GetPipelineAsync(instancedCreateInfo);
+    instancedMaterial.renderState = material.renderState;
+  }
+
   private:
+  bool FeatureCheckbox(const char* label, uint64_t feature) {
+    bool enabled = (features & feature) != 0;
+    if (!ImGui::Checkbox(label, &enabled)) {
+      return false;
+    }
+    features = enabled ? features | feature : features & ~feature;
+    return true;
+  }
+
   void CreateTriangleMesh() {
     mesh.vertices.resize(3);
     // Set vertex positions
@@ -137,29 +177,18 @@ class Triangle : public SDLKeyboardEventListener, public CoffeeMaker::Editor::Im
     mesh.vertices[2].color = {0.0f, 1.0f, 0.0f};
     // Ignore vertex normals for now
     mesh.CreateVertexBuffer();
-  }
-
-  void MakeMeshPipeline() {
-    using LogicDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
-    using Vertex = CoffeeMaker::Renderer::Vertex;
-    using PushConstants = CoffeeMaker::Renderer::MeshPushConstants;
-    using PipelineCreateInfo = CoffeeMaker::Renderer::Vulkan::PipelineCreateInfo;
-
-    VkPushConstantRange pushConstants{
-        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT, .offset = 0, .size = sizeof(PushConstants)};
-
-    PipelineCreateInfo pipelineCreateInfo{.vertexShader = VulkanShaderManager::ShaderModule("triangleMesh.spv"),
-                                          .fragmentShader = VulkanShaderManager::ShaderModule("frag.spv"),
-                                          .vertexInputs = Vertex::Description(),
-                                          .pushConstantRangeCount = 1,
-                                          .pushConstants = pushConstants};
-
-    pipeline.CreatePipeline(pipelineCreateInfo);
+    // NOTE: only indirect draws use the indices, see GpuScene
+    mesh.indices = {0, 1, 2};
+    mesh.CreateIndexBuffer();
   }
 
   Mesh mesh{};
 
-  Pipeline pipeline;
+  CoffeeMaker::Renderer::Material material{};
+  // NOTE: same mesh and features, the model matrix comes from the instance buffer
+  CoffeeMaker::Renderer::Material instancedMaterial{};
+  // NOTE: MeshShaderFeature bits
+  uint64_t features{0};
 
   std::shared_ptr<Camera> _mainCamera;
   glm::vec2 position{0.0f, 0.0f};
@@ -55,6 +55,19 @@ class VulkanImGui {
     // initialize imgui for sdl
     ImGui_ImplSDL2_InitForVulkan(window);
 
+    CreateVulkanBackend();
+  }
+
+  /**
+   * @brief The UI pipeline is built against the render pass, or the color format with dynamic rendering, so a new
+   * one needs a new pipeline. Only call once the GPU is done with the frames that drew the UI.
+   */
+  static void AttachmentsChanged() {
+    ImGui_ImplVulkan_Shutdown();
+    CreateVulkanBackend();
+  }
+
+  static void CreateVulkanBackend() {
     // initialize imgui for Vulkan
     ImGui_ImplVulkan_InitInfo init_info{};
     init_info.Instance = renderer->vulkanInstance;
@@ -62,11 +75,30 @@ class VulkanImGui {
     init_info.Device = logicalDevice;
     init_info.Queue = CoffeeMaker::Renderer::Vulkan::LogicalDevice::GraphicsQueue;
     init_info.DescriptorPool = imguiPool;
+    init_info.PipelineCache = CoffeeMaker::Renderer::Vulkan::PipelineCache::GetPipelineCache();
     init_info.MinImageCount = 3;
     init_info.ImageCount = 3;
     init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
 
-    ImGui_ImplVulkan_Init(&init_info, CoffeeMaker::Renderer::Vulkan::RenderPass::GetRenderPass());
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+#ifdef IMGUI_IMPL_VULKAN_HAS_DYNAMIC_RENDERING
+    if (CoffeeMaker::Renderer::Vulkan::DynamicRendering::Supported) {
+      // NOTE: the UI pipeline only knows the color format, it is drawn in its own color only rendering
+      init_info.UseDynamicRendering = true;
+      init_info.ColorAttachmentFormat = CoffeeMaker::Renderer::Vulkan::Swapchain::GetSwapchain()->surfaceFormat.format;
+    } else {
+      renderPass = CoffeeMaker::Renderer::Vulkan::RenderPass::GetRenderPass();
+    }
+#else
+    // NOTE: the UI is recorded inside the frame's dynamic rendering, a render pass pipeline cannot draw there
+    if (CoffeeMaker::Renderer::Vulkan::DynamicRendering::Supported) {
+      SDL_LogError(0, "The ImGui Vulkan backend was built without dynamic rendering, it cannot draw the UI.");
+      exit(20);
+    }
+    renderPass = CoffeeMaker::Renderer::Vulkan::RenderPass::GetRenderPass();
+#endif
+
+    ImGui_ImplVulkan_Init(&init_info, renderPass);
 
     // execute a gpu command to upload imgui font textures
     renderer->ImmediateSubmit([&](VkCommandBuffer cmd) { ImGui_ImplVulkan_CreateFontsTexture(cmd); });
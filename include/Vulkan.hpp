@@ -14,6 +14,10 @@
 
 #include "Editor/ImGuiEditorObject.hpp"
 #include "Rectangle.hpp"
+#include "Renderer/DrawList.hpp"
+#include "Renderer/GpuScene.hpp"
+#include "Renderer/InstanceBatcher.hpp"
+#include "Renderer/RenderGraph.hpp"
 #include "Renderer/Vulkan/Core.hpp"
 #include "Triangle.hpp"
 #include "VulkanShaderManager.hpp"
@@ -27,9 +31,17 @@ class Vulkan : public CoffeeMaker::Editor::ImGuiEditorObject {
 
   void BeginRender();
   void EndRender();
+  /**
+   * @brief Frame pacing wait, call before sampling input so the input is as fresh as possible.
+   */
+  void WaitForNextFrame();
   void Draw();
 
-  void RecreateSwapChain();
+  /**
+   * @brief Returns false when the current frame has to be skipped: the window is minimized, or the UI was rebuilt
+   * for a new render pass.
+   */
+  bool RecreateSwapChain();
   void FramebufferResize();
 
   void EditorUpdate() override;
@@ -102,6 +114,10 @@ class Vulkan : public CoffeeMaker::Editor::ImGuiEditorObject {
    */
   void AddRequiredDeviceExtensionSupport(VkPhysicalDevice device);
   void CreateSwapChain();
+  // Refresh rate of the window's display, the frame pacer schedules against it.
+  void SetRefreshRate();
+  // Formats pipelines are created against on the dynamic rendering path.
+  void SetAttachmentFormats();
   void CreateRenderPass();
   void CreateFramebuffer();
   void CreateCommands(bool recreation = false);
@@ -110,6 +126,10 @@ class Vulkan : public CoffeeMaker::Editor::ImGuiEditorObject {
   void CreateMemoryAllocator();
   void CreateSurface();
   void InitSyncStructures();
+  /**
+   * @brief Synchronously builds the default mesh pipeline that objects draw with while theirs compile.
+   */
+  void CreateFallbackPipeline();
 
   void ShowError(const std::string &title, const std::string &message);
 
@@ -143,6 +163,10 @@ class Vulkan : public CoffeeMaker::Editor::ImGuiEditorObject {
 
   Triangle *triangle;
   CoffeeMaker::Primitives::Rectangle *rectangle;
+  CoffeeMaker::Renderer::DrawList drawList;
+  CoffeeMaker::Renderer::InstanceBatcher batcher;
+  CoffeeMaker::Renderer::GpuScene gpuScene;
+  CoffeeMaker::Renderer::RenderGraph frameGraph;
 
   // NOTE: use for immediate submit command steps
   CoffeeMaker::Renderer::Vulkan::UploadContext _uploadContext;
@@ -157,8 +181,48 @@ class Vulkan : public CoffeeMaker::Editor::ImGuiEditorObject {
   void Editor_PhysicalDeviceSelection();
   // List available information about the selected device.
   void Editor_PhysicalDeviceInformation();
+  // Swapchain extent, depth format and the depth precision control.
+  void Editor_SwapchainInformation();
+  // Pipeline cache and registry statistics.
+  void Editor_PipelineInformation();
+  // Frames in flight, low latency mode and the measured latency.
+  void Editor_FramePacingInformation();
+  // CPU scope recording per thread and the Chrome trace export.
+  void Editor_CpuProfilerInformation();
+  // Per scope GPU timings and the timing log.
+  void Editor_GpuProfilerInformation();
+  // Render counters of the last frame, pipeline statistics and the counter log.
+  void Editor_CountersInformation();
+  // Transparent corner window with the render counters, drawn over the scene.
+  void Editor_CountersOverlay();
+  // Render graph passes, barriers, transient memory and the Graphviz dump.
+  void Editor_RenderGraphInformation();
+  // Parallel command recording controls and timings.
+  void Editor_RecordingInformation();
+  // GPU driven object count and culling results.
+  void Editor_GpuDrivenInformation();
+  // Recorded and elided state calls of the last frame.
+  void Editor_EncoderInformation();
+  // Draw list size, sort time and the radix sort benchmark.
+  void Editor_SortInformation();
+  // Fills the GPU scene with gpuObjectCount copies of the triangle.
+  void BuildGpuScene();
 
   size_t selectedPhysicalDeviceIndex{9999};
+  // NOTE: extra triangles drawn every frame to load the recording path
+  int stressDrawCount{0};
+  // NOTE: copies of the triangle drawn through the instance batcher
+  int propCount{0};
+  // NOTE: copies of the triangle culled and drawn on the GPU
+  int gpuObjectCount{0};
+  // NOTE: keys sorted by the sort benchmark
+  int sortBenchmarkCount{4000000};
+  CoffeeMaker::Renderer::DrawList::BenchmarkResult sortBenchmark{};
+  bool graphDumpWritten{false};
+  bool traceWritten{false};
+  bool countersOverlay{false};
+  // NOTE: the pipeline cache report waits for the compiles queued at startup
+  bool pipelineStartupReported{false};
 
   bool selectedPresentMode{false};
   std::array<const char *, 55> features{"robustBufferAccess",
@@ -5,73 +5,141 @@
 #include <fmt/core.h>
 #include <vulkan/vulkan.h>
 
-#include <fstream>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <iostream>
-#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
+#include "Renderer/Vulkan/ShaderCompiler.hpp"
+#include "Renderer/Vulkan/ShaderReflection.hpp"
+
+/**
+ * Read only view of a compiled shader binary. The file is memory mapped so the words handed to
+ * vkCreateShaderModule are the page cache itself, page aligned and never copied. Unmapped on destruction.
+ */
+class ShaderBinary {
+  public:
+  explicit ShaderBinary(const std::string &path);
+  ~ShaderBinary();
+
+  ShaderBinary(const ShaderBinary &s) = delete;
+  ShaderBinary &operator=(const ShaderBinary &s) = delete;
+
+  const uint32_t *Code() const { return code; }
+  size_t Size() const { return size; }
+  size_t WordCount() const { return size / sizeof(uint32_t); }
+  bool IsOpen() const { return code != nullptr; }
+
+  private:
+  const uint32_t *code{nullptr};
+  size_t size{0};
+  // NOTE: only used when the file could not be mapped, keeps the words 4 byte aligned
+  std::vector<uint32_t> fallback{};
+#ifdef _WIN32
+  void *file{nullptr};
+  void *mapping{nullptr};
+#else
+  void *mapped{nullptr};
+#endif
+};
+
+/**
+ * @brief Heterogeneous hasher so lookups by string literal or view never build a std::string.
+ */
+struct ShaderNameHasher {
+  using is_transparent = void;
+  size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+};
+
 class VulkanShaderManager {
   public:
+  using ShaderDefines = std::vector<CoffeeMaker::Renderer::Vulkan::ShaderDefine>;
+
   /**
-   * @brief Reads a compiled shader binary for Vulkan to use later.
+   * @brief Maps a compiled shader binary for Vulkan to use. Nothing is retained once the view is released.
    *
-   * @param filename
-   * @return std::vector<char>
+   * @param filename relative to the shader root, see ShaderRoot
    */
-  static std::vector<char> ReadShaderFile(const std::string &filename) {
-    std::string fullFilePath = fmt::format("{}{}", SDL_GetBasePath(), filename);
-    std::ifstream file{fullFilePath, std::ios::ate | std::ios::binary};
+  static std::unique_ptr<ShaderBinary> ReadShaderFile(std::string_view filename) {
+    auto binary = std::make_unique<ShaderBinary>(fmt::format("{}{}", ShaderRoot(), filename));
 
-    if (!file.is_open()) {
+    if (!binary->IsOpen()) {
       std::cerr << fmt::format("Could not open shader binary {}", filename) << std::endl;
       exit(2);
     }
 
-    size_t fileSize = (size_t)file.tellg();
-    std::vector<char> buffer(fileSize);
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-    file.close();
-
-    shaderByteCodes.try_emplace(filename, buffer);
-
-    return buffer;
+    return binary;
   }
 
-  static std::vector<char> UseShaderFile(const std::string &filename) {
-    auto elem = shaderByteCodes.find(filename);
-    if (elem != shaderByteCodes.end()) {
+  /**
+   * @brief Module for a precompiled .spv binary or a GLSL source (.vert, .frag, ...) compiled with the defines.
+   */
+  static VkShaderModule ShaderModule(std::string_view filename, const ShaderDefines &defines = {}) {
+    std::string name = ShaderName(filename, defines);
+    auto elem = shaders.find(name);
+    if (elem != shaders.end()) {
       return elem->second;
-    } else {
-      std::cerr << fmt::format(
-                       "Could not use shader binary \"{}\" because it was not "
-                       "loaded.\n"
-                       "Please ReadShaderFile first before calling UserShaderFile",
-                       filename)
-                << std::endl;
-      exit(3);
     }
+
+    if (ShaderCompiler::IsSource(filename)) {
+      auto compiled = TakeCompiled(name, filename, defines);
+      if (!compiled->success) {
+        SDL_LogError(0, "Failed to compile shader %s\n%s", name.c_str(), compiled->log.c_str());
+        exit(5);
+      }
+
+      return AddShaderModule(name, filename, defines, compiled->spirv.data(), compiled->spirv.size(),
+                             compiled->dependencies);
+    }
+
+    std::unique_ptr<ShaderBinary> binary = ReadShaderFile(filename);
+    return AddShaderModule(name, filename, defines, binary->Code(), binary->WordCount(),
+                           {fmt::format("{}{}", ShaderRoot(), filename)});
   }
 
-  static VkShaderModule ShaderModule(const std::string &filename) {
-    auto elem = shaders.find(filename);
-    if (elem != shaders.end()) {
-      return elem->second;
-    } else {
-      VkShaderModule module = CreateShaderModule(logicalDevice, ReadShaderFile(filename));
+  /**
+   * @brief Starts compiling a GLSL source on the ShaderCompiler's workers, ShaderModule picks up the result.
+   * Queue every shader (and permutation) up front so they compile in parallel.
+   */
+  static void Prefetch(std::string_view filename, const ShaderDefines &defines = {}) {
+    std::string name = ShaderName(filename, defines);
+    if (!ShaderCompiler::IsSource(filename) || shaders.find(name) != shaders.end() ||
+        pending.find(name) != pending.end()) {
+      return;
+    }
 
-      shaders.try_emplace(filename, module);
+    pending.try_emplace(name, ShaderCompiler::CompileAsync(fmt::format("{}{}", ShaderRoot(), filename), defines));
+  }
 
-      return module;
+  /**
+   * @brief Interface of a shader loaded through ShaderModule.
+   */
+  static const CoffeeMaker::Renderer::Vulkan::ShaderReflection &Reflection(std::string_view filename,
+                                                                          const ShaderDefines &defines = {}) {
+    std::string name = ShaderName(filename, defines);
+    auto elem = reflections.find(name);
+    if (elem == reflections.end()) {
+      ShaderModule(filename, defines);
+      elem = reflections.find(name);
     }
+
+    return elem->second;
   }
 
-  static VkShaderModule CreateShaderModule(VkDevice device, const std::vector<char> &code) {
+  /**
+   * @param size in bytes, a multiple of 4
+   */
+  static VkShaderModule CreateShaderModule(VkDevice device, const uint32_t *code, size_t size) {
     VkShaderModuleCreateInfo createInfo{};
 
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = code.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t *>(code.data());
+    createInfo.codeSize = size;
+    createInfo.pCode = code;
 
     VkShaderModule shaderModule;
     if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
@@ -82,23 +150,143 @@ class VulkanShaderManager {
     return shaderModule;
   }
 
+  /**
+   * @brief Serial of a module created through ShaderModule or a reload. Unlike the handle it is never handed out
+   * again once the module is destroyed, so it can key pipelines. 0 for modules the manager does not own.
+   */
+  static uint64_t ModuleId(VkShaderModule module) {
+    auto elem = moduleIds.find(module);
+    return elem != moduleIds.end() ? elem->second : 0;
+  }
+
   static void CleanupShaderModule(VkDevice logicalDevice, VkShaderModule shaderModule) {
     vkDestroyShaderModule(logicalDevice, shaderModule, nullptr);
   }
 
   static void AssignLogicalDevice(VkDevice device) { logicalDevice = device; }
 
+  /**
+   * @brief Watches the shader directory, changed shaders are recompiled and their pipelines rebuilt by Update.
+   */
+  static void EnableHotReload();
+
+  /**
+   * @brief Called once per frame on the render thread. Recompiles shaders whose files (or includes) changed and,
+   * once a compile finishes, swaps in the new module and queues rebuilds of the pipelines that use it. Destroys the
+   * modules replaced by earlier reloads once nothing can reference them anymore.
+   */
+  static void Update();
+
   static void CleanAllShaders() {
     for (auto p : shaders) {
       vkDestroyShaderModule(logicalDevice, p.second, nullptr);
     }
+    for (const auto &retired : retiredModules) {
+      vkDestroyShaderModule(logicalDevice, retired.module, nullptr);
+    }
     shaders.clear();
+    reflections.clear();
+    pending.clear();
+    reloading.clear();
+    sources.clear();
+    dependents.clear();
+    retiredModules.clear();
+    moduleIds.clear();
   }
 
   private:
+  using ShaderCompiler = CoffeeMaker::Renderer::Vulkan::ShaderCompiler;
+
+  struct ShaderSource {
+    std::string filename{};
+    ShaderDefines defines{};
+    // NOTE: normalized absolute paths, the source first and then its includes
+    std::vector<std::string> dependencies{};
+  };
+
+  struct RetiredModule {
+    VkShaderModule module{VK_NULL_HANDLE};
+    uint64_t value{0};
+  };
+
+  /**
+   * @brief Cache key of a shader, the filename followed by its defines.
+   */
+  static std::string ShaderName(std::string_view filename, const ShaderDefines &defines) {
+    std::string name{filename};
+    for (const auto &define : defines) {
+      name += fmt::format("|{}={}", define.name, define.value);
+    }
+
+    return name;
+  }
+
+  static std::shared_ptr<const CoffeeMaker::Renderer::Vulkan::CompiledShader> TakeCompiled(
+      const std::string &name, std::string_view filename, const ShaderDefines &defines) {
+    auto elem = pending.find(name);
+    if (elem == pending.end()) {
+      return ShaderCompiler::Compile(fmt::format("{}{}", ShaderRoot(), filename), defines);
+    }
+
+    auto compiled = elem->second.get();
+    pending.erase(elem);
+    return compiled;
+  }
+
+  static VkShaderModule AddShaderModule(const std::string &name, std::string_view filename,
+                                        const ShaderDefines &defines, const uint32_t *code, size_t wordCount,
+                                        const std::vector<std::string> &dependencies);
+  /**
+   * @brief Swaps a recompiled shader in and rebuilds the pipelines built from the previous module.
+   */
+  static void Reload(const std::string &name, const uint32_t *code, size_t wordCount,
+                     const std::vector<std::string> &dependencies);
+  /**
+   * @brief Points every file the shader was built from back at it, replacing the previous list.
+   */
+  static void IndexDependencies(const std::string &name, const std::vector<std::string> &dependencies);
+
+  /**
+   * @brief Directory shader filenames are relative to. Debug builds read the source tree directly (see
+   * COFFEEMAKER_SHADER_ROOT) so edits are picked up by hot reload, otherwise the executable's directory.
+   */
+  static const std::string &ShaderRoot() {
+#ifdef COFFEEMAKER_SHADER_ROOT
+    static const std::string root = COFFEEMAKER_SHADER_ROOT;
+#else
+    // NOTE: SDL_GetBasePath allocates on every call, so it is only asked once
+    static const std::string root = []() {
+      char *path = SDL_GetBasePath();
+      std::string result = path != nullptr ? path : "";
+      SDL_free(path);
+      return result;
+    }();
+#endif
+
+    return root;
+  }
+
   static VkDevice logicalDevice;
-  static std::map<std::string, std::vector<char>> shaderByteCodes;
-  static std::map<std::string, VkShaderModule> shaders;
+  static std::unordered_map<std::string, VkShaderModule, ShaderNameHasher, std::equal_to<>> shaders;
+  static std::unordered_map<std::string, CoffeeMaker::Renderer::Vulkan::ShaderReflection, ShaderNameHasher,
+                            std::equal_to<>>
+      reflections;
+  static std::unordered_map<std::string,
+                            std::shared_future<std::shared_ptr<const CoffeeMaker::Renderer::Vulkan::CompiledShader>>,
+                            ShaderNameHasher, std::equal_to<>>
+      pending;
+  static std::unordered_map<std::string,
+                            std::shared_future<std::shared_ptr<const CoffeeMaker::Renderer::Vulkan::CompiledShader>>,
+                            ShaderNameHasher, std::equal_to<>>
+      reloading;
+  static std::unordered_map<std::string, ShaderSource, ShaderNameHasher, std::equal_to<>> sources;
+  // NOTE: file -> names of the shaders built from it
+  static std::unordered_map<std::string, std::vector<std::string>, ShaderNameHasher, std::equal_to<>> dependents;
+  // NOTE: modules replaced by a reload with the timeline value of the frame they were replaced in, oldest first
+  static std::deque<RetiredModule> retiredModules;
+  // NOTE: every module not destroyed yet, see ModuleId
+  static std::unordered_map<VkShaderModule, uint64_t> moduleIds;
+  static uint64_t nextModuleId;
 };
 
 #endif
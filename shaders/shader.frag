@@ -3,7 +3,14 @@
 layout(location = 0) in vec3 fragColor;
 layout(location = 0) out vec4 outColor;
 
+// set per pipeline, the branch below is folded away when the pipeline is built
+layout(constant_id = 0) const bool GRAYSCALE = false;
+
 void main() { 
+  vec3 color = fragColor;
+  if (GRAYSCALE) {
+    color = vec3(dot(color, vec3(0.299, 0.587, 0.114)));
+  }
   // return color
-  outColor = vec4(fragColor, 1.0); 
+  outColor = vec4(color, 1.0);
 }
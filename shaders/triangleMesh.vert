@@ -3,6 +3,10 @@
 layout (location = 0) in vec3 vPosition;
 layout (location = 1) in vec3 vNormal;
 layout (location = 2) in vec3 vColor;
+#ifdef INSTANCED
+// per instance, binding 1
+layout (location = 3) in mat4 iModel;
+#endif
 
 layout (location = 0) out vec3 fragColor;
 
@@ -13,6 +17,16 @@ layout (push_constant) uniform constants
 } PushConstants;
 
 void main() {
+#ifdef INSTANCED
+  // renderMatrix only holds projection * view, the model matrix comes with the instance
+  gl_Position = PushConstants.renderMatrix * iModel * vec4(vPosition, 1.0f);
+#else
   gl_Position = PushConstants.renderMatrix * vec4(vPosition, 1.0f);
+#endif
+#ifdef SHOW_NORMALS
+  // debug view, normals remapped from [-1, 1] to a color
+  fragColor = vNormal * 0.5f + 0.5f;
+#else
   fragColor = vColor;
+#endif
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <utility>
 
 #include "Camera.hpp"
+#include "CpuProfiler.hpp"
 #include "DeltaTime.hpp"
 #include "Editor/MainMenuBar.hpp"
 #include "Triangle.hpp"
@@ -45,7 +46,13 @@ Application::~Application() {
 }
 
 void Application::Run() {
+#ifdef COFFEEMAKER_PROFILING
+  CoffeeMaker::CpuProfiler::SetThreadName("Main");
+#endif
   while (!quit) {
+    CPU_SCOPE("Application::Frame");
+    // NOTE: any wait for the GPU happens here, before the input is read, not after
+    renderer->WaitForNextFrame();
     while (SDL_PollEvent(&event)) {
       // Handle ImGui events first...
 
@@ -56,9 +63,7 @@ void Application::Run() {
         quit = true;
       }
       if (event.type == SDL_WINDOWEVENT) {
-        if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
-          renderer->FramebufferResize();
-        }
+        // NOTE: SIZE_CHANGED follows every RESIZED as well, handling both flagged each resize twice
         if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
           renderer->FramebufferResize();
         }
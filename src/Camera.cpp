@@ -59,6 +59,15 @@ glm::mat4 Camera::ScreenSpaceMatrix(glm::mat4 model) {
   return orthographicProj * view * model;
 }
 
+glm::mat4 Camera::ViewProjection() const {
+  glm::mat4 cameraView = glm::translate(glm::mat4{1.0f}, position);
+  if (_type == CameraType::Perspective) {
+    return perspectiveProj * cameraView;
+  }
+  cameraView = glm::scale(cameraView, glm::vec3{height / scale, height / scale, 1.0f});
+  return orthographicProj * cameraView;
+}
+
 void Camera::EditorUpdate() {
   ImGui::Begin("Camera");
 
@@ -0,0 +1,181 @@
+#include "CpuProfiler.hpp"
+
+#include <SDL2/SDL.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+
+#include "Json.hpp"
+#include "Renderer/Vulkan/GpuProfiler.hpp"
+
+namespace {
+  // NOTE: trace timestamps are microseconds, relative to the first event so they stay readable
+  double Microseconds(int64_t ns, int64_t originNs) { return static_cast<double>(ns - originNs) / 1000.0; }
+}  // namespace
+
+std::atomic<bool> CoffeeMaker::CpuProfiler::Enabled{true};
+std::mutex CoffeeMaker::CpuProfiler::gThreadsMutex{};
+std::vector<std::unique_ptr<CoffeeMaker::CpuProfiler::ThreadRing>> CoffeeMaker::CpuProfiler::gThreads{};
+
+int64_t CoffeeMaker::CpuProfiler::NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void CoffeeMaker::CpuProfiler::SetThreadName(const std::string& name) {
+  ThreadRing& ring = LocalRing();
+  std::lock_guard<std::mutex> lock{gThreadsMutex};
+  ring.name = name;
+}
+
+void CoffeeMaker::CpuProfiler::Record(const char* name, int64_t startNs, int64_t endNs) {
+  if (!Enabled.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  ThreadRing& ring = LocalRing();
+  uint64_t head = ring.head.load(std::memory_order_relaxed);
+  ring.events[head & (RingCapacity - 1)] = Event{.name = name, .startNs = startNs, .endNs = endNs};
+  ring.head.store(head + 1, std::memory_order_release);
+}
+
+std::vector<CoffeeMaker::CpuProfiler::ThreadInfo> CoffeeMaker::CpuProfiler::Threads() {
+  std::lock_guard<std::mutex> lock{gThreadsMutex};
+  std::vector<ThreadInfo> threads{};
+  for (const auto& ring : gThreads) {
+    threads.push_back(
+        ThreadInfo{.name = ring->name, .id = ring->id, .recorded = ring->head.load(std::memory_order_acquire)});
+  }
+  return threads;
+}
+
+bool CoffeeMaker::CpuProfiler::ExportChromeTrace(const std::string& path) {
+  using GpuProfiler = CoffeeMaker::Renderer::Vulkan::GpuProfiler;
+
+  struct ThreadEvents {
+    std::string name{};
+    uint32_t id{0};
+    std::vector<Event> events{};
+  };
+
+  std::vector<ThreadEvents> threads{};
+  {
+    std::lock_guard<std::mutex> lock{gThreadsMutex};
+    for (const auto& ring : gThreads) {
+      threads.push_back(ThreadEvents{.name = ring->name, .id = ring->id, .events = Snapshot(*ring)});
+    }
+  }
+
+  // NOTE: the GPU clock is not calibrated against the CPU one. A frame starts at its submit or when the frame
+  // before it ended on the GPU, whichever is later, so starts are a lower bound and durations are exact.
+  struct GpuEvent {
+    std::string name{};
+    int64_t startNs{0};
+    int64_t endNs{0};
+  };
+  std::vector<GpuEvent> gpuEvents{};
+  int64_t gpuEndNs = 0;
+  for (const GpuProfiler::FrameTimes& frame : GpuProfiler::History()) {
+    int64_t frameStartNs = std::max(frame.submitNs, gpuEndNs);
+    for (const GpuProfiler::ScopeTime& scope : frame.scopes) {
+      GpuEvent event{};
+      event.name = GpuProfiler::ScopeName(scope.stats);
+      event.startNs = frameStartNs + static_cast<int64_t>(scope.beginMs * 1000000.0);
+      event.endNs = frameStartNs + static_cast<int64_t>(scope.endMs * 1000000.0);
+      gpuEndNs = std::max(gpuEndNs, event.endNs);
+      gpuEvents.push_back(event);
+    }
+  }
+
+  int64_t originNs = INT64_MAX;
+  for (const ThreadEvents& thread : threads) {
+    for (const Event& event : thread.events) {
+      originNs = std::min(originNs, event.startNs);
+    }
+  }
+  for (const GpuEvent& event : gpuEvents) {
+    originNs = std::min(originNs, event.startNs);
+  }
+  if (originNs == INT64_MAX) {
+    originNs = 0;
+  }
+
+  std::ofstream file{path, std::ios::trunc};
+  if (!file) {
+    SDL_LogWarn(0, "Unable to write the trace to %s", path.c_str());
+    return false;
+  }
+
+  bool first = true;
+  auto separator = [&first]() {
+    const char* text = first ? "\n" : ",\n";
+    first = false;
+    return text;
+  };
+
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  file << separator() << R"({"name":"process_name","ph":"M","pid":1,"args":{"name":"CPU"}})";
+  file << separator() << R"({"name":"process_name","ph":"M","pid":2,"args":{"name":"GPU"}})";
+  file << separator() << R"({"name":"thread_name","ph":"M","pid":2,"tid":0,"args":{"name":"Graphics Queue"}})";
+  for (const ThreadEvents& thread : threads) {
+    std::string name = thread.name.empty() ? fmt::format("Thread {}", thread.id) : thread.name;
+    file << separator()
+         << fmt::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})", thread.id,
+                        CoffeeMaker::EscapeJson(name));
+    for (const Event& event : thread.events) {
+      file << separator()
+           << fmt::format(R"({{"name":"{}","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+                          CoffeeMaker::EscapeJson(event.name), thread.id, Microseconds(event.startNs, originNs),
+                          Microseconds(event.endNs, event.startNs));
+    }
+  }
+  for (const GpuEvent& event : gpuEvents) {
+    file << separator()
+         << fmt::format(R"({{"name":"{}","ph":"X","pid":2,"tid":0,"ts":{:.3f},"dur":{:.3f}}})",
+                        CoffeeMaker::EscapeJson(event.name), Microseconds(event.startNs, originNs),
+                        Microseconds(event.endNs, event.startNs));
+  }
+  file << "\n]}\n";
+  return static_cast<bool>(file);
+}
+
+CoffeeMaker::CpuProfiler::ThreadRing& CoffeeMaker::CpuProfiler::LocalRing() {
+  // NOTE: owned by the registry so a thread's scopes can still be exported after it has exited
+  thread_local ThreadRing* ring = nullptr;
+  if (ring == nullptr) {
+    std::lock_guard<std::mutex> lock{gThreadsMutex};
+    gThreads.push_back(std::make_unique<ThreadRing>());
+    ring = gThreads.back().get();
+    ring->id = static_cast<uint32_t>(gThreads.size());
+  }
+  return *ring;
+}
+
+std::vector<CoffeeMaker::CpuProfiler::Event> CoffeeMaker::CpuProfiler::Snapshot(const ThreadRing& ring) {
+  uint64_t head = ring.head.load(std::memory_order_acquire);
+  uint64_t begin = head > RingCapacity ? head - RingCapacity : 0;
+  std::vector<Event> events{};
+  events.reserve(static_cast<size_t>(head - begin));
+  for (uint64_t i = begin; i < head; i++) {
+    events.push_back(ring.events[i & (RingCapacity - 1)]);
+  }
+
+  // NOTE: whatever the owner wrote while copying, and the entry it may be writing now, replaced the oldest copies
+  uint64_t after = ring.head.load(std::memory_order_acquire) + 1;
+  uint64_t overwritten = after > RingCapacity ? after - RingCapacity : 0;
+  if (overwritten > begin) {
+    size_t drop = static_cast<size_t>(std::min<uint64_t>(overwritten - begin, events.size()));
+    events.erase(events.begin(), events.begin() + static_cast<std::ptrdiff_t>(drop));
+  }
+  return events;
+}
+
+CoffeeMaker::CpuScope::CpuScope(const char* scopeName)
+    : name(scopeName), startNs(CoffeeMaker::CpuProfiler::NowNs()) {}
+
+CoffeeMaker::CpuScope::~CpuScope() {
+  CoffeeMaker::CpuProfiler::Record(name, startNs, CoffeeMaker::CpuProfiler::NowNs());
+}
@@ -0,0 +1,41 @@
+#include "Json.hpp"
+
+#include <fmt/core.h>
+
+std::string CoffeeMaker::EscapeJson(std::string_view text) {
+  std::string escaped{};
+  escaped.reserve(text.size());
+  for (char c : text) {
+    switch (c) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\b':
+        escaped += "\\b";
+        break;
+      case '\f':
+        escaped += "\\f";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      case '\r':
+        escaped += "\\r";
+        break;
+      case '\t':
+        escaped += "\\t";
+        break;
+      default:
+        // NOTE: unsigned, bytes of multi byte UTF-8 sequences are >= 0x80 and pass through as they are
+        if (static_cast<unsigned char>(c) < 0x20) {
+          escaped += fmt::format("\\u{:04x}", static_cast<unsigned char>(c));
+        } else {
+          escaped.push_back(c);
+        }
+    }
+  }
+  return escaped;
+}
@@ -2,7 +2,9 @@
 
 #include <glm/glm.hpp>
 
+#include "Renderer/Material.hpp"
 #include "Renderer/Vulkan/Commands.hpp"
+#include "Renderer/Vulkan/PipelineRegistry.hpp"
 #include "Renderer/Vulkan/Swapchain.hpp"
 #include "VulkanShaderManager.hpp"
 
@@ -31,36 +33,18 @@ CoffeeMaker::Primitives::Rectangle::~Rectangle() {
   DestroyBuffer(mesh.indexBuffer);
 }
 
-void CoffeeMaker::Primitives::Rectangle::Draw() {
-  using PushConstants = CoffeeMaker::Renderer::MeshPushConstants;
-  using Commands = CoffeeMaker::Renderer::Vulkan::Commands;
-
-  VkCommandBuffer cmd = Commands::GetCurrentBuffer();
-
-  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineBuilder.pPipeline);
-  VkDeviceSize offset = 0;
-  vkCmdBindVertexBuffers(cmd, 0, 1, &mesh.vertexBuffer.buffer, &offset);
-  vkCmdBindIndexBuffer(cmd, mesh.indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT16);
-
+CoffeeMaker::Renderer::RenderObject CoffeeMaker::Primitives::Rectangle::Object() const {
   glm::mat4 meshMatrix{1.0f};
-  pushConstants.renderMatrix = _mainCamera->ScreenSpaceMatrix(meshMatrix);
-  vkCmdPushConstants(cmd, pipelineBuilder.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants), &pushConstants);
-  vkCmdDrawIndexed(cmd, static_cast<uint32_t>(mesh.indices.size()), 1, 0, 0, 0);
+  return CoffeeMaker::Renderer::RenderObject{.mesh = &mesh, .material = &material, .transform = meshMatrix};
 }
 
 void CoffeeMaker::Primitives::Rectangle::MakeMeshPipeline() {
-  using PushConstants = CoffeeMaker::Renderer::MeshPushConstants;
   using PipelineCreateInfo = CoffeeMaker::Renderer::Vulkan::PipelineCreateInfo;
+  using PipelineRegistry = CoffeeMaker::Renderer::Vulkan::PipelineRegistry;
   using Vertex = CoffeeMaker::Renderer::Vertex;
 
-  VkPushConstantRange pushConstants{
-      .stageFlags = VK_SHADER_STAGE_VERTEX_BIT, .offset = 0, .size = sizeof(PushConstants)};
-
-  PipelineCreateInfo info{.vertexShader = VulkanShaderManager::ShaderModule("triangleMesh.spv"),
-                          .fragmentShader = VulkanShaderManager::ShaderModule("frag.spv"),
-                          .vertexInputs = Vertex::Description(),
-                          .pushConstantRangeCount = 1,
-                          .pushConstants = pushConstants};
+  PipelineCreateInfo info = CoffeeMaker::Renderer::MeshShaders().MakePipelineCreateInfo(0, Vertex::Description());
+  info.renderState = material.renderState;
 
-  pipelineBuilder.CreatePipeline(info);
+  material.pipeline = PipelineRegistry::GetPipelineAsync(info);
 }
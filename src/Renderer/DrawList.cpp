@@ -0,0 +1,174 @@
+#include "Renderer/DrawList.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <random>
+
+#include "Renderer/Vulkan/PipelineRegistry.hpp"
+
+namespace {
+  using Pipeline = CoffeeMaker::Renderer::Vulkan::Pipeline;
+  using Material = CoffeeMaker::Renderer::Material;
+  using Mesh = CoffeeMaker::Renderer::Mesh;
+
+  constexpr uint64_t PIPELINE_MASK = (1ull << Pipeline::IdBits) - 1;
+  constexpr uint64_t MATERIAL_MASK = (1ull << Material::IdBits) - 1;
+  constexpr uint64_t MESH_MASK = (1ull << Mesh::IdBits) - 1;
+  constexpr uint64_t DEPTH_MASK = (1ull << 24) - 1;
+  // NOTE: MakeKey places the fields by these widths, the pools must not hand out more bits than the key has
+  static_assert(Pipeline::IdBits == 12 && Material::IdBits == 12 && Mesh::IdBits == 14);
+  constexpr int RADIX_BITS = 8;
+  constexpr int RADIX_PASSES = 64 / RADIX_BITS;
+  constexpr size_t RADIX_BUCKETS = 1ull << RADIX_BITS;
+}  // namespace
+
+void CoffeeMaker::Renderer::DrawList::Begin(const glm::mat4& frameViewProjection) {
+  viewProjection = frameViewProjection;
+  objects.clear();
+  items.clear();
+}
+
+void CoffeeMaker::Renderer::DrawList::Submit(const RenderObject& object) {
+  // NOTE: clip z over w of the object's origin, [0, 1] between the near and far planes for ortho and perspective
+  glm::vec4 clip = viewProjection * object.transform[3];
+  float depth = clip.w != 0.0f ? clip.z / clip.w : clip.z;
+  // NOTE: a material without a pipeline is skipped when drawing, where it sorts does not matter
+  uint32_t pipeline = object.material->pipeline != nullptr ? object.material->pipeline->id.Value() : 0;
+  uint64_t key =
+      MakeKey(object.material->layer, pipeline, object.material->id.Value(), object.mesh->id.Value(), depth);
+
+  items.push_back(SortItem{.key = key, .index = static_cast<uint32_t>(objects.size())});
+  objects.push_back(object);
+}
+
+void CoffeeMaker::Renderer::DrawList::Sort() {
+  auto start = std::chrono::steady_clock::now();
+  RadixSort(items, scratch);
+  LastSortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void CoffeeMaker::Renderer::DrawList::Draw(Vulkan::CommandEncoder& encoder, size_t begin, size_t end) const {
+  using PipelineRegistry = CoffeeMaker::Renderer::Vulkan::PipelineRegistry;
+  using Pipeline = CoffeeMaker::Renderer::Vulkan::Pipeline;
+
+  // NOTE: the encoder drops the binds neighbouring draws share, sorting is what makes them neighbours
+  for (size_t i = begin; i < end && i < items.size(); i++) {
+    const RenderObject& object = objects[items[i].index];
+
+    Pipeline* boundPipeline = PipelineRegistry::ResolveForDraw(object.material->pipeline);
+    if (boundPipeline == nullptr) {
+      continue;
+    }
+
+    encoder.BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, boundPipeline->pPipeline);
+    encoder.SetRenderState(object.material->renderState);
+    VkDeviceSize offset = 0;
+    encoder.BindVertexBuffers(0, 1, &object.mesh->vertexBuffer.buffer, &offset);
+    if (!object.mesh->indices.empty()) {
+      encoder.BindIndexBuffer(object.mesh->indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT16);
+    }
+
+    MeshPushConstants constants{};
+    constants.renderMatrix = viewProjection * object.transform;
+    encoder.PushConstants(boundPipeline->layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstants), &constants);
+
+    if (object.mesh->indices.empty()) {
+      encoder.Draw(static_cast<uint32_t>(object.mesh->vertices.size()), 1, 0, 0);
+    } else {
+      encoder.DrawIndexed(static_cast<uint32_t>(object.mesh->indices.size()), 1, 0, 0, 0);
+    }
+  }
+}
+
+size_t CoffeeMaker::Renderer::DrawList::Size() const { return items.size(); }
+
+uint64_t CoffeeMaker::Renderer::DrawList::MakeKey(RenderLayer layer, uint32_t pipeline, uint32_t material,
+                                                  uint32_t mesh, float depth) {
+  // NOTE: the bits of a positive float sort like the float, the top 24 are plenty to order draws
+  uint64_t quantizedDepth = (std::bit_cast<uint32_t>(std::max(depth, 0.0f)) >> 7) & DEPTH_MASK;
+  uint64_t key = static_cast<uint64_t>(layer) << 62;
+
+  if (layer == RenderLayer::Transparent) {
+    key |= (~quantizedDepth & DEPTH_MASK) << 38;
+    key |= (pipeline & PIPELINE_MASK) << 26;
+    key |= (material & MATERIAL_MASK) << 14;
+    key |= mesh & MESH_MASK;
+    return key;
+  }
+
+  key |= (pipeline & PIPELINE_MASK) << 50;
+  key |= (material & MATERIAL_MASK) << 38;
+  key |= (mesh & MESH_MASK) << 24;
+  key |= quantizedDepth;
+  return key;
+}
+
+void CoffeeMaker::Renderer::DrawList::RadixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch) {
+  if (items.size() < 2) {
+    return;
+  }
+
+  // NOTE: every pass's histogram in a single sweep over the keys
+  std::vector<std::array<uint32_t, RADIX_BUCKETS>> histograms(RADIX_PASSES);
+  for (const SortItem& item : items) {
+    for (int pass = 0; pass < RADIX_PASSES; pass++) {
+      histograms[pass][(item.key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+    }
+  }
+
+  scratch.resize(items.size());
+  SortItem* source = items.data();
+  SortItem* destination = scratch.data();
+  bool inScratch = false;
+
+  for (int pass = 0; pass < RADIX_PASSES; pass++) {
+    int shift = pass * RADIX_BITS;
+    std::array<uint32_t, RADIX_BUCKETS>& histogram = histograms[pass];
+    if (histogram[(source[0].key >> shift) & (RADIX_BUCKETS - 1)] == items.size()) {
+      continue;
+    }
+
+    uint32_t offset = 0;
+    for (uint32_t& bucket : histogram) {
+      uint32_t count = bucket;
+      bucket = offset;
+      offset += count;
+    }
+    for (size_t i = 0; i < items.size(); i++) {
+      destination[histogram[(source[i].key >> shift) & (RADIX_BUCKETS - 1)]++] = source[i];
+    }
+
+    std::swap(source, destination);
+    inScratch = !inScratch;
+  }
+
+  if (inScratch) {
+    items.swap(scratch);
+  }
+}
+
+CoffeeMaker::Renderer::DrawList::BenchmarkResult CoffeeMaker::Renderer::DrawList::Benchmark(size_t count) {
+  std::mt19937_64 random{count};
+  std::vector<SortItem> keys(count);
+  for (size_t i = 0; i < count; i++) {
+    keys[i] = SortItem{.key = random(), .index = static_cast<uint32_t>(i)};
+  }
+  std::vector<SortItem> radixKeys = keys;
+  // NOTE: sized up front, like the per frame scratch that is only ever grown
+  std::vector<SortItem> scratchKeys(count);
+
+  BenchmarkResult result{};
+  result.count = count;
+
+  auto start = std::chrono::steady_clock::now();
+  RadixSort(radixKeys, scratchKeys);
+  result.radixMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  std::sort(keys.begin(), keys.end(), [](const SortItem& lhs, const SortItem& rhs) { return lhs.key < rhs.key; });
+  result.stdSortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  return result;
+}
@@ -0,0 +1,381 @@
+#include "Renderer/GpuScene.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <array>
+#include <glm/gtc/matrix_access.hpp>
+
+#include "Renderer/Vulkan/IndirectDraw.hpp"
+#include "Renderer/Vulkan/LogicalDevice.hpp"
+#include "Renderer/Vulkan/PipelineRegistry.hpp"
+#include "Renderer/Vulkan/ShaderReflection.hpp"
+#include "VulkanShaderManager.hpp"
+
+namespace {
+  // NOTE: objects, groups, commands and counts
+  constexpr uint32_t STORAGE_BUFFER_BINDINGS = 4;
+  constexpr uint32_t COMMAND_STRIDE = sizeof(VkDrawIndexedIndirectCommand);
+}  // namespace
+
+void CoffeeMaker::Renderer::GpuScene::Create(size_t framesInFlight) {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+  using ComputePipeline = CoffeeMaker::Renderer::Vulkan::ComputePipeline;
+
+  VkShaderModule cullShader = VulkanShaderManager::ShaderModule("shaders/cull.comp");
+  cullPipeline = std::make_unique<ComputePipeline>();
+  cullPipeline->CreatePipeline(
+      Vulkan::MakeComputePipelineCreateInfo(cullShader, VulkanShaderManager::Reflection("shaders/cull.comp")));
+
+  VkDescriptorPoolSize poolSize{};
+  poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  poolSize.descriptorCount = static_cast<uint32_t>(framesInFlight) * STORAGE_BUFFER_BINDINGS;
+
+  VkDescriptorPoolCreateInfo poolInfo{};
+  poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  poolInfo.maxSets = static_cast<uint32_t>(framesInFlight);
+  poolInfo.poolSizeCount = 1;
+  poolInfo.pPoolSizes = &poolSize;
+
+  VkResult result = vkCreateDescriptorPool(LogicalDevice::GetLogicalDevice(), &poolInfo, nullptr, &descriptorPool);
+  if (result != VK_SUCCESS) {
+    SDL_LogError(0, "Unable to create GPU scene descriptor pool.\nVulkan Error Code: [%d]", result);
+    exit(13);
+  }
+
+  frames.resize(framesInFlight);
+  std::vector<VkDescriptorSetLayout> setLayouts(framesInFlight, cullPipeline->setLayouts[0]);
+  std::vector<VkDescriptorSet> descriptorSets(framesInFlight, VK_NULL_HANDLE);
+
+  VkDescriptorSetAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  allocInfo.descriptorPool = descriptorPool;
+  allocInfo.descriptorSetCount = static_cast<uint32_t>(framesInFlight);
+  allocInfo.pSetLayouts = setLayouts.data();
+
+  result = vkAllocateDescriptorSets(LogicalDevice::GetLogicalDevice(), &allocInfo, descriptorSets.data());
+  if (result != VK_SUCCESS) {
+    SDL_LogError(0, "Unable to allocate GPU scene descriptor sets.\nVulkan Error Code: [%d]", result);
+    exit(13);
+  }
+  for (size_t i = 0; i < frames.size(); i++) {
+    frames[i].descriptorSet = descriptorSets[i];
+  }
+}
+
+void CoffeeMaker::Renderer::GpuScene::Destroy() {
+  using namespace CoffeeMaker::Renderer::Vulkan;
+
+  for (auto& resources : frames) {
+    for (AllocatedBuffer* buffer : {&resources.transforms, &resources.objects, &resources.groups, &resources.commands,
+                                    &resources.counts, &resources.readback}) {
+      if (buffer->buffer != VK_NULL_HANDLE) {
+        DestroyBuffer(*buffer);
+      }
+    }
+  }
+  frames.clear();
+
+  // NOTE: destroying the pool frees its sets
+  vkDestroyDescriptorPool(LogicalDevice::GetLogicalDevice(), descriptorPool, nullptr);
+  descriptorPool = VK_NULL_HANDLE;
+  cullPipeline.reset();
+}
+
+uint32_t CoffeeMaker::Renderer::GpuScene::AddGroup(const Mesh* mesh, const Material* material) {
+  if (mesh->indices.empty()) {
+    SDL_LogError(0, "GPU scene groups need an indexed mesh.");
+    exit(13);
+  }
+
+  groups.push_back(Group{.mesh = mesh, .material = material});
+  version++;
+  return static_cast<uint32_t>(groups.size() - 1);
+}
+
+uint32_t CoffeeMaker::Renderer::GpuScene::AddObject(uint32_t group, const glm::mat4& transform, float radius) {
+  groups[group].objectCount++;
+  transforms.push_back(InstanceData{.model = transform});
+  objects.push_back(MakeObject(group, transform, radius));
+  radii.push_back(radius);
+  version++;
+  return static_cast<uint32_t>(objects.size() - 1);
+}
+
+void CoffeeMaker::Renderer::GpuScene::SetTransform(uint32_t object, const glm::mat4& transform) {
+  transforms[object].model = transform;
+  objects[object] = MakeObject(objects[object].group, transform, radii[object]);
+  version++;
+}
+
+void CoffeeMaker::Renderer::GpuScene::Clear() {
+  groups.clear();
+  transforms.clear();
+  objects.clear();
+  radii.clear();
+  visibleCount = 0;
+  visibleTriangles = 0;
+  version++;
+}
+
+void CoffeeMaker::Renderer::GpuScene::Prepare(size_t frameIndex) {
+  using namespace CoffeeMaker::Renderer::Vulkan;
+
+  if (frames.empty()) {
+    return;
+  }
+
+  frame = frameIndex;
+  FrameResources& resources = frames[frame];
+
+  // NOTE: the frame slot's timeline value was reached, the counts its last Cull copied out are complete
+  if (resources.readbackGroups > 0) {
+    std::vector<uint32_t> counts(resources.readbackGroups, 0);
+    ReadMemory(counts.data(), counts.size() * sizeof(uint32_t), resources.readback.allocation);
+    visibleCount = 0;
+    visibleTriangles = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+      visibleCount += counts[i];
+      // NOTE: groups are only appended or cleared, one cleared since the copy no longer has a mesh to count
+      if (i < groups.size()) {
+        visibleTriangles += static_cast<uint64_t>(counts[i]) * (groups[i].mesh->indices.size() / 3);
+      }
+    }
+    resources.readbackGroups = 0;
+  }
+
+  if (resources.version == version) {
+    return;
+  }
+  resources.version = version;
+
+  // NOTE: each group owns a range of the command buffer large enough for all of its objects
+  uint32_t firstCommand = 0;
+  std::vector<DrawGroup> drawGroups{};
+  drawGroups.reserve(groups.size());
+  for (Group& group : groups) {
+    group.firstCommand = firstCommand;
+    firstCommand += group.objectCount;
+    drawGroups.push_back(DrawGroup{.firstCommand = group.firstCommand,
+                                   .indexCount = static_cast<uint32_t>(group.mesh->indices.size()),
+                                   .firstIndex = 0,
+                                   .vertexOffset = 0});
+  }
+
+  if (objects.empty()) {
+    return;
+  }
+
+  Reserve(resources);
+  MapMemory(transforms.data(), transforms.size() * sizeof(InstanceData), resources.transforms.allocation);
+  FlushMemory(resources.transforms.allocation, 0, transforms.size() * sizeof(InstanceData));
+  UnmapMemory(resources.transforms.allocation);
+  MapMemory(objects.data(), objects.size() * sizeof(ObjectData), resources.objects.allocation);
+  FlushMemory(resources.objects.allocation, 0, objects.size() * sizeof(ObjectData));
+  UnmapMemory(resources.objects.allocation);
+  MapMemory(drawGroups.data(), drawGroups.size() * sizeof(DrawGroup), resources.groups.allocation);
+  FlushMemory(resources.groups.allocation, 0, drawGroups.size() * sizeof(DrawGroup));
+  UnmapMemory(resources.groups.allocation);
+}
+
+CoffeeMaker::Renderer::GpuScene::CullOutputs CoffeeMaker::Renderer::GpuScene::AddCullPasses(
+    RenderGraph& graph, const glm::mat4& viewProjection) {
+  using IndirectDraw = CoffeeMaker::Renderer::Vulkan::IndirectDraw;
+
+  if (objects.empty() || frames.empty()) {
+    return CullOutputs{};
+  }
+
+  FrameResources& resources = frames[frame];
+  CullOutputs outputs{.commands = graph.ImportBuffer("Draw Commands", resources.commands.buffer),
+                      .counts = graph.ImportBuffer("Draw Counts", resources.counts.buffer)};
+  RenderGraph::ResourceHandle readback =
+      graph.ImportBuffer("Visible Counts", resources.readback.buffer, ResourceAccess::HostRead);
+
+  graph.AddPass(
+      "Clear Draw Counts",
+      [&](RenderGraph::PassBuilder& pass) {
+        pass.Write(outputs.counts, ResourceAccess::TransferWrite);
+        if (!IndirectDraw::DrawCount) {
+          pass.Write(outputs.commands, ResourceAccess::TransferWrite);
+        }
+      },
+      [this, &resources](VkCommandBuffer cmd) {
+        vkCmdFillBuffer(cmd, resources.counts.buffer, 0, groups.size() * sizeof(uint32_t), 0);
+        if (!IndirectDraw::DrawCount) {
+          // NOTE: every command is drawn without a count, the slots culling leaves empty must draw nothing
+          vkCmdFillBuffer(cmd, resources.commands.buffer, 0, objects.size() * COMMAND_STRIDE, 0);
+        }
+      });
+
+  // NOTE: Gribb-Hartmann, the planes are rows of the view projection added to or subtracted from its last row
+  CullConstants constants{};
+  constants.objectCount = static_cast<uint32_t>(objects.size());
+  glm::vec4 w = glm::row(viewProjection, 3);
+  for (int i = 0; i < 3; i++) {
+    glm::vec4 row = glm::row(viewProjection, i);
+    constants.planes[i * 2] = w + row;
+    constants.planes[i * 2 + 1] = w - row;
+  }
+  // NOTE: GLM_FORCE_DEPTH_ZERO_TO_ONE puts the near plane at z = 0 instead of z = -w, far stays at z = w
+  constants.planes[4] = glm::row(viewProjection, 2);
+  for (glm::vec4& plane : constants.planes) {
+    plane /= glm::length(glm::vec3(plane));
+  }
+
+  graph.AddPass(
+      "Cull",
+      [&](RenderGraph::PassBuilder& pass) {
+        pass.Write(outputs.commands, ResourceAccess::ComputeStorageWrite);
+        pass.Write(outputs.counts, ResourceAccess::ComputeStorageWrite);
+      },
+      [this, &resources, constants](VkCommandBuffer cmd) {
+        cullPipeline->Bind(cmd);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline->layout, 0, 1,
+                                &resources.descriptorSet, 0, nullptr);
+        vkCmdPushConstants(cmd, cullPipeline->layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullConstants),
+                           &constants);
+        vkCmdDispatch(cmd, cullPipeline->GroupCount(constants.objectCount), 1, 1);
+      });
+
+  graph.AddPass(
+      "Read Back Counts",
+      [&](RenderGraph::PassBuilder& pass) {
+        pass.Read(outputs.counts, ResourceAccess::TransferRead);
+        pass.Write(readback, ResourceAccess::TransferWrite);
+      },
+      [this, &resources](VkCommandBuffer cmd) {
+        VkBufferCopy copy{};
+        copy.size = groups.size() * sizeof(uint32_t);
+        vkCmdCopyBuffer(cmd, resources.counts.buffer, resources.readback.buffer, 1, &copy);
+        resources.readbackGroups = groups.size();
+      });
+
+  return outputs;
+}
+
+void CoffeeMaker::Renderer::GpuScene::Draw(Vulkan::CommandEncoder& encoder, const glm::mat4& viewProjection) const {
+  using PipelineRegistry = CoffeeMaker::Renderer::Vulkan::PipelineRegistry;
+  using Pipeline = CoffeeMaker::Renderer::Vulkan::Pipeline;
+
+  if (objects.empty()) {
+    return;
+  }
+
+  const FrameResources& resources = frames[frame];
+  MeshPushConstants constants{};
+  constants.renderMatrix = viewProjection;
+
+  for (size_t i = 0; i < groups.size(); i++) {
+    const Group& group = groups[i];
+    if (group.objectCount == 0) {
+      continue;
+    }
+
+    // NOTE: the fallback pipeline has no instance binding
+    Pipeline* boundPipeline = PipelineRegistry::ResolveForDraw(group.material->pipeline, false);
+    if (boundPipeline == nullptr) {
+      continue;
+    }
+
+    encoder.BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, boundPipeline->pPipeline);
+    encoder.SetRenderState(group.material->renderState);
+    VkBuffer buffers[] = {group.mesh->vertexBuffer.buffer, resources.transforms.buffer};
+    VkDeviceSize offsets[] = {0, 0};
+    encoder.BindVertexBuffers(0, 2, buffers, offsets);
+    encoder.BindIndexBuffer(group.mesh->indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT16);
+    encoder.PushConstants(boundPipeline->layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstants), &constants);
+    encoder.DrawIndexedIndirectCount(resources.commands.buffer,
+                                     static_cast<VkDeviceSize>(group.firstCommand) * COMMAND_STRIDE,
+                                     resources.counts.buffer, i * sizeof(uint32_t), group.objectCount, COMMAND_STRIDE,
+                                     static_cast<uint32_t>(group.mesh->indices.size()));
+  }
+}
+
+size_t CoffeeMaker::Renderer::GpuScene::ObjectCount() const { return objects.size(); }
+
+size_t CoffeeMaker::Renderer::GpuScene::GroupCount() const { return groups.size(); }
+
+uint32_t CoffeeMaker::Renderer::GpuScene::VisibleCount() const { return visibleCount; }
+
+uint64_t CoffeeMaker::Renderer::GpuScene::VisibleTriangles() const { return visibleTriangles; }
+
+void CoffeeMaker::Renderer::GpuScene::Reserve(FrameResources& resources) {
+  using namespace CoffeeMaker::Renderer::Vulkan;
+
+  bool grown = false;
+  if (objects.size() > resources.objectCapacity) {
+    // NOTE: the frame slot's timeline value was reached, nothing is reading the old buffers anymore
+    for (AllocatedBuffer* buffer : {&resources.transforms, &resources.objects, &resources.commands}) {
+      if (buffer->buffer != VK_NULL_HANDLE) {
+        DestroyBuffer(*buffer);
+      }
+    }
+    resources.objectCapacity = std::max(objects.size(), resources.objectCapacity * 2);
+    // NOTE: also bound as the instance vertex buffer, firstInstance of each draw indexes it
+    resources.transforms = CreateBuffer(resources.objectCapacity * sizeof(InstanceData),
+                                        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                        VMA_MEMORY_USAGE_CPU_TO_GPU);
+    resources.objects = CreateBuffer(resources.objectCapacity * sizeof(ObjectData), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                     VMA_MEMORY_USAGE_CPU_TO_GPU);
+    resources.commands = CreateBuffer(resources.objectCapacity * COMMAND_STRIDE,
+                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                          VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      VMA_MEMORY_USAGE_GPU_ONLY);
+    grown = true;
+  }
+
+  if (groups.size() > resources.groupCapacity) {
+    for (AllocatedBuffer* buffer : {&resources.groups, &resources.counts, &resources.readback}) {
+      if (buffer->buffer != VK_NULL_HANDLE) {
+        DestroyBuffer(*buffer);
+      }
+    }
+    resources.groupCapacity = std::max(groups.size(), resources.groupCapacity * 2);
+    resources.groups = CreateBuffer(resources.groupCapacity * sizeof(DrawGroup), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                    VMA_MEMORY_USAGE_CPU_TO_GPU);
+    resources.counts = CreateBuffer(resources.groupCapacity * sizeof(uint32_t),
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                        VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                    VMA_MEMORY_USAGE_GPU_ONLY);
+    resources.readback = CreateBuffer(resources.groupCapacity * sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      VMA_MEMORY_USAGE_GPU_TO_CPU);
+    grown = true;
+  }
+
+  if (!grown) {
+    return;
+  }
+
+  // NOTE: binding order matches cull.comp
+  std::array<VkDescriptorBufferInfo, STORAGE_BUFFER_BINDINGS> bufferInfos{{
+      {resources.objects.buffer, 0, VK_WHOLE_SIZE},
+      {resources.groups.buffer, 0, VK_WHOLE_SIZE},
+      {resources.commands.buffer, 0, VK_WHOLE_SIZE},
+      {resources.counts.buffer, 0, VK_WHOLE_SIZE},
+  }};
+  std::array<VkWriteDescriptorSet, STORAGE_BUFFER_BINDINGS> writes{};
+  for (uint32_t i = 0; i < STORAGE_BUFFER_BINDINGS; i++) {
+    writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[i].dstSet = resources.descriptorSet;
+    writes[i].dstBinding = i;
+    writes[i].descriptorCount = 1;
+    writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[i].pBufferInfo = &bufferInfos[i];
+  }
+  vkUpdateDescriptorSets(LogicalDevice::GetLogicalDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0,
+                         nullptr);
+}
+
+CoffeeMaker::Renderer::GpuScene::ObjectData CoffeeMaker::Renderer::GpuScene::MakeObject(uint32_t group,
+                                                                                      const glm::mat4& transform,
+                                                                                      float radius) {
+  // NOTE: the sphere is culled in world space, scaled by the largest axis so it still bounds the mesh
+  float scale = std::max({glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])),
+                          glm::length(glm::vec3(transform[2]))});
+
+  ObjectData object{};
+  object.sphere = glm::vec4(glm::vec3(transform[3]), radius * scale);
+  object.group = group;
+  return object;
+}
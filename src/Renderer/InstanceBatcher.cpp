@@ -0,0 +1,109 @@
+#include "Renderer/InstanceBatcher.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+#include "Renderer/Vulkan/PipelineRegistry.hpp"
+
+void CoffeeMaker::Renderer::InstanceBatcher::Create(size_t framesInFlight) {
+  instanceBuffers.resize(framesInFlight);
+  capacities.resize(framesInFlight, 0);
+}
+
+void CoffeeMaker::Renderer::InstanceBatcher::Destroy() {
+  using namespace CoffeeMaker::Renderer::Vulkan;
+
+  for (auto& instanceBuffer : instanceBuffers) {
+    if (instanceBuffer.buffer != VK_NULL_HANDLE) {
+      DestroyBuffer(instanceBuffer);
+    }
+  }
+  instanceBuffers.clear();
+  capacities.clear();
+}
+
+void CoffeeMaker::Renderer::InstanceBatcher::Submit(const RenderObject& object) { objects.push_back(object); }
+
+void CoffeeMaker::Renderer::InstanceBatcher::Prepare(size_t frameIndex) {
+  using namespace CoffeeMaker::Renderer::Vulkan;
+
+  frame = frameIndex;
+  batches.clear();
+  instances.clear();
+
+  // NOTE: sorting brings every object sharing a mesh and material next to each other. By their ids, no two live
+  // objects share one and unlike addresses they order the same way on every run
+  std::sort(objects.begin(), objects.end(), [](const RenderObject& lhs, const RenderObject& rhs) {
+    return std::make_tuple(lhs.mesh->id.Value(), lhs.material->id.Value()) <
+           std::make_tuple(rhs.mesh->id.Value(), rhs.material->id.Value());
+  });
+
+  for (const RenderObject& object : objects) {
+    if (batches.empty() || batches.back().mesh != object.mesh || batches.back().material != object.material) {
+      batches.push_back(Batch{.mesh = object.mesh,
+                              .material = object.material,
+                              .firstInstance = static_cast<uint32_t>(instances.size()),
+                              .instanceCount = 0});
+    }
+    batches.back().instanceCount++;
+    instances.push_back(InstanceData{.model = object.transform});
+  }
+  objects.clear();
+
+  if (instances.empty()) {
+    return;
+  }
+
+  AllocatedBuffer& instanceBuffer = instanceBuffers[frame];
+  if (instances.size() > capacities[frame]) {
+    // NOTE: the frame slot's timeline value was reached, nothing is reading the old buffer anymore
+    if (instanceBuffer.buffer != VK_NULL_HANDLE) {
+      DestroyBuffer(instanceBuffer);
+    }
+    capacities[frame] = std::max(instances.size(), capacities[frame] * 2);
+    instanceBuffer = CreateBuffer(capacities[frame] * sizeof(InstanceData), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                  VMA_MEMORY_USAGE_CPU_TO_GPU);
+  }
+
+  MapMemory(instances.data(), instances.size() * sizeof(InstanceData), instanceBuffer.allocation);
+  FlushMemory(instanceBuffer.allocation, 0, instances.size() * sizeof(InstanceData));
+  UnmapMemory(instanceBuffer.allocation);
+}
+
+void CoffeeMaker::Renderer::InstanceBatcher::Draw(Vulkan::CommandEncoder& encoder, const glm::mat4& viewProjection,
+                                                  size_t begin, size_t end) const {
+  using PipelineRegistry = CoffeeMaker::Renderer::Vulkan::PipelineRegistry;
+  using Pipeline = CoffeeMaker::Renderer::Vulkan::Pipeline;
+
+  MeshPushConstants constants{};
+  constants.renderMatrix = viewProjection;
+
+  for (size_t i = begin; i < end && i < batches.size(); i++) {
+    const Batch& batch = batches[i];
+
+    // NOTE: the fallback pipeline has no instance binding, an instanced batch waits for its own pipeline
+    Pipeline* boundPipeline = PipelineRegistry::ResolveForDraw(batch.material->pipeline, false);
+    if (boundPipeline == nullptr) {
+      continue;
+    }
+
+    encoder.BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, boundPipeline->pPipeline);
+    encoder.SetRenderState(batch.material->renderState);
+    VkBuffer buffers[] = {batch.mesh->vertexBuffer.buffer, instanceBuffers[frame].buffer};
+    VkDeviceSize offsets[] = {0, 0};
+    encoder.BindVertexBuffers(0, 2, buffers, offsets);
+    encoder.PushConstants(boundPipeline->layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstants), &constants);
+
+    if (batch.mesh->indices.empty()) {
+      encoder.Draw(static_cast<uint32_t>(batch.mesh->vertices.size()), batch.instanceCount, 0, batch.firstInstance);
+    } else {
+      encoder.BindIndexBuffer(batch.mesh->indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT16);
+      encoder.DrawIndexed(static_cast<uint32_t>(batch.mesh->indices.size()), batch.instanceCount, 0, 0,
+                          batch.firstInstance);
+    }
+  }
+}
+
+size_t CoffeeMaker::Renderer::InstanceBatcher::BatchCount() const { return batches.size(); }
+
+size_t CoffeeMaker::Renderer::InstanceBatcher::InstanceCount() const { return instances.size(); }
@@ -1 +1,19 @@
 #include "Renderer/Material.hpp"
+
+CoffeeMaker::Renderer::IdPool CoffeeMaker::Renderer::Material::Ids{"material", Material::IdBits};
+
+const CoffeeMaker::Renderer::Vulkan::ShaderPermutation& CoffeeMaker::Renderer::MeshShaders() {
+  using ShaderFeatureBinding = CoffeeMaker::Renderer::Vulkan::ShaderFeatureBinding;
+
+  // NOTE: order matches the MeshShaderFeature bits
+  static const Vulkan::ShaderPermutation shaders{
+      "shaders/triangleMesh.vert",
+      "shaders/shader.frag",
+      {
+          {.name = "SHOW_NORMALS", .binding = ShaderFeatureBinding::Define, .stages = VK_SHADER_STAGE_VERTEX_BIT},
+          {.name = "GRAYSCALE", .binding = ShaderFeatureBinding::SpecializationConstant, .constantId = 0},
+          {.name = "INSTANCED", .binding = ShaderFeatureBinding::Define, .stages = VK_SHADER_STAGE_VERTEX_BIT},
+      }};
+
+  return shaders;
+}
@@ -0,0 +1,39 @@
+#include "Renderer/ObjectId.hpp"
+
+#include <SDL2/SDL.h>
+
+CoffeeMaker::Renderer::IdPool::IdPool(const char* name, uint32_t bits) : name(name), limit(1u << bits) {}
+
+uint32_t CoffeeMaker::Renderer::IdPool::Acquire() {
+  std::lock_guard<std::mutex> lock{mutex};
+
+  if (!released.empty()) {
+    uint32_t id = released.back();
+    released.pop_back();
+    return id;
+  }
+
+  if (next == limit) {
+    SDL_LogError(0, "More than %u %s objects alive, their ids no longer fit the draw sort key.", limit, name);
+    exit(19);
+  }
+
+  return next++;
+}
+
+void CoffeeMaker::Renderer::IdPool::Release(uint32_t id) {
+  std::lock_guard<std::mutex> lock{mutex};
+  released.push_back(id);
+}
+
+CoffeeMaker::Renderer::ObjectId::ObjectId(IdPool& pool) : pool(&pool), value(pool.Acquire()) {}
+
+CoffeeMaker::Renderer::ObjectId::ObjectId(const ObjectId& other) : pool(other.pool), value(other.pool->Acquire()) {}
+
+CoffeeMaker::Renderer::ObjectId& CoffeeMaker::Renderer::ObjectId::operator=(const ObjectId& other) {
+  // NOTE: assigning copies the object's state, not its identity, so the id stays
+  (void)other;
+  return *this;
+}
+
+CoffeeMaker::Renderer::ObjectId::~ObjectId() { pool->Release(value); }
@@ -0,0 +1,711 @@
+#include "Renderer/RenderGraph.hpp"
+
+#include <SDL2/SDL.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+#include "CpuProfiler.hpp"
+#include "Renderer/Vulkan/GpuProfiler.hpp"
+#include "Renderer/Vulkan/LogicalDevice.hpp"
+#include "Renderer/Vulkan/MemoryAllocator.hpp"
+#include "Renderer/Vulkan/PhysicalDevice.hpp"
+#include "Renderer/Vulkan/Synchronization.hpp"
+#include "Renderer/Vulkan/Synchronization2.hpp"
+#include "Renderer/Vulkan/Utilities.hpp"
+
+namespace {
+  struct AccessInfo {
+    VkPipelineStageFlags2 stages{VK_PIPELINE_STAGE_2_NONE};
+    VkAccessFlags2 access{VK_ACCESS_2_NONE};
+    VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+    bool write{false};
+    VkImageUsageFlags usage{0};
+  };
+
+  // NOTE: only bits that exist in the original flags, see Synchronization2
+  AccessInfo Info(CoffeeMaker::Renderer::ResourceAccess access) {
+    using ResourceAccess = CoffeeMaker::Renderer::ResourceAccess;
+
+    switch (access) {
+      case ResourceAccess::ColorAttachment:
+        return AccessInfo{VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                          VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT};
+      case ResourceAccess::DepthAttachment:
+        return AccessInfo{
+            VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+            VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, true, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT};
+      case ResourceAccess::DepthRead:
+        return AccessInfo{VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT |
+                              VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                          VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT,
+                          VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, false,
+                          VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT};
+      case ResourceAccess::FragmentSampled:
+        return AccessInfo{VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false, VK_IMAGE_USAGE_SAMPLED_BIT};
+      case ResourceAccess::ComputeSampled:
+        return AccessInfo{VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false, VK_IMAGE_USAGE_SAMPLED_BIT};
+      case ResourceAccess::ComputeStorageRead:
+        return AccessInfo{VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                          false, VK_IMAGE_USAGE_STORAGE_BIT};
+      case ResourceAccess::ComputeStorageWrite:
+        return AccessInfo{VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                          VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true,
+                          VK_IMAGE_USAGE_STORAGE_BIT};
+      case ResourceAccess::IndirectRead:
+        return AccessInfo{VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+                          VK_IMAGE_LAYOUT_GENERAL, false, 0};
+      case ResourceAccess::VertexRead:
+        return AccessInfo{VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT,
+                          VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                          false, 0};
+      case ResourceAccess::TransferRead:
+        return AccessInfo{VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false, VK_IMAGE_USAGE_TRANSFER_SRC_BIT};
+      case ResourceAccess::TransferWrite:
+        return AccessInfo{VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true, VK_IMAGE_USAGE_TRANSFER_DST_BIT};
+      case ResourceAccess::HostRead:
+        return AccessInfo{VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, false, 0};
+      case ResourceAccess::Present:
+        // NOTE: presentation waits on a semaphore, the barrier only has to change the layout
+        return AccessInfo{VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, false, 0};
+      default:
+        return AccessInfo{};
+    }
+  }
+}  // namespace
+
+CoffeeMaker::Renderer::RenderGraph::PassBuilder::PassBuilder(RenderGraph& renderGraph, uint32_t passIndex)
+    : graph(renderGraph), pass(passIndex) {}
+
+void CoffeeMaker::Renderer::RenderGraph::PassBuilder::Read(ResourceHandle resource, ResourceAccess access) {
+  Use(resource, access, false);
+}
+
+void CoffeeMaker::Renderer::RenderGraph::PassBuilder::Write(ResourceHandle resource, ResourceAccess access) {
+  Use(resource, access, true);
+}
+
+void CoffeeMaker::Renderer::RenderGraph::PassBuilder::SideEffects() { graph.passes[pass].sideEffects = true; }
+
+void CoffeeMaker::Renderer::RenderGraph::PassBuilder::Use(ResourceHandle resource, ResourceAccess access,
+                                                          bool write) {
+  if (!resource.Valid() || resource.index >= graph.resources.size()) {
+    SDL_LogError(0, "Render graph pass %s uses an unknown resource.", graph.passes[pass].name.c_str());
+    exit(14);
+  }
+
+  std::vector<Access>& accesses = graph.passes[pass].accesses;
+  auto existing = std::find_if(accesses.begin(), accesses.end(),
+                               [&](const Access& declared) { return declared.resource == resource.index; });
+  if (existing != accesses.end()) {
+    SDL_LogError(0, "Render graph pass %s declares %s twice.", graph.passes[pass].name.c_str(),
+                 graph.resources[resource.index].name.c_str());
+    exit(14);
+  }
+  accesses.push_back(Access{.resource = resource.index, .access = access, .write = write});
+}
+
+void CoffeeMaker::Renderer::RenderGraph::Destroy() {
+  RetireTransients();
+  DestroyRetired(true);
+  compiledSignature.clear();
+  passes.clear();
+  resources.clear();
+}
+
+void CoffeeMaker::Renderer::RenderGraph::BeginFrame() {
+  DestroyRetired(false);
+  passes.clear();
+  resources.clear();
+}
+
+CoffeeMaker::Renderer::RenderGraph::ResourceHandle CoffeeMaker::Renderer::RenderGraph::ImportImage(
+    const std::string& name, const ImportedImage& image) {
+  resources.push_back(Resource{.name = name,
+                               .imported = true,
+                               .isImage = true,
+                               .importedImage = image,
+                               .finalAccess = image.finalAccess});
+  return ResourceHandle{static_cast<uint32_t>(resources.size() - 1)};
+}
+
+CoffeeMaker::Renderer::RenderGraph::ResourceHandle CoffeeMaker::Renderer::RenderGraph::ImportBuffer(
+    const std::string& name, VkBuffer buffer, ResourceAccess finalAccess) {
+  resources.push_back(
+      Resource{.name = name, .imported = true, .isImage = false, .buffer = buffer, .finalAccess = finalAccess});
+  return ResourceHandle{static_cast<uint32_t>(resources.size() - 1)};
+}
+
+CoffeeMaker::Renderer::RenderGraph::ResourceHandle CoffeeMaker::Renderer::RenderGraph::CreateImage(
+    const std::string& name, const ImageDesc& desc) {
+  resources.push_back(Resource{.name = name, .imported = false, .isImage = true, .desc = desc});
+  return ResourceHandle{static_cast<uint32_t>(resources.size() - 1)};
+}
+
+void CoffeeMaker::Renderer::RenderGraph::AddPass(const std::string& name, const SetupFn& setup, ExecuteFn execute) {
+  passes.push_back(Pass{.name = name, .execute = std::move(execute)});
+  PassBuilder builder{*this, static_cast<uint32_t>(passes.size() - 1)};
+  setup(builder);
+}
+
+void CoffeeMaker::Renderer::RenderGraph::Compile() {
+  CPU_SCOPE("RenderGraph::Compile");
+  auto start = std::chrono::steady_clock::now();
+
+  std::string signature = Signature();
+  if (signature == compiledSignature) {
+    stats.cacheHits++;
+    return;
+  }
+
+  // NOTE: images of the last compile may still be in use by frames in flight
+  RetireTransients();
+  Cull();
+  AllocateTransients();
+  PlanBarriers();
+  compiledSignature = std::move(signature);
+
+  stats.passes = passes.size();
+  stats.culledPasses = static_cast<size_t>(std::count(culled.begin(), culled.end(), true));
+  stats.compiles++;
+  stats.compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void CoffeeMaker::Renderer::RenderGraph::Execute(VkCommandBuffer cmd) {
+  using Synchronization2 = CoffeeMaker::Renderer::Vulkan::Synchronization2;
+
+  CPU_SCOPE("RenderGraph::Execute");
+
+  stats.barriers = 0;
+  stats.barrierBatches = 0;
+
+  std::vector<VkImageMemoryBarrier2> imageBarriers{};
+  std::vector<VkBufferMemoryBarrier2> bufferBarriers{};
+  auto recordBarriers = [&](const std::vector<Barrier>& barriers) {
+    if (barriers.empty()) {
+      return;
+    }
+
+    imageBarriers.clear();
+    bufferBarriers.clear();
+    for (const Barrier& barrier : barriers) {
+      const Resource& resource = resources[barrier.resource];
+      if (resource.isImage) {
+        VkImageMemoryBarrier2 imageBarrier{};
+        imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        imageBarrier.srcStageMask = barrier.srcStages;
+        imageBarrier.srcAccessMask = barrier.srcAccess;
+        imageBarrier.dstStageMask = barrier.dstStages;
+        imageBarrier.dstAccessMask = barrier.dstAccess;
+        imageBarrier.oldLayout = barrier.oldLayout;
+        imageBarrier.newLayout = barrier.newLayout;
+        imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.image = Image(ResourceHandle{barrier.resource});
+        imageBarrier.subresourceRange.aspectMask =
+            resource.imported ? resource.importedImage.aspect : resource.desc.aspect;
+        imageBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+        imageBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+        imageBarriers.push_back(imageBarrier);
+      } else {
+        VkBufferMemoryBarrier2 bufferBarrier{};
+        bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+        bufferBarrier.srcStageMask = barrier.srcStages;
+        bufferBarrier.srcAccessMask = barrier.srcAccess;
+        bufferBarrier.dstStageMask = barrier.dstStages;
+        bufferBarrier.dstAccessMask = barrier.dstAccess;
+        bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarrier.buffer = resource.buffer;
+        bufferBarrier.offset = 0;
+        bufferBarrier.size = VK_WHOLE_SIZE;
+        bufferBarriers.push_back(bufferBarrier);
+      }
+    }
+
+    VkDependencyInfo dependency{};
+    dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependency.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+    dependency.pBufferMemoryBarriers = bufferBarriers.data();
+    dependency.imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size());
+    dependency.pImageMemoryBarriers = imageBarriers.data();
+    Synchronization2::PipelineBarrier(cmd, dependency);
+
+    stats.barriers += barriers.size();
+    stats.barrierBatches++;
+  };
+
+  for (const CompiledPass& compiledPass : compiled) {
+    recordBarriers(compiledPass.barriers);
+    // NOTE: timed after its barriers, a pass's time is its own work and not the wait on the previous one
+    GPU_SCOPE(cmd, passes[compiledPass.pass].name);
+    passes[compiledPass.pass].execute(cmd);
+  }
+  recordBarriers(finalBarriers);
+}
+
+VkImage CoffeeMaker::Renderer::RenderGraph::Image(ResourceHandle resource) const {
+  const Resource& declared = resources[resource.index];
+  return declared.imported ? declared.importedImage.image : transients[resource.index].image;
+}
+
+VkImageView CoffeeMaker::Renderer::RenderGraph::ImageView(ResourceHandle resource) const {
+  const Resource& declared = resources[resource.index];
+  return declared.imported ? declared.importedImage.view : transients[resource.index].view;
+}
+
+VkBuffer CoffeeMaker::Renderer::RenderGraph::Buffer(ResourceHandle resource) const {
+  return resources[resource.index].buffer;
+}
+
+const CoffeeMaker::Renderer::RenderGraph::Statistics& CoffeeMaker::Renderer::RenderGraph::Stats() const {
+  return stats;
+}
+
+std::string CoffeeMaker::Renderer::RenderGraph::Graphviz() const {
+  std::vector<size_t> barrierCounts(passes.size(), 0);
+  for (const CompiledPass& compiledPass : compiled) {
+    barrierCounts[compiledPass.pass] = compiledPass.barriers.size();
+  }
+
+  std::string dot = "digraph RenderGraph {\n  rankdir=LR;\n  node [fontname=\"Helvetica\"];\n";
+  for (size_t i = 0; i < resources.size(); i++) {
+    const Resource& resource = resources[i];
+    if (resource.imported) {
+      dot += fmt::format("  r{} [shape=ellipse, style=filled, fillcolor=lightblue, label=\"{}\\nimported {}\"];\n", i,
+                         resource.name, resource.isImage ? "image" : "buffer");
+    } else if (i < transients.size() && transients[i].image != VK_NULL_HANDLE) {
+      const TransientImage& transient = transients[i];
+      dot += fmt::format(
+          "  r{} [shape=ellipse, style=filled, fillcolor=lightyellow, label=\"{}\\n{}x{}\\n{} KiB in block {}\"];\n",
+          i, resource.name, resource.desc.extent.width, resource.desc.extent.height,
+          transient.requirements.size / 1024, transient.block);
+    } else {
+      dot += fmt::format("  r{} [shape=ellipse, style=dashed, label=\"{}\\nunused\"];\n", i, resource.name);
+    }
+  }
+
+  for (size_t i = 0; i < passes.size(); i++) {
+    const Pass& pass = passes[i];
+    bool wasCulled = i < culled.size() && culled[i];
+    if (wasCulled) {
+      dot += fmt::format("  p{} [shape=box, style=dashed, color=gray, fontcolor=gray, label=\"{}\\nculled\"];\n", i,
+                         pass.name);
+    } else {
+      dot += fmt::format("  p{} [shape=box, style=bold, label=\"{}\\n{} barriers\"];\n", i, pass.name,
+                         barrierCounts[i]);
+    }
+
+    for (const Access& access : pass.accesses) {
+      const char* style = wasCulled ? ", style=dashed, color=gray" : "";
+      if (access.write) {
+        dot += fmt::format("  p{} -> r{} [label=\"{}\"{}];\n", i, access.resource, AccessName(access.access), style);
+      } else {
+        dot += fmt::format("  r{} -> p{} [label=\"{}\"{}];\n", access.resource, i, AccessName(access.access), style);
+      }
+    }
+  }
+
+  dot += "}\n";
+  return dot;
+}
+
+bool CoffeeMaker::Renderer::RenderGraph::DumpGraphviz(const std::string& path) const {
+  std::ofstream file{path, std::ios::trunc};
+  if (!file) {
+    SDL_LogWarn(0, "Unable to write the render graph to %s", path.c_str());
+    return false;
+  }
+
+  file << Graphviz();
+  return static_cast<bool>(file);
+}
+
+const char* CoffeeMaker::Renderer::RenderGraph::AccessName(ResourceAccess access) {
+  switch (access) {
+    case ResourceAccess::ColorAttachment:
+      return "color attachment";
+    case ResourceAccess::DepthAttachment:
+      return "depth attachment";
+    case ResourceAccess::DepthRead:
+      return "depth read";
+    case ResourceAccess::FragmentSampled:
+      return "fragment sampled";
+    case ResourceAccess::ComputeSampled:
+      return "compute sampled";
+    case ResourceAccess::ComputeStorageRead:
+      return "compute storage read";
+    case ResourceAccess::ComputeStorageWrite:
+      return "compute storage write";
+    case ResourceAccess::IndirectRead:
+      return "indirect read";
+    case ResourceAccess::VertexRead:
+      return "vertex read";
+    case ResourceAccess::TransferRead:
+      return "transfer read";
+    case ResourceAccess::TransferWrite:
+      return "transfer write";
+    case ResourceAccess::HostRead:
+      return "host read";
+    case ResourceAccess::Present:
+      return "present";
+    default:
+      return "none";
+  }
+}
+
+std::string CoffeeMaker::Renderer::RenderGraph::Signature() const {
+  std::string signature{};
+  for (const Resource& resource : resources) {
+    signature += fmt::format("r {} {} {} {} {} {} {} {} {} {} {}\n", resource.name, resource.imported,
+                             resource.isImage, static_cast<int>(resource.desc.format), resource.desc.extent.width,
+                             resource.desc.extent.height, resource.desc.aspect, resource.desc.usage,
+                             static_cast<int>(resource.importedImage.previousAccess),
+                             static_cast<int>(resource.importedImage.previousLayout),
+                             static_cast<int>(resource.finalAccess));
+  }
+  for (const Pass& pass : passes) {
+    signature += fmt::format("p {} {}", pass.name, pass.sideEffects);
+    for (const Access& access : pass.accesses) {
+      signature += fmt::format(" {}:{}:{}", access.resource, static_cast<int>(access.access), access.write);
+    }
+    signature += "\n";
+  }
+  return signature;
+}
+
+void CoffeeMaker::Renderer::RenderGraph::Cull() {
+  // NOTE: a pass lives while something uses what it writes, imported resources are used outside of the graph
+  std::vector<size_t> passRefs(passes.size(), 0);
+  std::vector<size_t> resourceRefs(resources.size(), 0);
+  for (size_t i = 0; i < passes.size(); i++) {
+    for (const Access& access : passes[i].accesses) {
+      if (access.write) {
+        passRefs[i]++;
+      } else {
+        resourceRefs[access.resource]++;
+      }
+    }
+  }
+  for (size_t i = 0; i < resources.size(); i++) {
+    if (resources[i].imported) {
+      resourceRefs[i]++;
+    }
+  }
+
+  culled.assign(passes.size(), false);
+  std::vector<uint32_t> unused{};
+  auto cullPass = [&](size_t pass) {
+    culled[pass] = true;
+    for (const Access& access : passes[pass].accesses) {
+      if (!access.write && --resourceRefs[access.resource] == 0) {
+        unused.push_back(access.resource);
+      }
+    }
+  };
+
+  for (size_t i = 0; i < passes.size(); i++) {
+    if (passRefs[i] == 0 && !passes[i].sideEffects) {
+      cullPass(i);
+    }
+  }
+  for (size_t i = 0; i < resources.size(); i++) {
+    if (resourceRefs[i] == 0) {
+      unused.push_back(static_cast<uint32_t>(i));
+    }
+  }
+
+  while (!unused.empty()) {
+    uint32_t resource = unused.back();
+    unused.pop_back();
+    for (size_t i = 0; i < passes.size(); i++) {
+      if (culled[i] || passes[i].sideEffects) {
+        continue;
+      }
+      for (const Access& access : passes[i].accesses) {
+        if (access.write && access.resource == resource && --passRefs[i] == 0) {
+          cullPass(i);
+        }
+      }
+    }
+  }
+
+  compiled.clear();
+  for (size_t i = 0; i < passes.size(); i++) {
+    if (!culled[i]) {
+      compiled.push_back(CompiledPass{.pass = static_cast<uint32_t>(i)});
+    }
+  }
+}
+
+void CoffeeMaker::Renderer::RenderGraph::AllocateTransients() {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+  using MemoryAllocator = CoffeeMaker::Renderer::Vulkan::MemoryAllocator;
+  using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
+
+  transients.assign(resources.size(), TransientImage{});
+  std::vector<VkImageUsageFlags> usages(resources.size(), 0);
+  for (uint32_t i = 0; i < compiled.size(); i++) {
+    for (const Access& access : passes[compiled[i].pass].accesses) {
+      TransientImage& transient = transients[access.resource];
+      transient.first = std::min(transient.first, i);
+      transient.last = std::max(transient.last, i);
+      usages[access.resource] |= Info(access.access).usage;
+    }
+  }
+
+  VkDevice device = LogicalDevice::GetLogicalDevice();
+  std::vector<uint32_t> order{};
+  for (uint32_t i = 0; i < resources.size(); i++) {
+    const Resource& resource = resources[i];
+    TransientImage& transient = transients[i];
+    if (resource.imported || !resource.isImage || transient.first == UINT32_MAX) {
+      continue;
+    }
+
+    VkImageCreateInfo imageInfo = Vulkan::CreateImageInfo(
+        resource.desc.format, usages[i] | resource.desc.usage,
+        VkExtent3D{.width = resource.desc.extent.width, .height = resource.desc.extent.height, .depth = 1});
+    VkResult result = vkCreateImage(device, &imageInfo, nullptr, &transient.image);
+    if (result != VK_SUCCESS) {
+      SDL_LogError(0, "Unable to create render graph image %s.\nVulkan Error Code: [%d]", resource.name.c_str(),
+                   result);
+      exit(14);
+    }
+    vkGetImageMemoryRequirements(device, transient.image, &transient.requirements);
+    order.push_back(i);
+  }
+
+  // NOTE: largest first, each image goes into the first block whose other images are dead while it is alive
+  std::sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+    return transients[lhs].requirements.size > transients[rhs].requirements.size;
+  });
+
+  std::vector<VkMemoryRequirements> blockRequirements{};
+  std::vector<std::vector<uint32_t>> blockImages{};
+  for (uint32_t index : order) {
+    TransientImage& transient = transients[index];
+    for (uint32_t block = 0; block < blockRequirements.size() && transient.block == UINT32_MAX; block++) {
+      if ((blockRequirements[block].memoryTypeBits & transient.requirements.memoryTypeBits) == 0) {
+        continue;
+      }
+      bool overlaps = std::any_of(blockImages[block].begin(), blockImages[block].end(), [&](uint32_t other) {
+        return transients[other].first <= transient.last && transient.first <= transients[other].last;
+      });
+      if (!overlaps) {
+        transient.block = block;
+      }
+    }
+
+    if (transient.block == UINT32_MAX) {
+      transient.block = static_cast<uint32_t>(blockRequirements.size());
+      blockRequirements.push_back(VkMemoryRequirements{.size = 0, .alignment = 1, .memoryTypeBits = ~0u});
+      blockImages.emplace_back();
+    }
+
+    VkMemoryRequirements& requirements = blockRequirements[transient.block];
+    requirements.size = std::max(requirements.size, transient.requirements.size);
+    requirements.alignment = std::max(requirements.alignment, transient.requirements.alignment);
+    requirements.memoryTypeBits &= transient.requirements.memoryTypeBits;
+    blockImages[transient.block].push_back(index);
+  }
+
+  stats.transientImages = order.size();
+  stats.transientBytes = 0;
+  stats.allocatedBytes = 0;
+  for (uint32_t index : order) {
+    stats.transientBytes += transients[index].requirements.size;
+  }
+
+  bool lazyMemory = PhysicalDevice::GetPhysicalDeviceInUse()->SupportsLazilyAllocatedMemory();
+  blocks.assign(blockRequirements.size(), VK_NULL_HANDLE);
+  for (size_t block = 0; block < blockRequirements.size(); block++) {
+    // NOTE: a block only holding attachments that never reach memory can stay on-chip on tile-based GPUs
+    bool lazy = lazyMemory && std::all_of(blockImages[block].begin(), blockImages[block].end(), [&](uint32_t index) {
+      return (resources[index].desc.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) != 0;
+    });
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = lazy ? VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED : VMA_MEMORY_USAGE_GPU_ONLY;
+    allocInfo.requiredFlags = lazy ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+    VkResult result = vmaAllocateMemory(MemoryAllocator::GetAllocator(), &blockRequirements[block], &allocInfo,
+                                        &blocks[block], nullptr);
+    if (result != VK_SUCCESS) {
+      SDL_LogError(0, "Unable to allocate render graph memory.\nVulkan Error Code: [%d]", result);
+      exit(14);
+    }
+    stats.allocatedBytes += blockRequirements[block].size;
+
+    for (uint32_t index : blockImages[block]) {
+      TransientImage& transient = transients[index];
+      vmaBindImageMemory(MemoryAllocator::GetAllocator(), blocks[block], transient.image);
+
+      const Resource& resource = resources[index];
+      VkImageViewCreateInfo viewInfo =
+          Vulkan::CreateImageViewInfo(resource.desc.format, transient.image, resource.desc.aspect);
+      result = vkCreateImageView(device, &viewInfo, nullptr, &transient.view);
+      if (result != VK_SUCCESS) {
+        SDL_LogError(0, "Unable to create render graph image view %s.\nVulkan Error Code: [%d]",
+                     resource.name.c_str(), result);
+        exit(14);
+      }
+    }
+  }
+}
+
+void CoffeeMaker::Renderer::RenderGraph::PlanBarriers() {
+  struct State {
+    VkPipelineStageFlags2 writeStages{VK_PIPELINE_STAGE_2_NONE};
+    VkAccessFlags2 writeAccess{VK_ACCESS_2_NONE};
+    VkPipelineStageFlags2 readStages{VK_PIPELINE_STAGE_2_NONE};
+    VkAccessFlags2 readAccess{VK_ACCESS_2_NONE};
+    VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+    bool touched{false};
+  };
+
+  struct BlockState {
+    VkPipelineStageFlags2 stages{VK_PIPELINE_STAGE_2_NONE};
+    VkAccessFlags2 access{VK_ACCESS_2_NONE};
+  };
+
+  // NOTE: the barrier from last to next state, or false when the next access needs none
+  auto transition = [](State& state, const AccessInfo& info, bool isImage, Barrier& barrier) {
+    bool layoutChange = isImage && state.layout != info.layout;
+    barrier.oldLayout = isImage ? state.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = isImage ? info.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.dstStages = info.stages;
+    barrier.dstAccess = info.access;
+
+    bool needed = false;
+    if (info.write || layoutChange) {
+      // NOTE: writes and layout transitions wait for every earlier use, later reads chain off this barrier
+      barrier.srcStages = state.writeStages | state.readStages;
+      barrier.srcAccess = state.writeAccess;
+      needed = barrier.srcStages != VK_PIPELINE_STAGE_2_NONE || layoutChange;
+      state.writeStages = info.stages;
+      state.writeAccess = info.write ? info.access : VK_ACCESS_2_NONE;
+      state.readStages = info.write ? VK_PIPELINE_STAGE_2_NONE : info.stages;
+      state.readAccess = info.write ? VK_ACCESS_2_NONE : info.access;
+      state.layout = isImage ? info.layout : state.layout;
+    } else {
+      // NOTE: reads after reads only wait when the earlier barrier did not already cover this stage and access
+      bool covered = (state.readStages & info.stages) == info.stages && (state.readAccess & info.access) == info.access;
+      barrier.srcStages = state.writeStages;
+      barrier.srcAccess = state.writeAccess;
+      needed = !covered && state.writeStages != VK_PIPELINE_STAGE_2_NONE;
+      state.readStages |= info.stages;
+      state.readAccess |= info.access;
+    }
+    return needed;
+  };
+
+  size_t blockCount = 0;
+  for (const TransientImage& transient : transients) {
+    if (transient.block != UINT32_MAX) {
+      blockCount = std::max<size_t>(blockCount, transient.block + 1);
+    }
+  }
+
+  // NOTE: the first image in a block waits on the last one of the previous frame, which ends the same way as this
+  // one, so a second round starts every block from the state the first round left it in
+  std::vector<BlockState> blockStates(blockCount);
+  int rounds = blockCount > 0 ? 2 : 1;
+  for (int round = 0; round < rounds; round++) {
+    std::vector<State> states(resources.size());
+    for (size_t i = 0; i < resources.size(); i++) {
+      const Resource& resource = resources[i];
+      if (!resource.imported) {
+        continue;
+      }
+      AccessInfo previous = Info(resource.importedImage.previousAccess);
+      states[i].writeStages = previous.stages;
+      states[i].writeAccess = previous.write ? previous.access : VK_ACCESS_2_NONE;
+      states[i].layout = resource.importedImage.previousLayout;
+    }
+
+    finalBarriers.clear();
+    for (CompiledPass& compiledPass : compiled) {
+      compiledPass.barriers.clear();
+      for (const Access& access : passes[compiledPass.pass].accesses) {
+        const Resource& resource = resources[access.resource];
+        State& state = states[access.resource];
+        uint32_t block = resource.imported ? UINT32_MAX : transients[access.resource].block;
+        if (block != UINT32_MAX && !state.touched) {
+          // NOTE: the memory was used by another image, its contents are discarded
+          state.writeStages = blockStates[block].stages;
+          state.writeAccess = blockStates[block].access;
+          state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        }
+        state.touched = true;
+
+        Barrier barrier{.resource = access.resource};
+        if (transition(state, Info(access.access), resource.isImage, barrier)) {
+          compiledPass.barriers.push_back(barrier);
+        }
+        if (block != UINT32_MAX) {
+          blockStates[block] = BlockState{.stages = state.writeStages | state.readStages, .access = state.writeAccess};
+        }
+      }
+    }
+
+    for (size_t i = 0; i < resources.size(); i++) {
+      const Resource& resource = resources[i];
+      if (!resource.imported || resource.finalAccess == ResourceAccess::None) {
+        continue;
+      }
+      Barrier barrier{.resource = static_cast<uint32_t>(i)};
+      if (transition(states[i], Info(resource.finalAccess), resource.isImage, barrier)) {
+        finalBarriers.push_back(barrier);
+      }
+    }
+  }
+}
+
+void CoffeeMaker::Renderer::RenderGraph::RetireTransients() {
+  using Synchronization = CoffeeMaker::Renderer::Vulkan::Synchronization;
+
+  if (transients.empty() && blocks.empty()) {
+    return;
+  }
+
+  // NOTE: the frame being recorded may still use them, whether it compiles before or after recording
+  retired.push_back(Retired{
+      .value = Synchronization::PendingValue(), .transients = std::move(transients), .blocks = std::move(blocks)});
+  transients.clear();
+  blocks.clear();
+}
+
+void CoffeeMaker::Renderer::RenderGraph::DestroyRetired(bool all) {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+  using MemoryAllocator = CoffeeMaker::Renderer::Vulkan::MemoryAllocator;
+  using Synchronization = CoffeeMaker::Renderer::Vulkan::Synchronization;
+
+  // NOTE: everything goes when destroying, the timeline may already be gone by then
+  uint64_t completed = all ? 0 : Synchronization::CompletedValue();
+  auto expired = [&](const Retired& entry) { return all || entry.value <= completed; };
+  for (Retired& entry : retired) {
+    if (!expired(entry)) {
+      continue;
+    }
+    for (TransientImage& transient : entry.transients) {
+      if (transient.view != VK_NULL_HANDLE) {
+        vkDestroyImageView(LogicalDevice::GetLogicalDevice(), transient.view, nullptr);
+      }
+      if (transient.image != VK_NULL_HANDLE) {
+        vkDestroyImage(LogicalDevice::GetLogicalDevice(), transient.image, nullptr);
+      }
+    }
+    for (VmaAllocation block : entry.blocks) {
+      vmaFreeMemory(MemoryAllocator::GetAllocator(), block);
+    }
+  }
+  retired.erase(std::remove_if(retired.begin(), retired.end(), expired), retired.end());
+}
@@ -5,6 +5,8 @@
 #include <tiny_obj_loader.h>
 #include <vulkan/vulkan.h>
 
+CoffeeMaker::Renderer::IdPool CoffeeMaker::Renderer::Mesh::Ids{"mesh", Mesh::IdBits};
+
 CoffeeMaker::Renderer::Vulkan::VertexInputDescription CoffeeMaker::Renderer::Vertex::Description() {
   CoffeeMaker::Renderer::Vulkan::VertexInputDescription desc;
 
@@ -42,6 +44,29 @@ CoffeeMaker::Renderer::Vulkan::VertexInputDescription CoffeeMaker::Renderer::Ver
   return desc;
 }
 
+CoffeeMaker::Renderer::Vulkan::VertexInputDescription CoffeeMaker::Renderer::Vertex::InstancedDescription() {
+  CoffeeMaker::Renderer::Vulkan::VertexInputDescription desc = Description();
+
+  VkVertexInputBindingDescription instanceBinding{};
+  instanceBinding.binding = 1;
+  instanceBinding.stride = sizeof(InstanceData);
+  instanceBinding.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+  desc.bindings.push_back(instanceBinding);
+
+  // Model matrix at locations 3 - 6, a mat4 input takes one location per column
+  for (uint32_t column = 0; column < 4; column++) {
+    VkVertexInputAttributeDescription modelAttribute{};
+    modelAttribute.binding = 1;
+    modelAttribute.location = 3 + column;
+    modelAttribute.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    modelAttribute.offset = offsetof(InstanceData, model) + column * sizeof(glm::vec4);
+    desc.attributes.push_back(modelAttribute);
+  }
+
+  return desc;
+}
+
 void CoffeeMaker::Renderer::Mesh::LoadObj(const std::string& filename) {
   std::string fullFilePath = fmt::format("{}{}", SDL_GetBasePath(), filename);
   tinyobj::attrib_t vertexAttributes;
@@ -0,0 +1,221 @@
+#include "Renderer/Vulkan/CommandEncoder.hpp"
+
+#include <cstring>
+
+#include "Renderer/Vulkan/DynamicState.hpp"
+#include "Renderer/Vulkan/IndirectDraw.hpp"
+
+std::array<std::atomic<size_t>, CoffeeMaker::Renderer::Vulkan::CommandEncoder::CALL_COUNT>
+    CoffeeMaker::Renderer::Vulkan::CommandEncoder::gIssued{};
+std::array<std::atomic<size_t>, CoffeeMaker::Renderer::Vulkan::CommandEncoder::CALL_COUNT>
+    CoffeeMaker::Renderer::Vulkan::CommandEncoder::gElided{};
+std::array<size_t, CoffeeMaker::Renderer::Vulkan::CommandEncoder::CALL_COUNT>
+    CoffeeMaker::Renderer::Vulkan::CommandEncoder::LastIssued{};
+std::array<size_t, CoffeeMaker::Renderer::Vulkan::CommandEncoder::CALL_COUNT>
+    CoffeeMaker::Renderer::Vulkan::CommandEncoder::LastElided{};
+std::array<std::atomic<size_t>, CoffeeMaker::Renderer::Vulkan::CommandEncoder::COUNTER_COUNT>
+    CoffeeMaker::Renderer::Vulkan::CommandEncoder::gCounters{};
+std::array<size_t, CoffeeMaker::Renderer::Vulkan::CommandEncoder::COUNTER_COUNT>
+    CoffeeMaker::Renderer::Vulkan::CommandEncoder::LastCounters{};
+
+CoffeeMaker::Renderer::Vulkan::CommandEncoder::CommandEncoder(VkCommandBuffer commandBuffer) : cmd(commandBuffer) {}
+
+CoffeeMaker::Renderer::Vulkan::CommandEncoder::~CommandEncoder() {
+  // NOTE: counted locally and added once, recording threads would otherwise contend on every call
+  for (size_t i = 0; i < CALL_COUNT; i++) {
+    gIssued[i].fetch_add(issued[i], std::memory_order_relaxed);
+    gElided[i].fetch_add(elided[i], std::memory_order_relaxed);
+  }
+  for (size_t i = 0; i < COUNTER_COUNT; i++) {
+    gCounters[i].fetch_add(counters[i], std::memory_order_relaxed);
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::CommandEncoder::BindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline) {
+  BindPointState& state = State(bindPoint);
+  if (!Issue(EncodedCall::Pipeline, state.pipeline == pipeline)) {
+    return;
+  }
+
+  vkCmdBindPipeline(cmd, bindPoint, pipeline);
+  state.pipeline = pipeline;
+  // NOTE: every graphics pipeline lists the same dynamic states, so dynamic state survives the bind. Bound sets
+  // and push constants are tracked against the layout they were recorded with and need no reset either.
+}
+
+void CoffeeMaker::Renderer::Vulkan::CommandEncoder::BindVertexBuffers(uint32_t firstBinding, uint32_t bindingCount,
+                                                                      const VkBuffer* buffers,
+                                                                      const VkDeviceSize* offsets) {
+  bool tracked = firstBinding + bindingCount <= MAX_VERTEX_BINDINGS;
+  bool redundant = tracked;
+  for (uint32_t i = 0; redundant && i < bindingCount; i++) {
+    redundant = vertexBuffers[firstBinding + i] == buffers[i] && vertexOffsets[firstBinding + i] == offsets[i];
+  }
+  if (!Issue(EncodedCall::VertexBuffers, redundant)) {
+    return;
+  }
+
+  vkCmdBindVertexBuffers(cmd, firstBinding, bindingCount, buffers, offsets);
+  for (uint32_t i = 0; tracked && i < bindingCount; i++) {
+    vertexBuffers[firstBinding + i] = buffers[i];
+    vertexOffsets[firstBinding + i] = offsets[i];
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::CommandEncoder::BindIndexBuffer(VkBuffer buffer, VkDeviceSize offset,
+                                                                    VkIndexType type) {
+  bool redundant = indexBuffer == buffer && indexOffset == offset && indexType == type;
+  if (!Issue(EncodedCall::IndexBuffer, redundant)) {
+    return;
+  }
+
+  vkCmdBindIndexBuffer(cmd, buffer, offset, type);
+  indexBuffer = buffer;
+  indexOffset = offset;
+  indexType = type;
+}
+
+void CoffeeMaker::Renderer::Vulkan::CommandEncoder::BindDescriptorSets(VkPipelineBindPoint bindPoint,
+                                                                       VkPipelineLayout layout, uint32_t firstSet,
+                                                                       uint32_t setCount, const VkDescriptorSet* sets,
+                                                                       uint32_t dynamicOffsetCount,
+                                                                       const uint32_t* dynamicOffsets) {
+  BindPointState& state = State(bindPoint);
+  bool tracked = firstSet + setCount <= MAX_DESCRIPTOR_SETS;
+  // NOTE: dynamic offsets change what the shader reads without changing the set, those binds are always recorded
+  bool redundant = tracked && dynamicOffsetCount == 0 && state.setLayout == layout;
+  for (uint32_t i = 0; redundant && i < setCount; i++) {
+    redundant = state.sets[firstSet + i] == sets[i];
+  }
+  if (!Issue(EncodedCall::DescriptorSets, redundant)) {
+    return;
+  }
+
+  vkCmdBindDescriptorSets(cmd, bindPoint, layout, firstSet, setCount, sets, dynamicOffsetCount, dynamicOffsets);
+  if (state.setLayout != layout || !tracked || dynamicOffsetCount > 0) {
+    state.sets.fill(VK_NULL_HANDLE);
+  }
+  state.setLayout = layout;
+  for (uint32_t i = 0; tracked && dynamicOffsetCount == 0 && i < setCount; i++) {
+    state.sets[firstSet + i] = sets[i];
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::CommandEncoder::SetRenderState(const RenderState& state) {
+  if (!DynamicState::ExtendedDynamicState) {
+    // NOTE: baked into the pipelines, nothing is recorded either way
+    return;
+  }
+  if (!Issue(EncodedCall::DynamicState, hasRenderState && renderState == state)) {
+    return;
+  }
+
+  DynamicState::SetRenderState(cmd, state);
+  renderState = state;
+  hasRenderState = true;
+}
+
+void CoffeeMaker::Renderer::Vulkan::CommandEncoder::PushConstants(VkPipelineLayout layout, VkShaderStageFlags stages,
+                                                                  uint32_t offset, uint32_t size, const void* data) {
+  bool tracked = size <= MAX_PUSH_CONSTANT_BYTES;
+  bool redundant = tracked && pushLayout == layout && pushStages == stages && pushOffset == offset &&
+                   pushSize == size && std::memcmp(pushData.data(), data, size) == 0;
+  if (!Issue(EncodedCall::PushConstants, redundant)) {
+    return;
+  }
+
+  vkCmdPushConstants(cmd, layout, stages, offset, size, data);
+  Count(EncodedCounter::PushConstantBytes, size);
+  pushLayout = tracked ? layout : VK_NULL_HANDLE;
+  pushStages = stages;
+  pushOffset = offset;
+  pushSize = size;
+  if (tracked) {
+    std::memcpy(pushData.data(), data, size);
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::CommandEncoder::Draw(uint32_t vertexCount, uint32_t instanceCount,
+                                                         uint32_t firstVertex, uint32_t firstInstance) {
+  vkCmdDraw(cmd, vertexCount, instanceCount, firstVertex, firstInstance);
+  Count(EncodedCounter::DrawCalls, 1);
+  Count(EncodedCounter::Instances, instanceCount);
+  Count(EncodedCounter::Triangles, static_cast<size_t>(vertexCount / 3) * instanceCount);
+}
+
+void CoffeeMaker::Renderer::Vulkan::CommandEncoder::DrawIndexed(uint32_t indexCount, uint32_t instanceCount,
+                                                                uint32_t firstIndex, int32_t vertexOffset,
+                                                                uint32_t firstInstance) {
+  vkCmdDrawIndexed(cmd, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+  Count(EncodedCounter::DrawCalls, 1);
+  Count(EncodedCounter::Instances, instanceCount);
+  Count(EncodedCounter::Triangles, static_cast<size_t>(indexCount / 3) * instanceCount);
+}
+
+void CoffeeMaker::Renderer::Vulkan::CommandEncoder::DrawIndexedIndirectCount(VkBuffer buffer, VkDeviceSize offset,
+                                                                             VkBuffer countBuffer,
+                                                                             VkDeviceSize countOffset,
+                                                                             uint32_t maxDrawCount, uint32_t stride,
+                                                                             uint32_t indexCount) {
+  using IndirectDraw = CoffeeMaker::Renderer::Vulkan::IndirectDraw;
+
+  IndirectDraw::DrawIndexedIndirectCount(cmd, buffer, offset, countBuffer, countOffset, maxDrawCount, stride);
+  // NOTE: one call from the CPU's side, the commands it expands to are counted as instances
+  Count(EncodedCounter::DrawCalls, 1);
+  Count(EncodedCounter::Instances, maxDrawCount);
+  Count(EncodedCounter::IndirectTriangles, static_cast<size_t>(indexCount / 3) * maxDrawCount);
+}
+
+VkCommandBuffer CoffeeMaker::Renderer::Vulkan::CommandEncoder::Buffer() const { return cmd; }
+
+void CoffeeMaker::Renderer::Vulkan::CommandEncoder::EndFrame() {
+  for (size_t i = 0; i < CALL_COUNT; i++) {
+    LastIssued[i] = gIssued[i].exchange(0, std::memory_order_relaxed);
+    LastElided[i] = gElided[i].exchange(0, std::memory_order_relaxed);
+  }
+  for (size_t i = 0; i < COUNTER_COUNT; i++) {
+    LastCounters[i] = gCounters[i].exchange(0, std::memory_order_relaxed);
+  }
+}
+
+const char* CoffeeMaker::Renderer::Vulkan::CommandEncoder::CallName(EncodedCall call) {
+  switch (call) {
+    case EncodedCall::Pipeline:
+      return "Bind Pipeline";
+    case EncodedCall::VertexBuffers:
+      return "Bind Vertex Buffers";
+    case EncodedCall::IndexBuffer:
+      return "Bind Index Buffer";
+    case EncodedCall::DescriptorSets:
+      return "Bind Descriptor Sets";
+    case EncodedCall::DynamicState:
+      return "Dynamic State";
+    case EncodedCall::PushConstants:
+      return "Push Constants";
+    default:
+      return "Unknown";
+  }
+}
+
+size_t CoffeeMaker::Renderer::Vulkan::CommandEncoder::LastCounter(EncodedCounter counter) {
+  return LastCounters[static_cast<size_t>(counter)];
+}
+
+bool CoffeeMaker::Renderer::Vulkan::CommandEncoder::Issue(EncodedCall call, bool redundant) {
+  size_t index = static_cast<size_t>(call);
+  if (redundant) {
+    elided[index]++;
+    return false;
+  }
+  issued[index]++;
+  return true;
+}
+
+CoffeeMaker::Renderer::Vulkan::CommandEncoder::BindPointState& CoffeeMaker::Renderer::Vulkan::CommandEncoder::State(
+    VkPipelineBindPoint bindPoint) {
+  return bindPoint == VK_PIPELINE_BIND_POINT_COMPUTE ? compute : graphics;
+}
+
+void CoffeeMaker::Renderer::Vulkan::CommandEncoder::Count(EncodedCounter counter, size_t amount) {
+  counters[static_cast<size_t>(counter)] += amount;
+}
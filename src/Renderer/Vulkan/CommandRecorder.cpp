@@ -0,0 +1,197 @@
+#include "Renderer/Vulkan/CommandRecorder.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#include "CpuProfiler.hpp"
+#include "Renderer/Vulkan/Commands.hpp"
+#include "Renderer/Vulkan/DynamicRendering.hpp"
+#include "Renderer/Vulkan/FrameContext.hpp"
+#include "Renderer/Vulkan/FrameCounters.hpp"
+
+std::vector<std::thread> CoffeeMaker::Renderer::Vulkan::CommandRecorder::gWorkers{};
+std::mutex CoffeeMaker::Renderer::Vulkan::CommandRecorder::gMutex{};
+std::condition_variable CoffeeMaker::Renderer::Vulkan::CommandRecorder::gCondition{};
+std::condition_variable CoffeeMaker::Renderer::Vulkan::CommandRecorder::gIdleCondition{};
+bool CoffeeMaker::Renderer::Vulkan::CommandRecorder::gStopping{false};
+bool CoffeeMaker::Renderer::Vulkan::CommandRecorder::Enabled{true};
+const size_t CoffeeMaker::Renderer::Vulkan::CommandRecorder::MinItemsPerChunk{512};
+size_t CoffeeMaker::Renderer::Vulkan::CommandRecorder::LastChunkCount{0};
+double CoffeeMaker::Renderer::Vulkan::CommandRecorder::LastRecordMs{0.0};
+std::deque<CoffeeMaker::Renderer::Vulkan::CommandRecorder::Chunk>
+    CoffeeMaker::Renderer::Vulkan::CommandRecorder::gQueue{};
+const CoffeeMaker::Renderer::Vulkan::CommandRecorder::RecordFunction*
+    CoffeeMaker::Renderer::Vulkan::CommandRecorder::gRecord{nullptr};
+size_t CoffeeMaker::Renderer::Vulkan::CommandRecorder::gRemaining{0};
+VkCommandBufferInheritanceInfo CoffeeMaker::Renderer::Vulkan::CommandRecorder::gInheritance{};
+VkCommandBufferInheritanceRenderingInfo CoffeeMaker::Renderer::Vulkan::CommandRecorder::gRenderingInheritance{};
+VkExtent2D CoffeeMaker::Renderer::Vulkan::CommandRecorder::gExtent{};
+
+void CoffeeMaker::Renderer::Vulkan::CommandRecorder::Start(size_t threadCount) {
+  if (!gWorkers.empty()) {
+    return;
+  }
+
+  if (threadCount == 0) {
+    // NOTE: the render thread records chunks too, so it does not need a core of its own
+    size_t hardwareThreads = std::thread::hardware_concurrency();
+    threadCount = std::clamp<size_t>(hardwareThreads > 1 ? hardwareThreads - 1 : 0, 0, 8);
+  }
+
+  gStopping = false;
+  for (size_t i = 0; i < threadCount; i++) {
+    gWorkers.emplace_back(WorkerLoop, i);
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::CommandRecorder::Stop() {
+  {
+    std::lock_guard<std::mutex> lock{gMutex};
+    gStopping = true;
+  }
+  gCondition.notify_all();
+
+  for (auto& worker : gWorkers) {
+    worker.join();
+  }
+  gWorkers.clear();
+  gStopping = false;
+}
+
+size_t CoffeeMaker::Renderer::Vulkan::CommandRecorder::ThreadSlots() { return gWorkers.size() + 1; }
+
+void CoffeeMaker::Renderer::Vulkan::CommandRecorder::SetTarget(VkRenderPass renderPass, VkFramebuffer framebuffer,
+                                                               VkExtent2D extent) {
+  using FrameCounters = CoffeeMaker::Renderer::Vulkan::FrameCounters;
+
+  gInheritance = {};
+  gInheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  gInheritance.renderPass = renderPass;
+  gInheritance.subpass = 0;
+  gInheritance.framebuffer = framebuffer;
+  gInheritance.pipelineStatistics = FrameCounters::InheritedStatistics();
+  gExtent = extent;
+}
+
+void CoffeeMaker::Renderer::Vulkan::CommandRecorder::SetRenderingTarget(VkExtent2D extent, bool withDepth) {
+  using DynamicRendering = CoffeeMaker::Renderer::Vulkan::DynamicRendering;
+  using FrameCounters = CoffeeMaker::Renderer::Vulkan::FrameCounters;
+
+  gRenderingInheritance = DynamicRendering::InheritanceRenderingInfo(withDepth);
+  gInheritance = {};
+  gInheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  gInheritance.pNext = &gRenderingInheritance;
+  gInheritance.renderPass = VK_NULL_HANDLE;
+  gInheritance.subpass = 0;
+  gInheritance.framebuffer = VK_NULL_HANDLE;
+  gInheritance.pipelineStatistics = FrameCounters::InheritedStatistics();
+  gExtent = extent;
+}
+
+void CoffeeMaker::Renderer::Vulkan::CommandRecorder::Record(VkCommandBuffer primary, size_t count,
+                                                            const RecordFunction& record) {
+  if (count == 0) {
+    return;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  size_t renderSlot = gWorkers.size();
+  size_t chunkCount = 1;
+  if (Enabled && !gWorkers.empty()) {
+    chunkCount = std::clamp<size_t>((count + MinItemsPerChunk - 1) / MinItemsPerChunk, 1, gWorkers.size() + 1);
+  }
+
+  std::vector<VkCommandBuffer> buffers(chunkCount, VK_NULL_HANDLE);
+  if (chunkCount == 1) {
+    gRecord = &record;
+    RecordChunk(renderSlot, Chunk{.begin = 0, .end = count, .result = &buffers[0]});
+  } else {
+    size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+    {
+      std::lock_guard<std::mutex> lock{gMutex};
+      gRecord = &record;
+      for (size_t i = 0; i < chunkCount; i++) {
+        gQueue.push_back(
+            Chunk{.begin = i * chunkSize, .end = std::min(count, (i + 1) * chunkSize), .result = &buffers[i]});
+      }
+      gRemaining = chunkCount;
+    }
+    gCondition.notify_all();
+
+    // NOTE: the render thread takes chunks as well instead of sitting idle until the workers are done
+    std::unique_lock<std::mutex> lock{gMutex};
+    while (!gQueue.empty()) {
+      Chunk chunk = gQueue.front();
+      gQueue.pop_front();
+      lock.unlock();
+      RecordChunk(renderSlot, chunk);
+      lock.lock();
+      gRemaining--;
+    }
+    gIdleCondition.wait(lock, [] { return gRemaining == 0; });
+  }
+  gRecord = nullptr;
+
+  // NOTE: chunks are contiguous, executing them in order keeps the draw order of the list
+  vkCmdExecuteCommands(primary, static_cast<uint32_t>(buffers.size()), buffers.data());
+
+  LastChunkCount = chunkCount;
+  LastRecordMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+VkCommandBuffer CoffeeMaker::Renderer::Vulkan::CommandRecorder::BeginSecondary() { return Allocate(gWorkers.size()); }
+
+void CoffeeMaker::Renderer::Vulkan::CommandRecorder::WorkerLoop(size_t slot) {
+#ifdef COFFEEMAKER_PROFILING
+  CoffeeMaker::CpuProfiler::SetThreadName("Recorder " + std::to_string(slot));
+#endif
+  while (true) {
+    Chunk chunk{};
+    {
+      std::unique_lock<std::mutex> lock{gMutex};
+      gCondition.wait(lock, [] { return gStopping || !gQueue.empty(); });
+      if (gStopping) {
+        return;
+      }
+      chunk = gQueue.front();
+      gQueue.pop_front();
+    }
+
+    RecordChunk(slot, chunk);
+
+    {
+      std::lock_guard<std::mutex> lock{gMutex};
+      gRemaining--;
+    }
+    gIdleCondition.notify_one();
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::CommandRecorder::RecordChunk(size_t slot, const Chunk& chunk) {
+  CPU_SCOPE("CommandRecorder::RecordChunk");
+  VkCommandBuffer cmd = Allocate(slot);
+  (*gRecord)(cmd, chunk.begin, chunk.end);
+  vkEndCommandBuffer(cmd);
+  *chunk.result = cmd;
+}
+
+VkCommandBuffer CoffeeMaker::Renderer::Vulkan::CommandRecorder::Allocate(size_t slot) {
+  using FrameContext = CoffeeMaker::Renderer::Vulkan::FrameContext;
+
+  VkCommandBuffer cmd = FrameContext::Current().Arena(slot).Allocate(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+  VkCommandBufferBeginInfo beginInfo = CommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT |
+                                                              VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+  beginInfo.pInheritanceInfo = &gInheritance;
+  vkBeginCommandBuffer(cmd, &beginInfo);
+
+  // NOTE: dynamic state is not inherited from the primary
+  VkViewport viewport{0.0f, 0.0f, static_cast<float>(gExtent.width), static_cast<float>(gExtent.height), 0.0f, 1.0f};
+  VkRect2D scissor{{0, 0}, gExtent};
+  vkCmdSetViewport(cmd, 0, 1, &viewport);
+  vkCmdSetScissor(cmd, 0, 1, &scissor);
+
+  return cmd;
+}
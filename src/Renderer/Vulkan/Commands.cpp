@@ -2,11 +2,11 @@
 
 #include <SDL2/SDL.h>
 
+#include "Renderer/Vulkan/DynamicRendering.hpp"
 #include "Renderer/Vulkan/Framebuffer.hpp"
-#include "Renderer/Vulkan/LogicalDevice.hpp"
-#include "Renderer/Vulkan/PhysicalDevice.hpp"
 #include "Renderer/Vulkan/RenderPass.hpp"
 #include "Renderer/Vulkan/Swapchain.hpp"
+#include "Renderer/Vulkan/Utilities.hpp"
 
 VkCommandPoolCreateInfo CoffeeMaker::Renderer::Vulkan::CommandPoolCreateInfo(uint32_t queueFamilyIndex,
                                                                              VkCommandPoolCreateFlags flags) {
@@ -14,6 +14,7 @@ VkCommandPoolCreateInfo CoffeeMaker::Renderer::Vulkan::CommandPoolCreateInfo(uin
 
   info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
   info.pNext = nullptr;
+  info.queueFamilyIndex = queueFamilyIndex;
   info.flags = flags;
 
   return info;
@@ -43,12 +44,10 @@ VkCommandBufferBeginInfo CoffeeMaker::Renderer::Vulkan::CommandBufferBeginInfo(V
   return info;
 }
 
-VkCommandPool CoffeeMaker::Renderer::Vulkan::Commands::commandPool{VK_NULL_HANDLE};
 VkClearValue CoffeeMaker::Renderer::Vulkan::Commands::clearColor{};
 VkClearValue CoffeeMaker::Renderer::Vulkan::Commands::depthClear{};
 std::array<VkClearValue, 2> CoffeeMaker::Renderer::Vulkan::Commands::clearValues{};
-std::vector<VkCommandBuffer> CoffeeMaker::Renderer::Vulkan::Commands::CommandBuffers{};
-size_t CoffeeMaker::Renderer::Vulkan::Commands::CurrentCmdBufferIndex{0};
+VkCommandBuffer CoffeeMaker::Renderer::Vulkan::Commands::CurrentBuffer{VK_NULL_HANDLE};
 
 void CoffeeMaker::Renderer::Vulkan::Commands::SetClearValues() {
   clearColor.color = {0.0f, 0.0f, 0.0f, 1.0f};
@@ -58,66 +57,31 @@ void CoffeeMaker::Renderer::Vulkan::Commands::SetClearValues() {
   clearValues[1] = depthClear;
 }
 
-void CoffeeMaker::Renderer::Vulkan::Commands::DestroyCommandPool() {
-  using LogicDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
-
-  vkDestroyCommandPool(LogicDevice::GetLogicalDevice(), commandPool, nullptr);
-  commandPool = VK_NULL_HANDLE;
-}
-
-void CoffeeMaker::Renderer::Vulkan::Commands::FreeCommandBuffers() {
-  using LogicDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
-
-  vkFreeCommandBuffers(LogicDevice::GetLogicalDevice(), commandPool, static_cast<uint32_t>(CommandBuffers.size()),
-                       CommandBuffers.data());
+void CoffeeMaker::Renderer::Vulkan::Commands::BeginRecording(VkCommandBuffer cmd, size_t swapchainImageIndex,
+                                                             VkSubpassContents contents, VkImageView depthView) {
+  BeginBuffer(cmd);
+  BeginRenderPass(swapchainImageIndex, contents, depthView);
 }
 
-void CoffeeMaker::Renderer::Vulkan::Commands::CreateCommandPool() {
-  using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
-  using VulkanQueueFamilyIndices = CoffeeMaker::Renderer::Vulkan::VulkanQueueFamilyIndices;
-  using LogicDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
-
-  VulkanQueueFamilyIndices queueFamilyIndices = PhysicalDevice::GetPhysicalDeviceInUse()->QueueFamilies;
-  uint32_t graphicsFamilyIndex = queueFamilyIndices.graphicsFamily.value();
-
-  VkCommandPoolCreateInfo poolInfo =
-      CommandPoolCreateInfo(graphicsFamilyIndex, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
-
-  VkResult result = vkCreateCommandPool(LogicDevice::GetLogicalDevice(), &poolInfo, nullptr, &commandPool);
-  if (result != VK_SUCCESS) {
-    SDL_LogError(0, "Unable to create command pool.\nVulkan Error Code: [%d]", result);
-    exit(4444);
-  }
-}
-
-void CoffeeMaker::Renderer::Vulkan::Commands::CreateCommandBuffers() {
-  using LogicDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
-  using Framebuffer = CoffeeMaker::Renderer::Vulkan::Framebuffer;
-
-  CommandBuffers.resize(Framebuffer::framebuffers.size());
-
-  VkCommandBufferAllocateInfo allocInfo =
-      CommandBufferAllocateInfo(commandPool, CommandBuffers.size(), VK_COMMAND_BUFFER_LEVEL_PRIMARY);
-
-  VkResult result = vkAllocateCommandBuffers(LogicDevice::GetLogicalDevice(), &allocInfo, CommandBuffers.data());
-  if (result != VK_SUCCESS) {
-    SDL_LogError(0, "Unable to create command buffers.\nVulkan Error Code: [%d]", result);
-    exit(4444);
-  }
-}
+void CoffeeMaker::Renderer::Vulkan::Commands::BeginBuffer(VkCommandBuffer cmd) {
+  CurrentBuffer = cmd;
+  // NOTE: recorded every frame from a freshly reset pool, the driver can skip keeping it resubmittable
+  VkCommandBufferBeginInfo beginInfo = CommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
-void CoffeeMaker::Renderer::Vulkan::Commands::ResetCommandBuffers(size_t swapChainImageIndex) {
-  vkResetCommandBuffer(CommandBuffers[swapChainImageIndex], 0);
+  vkBeginCommandBuffer(CurrentBuffer, &beginInfo);
 }
 
-void CoffeeMaker::Renderer::Vulkan::Commands::BeginRecording(size_t swapchainImageIndex) {
+void CoffeeMaker::Renderer::Vulkan::Commands::BeginRenderPass(size_t swapchainImageIndex, VkSubpassContents contents,
+                                                              VkImageView depthView) {
   using Swapchain = CoffeeMaker::Renderer::Vulkan::Swapchain;
   using RenderPass = CoffeeMaker::Renderer::Vulkan::RenderPass;
   using Framebuffer = CoffeeMaker::Renderer::Vulkan::Framebuffer;
+  using DynamicRendering = CoffeeMaker::Renderer::Vulkan::DynamicRendering;
 
-  VkCommandBufferBeginInfo beginInfo = CommandBufferBeginInfo(0);
-
-  vkBeginCommandBuffer(CommandBuffers[swapchainImageIndex], &beginInfo);
+  if (DynamicRendering::Supported) {
+    BeginRendering(swapchainImageIndex, contents, depthView);
+    return;
+  }
 
   // Start the render pass
   VkRenderPassBeginInfo renderPassInfo{};
@@ -129,14 +93,95 @@ void CoffeeMaker::Renderer::Vulkan::Commands::BeginRecording(size_t swapchainIma
   renderPassInfo.clearValueCount = clearValues.size();
   renderPassInfo.pClearValues = clearValues.data();
 
-  vkCmdBeginRenderPass(CommandBuffers[swapchainImageIndex], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+  vkCmdBeginRenderPass(CurrentBuffer, &renderPassInfo, contents);
+}
+
+void CoffeeMaker::Renderer::Vulkan::Commands::BeginRendering(size_t swapchainImageIndex, VkSubpassContents contents,
+                                                             VkImageView depthView) {
+  using Swapchain = CoffeeMaker::Renderer::Vulkan::Swapchain;
+  using DynamicRendering = CoffeeMaker::Renderer::Vulkan::DynamicRendering;
+
+  Swapchain* swapchain = Swapchain::GetSwapchain();
+
+  VkRenderingAttachmentInfo colorAttachment{};
+  colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+  colorAttachment.imageView = swapchain->swapChainImageViews[swapchainImageIndex];
+  colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  colorAttachment.resolveMode = VK_RESOLVE_MODE_NONE;
+  colorAttachment.loadOp = ChooseLoadOp(swapchain->colorUsage);
+  colorAttachment.storeOp = ChooseStoreOp(swapchain->colorUsage);
+  colorAttachment.clearValue = clearValues[0];
+
+  VkRenderingAttachmentInfo depthAttachment{};
+  depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+  depthAttachment.imageView = depthView;
+  depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+  depthAttachment.resolveMode = VK_RESOLVE_MODE_NONE;
+  depthAttachment.loadOp = ChooseLoadOp(swapchain->depthUsage);
+  depthAttachment.storeOp = ChooseStoreOp(swapchain->depthUsage);
+  depthAttachment.clearValue = clearValues[1];
+
+  VkRenderingInfo renderingInfo{};
+  renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+  if (contents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS) {
+    renderingInfo.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+  }
+  renderingInfo.renderArea.offset = {0, 0};
+  renderingInfo.renderArea.extent = swapchain->extent;
+  renderingInfo.layerCount = 1;
+  renderingInfo.viewMask = 0;
+  renderingInfo.colorAttachmentCount = 1;
+  renderingInfo.pColorAttachments = &colorAttachment;
+  renderingInfo.pDepthAttachment = &depthAttachment;
+  // NOTE: stencil follows depth when the format has it, like the render pass path
+  renderingInfo.pStencilAttachment = FormatHasStencil(swapchain->depthFormat) ? &depthAttachment : nullptr;
+
+  DynamicRendering::Begin(CurrentBuffer, renderingInfo);
 }
 
-void CoffeeMaker::Renderer::Vulkan::Commands::EndRecording(size_t swapchainImageIndex) {
-  vkCmdEndRenderPass(CommandBuffers[swapchainImageIndex]);
-  vkEndCommandBuffer(CommandBuffers[swapchainImageIndex]);
+void CoffeeMaker::Renderer::Vulkan::Commands::BeginOverlayRendering(size_t swapchainImageIndex) {
+  using Swapchain = CoffeeMaker::Renderer::Vulkan::Swapchain;
+  using DynamicRendering = CoffeeMaker::Renderer::Vulkan::DynamicRendering;
+
+  Swapchain* swapchain = Swapchain::GetSwapchain();
+
+  VkRenderingAttachmentInfo colorAttachment{};
+  colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+  colorAttachment.imageView = swapchain->swapChainImageViews[swapchainImageIndex];
+  colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  colorAttachment.resolveMode = VK_RESOLVE_MODE_NONE;
+  colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+  colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+
+  VkRenderingInfo renderingInfo{};
+  renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+  renderingInfo.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+  renderingInfo.renderArea.offset = {0, 0};
+  renderingInfo.renderArea.extent = swapchain->extent;
+  renderingInfo.layerCount = 1;
+  renderingInfo.viewMask = 0;
+  renderingInfo.colorAttachmentCount = 1;
+  renderingInfo.pColorAttachments = &colorAttachment;
+
+  DynamicRendering::Begin(CurrentBuffer, renderingInfo);
 }
 
-VkCommandBuffer CoffeeMaker::Renderer::Vulkan::Commands::GetCurrentBuffer() {
-  return CommandBuffers[CurrentCmdBufferIndex];
+void CoffeeMaker::Renderer::Vulkan::Commands::EndRecording() {
+  EndRenderPass();
+  EndBuffer();
 }
+
+void CoffeeMaker::Renderer::Vulkan::Commands::EndRenderPass() {
+  using DynamicRendering = CoffeeMaker::Renderer::Vulkan::DynamicRendering;
+
+  if (DynamicRendering::Supported) {
+    DynamicRendering::End(CurrentBuffer);
+    return;
+  }
+
+  vkCmdEndRenderPass(CurrentBuffer);
+}
+
+void CoffeeMaker::Renderer::Vulkan::Commands::EndBuffer() { vkEndCommandBuffer(CurrentBuffer); }
+
+VkCommandBuffer CoffeeMaker::Renderer::Vulkan::Commands::GetCurrentBuffer() { return CurrentBuffer; }
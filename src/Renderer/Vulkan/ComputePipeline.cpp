@@ -0,0 +1,64 @@
+#include "Renderer/Vulkan/ComputePipeline.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <chrono>
+
+#include "Renderer/Vulkan/LogicalDevice.hpp"
+#include "Renderer/Vulkan/PipelineCache.hpp"
+#include "Renderer/Vulkan/PipelineRegistry.hpp"
+
+void CoffeeMaker::Renderer::Vulkan::ComputePipeline::CreatePipeline(
+    CoffeeMaker::Renderer::Vulkan::ComputePipelineCreateInfo createInfo) {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+  using PipelineCache = CoffeeMaker::Renderer::Vulkan::PipelineCache;
+  using PipelineRegistry = CoffeeMaker::Renderer::Vulkan::PipelineRegistry;
+
+  auto start = std::chrono::steady_clock::now();
+  info = createInfo;
+
+  layoutInfo = CreatePipelineLayoutInfo(info.pushConstantRangeCount,
+                                        info.pushConstantRangeCount == 0 ? nullptr : &info.pushConstants);
+  for (const auto& bindings : info.descriptorSets) {
+    sharedSetLayouts.push_back(PipelineRegistry::GetDescriptorSetLayout(bindings));
+    setLayouts.push_back(sharedSetLayouts.back()->layout);
+  }
+  layoutInfo.setLayoutCount = setLayouts.size();
+  layoutInfo.pSetLayouts = setLayouts.empty() ? nullptr : setLayouts.data();
+  sharedLayout = PipelineRegistry::GetPipelineLayout(layoutInfo);
+  layout = sharedLayout->layout;
+
+  VkComputePipelineCreateInfo pipelineInfo{};
+  pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+  pipelineInfo.stage = CreatePipelineShaderStageInfo(VK_SHADER_STAGE_COMPUTE_BIT, info.computeShader);
+  pipelineInfo.layout = layout;
+  pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+  pipelineInfo.basePipelineIndex = -1;
+
+  VkResult result = vkCreateComputePipelines(LogicalDevice::GetLogicalDevice(), PipelineCache::GetPipelineCache(), 1,
+                                             &pipelineInfo, nullptr, &pPipeline);
+  if (result != VK_SUCCESS) {
+    SDL_LogError(0, "Unable to create Vulkan Compute Pipeline.\nVulkan Error Code: [%d]", result);
+    exit(12);
+  }
+
+  compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  PipelineCache::RecordPipelineCreation(compileMs);
+}
+
+void CoffeeMaker::Renderer::Vulkan::ComputePipeline::Bind(VkCommandBuffer cmd) const {
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pPipeline);
+}
+
+uint32_t CoffeeMaker::Renderer::Vulkan::ComputePipeline::GroupCount(uint32_t count) const {
+  return (count + info.localSize[0] - 1) / info.localSize[0];
+}
+
+CoffeeMaker::Renderer::Vulkan::ComputePipeline::ComputePipeline() = default;
+
+CoffeeMaker::Renderer::Vulkan::ComputePipeline::~ComputePipeline() {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  // NOTE: the layout is released with sharedLayout once no other pipeline references it
+  vkDestroyPipeline(LogicalDevice::GetLogicalDevice(), pPipeline, nullptr);
+}
@@ -33,7 +33,7 @@ CoffeeMaker::Renderer::Vulkan::VulkanRenderer::~VulkanRenderer() {
   // CleanupSwapChain();
 
   Synchronization::DestroySyncTools();
-  Commands::DestroyCommandPool();
+  FrameContext::Destroy();
   // VulkanShaderManager::CleanAllShaders();
   MemoryAllocator::DestroyAllocator();
   LogicalDevice::Destroy();
@@ -48,7 +48,6 @@ CoffeeMaker::Renderer::Vulkan::VulkanRenderer *CoffeeMaker::Renderer::Vulkan::Vu
 
 void CoffeeMaker::Renderer::Vulkan::VulkanRenderer::CleanSwapchain() {
   Framebuffer::CreateFramebuffers();
-  Commands::FreeCommandBuffers();
   RenderPass::Destroy();
   Swapchain::Destroy();
 }
@@ -0,0 +1,122 @@
+#include "Renderer/Vulkan/DynamicRendering.hpp"
+
+#include <SDL2/SDL.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "Renderer/Vulkan/LogicalDevice.hpp"
+#include "Renderer/Vulkan/PhysicalDevice.hpp"
+#include "Renderer/Vulkan/Utilities.hpp"
+
+bool CoffeeMaker::Renderer::Vulkan::DynamicRendering::Requested{true};
+bool CoffeeMaker::Renderer::Vulkan::DynamicRendering::Supported{false};
+VkPhysicalDeviceDynamicRenderingFeatures CoffeeMaker::Renderer::Vulkan::DynamicRendering::gFeatures{};
+PFN_vkCmdBeginRenderingKHR CoffeeMaker::Renderer::Vulkan::DynamicRendering::gCmdBeginRendering{nullptr};
+PFN_vkCmdEndRenderingKHR CoffeeMaker::Renderer::Vulkan::DynamicRendering::gCmdEndRendering{nullptr};
+VkFormat CoffeeMaker::Renderer::Vulkan::DynamicRendering::gColorFormat{VK_FORMAT_UNDEFINED};
+VkFormat CoffeeMaker::Renderer::Vulkan::DynamicRendering::gDepthFormat{VK_FORMAT_UNDEFINED};
+VkFormat CoffeeMaker::Renderer::Vulkan::DynamicRendering::gStencilFormat{VK_FORMAT_UNDEFINED};
+
+void CoffeeMaker::Renderer::Vulkan::DynamicRendering::EnableIfSupported(std::vector<const char*>& deviceExtensions) {
+  using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  PhysicalDevice* device = PhysicalDevice::GetPhysicalDeviceInUse();
+
+  // NOTE: on a 1.1 device the extension depends on these two, they are core from 1.2 on
+  const std::vector<const char*> dependencies{VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+                                              VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME};
+  bool hasExtensions = device->IsExtensionSupported(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+  for (const char* dependency : dependencies) {
+    hasExtensions = hasExtensions && device->IsExtensionSupported(dependency);
+  }
+
+  gFeatures = {};
+  gFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+  if (!Requested || !hasExtensions || !device->QueryFeatures2(&gFeatures)) {
+    fmt::print("Dynamic rendering: off\n");
+    return;
+  }
+
+  Supported = gFeatures.dynamicRendering == VK_TRUE;
+  if (Supported) {
+    for (const char* dependency : dependencies) {
+      bool enabled = std::any_of(deviceExtensions.begin(), deviceExtensions.end(), [dependency](const char* name) {
+        return std::strcmp(name, dependency) == 0;
+      });
+      if (!enabled) {
+        deviceExtensions.push_back(dependency);
+      }
+    }
+    deviceExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+    gFeatures = {};
+    gFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+    gFeatures.dynamicRendering = VK_TRUE;
+    LogicalDevice::AddFeatures(&gFeatures);
+  }
+
+  fmt::print("Dynamic rendering: {}\n", Supported ? "on" : "off");
+}
+
+void CoffeeMaker::Renderer::Vulkan::DynamicRendering::LoadFunctions(VkDevice device) {
+  if (!Supported) {
+    return;
+  }
+
+  gCmdBeginRendering = (PFN_vkCmdBeginRenderingKHR)vkGetDeviceProcAddr(device, "vkCmdBeginRenderingKHR");
+  gCmdEndRendering = (PFN_vkCmdEndRenderingKHR)vkGetDeviceProcAddr(device, "vkCmdEndRenderingKHR");
+  if (gCmdBeginRendering == nullptr || gCmdEndRendering == nullptr) {
+    SDL_LogError(0, "Unable to load vkCmdBeginRenderingKHR/vkCmdEndRenderingKHR.");
+    exit(15);
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::DynamicRendering::SetAttachmentFormats(VkFormat color, VkFormat depth) {
+  if (gColorFormat != VK_FORMAT_UNDEFINED && (gColorFormat != color || gDepthFormat != depth)) {
+    SDL_LogWarn(0, "Attachment formats changed, pipelines created for the old formats are no longer compatible.");
+  }
+
+  gColorFormat = color;
+  gDepthFormat = depth;
+  gStencilFormat = FormatHasStencil(depth) ? depth : VK_FORMAT_UNDEFINED;
+}
+
+VkPipelineRenderingCreateInfo CoffeeMaker::Renderer::Vulkan::DynamicRendering::PipelineRenderingInfo() {
+  VkPipelineRenderingCreateInfo info{};
+
+  info.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+  info.pNext = nullptr;
+  info.viewMask = 0;
+  info.colorAttachmentCount = 1;
+  info.pColorAttachmentFormats = &gColorFormat;
+  info.depthAttachmentFormat = gDepthFormat;
+  info.stencilAttachmentFormat = gStencilFormat;
+
+  return info;
+}
+
+VkCommandBufferInheritanceRenderingInfo CoffeeMaker::Renderer::Vulkan::DynamicRendering::InheritanceRenderingInfo(
+    bool withDepth) {
+  VkCommandBufferInheritanceRenderingInfo info{};
+
+  info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+  info.pNext = nullptr;
+  // NOTE: the secondary contents flag belongs to the primary's begin only
+  info.flags = 0;
+  info.viewMask = 0;
+  info.colorAttachmentCount = 1;
+  info.pColorAttachmentFormats = &gColorFormat;
+  info.depthAttachmentFormat = withDepth ? gDepthFormat : VK_FORMAT_UNDEFINED;
+  info.stencilAttachmentFormat = withDepth ? gStencilFormat : VK_FORMAT_UNDEFINED;
+  info.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+  return info;
+}
+
+void CoffeeMaker::Renderer::Vulkan::DynamicRendering::Begin(VkCommandBuffer cmd, const VkRenderingInfo& renderingInfo) {
+  gCmdBeginRendering(cmd, &renderingInfo);
+}
+
+void CoffeeMaker::Renderer::Vulkan::DynamicRendering::End(VkCommandBuffer cmd) { gCmdEndRendering(cmd); }
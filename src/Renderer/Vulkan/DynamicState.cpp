@@ -0,0 +1,141 @@
+#include "Renderer/Vulkan/DynamicState.hpp"
+
+#include <SDL2/SDL.h>
+#include <fmt/core.h>
+
+#include "Renderer/Vulkan/LogicalDevice.hpp"
+#include "Renderer/Vulkan/PhysicalDevice.hpp"
+
+bool CoffeeMaker::Renderer::Vulkan::DynamicState::ExtendedDynamicState{false};
+bool CoffeeMaker::Renderer::Vulkan::DynamicState::ExtendedDynamicState3PolygonMode{false};
+VkPhysicalDeviceExtendedDynamicStateFeaturesEXT
+    CoffeeMaker::Renderer::Vulkan::DynamicState::gExtendedDynamicStateFeatures{};
+VkPhysicalDeviceExtendedDynamicState3FeaturesEXT
+    CoffeeMaker::Renderer::Vulkan::DynamicState::gExtendedDynamicState3Features{};
+PFN_vkCmdSetCullModeEXT CoffeeMaker::Renderer::Vulkan::DynamicState::gCmdSetCullMode{nullptr};
+PFN_vkCmdSetFrontFaceEXT CoffeeMaker::Renderer::Vulkan::DynamicState::gCmdSetFrontFace{nullptr};
+PFN_vkCmdSetPrimitiveTopologyEXT CoffeeMaker::Renderer::Vulkan::DynamicState::gCmdSetPrimitiveTopology{nullptr};
+PFN_vkCmdSetDepthTestEnableEXT CoffeeMaker::Renderer::Vulkan::DynamicState::gCmdSetDepthTestEnable{nullptr};
+PFN_vkCmdSetDepthWriteEnableEXT CoffeeMaker::Renderer::Vulkan::DynamicState::gCmdSetDepthWriteEnable{nullptr};
+PFN_vkCmdSetDepthCompareOpEXT CoffeeMaker::Renderer::Vulkan::DynamicState::gCmdSetDepthCompareOp{nullptr};
+PFN_vkCmdSetPolygonModeEXT CoffeeMaker::Renderer::Vulkan::DynamicState::gCmdSetPolygonMode{nullptr};
+
+void CoffeeMaker::Renderer::Vulkan::DynamicState::EnableIfSupported(std::vector<const char*>& deviceExtensions) {
+  using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  PhysicalDevice* device = PhysicalDevice::GetPhysicalDeviceInUse();
+
+  gExtendedDynamicStateFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+  gExtendedDynamicState3Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+
+  bool hasExtendedDynamicState = device->IsExtensionSupported(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+  bool hasExtendedDynamicState3 = device->IsExtensionSupported(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+  if (!hasExtendedDynamicState) {
+    return;
+  }
+
+  gExtendedDynamicStateFeatures.pNext = hasExtendedDynamicState3 ? &gExtendedDynamicState3Features : nullptr;
+  gExtendedDynamicState3Features.pNext = nullptr;
+  if (!device->QueryFeatures2(&gExtendedDynamicStateFeatures)) {
+    return;
+  }
+
+  ExtendedDynamicState = gExtendedDynamicStateFeatures.extendedDynamicState == VK_TRUE;
+  ExtendedDynamicState3PolygonMode =
+      ExtendedDynamicState && hasExtendedDynamicState3 &&
+      gExtendedDynamicState3Features.extendedDynamicState3PolygonMode == VK_TRUE;
+
+  if (ExtendedDynamicState) {
+    deviceExtensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+    gExtendedDynamicStateFeatures = {};
+    gExtendedDynamicStateFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+    gExtendedDynamicStateFeatures.extendedDynamicState = VK_TRUE;
+    LogicalDevice::AddFeatures(&gExtendedDynamicStateFeatures);
+  }
+
+  if (ExtendedDynamicState3PolygonMode) {
+    // NOTE: only enable what we use, the rest of extended dynamic state 3 is left off
+    deviceExtensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+    gExtendedDynamicState3Features = {};
+    gExtendedDynamicState3Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+    gExtendedDynamicState3Features.extendedDynamicState3PolygonMode = VK_TRUE;
+    LogicalDevice::AddFeatures(&gExtendedDynamicState3Features);
+  }
+
+  fmt::print("Extended dynamic state: {}, dynamic polygon mode: {}\n", ExtendedDynamicState ? "on" : "off",
+             ExtendedDynamicState3PolygonMode ? "on" : "off");
+}
+
+void CoffeeMaker::Renderer::Vulkan::DynamicState::LoadFunctions(VkDevice device) {
+  if (ExtendedDynamicState) {
+    gCmdSetCullMode = (PFN_vkCmdSetCullModeEXT)vkGetDeviceProcAddr(device, "vkCmdSetCullModeEXT");
+    gCmdSetFrontFace = (PFN_vkCmdSetFrontFaceEXT)vkGetDeviceProcAddr(device, "vkCmdSetFrontFaceEXT");
+    gCmdSetPrimitiveTopology =
+        (PFN_vkCmdSetPrimitiveTopologyEXT)vkGetDeviceProcAddr(device, "vkCmdSetPrimitiveTopologyEXT");
+    gCmdSetDepthTestEnable = (PFN_vkCmdSetDepthTestEnableEXT)vkGetDeviceProcAddr(device, "vkCmdSetDepthTestEnableEXT");
+    gCmdSetDepthWriteEnable =
+        (PFN_vkCmdSetDepthWriteEnableEXT)vkGetDeviceProcAddr(device, "vkCmdSetDepthWriteEnableEXT");
+    gCmdSetDepthCompareOp = (PFN_vkCmdSetDepthCompareOpEXT)vkGetDeviceProcAddr(device, "vkCmdSetDepthCompareOpEXT");
+
+    if (gCmdSetCullMode == nullptr || gCmdSetFrontFace == nullptr || gCmdSetPrimitiveTopology == nullptr ||
+        gCmdSetDepthTestEnable == nullptr || gCmdSetDepthWriteEnable == nullptr || gCmdSetDepthCompareOp == nullptr) {
+      SDL_LogWarn(0, "Unable to load extended dynamic state functions, using static pipeline state.");
+      ExtendedDynamicState = false;
+      ExtendedDynamicState3PolygonMode = false;
+    }
+  }
+
+  if (ExtendedDynamicState3PolygonMode) {
+    gCmdSetPolygonMode = (PFN_vkCmdSetPolygonModeEXT)vkGetDeviceProcAddr(device, "vkCmdSetPolygonModeEXT");
+    if (gCmdSetPolygonMode == nullptr) {
+      ExtendedDynamicState3PolygonMode = false;
+    }
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::DynamicState::AppendDynamicStates(std::vector<VkDynamicState>& dynamicStates) {
+  if (ExtendedDynamicState) {
+    dynamicStates.push_back(VK_DYNAMIC_STATE_CULL_MODE_EXT);
+    dynamicStates.push_back(VK_DYNAMIC_STATE_FRONT_FACE_EXT);
+    dynamicStates.push_back(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT);
+    dynamicStates.push_back(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT);
+    dynamicStates.push_back(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT);
+    dynamicStates.push_back(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT);
+  }
+
+  if (ExtendedDynamicState3PolygonMode) {
+    dynamicStates.push_back(VK_DYNAMIC_STATE_POLYGON_MODE_EXT);
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::DynamicState::SetRenderState(VkCommandBuffer cmd, const RenderState& state) {
+  if (ExtendedDynamicState) {
+    gCmdSetCullMode(cmd, state.cullMode);
+    gCmdSetFrontFace(cmd, state.frontFace);
+    gCmdSetPrimitiveTopology(cmd, state.topology);
+    gCmdSetDepthTestEnable(cmd, state.depthTest ? VK_TRUE : VK_FALSE);
+    gCmdSetDepthWriteEnable(cmd, state.depthWrite ? VK_TRUE : VK_FALSE);
+    gCmdSetDepthCompareOp(cmd, state.depthTest ? state.depthCompareOp : VK_COMPARE_OP_ALWAYS);
+  }
+
+  if (ExtendedDynamicState3PolygonMode) {
+    gCmdSetPolygonMode(cmd, state.polygonMode);
+  }
+}
+
+uint32_t CoffeeMaker::Renderer::Vulkan::DynamicState::TopologyClass(VkPrimitiveTopology topology) {
+  switch (topology) {
+    case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+      return 0;
+    case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+    case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+    case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+    case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+      return 1;
+    case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+      return 3;
+    default:
+      return 2;
+  }
+}
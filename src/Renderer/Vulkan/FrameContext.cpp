@@ -0,0 +1,155 @@
+#include "Renderer/Vulkan/FrameContext.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <chrono>
+
+#include "Renderer/Vulkan/Commands.hpp"
+#include "Renderer/Vulkan/LogicalDevice.hpp"
+#include "Renderer/Vulkan/PhysicalDevice.hpp"
+
+namespace {
+  // NOTE: weight of the newest sample in the moving averages
+  constexpr double AVERAGE_WEIGHT = 0.05;
+}  // namespace
+
+std::vector<CoffeeMaker::Renderer::Vulkan::FrameContext> CoffeeMaker::Renderer::Vulkan::FrameContext::gFrames{};
+size_t CoffeeMaker::Renderer::Vulkan::FrameContext::gCurrent{0};
+double CoffeeMaker::Renderer::Vulkan::FrameContext::ResetMs{0.0};
+double CoffeeMaker::Renderer::Vulkan::FrameContext::RecordMs{0.0};
+
+void CoffeeMaker::Renderer::Vulkan::CommandArena::Create(uint32_t queueFamilyIndex) {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+#ifdef COFFEEMAKER_PER_BUFFER_RESET
+  VkCommandPoolCreateFlags flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+#else
+  VkCommandPoolCreateFlags flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+#endif
+  VkCommandPoolCreateInfo poolInfo = CommandPoolCreateInfo(queueFamilyIndex, flags);
+
+  VkResult result = vkCreateCommandPool(LogicalDevice::GetLogicalDevice(), &poolInfo, nullptr, &pool);
+  if (result != VK_SUCCESS) {
+    SDL_LogError(0, "Unable to create frame command pool.\nVulkan Error Code: [%d]", result);
+    exit(4444);
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::CommandArena::Destroy() {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  // NOTE: destroying the pool frees every buffer allocated from it
+  vkDestroyCommandPool(LogicalDevice::GetLogicalDevice(), pool, nullptr);
+  pool = VK_NULL_HANDLE;
+  primaries.clear();
+  secondaries.clear();
+  usedPrimaries = 0;
+  usedSecondaries = 0;
+}
+
+VkCommandBuffer CoffeeMaker::Renderer::Vulkan::CommandArena::Allocate(VkCommandBufferLevel level) {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  bool primary = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  std::vector<VkCommandBuffer>& buffers = primary ? primaries : secondaries;
+  size_t& used = primary ? usedPrimaries : usedSecondaries;
+
+  if (used == buffers.size()) {
+    // NOTE: grows in batches, once a scene has warmed up every frame reuses what is already allocated
+    size_t previous = buffers.size();
+    uint32_t batch = primary ? 1 : 4;
+    buffers.resize(previous + batch);
+    VkCommandBufferAllocateInfo allocInfo = CommandBufferAllocateInfo(pool, batch, level);
+    VkResult result = vkAllocateCommandBuffers(LogicalDevice::GetLogicalDevice(), &allocInfo, buffers.data() + previous);
+    if (result != VK_SUCCESS) {
+      SDL_LogError(0, "Unable to allocate frame command buffers.\nVulkan Error Code: [%d]", result);
+      exit(4444);
+    }
+  }
+
+  return buffers[used++];
+}
+
+void CoffeeMaker::Renderer::Vulkan::CommandArena::Reset() {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  if (usedPrimaries == 0 && usedSecondaries == 0) {
+    return;
+  }
+
+#ifdef COFFEEMAKER_PER_BUFFER_RESET
+  for (size_t i = 0; i < usedPrimaries; i++) {
+    vkResetCommandBuffer(primaries[i], 0);
+  }
+  for (size_t i = 0; i < usedSecondaries; i++) {
+    vkResetCommandBuffer(secondaries[i], 0);
+  }
+#else
+  // NOTE: keeps the buffers allocated, they are handed out again from the start
+  vkResetCommandPool(LogicalDevice::GetLogicalDevice(), pool, 0);
+#endif
+  usedPrimaries = 0;
+  usedSecondaries = 0;
+}
+
+void CoffeeMaker::Renderer::Vulkan::FrameContext::Create(size_t framesInFlight, size_t threadSlots) {
+  using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
+
+  uint32_t graphicsFamilyIndex = PhysicalDevice::GetPhysicalDeviceInUse()->QueueFamilies.graphicsFamily.value();
+
+  gFrames.resize(framesInFlight);
+  for (size_t i = 0; i < gFrames.size(); i++) {
+    gFrames[i].index = i;
+    gFrames[i].arenas.resize(threadSlots);
+    for (auto& arena : gFrames[i].arenas) {
+      arena.Create(graphicsFamilyIndex);
+    }
+  }
+  gCurrent = 0;
+}
+
+void CoffeeMaker::Renderer::Vulkan::FrameContext::Destroy() {
+  for (auto& frame : gFrames) {
+    for (auto& arena : frame.arenas) {
+      arena.Destroy();
+    }
+  }
+  gFrames.clear();
+}
+
+CoffeeMaker::Renderer::Vulkan::FrameContext& CoffeeMaker::Renderer::Vulkan::FrameContext::Begin(size_t frame) {
+  auto start = std::chrono::steady_clock::now();
+  gCurrent = frame;
+  for (auto& arena : gFrames[gCurrent].arenas) {
+    arena.Reset();
+  }
+
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  ResetMs += (ms - ResetMs) * AVERAGE_WEIGHT;
+
+  return gFrames[gCurrent];
+}
+
+CoffeeMaker::Renderer::Vulkan::FrameContext& CoffeeMaker::Renderer::Vulkan::FrameContext::Current() {
+  return gFrames[gCurrent];
+}
+
+void CoffeeMaker::Renderer::Vulkan::FrameContext::ReportRecording(double ms) {
+  RecordMs += (ms - RecordMs) * AVERAGE_WEIGHT;
+}
+
+CoffeeMaker::Renderer::Vulkan::CommandArena& CoffeeMaker::Renderer::Vulkan::FrameContext::Arena(size_t slot) {
+  return arenas[slot];
+}
+
+CoffeeMaker::Renderer::Vulkan::CommandArena& CoffeeMaker::Renderer::Vulkan::FrameContext::RenderArena() {
+  return arenas.back();
+}
+
+size_t CoffeeMaker::Renderer::Vulkan::FrameContext::CommandBufferCount() const {
+  size_t count = 0;
+  for (const auto& arena : arenas) {
+    count += arena.usedPrimaries + arena.usedSecondaries;
+  }
+  return count;
+}
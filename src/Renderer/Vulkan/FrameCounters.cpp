@@ -0,0 +1,243 @@
+#include "Renderer/Vulkan/FrameCounters.hpp"
+
+#include <SDL2/SDL.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+#include "Renderer/Vulkan/CommandEncoder.hpp"
+#include "Renderer/Vulkan/FrameContext.hpp"
+#include "Renderer/Vulkan/LogicalDevice.hpp"
+#include "Renderer/Vulkan/MemoryAllocator.hpp"
+#include "Renderer/Vulkan/PhysicalDevice.hpp"
+#include "Renderer/Vulkan/Synchronization.hpp"
+
+namespace {
+  // NOTE: results come back in bit order, the Statistics fields follow it
+  constexpr VkQueryPipelineStatisticFlags STATISTICS = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+                                                       VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                                                       VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+                                                       VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+  constexpr size_t STATISTICS_COUNT = 4;
+}  // namespace
+
+bool CoffeeMaker::Renderer::Vulkan::FrameCounters::Supported{false};
+bool CoffeeMaker::Renderer::Vulkan::FrameCounters::Enabled{true};
+CoffeeMaker::Renderer::Vulkan::FrameCounters::Counters CoffeeMaker::Renderer::Vulkan::FrameCounters::Last{};
+CoffeeMaker::Renderer::Vulkan::FrameCounters::Statistics
+    CoffeeMaker::Renderer::Vulkan::FrameCounters::LastStatistics{};
+std::string CoffeeMaker::Renderer::Vulkan::FrameCounters::LogPath{};
+std::vector<CoffeeMaker::Renderer::Vulkan::FrameCounters::Slot> CoffeeMaker::Renderer::Vulkan::FrameCounters::gSlots{};
+size_t CoffeeMaker::Renderer::Vulkan::FrameCounters::gCurrent{0};
+uint64_t CoffeeMaker::Renderer::Vulkan::FrameCounters::gFrame{0};
+bool CoffeeMaker::Renderer::Vulkan::FrameCounters::gQueryOpen{false};
+bool CoffeeMaker::Renderer::Vulkan::FrameCounters::gCsv{false};
+std::ofstream CoffeeMaker::Renderer::Vulkan::FrameCounters::gLog{};
+
+void CoffeeMaker::Renderer::Vulkan::FrameCounters::EnableIfSupported() {
+  using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  PhysicalDevice* device = PhysicalDevice::GetPhysicalDeviceInUse();
+
+  // NOTE: the scene is recorded into secondaries, without inheritedQueries they could not run inside the query
+  Supported = device->Features.pipelineStatisticsQuery == VK_TRUE && device->Features.inheritedQueries == VK_TRUE;
+  if (!Supported) {
+    fmt::print("Pipeline statistics: off\n");
+    return;
+  }
+
+  LogicalDevice::CoreFeatures().pipelineStatisticsQuery = VK_TRUE;
+  LogicalDevice::CoreFeatures().inheritedQueries = VK_TRUE;
+  fmt::print("Pipeline statistics: on\n");
+}
+
+void CoffeeMaker::Renderer::Vulkan::FrameCounters::Create(size_t framesInFlight) {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  if (!Supported) {
+    return;
+  }
+
+  gSlots.resize(framesInFlight);
+  for (Slot& slot : gSlots) {
+    VkQueryPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    poolInfo.queryCount = 1;
+    poolInfo.pipelineStatistics = STATISTICS;
+
+    VkResult result = vkCreateQueryPool(LogicalDevice::GetLogicalDevice(), &poolInfo, nullptr, &slot.pool);
+    if (result != VK_SUCCESS) {
+      SDL_LogError(0, "Unable to create the pipeline statistics query pool.\nVulkan Error Code: [%d]", result);
+      exit(18);
+    }
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::FrameCounters::Destroy() {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  for (Slot& slot : gSlots) {
+    vkDestroyQueryPool(LogicalDevice::GetLogicalDevice(), slot.pool, nullptr);
+  }
+  gSlots.clear();
+  SetLogPath("");
+}
+
+void CoffeeMaker::Renderer::Vulkan::FrameCounters::BeginFrame(VkCommandBuffer cmd, size_t frame) {
+  using Synchronization = CoffeeMaker::Renderer::Vulkan::Synchronization;
+
+  gFrame++;
+  gCurrent = frame;
+  gQueryOpen = false;
+  if (gSlots.empty()) {
+    return;
+  }
+
+  // NOTE: oldest first, LastStatistics ends up with the newest frame. The current slot was waited for already.
+  uint64_t completed = Synchronization::CompletedValue();
+  std::vector<Slot*> finished{};
+  for (size_t i = 0; i < gSlots.size(); i++) {
+    if (gSlots[i].pending && (i == frame || gSlots[i].value <= completed)) {
+      finished.push_back(&gSlots[i]);
+    }
+  }
+  std::sort(finished.begin(), finished.end(), [](const Slot* a, const Slot* b) { return a->frame < b->frame; });
+  for (Slot* slot : finished) {
+    Read(*slot);
+    slot->pending = false;
+  }
+
+  if (!Enabled) {
+    return;
+  }
+
+  Slot& slot = gSlots[frame];
+  vkCmdResetQueryPool(cmd, slot.pool, 0, 1);
+  slot.value = Synchronization::PendingValue();
+  slot.frame = gFrame;
+  slot.pending = true;
+}
+
+void CoffeeMaker::Renderer::Vulkan::FrameCounters::BeginQuery(VkCommandBuffer cmd) {
+  if (gSlots.empty() || !gSlots[gCurrent].pending || gQueryOpen) {
+    return;
+  }
+
+  vkCmdBeginQuery(cmd, gSlots[gCurrent].pool, 0, 0);
+  gQueryOpen = true;
+}
+
+void CoffeeMaker::Renderer::Vulkan::FrameCounters::EndQuery(VkCommandBuffer cmd) {
+  if (!gQueryOpen) {
+    return;
+  }
+
+  vkCmdEndQuery(cmd, gSlots[gCurrent].pool, 0);
+  gQueryOpen = false;
+}
+
+VkQueryPipelineStatisticFlags CoffeeMaker::Renderer::Vulkan::FrameCounters::InheritedStatistics() {
+  // NOTE: inheriting while no query is active is allowed, so the flags do not follow Enabled
+  return Supported ? STATISTICS : 0;
+}
+
+void CoffeeMaker::Renderer::Vulkan::FrameCounters::EndFrame(uint64_t culledVisibleTriangles) {
+  using CommandEncoder = CoffeeMaker::Renderer::Vulkan::CommandEncoder;
+  using EncodedCall = CoffeeMaker::Renderer::Vulkan::EncodedCall;
+  using EncodedCounter = CoffeeMaker::Renderer::Vulkan::EncodedCounter;
+  using FrameContext = CoffeeMaker::Renderer::Vulkan::FrameContext;
+  using MemoryAllocator = CoffeeMaker::Renderer::Vulkan::MemoryAllocator;
+
+  Last = Counters{};
+  Last.frame = gFrame;
+  Last.drawCalls = CommandEncoder::LastCounter(EncodedCounter::DrawCalls);
+  Last.instances = CommandEncoder::LastCounter(EncodedCounter::Instances);
+  Last.triangles = CommandEncoder::LastCounter(EncodedCounter::Triangles);
+  Last.indirectTriangles = CommandEncoder::LastCounter(EncodedCounter::IndirectTriangles);
+  // NOTE: direct draws are not culled on the CPU, every triangle they submit counts as visible
+  Last.visibleTriangles = Last.triangles + culledVisibleTriangles;
+  Last.pipelineBinds = CommandEncoder::LastIssued[static_cast<size_t>(EncodedCall::Pipeline)];
+  Last.descriptorBinds = CommandEncoder::LastIssued[static_cast<size_t>(EncodedCall::DescriptorSets)];
+  Last.pushConstantBytes = CommandEncoder::LastCounter(EncodedCounter::PushConstantBytes);
+  Last.uploadedBytes = MemoryAllocator::UploadedBytes.exchange(0, std::memory_order_relaxed);
+  Last.commandBuffers = FrameContext::Current().CommandBufferCount();
+
+  if (gLog.is_open()) {
+    WriteRow();
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::FrameCounters::SetLogPath(const std::string& path) {
+  if (gLog.is_open()) {
+    gLog.close();
+  }
+  LogPath = path;
+  if (path.empty()) {
+    return;
+  }
+
+  gCsv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+  gLog.open(path, std::ios::app);
+  if (!gLog) {
+    SDL_LogWarn(0, "Unable to write the frame counters to %s", path.c_str());
+    LogPath.clear();
+    return;
+  }
+
+  // NOTE: appended to, the header is only written into an empty file
+  if (gCsv && gLog.tellp() == 0) {
+    gLog << "frame,drawCalls,instances,triangles,indirectTriangles,visibleTriangles,pipelineBinds,descriptorBinds,"
+            "pushConstantBytes,uploadedBytes,commandBuffers,statisticsFrame,inputPrimitives,vertexInvocations,"
+            "clippingPrimitives,fragmentInvocations\n";
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::FrameCounters::Read(Slot& slot) {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  // NOTE: no wait flag, the timeline says the frame is done so the results are available
+  std::array<uint64_t, STATISTICS_COUNT> results{};
+  VkResult result = vkGetQueryPoolResults(LogicalDevice::GetLogicalDevice(), slot.pool, 0, 1,
+                                          results.size() * sizeof(uint64_t), results.data(),
+                                          results.size() * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+  if (result != VK_SUCCESS) {
+    return;
+  }
+
+  LastStatistics.frame = slot.frame;
+  LastStatistics.inputPrimitives = results[0];
+  LastStatistics.vertexInvocations = results[1];
+  LastStatistics.clippingPrimitives = results[2];
+  LastStatistics.fragmentInvocations = results[3];
+}
+
+void CoffeeMaker::Renderer::Vulkan::FrameCounters::WriteRow() {
+  // NOTE: the statistics are the newest read back, statisticsFrame says which frame they belong to
+  const Counters& c = Last;
+  const Statistics& s = LastStatistics;
+  if (gCsv) {
+    gLog << fmt::format("{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{}\n", c.frame, c.drawCalls, c.instances,
+                        c.triangles, c.indirectTriangles, c.visibleTriangles, c.pipelineBinds, c.descriptorBinds,
+                        c.pushConstantBytes, c.uploadedBytes, c.commandBuffers, s.frame, s.inputPrimitives,
+                        s.vertexInvocations, s.clippingPrimitives, s.fragmentInvocations);
+    return;
+  }
+
+  gLog << fmt::format(
+      "{{\"frame\":{},\"drawCalls\":{},\"instances\":{},\"triangles\":{},\"indirectTriangles\":{},"
+      "\"visibleTriangles\":{},\"pipelineBinds\":{},\"descriptorBinds\":{},\"pushConstantBytes\":{},"
+      "\"uploadedBytes\":{},\"commandBuffers\":{}",
+      c.frame, c.drawCalls, c.instances, c.triangles, c.indirectTriangles, c.visibleTriangles, c.pipelineBinds,
+      c.descriptorBinds, c.pushConstantBytes, c.uploadedBytes, c.commandBuffers);
+  if (Supported) {
+    gLog << fmt::format(
+        ",\"statistics\":{{\"frame\":{},\"inputPrimitives\":{},\"vertexInvocations\":{},\"clippingPrimitives\":{},"
+        "\"fragmentInvocations\":{}}}",
+        s.frame, s.inputPrimitives, s.vertexInvocations, s.clippingPrimitives, s.fragmentInvocations);
+  }
+  gLog << "}\n";
+}
@@ -0,0 +1,207 @@
+#include "Renderer/Vulkan/FramePacer.hpp"
+
+#include <SDL2/SDL.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <thread>
+
+#include "CpuProfiler.hpp"
+#include "Renderer/Vulkan/LogicalDevice.hpp"
+#include "Renderer/Vulkan/PhysicalDevice.hpp"
+#include "Renderer/Vulkan/Swapchain.hpp"
+#include "Renderer/Vulkan/Synchronization.hpp"
+
+namespace {
+  // NOTE: weight of the newest sample in the moving averages
+  constexpr double AVERAGE_WEIGHT = 0.05;
+  // NOTE: a minimized window may never present, the pacer gives up on the wait instead of hanging
+  constexpr uint64_t PRESENT_TIMEOUT_NS = 100000000;
+
+  double Milliseconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  }
+}  // namespace
+
+size_t CoffeeMaker::Renderer::Vulkan::FramePacer::FramesInFlight{2};
+bool CoffeeMaker::Renderer::Vulkan::FramePacer::LowLatency{false};
+double CoffeeMaker::Renderer::Vulkan::FramePacer::SafetyMarginMs{1.0};
+bool CoffeeMaker::Renderer::Vulkan::FramePacer::PresentWaitSupported{false};
+VkPhysicalDevicePresentIdFeaturesKHR CoffeeMaker::Renderer::Vulkan::FramePacer::gPresentIdFeatures{};
+VkPhysicalDevicePresentWaitFeaturesKHR CoffeeMaker::Renderer::Vulkan::FramePacer::gPresentWaitFeatures{};
+double CoffeeMaker::Renderer::Vulkan::FramePacer::LatencyMs{0.0};
+double CoffeeMaker::Renderer::Vulkan::FramePacer::LastLatencyMs{0.0};
+double CoffeeMaker::Renderer::Vulkan::FramePacer::CpuMs{0.0};
+double CoffeeMaker::Renderer::Vulkan::FramePacer::GpuMs{0.0};
+double CoffeeMaker::Renderer::Vulkan::FramePacer::RefreshIntervalMs{1000.0 / 60.0};
+double CoffeeMaker::Renderer::Vulkan::FramePacer::LastSleepMs{0.0};
+double CoffeeMaker::Renderer::Vulkan::FramePacer::LastWaitMs{0.0};
+PFN_vkWaitForPresentKHR CoffeeMaker::Renderer::Vulkan::FramePacer::gWaitForPresent{nullptr};
+std::deque<CoffeeMaker::Renderer::Vulkan::FramePacer::Frame> CoffeeMaker::Renderer::Vulkan::FramePacer::gFrames{};
+CoffeeMaker::Renderer::Vulkan::FramePacer::Clock::time_point CoffeeMaker::Renderer::Vulkan::FramePacer::gInput{};
+
+void CoffeeMaker::Renderer::Vulkan::FramePacer::EnableIfSupported(std::vector<const char*>& deviceExtensions) {
+  using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  PhysicalDevice* device = PhysicalDevice::GetPhysicalDeviceInUse();
+
+  gPresentIdFeatures = {};
+  gPresentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+  gPresentWaitFeatures = {};
+  gPresentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+  gPresentIdFeatures.pNext = &gPresentWaitFeatures;
+
+  bool hasExtensions = device->IsExtensionSupported(VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+                       device->IsExtensionSupported(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+  if (!hasExtensions || !device->QueryFeatures2(&gPresentIdFeatures)) {
+    fmt::print("Present wait: off\n");
+    return;
+  }
+
+  PresentWaitSupported = gPresentIdFeatures.presentId == VK_TRUE && gPresentWaitFeatures.presentWait == VK_TRUE;
+  if (PresentWaitSupported) {
+    deviceExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+    deviceExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+    gPresentIdFeatures = {};
+    gPresentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    gPresentIdFeatures.presentId = VK_TRUE;
+    gPresentWaitFeatures = {};
+    gPresentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    gPresentWaitFeatures.presentWait = VK_TRUE;
+    LogicalDevice::AddFeatures(&gPresentIdFeatures);
+    LogicalDevice::AddFeatures(&gPresentWaitFeatures);
+  }
+
+  fmt::print("Present wait: {}\n", PresentWaitSupported ? "on" : "off");
+}
+
+void CoffeeMaker::Renderer::Vulkan::FramePacer::LoadFunctions(VkDevice device) {
+  if (!PresentWaitSupported) {
+    return;
+  }
+
+  gWaitForPresent = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(device, "vkWaitForPresentKHR");
+  if (gWaitForPresent == nullptr) {
+    SDL_LogWarn(0, "Unable to load vkWaitForPresentKHR, latency is measured up to GPU completion.");
+    PresentWaitSupported = false;
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::FramePacer::SetRefreshRate(int hz) {
+  if (hz > 0) {
+    RefreshIntervalMs = 1000.0 / static_cast<double>(hz);
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::FramePacer::WaitForNextFrame() {
+  using Synchronization = CoffeeMaker::Renderer::Vulkan::Synchronization;
+
+  CPU_SCOPE("FramePacer::WaitForNextFrame");
+  Clock::time_point start = Clock::now();
+  FramesInFlight = std::clamp<size_t>(FramesInFlight, 1, MaxFramesInFlight);
+  LastSleepMs = 0.0;
+
+  if (LowLatency && Synchronization::gSubmitted > 0) {
+    uint64_t previous = Synchronization::gSubmitted;
+    bool finished = previous <= Synchronization::CompletedValue();
+    Synchronization::WaitForValue(previous);
+    // NOTE: with a single frame in flight the GPU starts on the frame when it is submitted, a wait that had to
+    // block ends when the GPU is done with it
+    if (!finished && !gFrames.empty() && gFrames.back().value == previous) {
+      GpuMs += (Milliseconds(Clock::now() - gFrames.back().submit) - GpuMs) * AVERAGE_WEIGHT;
+    }
+    Measure(true);
+
+    // NOTE: the previous frame just reached the screen, the next refresh is an interval away
+    double slack = RefreshIntervalMs - CpuMs - GpuMs - SafetyMarginMs;
+    if (PresentWaitSupported && slack > 0.0) {
+      std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(slack));
+      LastSleepMs = slack;
+    }
+  } else {
+    uint64_t pending = Synchronization::PendingValue();
+    if (pending > FramesInFlight) {
+      Synchronization::WaitForValue(pending - FramesInFlight);
+    }
+    Measure(false);
+  }
+
+  gInput = Clock::now();
+  LastWaitMs = Milliseconds(gInput - start);
+}
+
+void CoffeeMaker::Renderer::Vulkan::FramePacer::FrameSubmitted(uint64_t value) {
+  Clock::time_point now = Clock::now();
+  CpuMs += (Milliseconds(now - gInput) - CpuMs) * AVERAGE_WEIGHT;
+
+  gFrames.push_back(Frame{.value = value, .input = gInput, .submit = now});
+  // NOTE: frames that are never presented (e.g. a lost surface) must not pile up
+  while (gFrames.size() > MaxFramesInFlight * 2) {
+    gFrames.pop_front();
+  }
+}
+
+VkResult CoffeeMaker::Renderer::Vulkan::FramePacer::Present(VkQueue queue, VkPresentInfoKHR presentInfo,
+                                                            uint64_t value) {
+  // NOTE: the timeline value is already unique and increasing, it doubles as the present id
+  std::vector<uint64_t> presentIds(presentInfo.swapchainCount, value);
+  VkPresentIdKHR presentId{};
+  if (PresentWaitSupported) {
+    presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+    presentId.pNext = presentInfo.pNext;
+    presentId.swapchainCount = presentInfo.swapchainCount;
+    presentId.pPresentIds = presentIds.data();
+    presentInfo.pNext = &presentId;
+  }
+
+  CPU_SCOPE("vkQueuePresentKHR");
+  return vkQueuePresentKHR(queue, &presentInfo);
+}
+
+void CoffeeMaker::Renderer::Vulkan::FramePacer::SwapchainRecreated() { gFrames.clear(); }
+
+void CoffeeMaker::Renderer::Vulkan::FramePacer::Measure(bool block) {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+  using Swapchain = CoffeeMaker::Renderer::Vulkan::Swapchain;
+  using Synchronization = CoffeeMaker::Renderer::Vulkan::Synchronization;
+
+  if (gFrames.empty()) {
+    return;
+  }
+
+  // NOTE: frames are presented in order, once the newest is done so are the others
+  if (block && PresentWaitSupported) {
+    gWaitForPresent(LogicalDevice::GetLogicalDevice(), Swapchain::GetVkpSwapchain(), gFrames.back().value,
+                    PRESENT_TIMEOUT_NS);
+  } else if (block) {
+    Synchronization::WaitForValue(gFrames.back().value);
+  }
+
+  Clock::time_point now = Clock::now();
+  while (!gFrames.empty()) {
+    const Frame& frame = gFrames.front();
+    if (PresentWaitSupported) {
+      VkResult result =
+          gWaitForPresent(LogicalDevice::GetLogicalDevice(), Swapchain::GetVkpSwapchain(), frame.value, 0);
+      if (result == VK_TIMEOUT) {
+        break;
+      }
+      // NOTE: anything else (out of date, surface lost) means the frame will not be shown, there is nothing to report
+      if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR) {
+        Report(frame, now);
+      }
+    } else {
+      if (frame.value > Synchronization::CompletedValue()) {
+        break;
+      }
+      Report(frame, now);
+    }
+    gFrames.pop_front();
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::FramePacer::Report(const Frame& frame, Clock::time_point end) {
+  LastLatencyMs = Milliseconds(end - frame.input);
+  LatencyMs += (LastLatencyMs - LatencyMs) * AVERAGE_WEIGHT;
+}
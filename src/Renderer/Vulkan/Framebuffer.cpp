@@ -2,13 +2,18 @@
 
 #include <SDL2/SDL.h>
 
+#include <algorithm>
 #include <array>
+#include <utility>
 
 #include "Renderer/Vulkan/LogicalDevice.hpp"
 #include "Renderer/Vulkan/RenderPass.hpp"
 #include "Renderer/Vulkan/Swapchain.hpp"
+#include "Renderer/Vulkan/Synchronization.hpp"
 
 std::vector<VkFramebuffer> CoffeeMaker::Renderer::Vulkan::Framebuffer::framebuffers{};
+std::vector<CoffeeMaker::Renderer::Vulkan::Framebuffer::Retired>
+    CoffeeMaker::Renderer::Vulkan::Framebuffer::gRetired{};
 
 void CoffeeMaker::Renderer::Vulkan::Framebuffer::CreateFramebuffers() {
   using Swapchain = CoffeeMaker::Renderer::Vulkan::Swapchain;
@@ -47,7 +52,32 @@ void CoffeeMaker::Renderer::Vulkan::Framebuffer::CreateFramebuffers() {
 void CoffeeMaker::Renderer::Vulkan::Framebuffer::ClearFramebuffers() {
   using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
 
+  DestroyRetired(true);
   for (auto framebuffer : framebuffers) {
     vkDestroyFramebuffer(LogicalDevice::GetLogicalDevice(), framebuffer, nullptr);
   }
+  framebuffers.clear();
+}
+
+void CoffeeMaker::Renderer::Vulkan::Framebuffer::RetireFramebuffers(uint64_t lastUse) {
+  gRetired.push_back({.value = lastUse, .framebuffers = std::move(framebuffers)});
+  framebuffers.clear();
+}
+
+void CoffeeMaker::Renderer::Vulkan::Framebuffer::DestroyRetired(bool all) {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+  using Synchronization = CoffeeMaker::Renderer::Vulkan::Synchronization;
+
+  // NOTE: everything goes when destroying, the timeline may already be gone by then
+  uint64_t completed = all ? 0 : Synchronization::CompletedValue();
+  auto expired = [&](const Retired& entry) { return all || entry.value <= completed; };
+  for (Retired& entry : gRetired) {
+    if (!expired(entry)) {
+      continue;
+    }
+    for (auto framebuffer : entry.framebuffers) {
+      vkDestroyFramebuffer(LogicalDevice::GetLogicalDevice(), framebuffer, nullptr);
+    }
+  }
+  gRetired.erase(std::remove_if(gRetired.begin(), gRetired.end(), expired), gRetired.end());
 }
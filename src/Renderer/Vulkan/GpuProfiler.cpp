@@ -0,0 +1,304 @@
+#include "Renderer/Vulkan/GpuProfiler.hpp"
+
+#include <SDL2/SDL.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "Json.hpp"
+#include "Renderer/Vulkan/LogicalDevice.hpp"
+#include "Renderer/Vulkan/PhysicalDevice.hpp"
+#include "Renderer/Vulkan/Synchronization.hpp"
+#include "Renderer/Vulkan/Synchronization2.hpp"
+
+namespace {
+  // NOTE: weight of the newest sample in the moving averages
+  constexpr double AVERAGE_WEIGHT = 0.05;
+}  // namespace
+
+bool CoffeeMaker::Renderer::Vulkan::GpuProfiler::Supported{false};
+bool CoffeeMaker::Renderer::Vulkan::GpuProfiler::Enabled{true};
+double CoffeeMaker::Renderer::Vulkan::GpuProfiler::FrameMs{0.0};
+std::string CoffeeMaker::Renderer::Vulkan::GpuProfiler::LogPath{};
+std::vector<CoffeeMaker::Renderer::Vulkan::GpuProfiler::Slot> CoffeeMaker::Renderer::Vulkan::GpuProfiler::gSlots{};
+size_t CoffeeMaker::Renderer::Vulkan::GpuProfiler::gCurrent{0};
+std::vector<uint32_t> CoffeeMaker::Renderer::Vulkan::GpuProfiler::gOpen{};
+std::vector<CoffeeMaker::Renderer::Vulkan::GpuProfiler::ScopeStats>
+    CoffeeMaker::Renderer::Vulkan::GpuProfiler::gStats{};
+std::unordered_map<std::string, uint32_t> CoffeeMaker::Renderer::Vulkan::GpuProfiler::gStatsIndex{};
+uint64_t CoffeeMaker::Renderer::Vulkan::GpuProfiler::gFrame{0};
+std::vector<uint32_t> CoffeeMaker::Renderer::Vulkan::GpuProfiler::gLastFrame{};
+std::deque<CoffeeMaker::Renderer::Vulkan::GpuProfiler::FrameTimes>
+    CoffeeMaker::Renderer::Vulkan::GpuProfiler::gHistory{};
+uint64_t CoffeeMaker::Renderer::Vulkan::GpuProfiler::gValidMask{0};
+double CoffeeMaker::Renderer::Vulkan::GpuProfiler::gPeriodNs{1.0};
+std::ofstream CoffeeMaker::Renderer::Vulkan::GpuProfiler::gLog{};
+
+void CoffeeMaker::Renderer::Vulkan::GpuProfiler::Create(size_t framesInFlight) {
+  using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  PhysicalDevice* device = PhysicalDevice::GetPhysicalDeviceInUse();
+  uint32_t graphicsFamily = device->QueueFamilies.graphicsFamily.value();
+  uint32_t validBits = device->QueueFamilies.properties[graphicsFamily].timestampValidBits;
+  gPeriodNs = static_cast<double>(device->Properties.limits.timestampPeriod);
+
+  Supported = validBits > 0 && gPeriodNs > 0.0;
+  fmt::print("GPU timestamps: {}\n", Supported ? "on" : "off");
+  if (!Supported) {
+    return;
+  }
+  gValidMask = validBits >= 64 ? UINT64_MAX : (uint64_t{1} << validBits) - 1;
+
+  gSlots.resize(framesInFlight);
+  for (Slot& slot : gSlots) {
+    VkQueryPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = MaxScopes * 2;
+
+    VkResult result = vkCreateQueryPool(LogicalDevice::GetLogicalDevice(), &poolInfo, nullptr, &slot.pool);
+    if (result != VK_SUCCESS) {
+      SDL_LogError(0, "Unable to create the GPU profiler query pool.\nVulkan Error Code: [%d]", result);
+      exit(17);
+    }
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::GpuProfiler::Destroy() {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  for (Slot& slot : gSlots) {
+    vkDestroyQueryPool(LogicalDevice::GetLogicalDevice(), slot.pool, nullptr);
+  }
+  gSlots.clear();
+  gOpen.clear();
+  SetLogPath("");
+}
+
+void CoffeeMaker::Renderer::Vulkan::GpuProfiler::BeginFrame(VkCommandBuffer cmd, size_t frame) {
+  using Synchronization = CoffeeMaker::Renderer::Vulkan::Synchronization;
+
+  gFrame++;
+  gCurrent = frame;
+  gOpen.clear();
+  if (!Supported) {
+    return;
+  }
+
+  // NOTE: oldest first so the log stays in frame order. The current slot was waited for before recording began.
+  uint64_t completed = Synchronization::CompletedValue();
+  std::vector<Slot*> finished{};
+  for (size_t i = 0; i < gSlots.size(); i++) {
+    if (gSlots[i].pending && (i == frame || gSlots[i].value <= completed)) {
+      finished.push_back(&gSlots[i]);
+    }
+  }
+  std::sort(finished.begin(), finished.end(), [](const Slot* a, const Slot* b) { return a->frame < b->frame; });
+  for (Slot* slot : finished) {
+    Read(*slot);
+    slot->pending = false;
+  }
+
+  Slot& slot = gSlots[frame];
+  slot.scopes.clear();
+  slot.queries = 0;
+  if (!Enabled) {
+    return;
+  }
+
+  vkCmdResetQueryPool(cmd, slot.pool, 0, MaxScopes * 2);
+  slot.value = Synchronization::PendingValue();
+  slot.frame = gFrame;
+  slot.pending = true;
+}
+
+void CoffeeMaker::Renderer::Vulkan::GpuProfiler::BeginScope(VkCommandBuffer cmd, const std::string& name) {
+  if (!Supported || gSlots.empty() || !gSlots[gCurrent].pending) {
+    return;
+  }
+
+  Slot& slot = gSlots[gCurrent];
+  if (slot.queries + 2 > MaxScopes * 2) {
+    // NOTE: still tracked so the matching EndScope closes the right scope
+    gOpen.push_back(UINT32_MAX);
+    return;
+  }
+
+  std::string path = name;
+  uint32_t depth = 0;
+  for (auto open = gOpen.rbegin(); open != gOpen.rend(); open++) {
+    if (*open != UINT32_MAX) {
+      path = gStats[slot.scopes[*open].stats].path + "/" + name;
+      depth = gStats[slot.scopes[*open].stats].depth + 1;
+      break;
+    }
+  }
+
+  Scope scope{};
+  scope.stats = StatsIndex(path, name, depth);
+  scope.begin = slot.queries++;
+  WriteTimestamp(cmd, scope.begin);
+  gOpen.push_back(static_cast<uint32_t>(slot.scopes.size()));
+  slot.scopes.push_back(scope);
+}
+
+void CoffeeMaker::Renderer::Vulkan::GpuProfiler::EndScope(VkCommandBuffer cmd) {
+  if (gOpen.empty()) {
+    return;
+  }
+
+  uint32_t open = gOpen.back();
+  gOpen.pop_back();
+  if (open == UINT32_MAX) {
+    return;
+  }
+
+  Slot& slot = gSlots[gCurrent];
+  slot.scopes[open].end = slot.queries++;
+  WriteTimestamp(cmd, slot.scopes[open].end);
+}
+
+void CoffeeMaker::Renderer::Vulkan::GpuProfiler::FrameSubmitted(size_t frame) {
+  if (gSlots.empty()) {
+    return;
+  }
+
+  gSlots[frame].submitNs =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+}
+
+void CoffeeMaker::Renderer::Vulkan::GpuProfiler::ResetStats() {
+  for (ScopeStats& stats : gStats) {
+    stats.averageMs = 0.0;
+    stats.minMs = 0.0;
+    stats.maxMs = 0.0;
+    stats.samples = 0;
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::GpuProfiler::SetLogPath(const std::string& path) {
+  if (gLog.is_open()) {
+    gLog.close();
+  }
+  LogPath = path;
+  if (path.empty()) {
+    return;
+  }
+
+  gLog.open(path, std::ios::app);
+  if (!gLog) {
+    SDL_LogWarn(0, "Unable to write the GPU profile to %s", path.c_str());
+    LogPath.clear();
+  }
+}
+
+std::vector<const CoffeeMaker::Renderer::Vulkan::GpuProfiler::ScopeStats*>
+CoffeeMaker::Renderer::Vulkan::GpuProfiler::LastFrameScopes() {
+  std::vector<const ScopeStats*> scopes{};
+  for (uint32_t index : gLastFrame) {
+    scopes.push_back(&gStats[index]);
+  }
+  return scopes;
+}
+
+const std::deque<CoffeeMaker::Renderer::Vulkan::GpuProfiler::FrameTimes>&
+CoffeeMaker::Renderer::Vulkan::GpuProfiler::History() {
+  return gHistory;
+}
+
+const std::string& CoffeeMaker::Renderer::Vulkan::GpuProfiler::ScopeName(uint32_t stats) { return gStats[stats].name; }
+
+uint32_t CoffeeMaker::Renderer::Vulkan::GpuProfiler::StatsIndex(const std::string& path, const std::string& name,
+                                                                uint32_t depth) {
+  auto found = gStatsIndex.find(path);
+  if (found != gStatsIndex.end()) {
+    return found->second;
+  }
+
+  uint32_t index = static_cast<uint32_t>(gStats.size());
+  gStats.push_back(ScopeStats{.path = path, .name = name, .depth = depth});
+  gStatsIndex.emplace(path, index);
+  return index;
+}
+
+void CoffeeMaker::Renderer::Vulkan::GpuProfiler::Read(Slot& slot) {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  if (slot.queries == 0) {
+    return;
+  }
+
+  // NOTE: no wait flag, the timeline says the frame is done so the results are available
+  std::vector<uint64_t> timestamps(slot.queries);
+  VkResult result = vkGetQueryPoolResults(LogicalDevice::GetLogicalDevice(), slot.pool, 0, slot.queries,
+                                          timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t),
+                                          VK_QUERY_RESULT_64_BIT);
+  if (result != VK_SUCCESS) {
+    return;
+  }
+
+  auto milliseconds = [](uint64_t begin, uint64_t end) {
+    return static_cast<double>((end - begin) & gValidMask) * gPeriodNs / 1000000.0;
+  };
+
+  std::vector<std::pair<uint32_t, double>> frameScopes{};
+  gLastFrame.clear();
+  FrameTimes times{.frame = slot.frame, .submitNs = slot.submitNs};
+  for (const Scope& scope : slot.scopes) {
+    if (scope.end == UINT32_MAX) {
+      continue;
+    }
+
+    double ms = milliseconds(timestamps[scope.begin], timestamps[scope.end]);
+    ScopeStats& stats = gStats[scope.stats];
+    stats.lastMs = ms;
+    if (stats.samples == 0) {
+      stats.averageMs = ms;
+      stats.minMs = ms;
+      stats.maxMs = ms;
+    } else {
+      stats.averageMs += (ms - stats.averageMs) * AVERAGE_WEIGHT;
+      stats.minMs = std::min(stats.minMs, ms);
+      stats.maxMs = std::max(stats.maxMs, ms);
+    }
+    stats.samples++;
+    frameScopes.emplace_back(scope.stats, ms);
+    gLastFrame.push_back(scope.stats);
+    times.scopes.push_back(ScopeTime{.stats = scope.stats,
+                                     .beginMs = milliseconds(timestamps.front(), timestamps[scope.begin]),
+                                     .endMs = milliseconds(timestamps.front(), timestamps[scope.end])});
+  }
+  FrameMs = milliseconds(timestamps.front(), timestamps.back());
+  gHistory.push_back(std::move(times));
+  if (gHistory.size() > MaxHistory) {
+    gHistory.pop_front();
+  }
+
+  if (!gLog.is_open()) {
+    return;
+  }
+  gLog << fmt::format("{{\"frame\":{},\"gpuMs\":{:.4f},\"scopes\":[", slot.frame, FrameMs);
+  for (size_t i = 0; i < frameScopes.size(); i++) {
+    gLog << fmt::format("{}{{\"path\":\"{}\",\"ms\":{:.4f}}}", i == 0 ? "" : ",",
+                        CoffeeMaker::EscapeJson(gStats[frameScopes[i].first].path), frameScopes[i].second);
+  }
+  gLog << "]}\n";
+}
+
+void CoffeeMaker::Renderer::Vulkan::GpuProfiler::WriteTimestamp(VkCommandBuffer cmd, uint32_t query) {
+  using Synchronization2 = CoffeeMaker::Renderer::Vulkan::Synchronization2;
+
+  // NOTE: written once everything recorded before it has finished, consecutive scopes split the frame between them
+  Synchronization2::WriteTimestamp(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, gSlots[gCurrent].pool, query);
+}
+
+CoffeeMaker::Renderer::Vulkan::GpuScope::GpuScope(VkCommandBuffer commandBuffer, const std::string& name)
+    : cmd(commandBuffer) {
+  CoffeeMaker::Renderer::Vulkan::GpuProfiler::BeginScope(cmd, name);
+}
+
+CoffeeMaker::Renderer::Vulkan::GpuScope::~GpuScope() { CoffeeMaker::Renderer::Vulkan::GpuProfiler::EndScope(cmd); }
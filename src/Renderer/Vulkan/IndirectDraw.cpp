@@ -0,0 +1,71 @@
+#include "Renderer/Vulkan/IndirectDraw.hpp"
+
+#include <SDL2/SDL.h>
+#include <fmt/core.h>
+
+#include "Renderer/Vulkan/LogicalDevice.hpp"
+#include "Renderer/Vulkan/PhysicalDevice.hpp"
+
+bool CoffeeMaker::Renderer::Vulkan::IndirectDraw::Supported{false};
+bool CoffeeMaker::Renderer::Vulkan::IndirectDraw::MultiDraw{false};
+bool CoffeeMaker::Renderer::Vulkan::IndirectDraw::DrawCount{false};
+PFN_vkCmdDrawIndexedIndirectCountKHR CoffeeMaker::Renderer::Vulkan::IndirectDraw::gCmdDrawIndexedIndirectCount{
+    nullptr};
+
+void CoffeeMaker::Renderer::Vulkan::IndirectDraw::EnableIfSupported(std::vector<const char*>& deviceExtensions) {
+  using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  PhysicalDevice* device = PhysicalDevice::GetPhysicalDeviceInUse();
+
+  Supported = device->Features.drawIndirectFirstInstance == VK_TRUE;
+  if (!Supported) {
+    fmt::print("GPU driven rendering: off, drawIndirectFirstInstance is not supported\n");
+    return;
+  }
+  MultiDraw = device->Features.multiDrawIndirect == VK_TRUE;
+  DrawCount = device->IsExtensionSupported(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+
+  if (DrawCount) {
+    deviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+  }
+
+  LogicalDevice::CoreFeatures().drawIndirectFirstInstance = VK_TRUE;
+  LogicalDevice::CoreFeatures().multiDrawIndirect = MultiDraw ? VK_TRUE : VK_FALSE;
+
+  fmt::print("GPU driven rendering: on, multi draw: {}, draw count: {}\n", MultiDraw ? "on" : "off",
+             DrawCount ? "on" : "off");
+}
+
+void CoffeeMaker::Renderer::Vulkan::IndirectDraw::LoadFunctions(VkDevice device) {
+  if (!DrawCount) {
+    return;
+  }
+
+  gCmdDrawIndexedIndirectCount =
+      (PFN_vkCmdDrawIndexedIndirectCountKHR)vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR");
+  if (gCmdDrawIndexedIndirectCount == nullptr) {
+    SDL_LogWarn(0, "Unable to load vkCmdDrawIndexedIndirectCountKHR, drawing every indirect command.");
+    DrawCount = false;
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::IndirectDraw::DrawIndexedIndirectCount(VkCommandBuffer cmd, VkBuffer buffer,
+                                                                           VkDeviceSize offset, VkBuffer countBuffer,
+                                                                           VkDeviceSize countOffset,
+                                                                           uint32_t maxDrawCount, uint32_t stride) {
+  if (DrawCount) {
+    gCmdDrawIndexedIndirectCount(cmd, buffer, offset, countBuffer, countOffset, maxDrawCount, stride);
+    return;
+  }
+
+  if (MultiDraw) {
+    vkCmdDrawIndexedIndirect(cmd, buffer, offset, maxDrawCount, stride);
+    return;
+  }
+
+  // NOTE: without multiDrawIndirect a draw may only read a single command
+  for (uint32_t i = 0; i < maxDrawCount; i++) {
+    vkCmdDrawIndexedIndirect(cmd, buffer, offset + static_cast<VkDeviceSize>(i) * stride, 1, stride);
+  }
+}
@@ -14,6 +14,8 @@ std::vector<const char*> CoffeeMaker::Renderer::Vulkan::LogicalDevice::Layers{};
 std::vector<VkDeviceQueueCreateInfo> CoffeeMaker::Renderer::Vulkan::LogicalDevice::queueCreateInfos{};
 VkDeviceCreateInfo CoffeeMaker::Renderer::Vulkan::LogicalDevice::logicalDeviceCreateInfo{};
 bool CoffeeMaker::Renderer::Vulkan::LogicalDevice::validationLayersEnabled{false};
+void* CoffeeMaker::Renderer::Vulkan::LogicalDevice::gFeatureChain{nullptr};
+VkPhysicalDeviceFeatures2 CoffeeMaker::Renderer::Vulkan::LogicalDevice::gCoreFeatures{};
 
 VkDevice CoffeeMaker::Renderer::Vulkan::LogicalDevice::GetLogicalDevice() { return gLogicalDevice; }
 
@@ -25,6 +27,16 @@ void CoffeeMaker::Renderer::Vulkan::LogicalDevice::SetExentions(const std::vecto
 
 void CoffeeMaker::Renderer::Vulkan::LogicalDevice::SetLayers(const std::vector<const char*>& l) { Layers = l; }
 
+void CoffeeMaker::Renderer::Vulkan::LogicalDevice::AddFeatures(void* features) {
+  VkBaseOutStructure* base = reinterpret_cast<VkBaseOutStructure*>(features);
+  base->pNext = reinterpret_cast<VkBaseOutStructure*>(gFeatureChain);
+  gFeatureChain = features;
+}
+
+VkPhysicalDeviceFeatures& CoffeeMaker::Renderer::Vulkan::LogicalDevice::CoreFeatures() {
+  return gCoreFeatures.features;
+}
+
 void CoffeeMaker::Renderer::Vulkan::LogicalDevice::CreateLogicalDevice(bool enableValidationLayers) {
   using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
   using QueueFamilies = CoffeeMaker::Renderer::Vulkan::VulkanQueueFamilyIndices;
@@ -32,6 +44,10 @@ void CoffeeMaker::Renderer::Vulkan::LogicalDevice::CreateLogicalDevice(bool enab
 
   validationLayersEnabled = enableValidationLayers;
 
+  // NOTE: core features are chained in as well since pEnabledFeatures is left empty
+  gCoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  AddFeatures(&gCoreFeatures);
+
   InitCreateQueueInfos();
   InitLogicalDeviceCreateInfo();
 
@@ -51,7 +67,8 @@ void CoffeeMaker::Renderer::Vulkan::LogicalDevice::CreateLogicalDevice(bool enab
 
 void CoffeeMaker::Renderer::Vulkan::LogicalDevice::InitLogicalDeviceCreateInfo() {
   logicalDeviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-  logicalDeviceCreateInfo.pNext = nullptr;
+  // NOTE: optional features (extended dynamic state, etc...) are chained in by their owners
+  logicalDeviceCreateInfo.pNext = gFeatureChain;
   logicalDeviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
   logicalDeviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
   logicalDeviceCreateInfo.pEnabledFeatures = nullptr;  // NOTE: Optional
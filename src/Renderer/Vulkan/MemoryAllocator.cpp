@@ -4,6 +4,7 @@
 
 VmaAllocator CoffeeMaker::Renderer::Vulkan::MemoryAllocator::gAllocator{VK_NULL_HANDLE};
 VmaAllocatorCreateInfo CoffeeMaker::Renderer::Vulkan::MemoryAllocator::gAllocatorCreateInfo{};
+std::atomic<size_t> CoffeeMaker::Renderer::Vulkan::MemoryAllocator::UploadedBytes{0};
 
 void CoffeeMaker::Renderer::Vulkan::MemoryAllocator::CreateAllocator(VkPhysicalDevice physicalDevice,
                                                                      VkDevice logicalDevice, VkInstance instance) {
@@ -60,6 +61,7 @@ void CoffeeMaker::Renderer::Vulkan::MapMemory(const void* pData, size_t size, Vm
   void* data;
   vmaMapMemory(MemAlloc::GetAllocator(), allocation, &data);
   memcpy(data, pData, size);
+  MemAlloc::UploadedBytes.fetch_add(size, std::memory_order_relaxed);
 }
 
 void CoffeeMaker::Renderer::Vulkan::UnmapMemory(VmaAllocation allocation) {
@@ -73,3 +75,13 @@ void CoffeeMaker::Renderer::Vulkan::FlushMemory(VmaAllocation allocation, VkDevi
 
   vmaFlushAllocation(MemAlloc::GetAllocator(), allocation, offset, size);
 }
+
+void CoffeeMaker::Renderer::Vulkan::ReadMemory(void* pData, size_t size, VmaAllocation allocation) {
+  using MemAlloc = CoffeeMaker::Renderer::Vulkan::MemoryAllocator;
+
+  void* data;
+  vmaMapMemory(MemAlloc::GetAllocator(), allocation, &data);
+  vmaInvalidateAllocation(MemAlloc::GetAllocator(), allocation, 0, size);
+  memcpy(pData, data, size);
+  vmaUnmapMemory(MemAlloc::GetAllocator(), allocation);
+}
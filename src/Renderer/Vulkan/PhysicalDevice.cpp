@@ -1,5 +1,7 @@
 #include "Renderer/Vulkan/PhysicalDevice.hpp"
 
+#include <cstring>
+
 #include "Renderer/Vulkan/Surface.hpp"
 
 std::vector<CoffeeMaker::Renderer::Vulkan::PhysicalDevice*>
@@ -180,3 +182,66 @@ bool CoffeeMaker::Renderer::Vulkan::PhysicalDevice::AreExtensionsSupported(
 
   return requiredExtensions.empty();
 }
+
+bool CoffeeMaker::Renderer::Vulkan::PhysicalDevice::IsExtensionSupported(const char* extension) {
+  for (const auto& supported : SupportedExtensions) {
+    if (strcmp(supported.extensionName, extension) == 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool CoffeeMaker::Renderer::Vulkan::PhysicalDevice::QueryFeatures2(void* features) {
+  if (Properties.apiVersion < VK_API_VERSION_1_1) {
+    return false;
+  }
+
+  VkPhysicalDeviceFeatures2 features2{};
+  features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  features2.pNext = features;
+  vkGetPhysicalDeviceFeatures2(vkpPhysicalDevice, &features2);
+
+  return true;
+}
+
+bool CoffeeMaker::Renderer::Vulkan::PhysicalDevice::QueryProperties2(void* properties) {
+  if (Properties.apiVersion < VK_API_VERSION_1_1) {
+    return false;
+  }
+
+  VkPhysicalDeviceProperties2 properties2{};
+  properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  properties2.pNext = properties;
+  vkGetPhysicalDeviceProperties2(vkpPhysicalDevice, &properties2);
+
+  return true;
+}
+
+VkFormat CoffeeMaker::Renderer::Vulkan::PhysicalDevice::FindSupportedFormat(const std::vector<VkFormat>& candidates,
+                                                                            VkImageTiling tiling,
+                                                                            VkFormatFeatureFlags features) {
+  for (VkFormat format : candidates) {
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(vkpPhysicalDevice, format, &properties);
+
+    VkFormatFeatureFlags supported =
+        tiling == VK_IMAGE_TILING_LINEAR ? properties.linearTilingFeatures : properties.optimalTilingFeatures;
+    if ((supported & features) == features) {
+      return format;
+    }
+  }
+
+  return VK_FORMAT_UNDEFINED;
+}
+
+bool CoffeeMaker::Renderer::Vulkan::PhysicalDevice::SupportsLazilyAllocatedMemory() {
+  for (uint32_t i = 0; i < MemoryProperties.memoryTypeCount; i++) {
+    if (MemoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) {
+      return true;
+    }
+  }
+
+  return false;
+}
@@ -1,8 +1,20 @@
 #include "Renderer/Vulkan/Pipeline.hpp"
 
+#include <SDL2/SDL.h>
+
+#include <chrono>
+
+#include "Renderer/Vulkan/DynamicRendering.hpp"
+#include "Renderer/Vulkan/DynamicState.hpp"
 #include "Renderer/Vulkan/LogicalDevice.hpp"
+#include "Renderer/Vulkan/PipelineCache.hpp"
+#include "Renderer/Vulkan/PipelineCompiler.hpp"
+#include "Renderer/Vulkan/PipelineLibrary.hpp"
+#include "Renderer/Vulkan/PipelineRegistry.hpp"
 #include "Renderer/Vulkan/RenderPass.hpp"
 
+CoffeeMaker::Renderer::IdPool CoffeeMaker::Renderer::Vulkan::Pipeline::Ids{"pipeline", Pipeline::IdBits};
+
 VkPipelineShaderStageCreateInfo CoffeeMaker::Renderer::Vulkan::CreatePipelineShaderStageInfo(
     VkShaderStageFlagBits stage, VkShaderModule shaderModule) {
   VkPipelineShaderStageCreateInfo info{};
@@ -104,7 +116,9 @@ VkRect2D CoffeeMaker::Renderer::Vulkan::CreateScissor() {
  * VK_POLYGON_MODE_FILL_RECTANGLE_NV = 1000153000,
  * VK_POLYGON_MODE_MAX_ENUM = 0x7FFFFFFF
  */
-VkPipelineRasterizationStateCreateInfo CoffeeMaker::Renderer::Vulkan::CreateRasterizer(VkPolygonMode polygonMode) {
+VkPipelineRasterizationStateCreateInfo CoffeeMaker::Renderer::Vulkan::CreateRasterizer(VkPolygonMode polygonMode,
+                                                                                       VkCullModeFlags cullMode,
+                                                                                       VkFrontFace frontFace) {
   VkPipelineRasterizationStateCreateInfo info = {};
 
   info.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -114,9 +128,9 @@ VkPipelineRasterizationStateCreateInfo CoffeeMaker::Renderer::Vulkan::CreateRast
   info.rasterizerDiscardEnable = VK_FALSE;
   info.polygonMode = polygonMode;
   info.lineWidth = 1.0f;
-  // NOTE: no backface culling
-  info.cullMode = VK_CULL_MODE_NONE;
-  info.frontFace = VK_FRONT_FACE_CLOCKWISE;
+  // NOTE: defaults to no backface culling
+  info.cullMode = cullMode;
+  info.frontFace = frontFace;
   // NOTE: no depth bias
   info.depthBiasEnable = VK_FALSE;
   info.depthBiasConstantFactor = 0.0f;  // Optional
@@ -204,35 +218,86 @@ VkPipelineLayoutCreateInfo CoffeeMaker::Renderer::Vulkan::CreatePipelineLayoutIn
   return info;
 }
 
-void CoffeeMaker::Renderer::Vulkan::Pipeline::CreatePipeline(CoffeeMaker::Renderer::Vulkan::PipelineCreateInfo info) {
-  using RenderPass = CoffeeMaker::Renderer::Vulkan::RenderPass;
-  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+void CoffeeMaker::Renderer::Vulkan::Pipeline::CreatePipeline(
+    CoffeeMaker::Renderer::Vulkan::PipelineCreateInfo createInfo) {
+  using PipelineCompiler = CoffeeMaker::Renderer::Vulkan::PipelineCompiler;
 
-  VkGraphicsPipelineCreateInfo pipelineInfo = {};
+  Prepare(createInfo);
+  Compile();
+  PipelineCompiler::Record(*this);
+}
 
+void CoffeeMaker::Renderer::Vulkan::Pipeline::Prepare(CoffeeMaker::Renderer::Vulkan::PipelineCreateInfo createInfo) {
+  // NOTE: keep our own copy, the create infos below point into it
+  info = createInfo;
   shaderStages.push_back(CreateVertexShaderInfo(info.vertexShader));
   shaderStages.push_back(CreateFragmentShaderInfo(info.fragmentShader));
+  for (size_t i = 0; i < shaderStages.size(); i++) {
+    PrepareSpecialization(shaderStages[i], specializations[i]);
+  }
   vertexInputInfo = CreateVertexInputInfo(info.vertexInputs);
-  inputAssembly = CreateInputAssembly();
+  inputAssembly = CreateInputAssembly(info.renderState.topology);
   viewport = CreateViewport();
   scissor = CreateScissor();
   viewportState = CreateViewportState(viewport, scissor);
-  rasterizer = CreateRasterizer();
+  rasterizer = CreateRasterizer(info.renderState.polygonMode, info.renderState.cullMode, info.renderState.frontFace);
   colorBlendAttachment = CreateColorBlendAttachState();
   colorBlending = CreateColorBlendState(colorBlendAttachment);
   multisampling = MultiSampling();
-  depthStencil = CreateDepthStencilCreateInfo();
+  depthStencil = CreateDepthStencilCreateInfo(info.renderState.depthTest, info.renderState.depthWrite,
+                                              info.renderState.depthCompareOp);
   layoutInfo = CreatePipelineLayoutInfo(info.pushConstantRangeCount,
                                         info.pushConstantRangeCount == 0 ? nullptr : &info.pushConstants);
+  for (const auto& bindings : info.descriptorSets) {
+    sharedSetLayouts.push_back(PipelineRegistry::GetDescriptorSetLayout(bindings));
+    setLayouts.push_back(sharedSetLayouts.back()->layout);
+  }
+  layoutInfo.setLayoutCount = setLayouts.size();
+  layoutInfo.pSetLayouts = setLayouts.empty() ? nullptr : setLayouts.data();
 
+  // NOTE: with extended dynamic state the render state above is only a placeholder, see DynamicState
+  DynamicState::AppendDynamicStates(dynamicStates);
   dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
   dynamicState.dynamicStateCount = dynamicStates.size();
   dynamicState.pDynamicStates = dynamicStates.data();
 
-  VkResult result = vkCreatePipelineLayout(LogicalDevice::GetLogicalDevice(), &layoutInfo, nullptr, &layout);
-  if (result != VK_SUCCESS) {
-    abort();
+  // NOTE: identical layouts are shared between pipelines
+  sharedLayout = PipelineRegistry::GetPipelineLayout(layoutInfo);
+  layout = sharedLayout->layout;
+}
+
+void CoffeeMaker::Renderer::Vulkan::Pipeline::Compile() {
+  using PipelineLibrary = CoffeeMaker::Renderer::Vulkan::PipelineLibrary;
+
+  // NOTE: vkCreateGraphicsPipelines and the pipeline cache are both safe to use from any thread
+  auto start = std::chrono::steady_clock::now();
+  if (PipelineLibrary::Enabled) {
+    // NOTE: fast link from the cached parts now, the optimized link is swapped in once it is built
+    pPipeline = PipelineLibrary::Link(*this, false);
+    needsOptimization = true;
+  } else {
+    CompileMonolithic();
   }
+  compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  ready.store(true, std::memory_order_release);
+}
+
+void CoffeeMaker::Renderer::Vulkan::Pipeline::Optimize() {
+  using PipelineLibrary = CoffeeMaker::Renderer::Vulkan::PipelineLibrary;
+
+  auto start = std::chrono::steady_clock::now();
+  optimizedPipeline = PipelineLibrary::Link(*this, true);
+  optimizeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  needsOptimization = false;
+}
+
+void CoffeeMaker::Renderer::Vulkan::Pipeline::CompileMonolithic() {
+  using RenderPass = CoffeeMaker::Renderer::Vulkan::RenderPass;
+  using DynamicRendering = CoffeeMaker::Renderer::Vulkan::DynamicRendering;
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+  using PipelineCache = CoffeeMaker::Renderer::Vulkan::PipelineCache;
+
+  VkGraphicsPipelineCreateInfo pipelineInfo = {};
 
   pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
   pipelineInfo.stageCount = shaderStages.size();
@@ -246,25 +311,79 @@ void CoffeeMaker::Renderer::Vulkan::Pipeline::CreatePipeline(CoffeeMaker::Render
   pipelineInfo.pColorBlendState = &colorBlending;
   pipelineInfo.pDynamicState = &dynamicState;
   pipelineInfo.layout = layout;
-  pipelineInfo.renderPass = RenderPass::GetRenderPass();
+  // NOTE: with dynamic rendering the pipeline only depends on the attachment formats, not on a render pass
+  VkPipelineRenderingCreateInfo renderingInfo = DynamicRendering::PipelineRenderingInfo();
+  if (DynamicRendering::Supported) {
+    pipelineInfo.pNext = &renderingInfo;
+    pipelineInfo.renderPass = VK_NULL_HANDLE;
+  } else {
+    pipelineInfo.renderPass = RenderPass::GetRenderPass();
+  }
   pipelineInfo.subpass = 0;
   pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;  // Optional
   pipelineInfo.basePipelineIndex = -1;               // Optional
 
-  result = vkCreateGraphicsPipelines(LogicalDevice::GetLogicalDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr,
-                                     &pPipeline);
+  VkResult result = vkCreateGraphicsPipelines(LogicalDevice::GetLogicalDevice(), PipelineCache::GetPipelineCache(),
+                                              1, &pipelineInfo, nullptr, &pPipeline);
   if (result != VK_SUCCESS) {
+    SDL_LogError(0, "Unable to create Vulkan Graphics Pipeline.\nVulkan Error Code: [%d]", result);
     exit(12);
   }
 }
 
+void CoffeeMaker::Renderer::Vulkan::Pipeline::PrepareSpecialization(VkPipelineShaderStageCreateInfo& stage,
+                                                                    StageSpecialization& specialization) {
+  for (const SpecializationConstant& constant : info.specializationConstants) {
+    if ((constant.stages & stage.stage) == 0) {
+      continue;
+    }
+
+    VkSpecializationMapEntry entry{};
+    entry.constantID = constant.id;
+    entry.offset = specialization.data.size() * sizeof(uint32_t);
+    entry.size = sizeof(uint32_t);
+    specialization.entries.push_back(entry);
+    specialization.data.push_back(constant.value);
+  }
+
+  if (specialization.entries.empty()) {
+    return;
+  }
+
+  specialization.info.mapEntryCount = specialization.entries.size();
+  specialization.info.pMapEntries = specialization.entries.data();
+  specialization.info.dataSize = specialization.data.size() * sizeof(uint32_t);
+  specialization.info.pData = specialization.data.data();
+  stage.pSpecializationInfo = &specialization.info;
+}
+
+bool CoffeeMaker::Renderer::Vulkan::Pipeline::IsReady() const { return ready.load(std::memory_order_acquire); }
+
+void CoffeeMaker::Renderer::Vulkan::Pipeline::Wait() const {
+  if (!IsReady() && compiled.valid()) {
+    compiled.wait();
+  }
+}
+
 CoffeeMaker::Renderer::Vulkan::Pipeline::Pipeline() = default;
 
 CoffeeMaker::Renderer::Vulkan::Pipeline::~Pipeline() {
+  using PipelineCompiler = CoffeeMaker::Renderer::Vulkan::PipelineCompiler;
+
+  // NOTE: frames in flight may still be drawing with it, retiring defers the destruction instead of waiting
+  PipelineCompiler::Retire(pPipeline);
+  PipelineCompiler::Retire(optimizedPipeline);
+  // NOTE: the layout is released with sharedLayout once no other pipeline references it
+}
+
+CoffeeMaker::Renderer::Vulkan::PipelineLayout::~PipelineLayout() {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  vkDestroyPipelineLayout(LogicalDevice::GetLogicalDevice(), layout, nullptr);
+}
+
+CoffeeMaker::Renderer::Vulkan::DescriptorSetLayout::~DescriptorSetLayout() {
   using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
-  VkDevice ld = LogicalDevice::GetLogicalDevice();
 
-  vkDeviceWaitIdle(ld);
-  vkDestroyPipeline(ld, pPipeline, nullptr);
-  vkDestroyPipelineLayout(ld, layout, nullptr);
+  vkDestroyDescriptorSetLayout(LogicalDevice::GetLogicalDevice(), layout, nullptr);
 }
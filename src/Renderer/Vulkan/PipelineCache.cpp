@@ -0,0 +1,257 @@
+#include "Renderer/Vulkan/PipelineCache.hpp"
+
+#include <SDL2/SDL.h>
+#include <fmt/core.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "Renderer/Vulkan/LogicalDevice.hpp"
+#include "Renderer/Vulkan/PhysicalDevice.hpp"
+
+namespace {
+  // NOTE: "CMPC" - CoffeeMaker Pipeline Cache
+  constexpr uint32_t PIPELINE_CACHE_MAGIC = 0x43504d43;
+  constexpr uint32_t PIPELINE_CACHE_VERSION = 1;
+}  // namespace
+
+VkPipelineCache CoffeeMaker::Renderer::Vulkan::PipelineCache::gPipelineCache{VK_NULL_HANDLE};
+std::string CoffeeMaker::Renderer::Vulkan::PipelineCache::gFilePath{};
+bool CoffeeMaker::Renderer::Vulkan::PipelineCache::gWarm{false};
+size_t CoffeeMaker::Renderer::Vulkan::PipelineCache::gLastSavedSize{0};
+uint32_t CoffeeMaker::Renderer::Vulkan::PipelineCache::gLastSaveTicks{0};
+uint32_t CoffeeMaker::Renderer::Vulkan::PipelineCache::gCreatedTicks{0};
+std::future<bool> CoffeeMaker::Renderer::Vulkan::PipelineCache::gPendingSave{};
+uint32_t CoffeeMaker::Renderer::Vulkan::PipelineCache::gPipelinesCreated{0};
+double CoffeeMaker::Renderer::Vulkan::PipelineCache::gPipelineCreationMs{0.0};
+const uint32_t CoffeeMaker::Renderer::Vulkan::PipelineCache::SaveIntervalMs{60000};
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCache::CreatePipelineCache(const std::string& filename) {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  // NOTE: the base path may be read-only (app bundles, install dirs), the pref path is always writable
+  char* prefPath = SDL_GetPrefPath("obscurelyme", "CoffeeRender");
+  if (prefPath != nullptr) {
+    gFilePath = fmt::format("{}{}", prefPath, filename);
+    SDL_free(prefPath);
+  } else {
+    gFilePath = fmt::format("{}{}", SDL_GetBasePath(), filename);
+  }
+
+  std::vector<char> fileData = LoadFromDisk();
+  gWarm = IsValid(fileData);
+
+  VkPipelineCacheCreateInfo createInfo{};
+  createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  createInfo.pNext = nullptr;
+  createInfo.flags = 0;
+  if (gWarm) {
+    createInfo.initialDataSize = fileData.size() - sizeof(PipelineCacheFileHeader);
+    createInfo.pInitialData = fileData.data() + sizeof(PipelineCacheFileHeader);
+  } else {
+    createInfo.initialDataSize = 0;
+    createInfo.pInitialData = nullptr;
+  }
+
+  VkResult result = vkCreatePipelineCache(LogicalDevice::GetLogicalDevice(), &createInfo, nullptr, &gPipelineCache);
+  if (result != VK_SUCCESS && gWarm) {
+    // NOTE: the driver rejected data that passed our checks, start over with an empty cache
+    SDL_LogWarn(0, "Vulkan rejected the pipeline cache on disk, starting with an empty one.");
+    gWarm = false;
+    createInfo.initialDataSize = 0;
+    createInfo.pInitialData = nullptr;
+    result = vkCreatePipelineCache(LogicalDevice::GetLogicalDevice(), &createInfo, nullptr, &gPipelineCache);
+  }
+
+  if (result != VK_SUCCESS) {
+    SDL_LogError(0, "Unable to create Vulkan Pipeline Cache.\nVulkan Error Code: [%d]", result);
+    exit(9999);
+  }
+
+  gLastSavedSize = createInfo.initialDataSize;
+  gLastSaveTicks = SDL_GetTicks();
+  gCreatedTicks = gLastSaveTicks;
+}
+
+VkPipelineCache CoffeeMaker::Renderer::Vulkan::PipelineCache::GetPipelineCache() { return gPipelineCache; }
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCache::Destroy() {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  Save();
+  vkDestroyPipelineCache(LogicalDevice::GetLogicalDevice(), gPipelineCache, nullptr);
+  gPipelineCache = VK_NULL_HANDLE;
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCache::Save() {
+  if (gPendingSave.valid()) {
+    gPendingSave.wait();
+    gPendingSave = {};
+  }
+
+  std::vector<char> data = ReadData();
+  if (data.empty() || !WriteToDisk(gFilePath, data)) {
+    return;
+  }
+
+  gLastSavedSize = data.size() - sizeof(PipelineCacheFileHeader);
+  gLastSaveTicks = SDL_GetTicks();
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCache::Update() {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  if (gPendingSave.valid()) {
+    if (gPendingSave.wait_for(std::chrono::seconds{0}) != std::future_status::ready) {
+      return;
+    }
+    if (!gPendingSave.get()) {
+      // NOTE: nothing reached the disk, saved again on the next interval even if the cache has not grown
+      gLastSavedSize = 0;
+    }
+  }
+
+  if (SDL_GetTicks() - gLastSaveTicks < SaveIntervalMs) {
+    return;
+  }
+  gLastSaveTicks = SDL_GetTicks();
+
+  size_t dataSize = 0;
+  vkGetPipelineCacheData(LogicalDevice::GetLogicalDevice(), gPipelineCache, &dataSize, nullptr);
+  if (dataSize == gLastSavedSize) {
+    return;
+  }
+
+  std::vector<char> data = ReadData();
+  if (data.empty()) {
+    return;
+  }
+  gLastSavedSize = data.size() - sizeof(PipelineCacheFileHeader);
+  gPendingSave = std::async(std::launch::async, [path = gFilePath, data = std::move(data)]() {
+    return WriteToDisk(path, data);
+  });
+}
+
+std::vector<char> CoffeeMaker::Renderer::Vulkan::PipelineCache::ReadData() {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+  using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
+
+  if (gPipelineCache == VK_NULL_HANDLE) {
+    return {};
+  }
+
+  size_t dataSize = 0;
+  vkGetPipelineCacheData(LogicalDevice::GetLogicalDevice(), gPipelineCache, &dataSize, nullptr);
+  std::vector<char> data(sizeof(PipelineCacheFileHeader) + dataSize);
+  VkResult result = vkGetPipelineCacheData(LogicalDevice::GetLogicalDevice(), gPipelineCache, &dataSize,
+                                           data.data() + sizeof(PipelineCacheFileHeader));
+  if (result != VK_SUCCESS) {
+    SDL_LogWarn(0, "Unable to read Vulkan Pipeline Cache data.\nVulkan Error Code: [%d]", result);
+    return {};
+  }
+  data.resize(sizeof(PipelineCacheFileHeader) + dataSize);
+
+  const VkPhysicalDeviceProperties& properties = PhysicalDevice::GetPhysicalDeviceInUse()->Properties;
+  PipelineCacheFileHeader header{};
+  header.magic = PIPELINE_CACHE_MAGIC;
+  header.version = PIPELINE_CACHE_VERSION;
+  header.vendorID = properties.vendorID;
+  header.deviceID = properties.deviceID;
+  header.driverVersion = properties.driverVersion;
+  memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+  header.dataSize = dataSize;
+  memcpy(data.data(), &header, sizeof(header));
+
+  return data;
+}
+
+bool CoffeeMaker::Renderer::Vulkan::PipelineCache::WriteToDisk(const std::string& path,
+                                                               const std::vector<char>& data) {
+  std::string tempPath = fmt::format("{}.tmp", path);
+  {
+    std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+    if (!file.is_open()) {
+      SDL_LogWarn(0, "Unable to write pipeline cache to %s", tempPath.c_str());
+      return false;
+    }
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file.good()) {
+      SDL_LogWarn(0, "Unable to write pipeline cache to %s", tempPath.c_str());
+      return false;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(tempPath, path, error);
+  if (error) {
+    SDL_LogWarn(0, "Unable to move pipeline cache into place: %s", error.message().c_str());
+    std::filesystem::remove(tempPath, error);
+    return false;
+  }
+
+  return true;
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCache::RecordPipelineCreation(double milliseconds) {
+  gPipelinesCreated++;
+  gPipelineCreationMs += milliseconds;
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCache::ReportStartup() {
+  fmt::print("Pipeline cache ({}): {} pipelines created in {:.3f} ms, ready {} ms after loading the cache\n",
+             gWarm ? "warm" : "cold", gPipelinesCreated, gPipelineCreationMs, SDL_GetTicks() - gCreatedTicks);
+}
+
+bool CoffeeMaker::Renderer::Vulkan::PipelineCache::IsWarm() { return gWarm; }
+
+std::vector<char> CoffeeMaker::Renderer::Vulkan::PipelineCache::LoadFromDisk() {
+  std::ifstream file{gFilePath, std::ios::ate | std::ios::binary};
+
+  if (!file.is_open()) {
+    return {};
+  }
+
+  size_t fileSize = (size_t)file.tellg();
+  std::vector<char> buffer(fileSize);
+  file.seekg(0);
+  file.read(buffer.data(), fileSize);
+  file.close();
+
+  return buffer;
+}
+
+bool CoffeeMaker::Renderer::Vulkan::PipelineCache::IsValid(const std::vector<char>& fileData) {
+  using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
+
+  if (fileData.size() < sizeof(PipelineCacheFileHeader)) {
+    return false;
+  }
+
+  PipelineCacheFileHeader header{};
+  memcpy(&header, fileData.data(), sizeof(header));
+
+  const VkPhysicalDeviceProperties& properties = PhysicalDevice::GetPhysicalDeviceInUse()->Properties;
+  if (header.magic != PIPELINE_CACHE_MAGIC || header.version != PIPELINE_CACHE_VERSION ||
+      header.vendorID != properties.vendorID || header.deviceID != properties.deviceID ||
+      header.driverVersion != properties.driverVersion ||
+      memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+    return false;
+  }
+
+  if (header.dataSize != fileData.size() - sizeof(PipelineCacheFileHeader)) {
+    return false;
+  }
+
+  // NOTE: also check the driver's own header, a mismatch here means the blob is corrupt
+  VkPipelineCacheHeaderVersionOne driverHeader{};
+  if (header.dataSize < sizeof(driverHeader)) {
+    return false;
+  }
+  memcpy(&driverHeader, fileData.data() + sizeof(PipelineCacheFileHeader), sizeof(driverHeader));
+
+  return driverHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         driverHeader.vendorID == properties.vendorID && driverHeader.deviceID == properties.deviceID &&
+         memcmp(driverHeader.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
@@ -0,0 +1,302 @@
+#include "Renderer/Vulkan/PipelineCompiler.hpp"
+
+#include <SDL2/SDL.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "Renderer/Vulkan/LogicalDevice.hpp"
+#include "Renderer/Vulkan/PipelineCache.hpp"
+#include "Renderer/Vulkan/Synchronization.hpp"
+
+std::vector<std::thread> CoffeeMaker::Renderer::Vulkan::PipelineCompiler::gWorkers{};
+std::mutex CoffeeMaker::Renderer::Vulkan::PipelineCompiler::gMutex{};
+std::condition_variable CoffeeMaker::Renderer::Vulkan::PipelineCompiler::gCondition{};
+std::condition_variable CoffeeMaker::Renderer::Vulkan::PipelineCompiler::gIdleCondition{};
+bool CoffeeMaker::Renderer::Vulkan::PipelineCompiler::gStopping{false};
+size_t CoffeeMaker::Renderer::Vulkan::PipelineCompiler::gPending{0};
+size_t CoffeeMaker::Renderer::Vulkan::PipelineCompiler::PipelinesCompiled{0};
+size_t CoffeeMaker::Renderer::Vulkan::PipelineCompiler::PipelinesOptimized{0};
+size_t CoffeeMaker::Renderer::Vulkan::PipelineCompiler::PipelinesRebuilt{0};
+double CoffeeMaker::Renderer::Vulkan::PipelineCompiler::SlowestCompileMs{0.0};
+const double CoffeeMaker::Renderer::Vulkan::PipelineCompiler::SlowPipelineMs{50.0};
+std::deque<CoffeeMaker::Renderer::Vulkan::PipelineCompiler::Job>
+    CoffeeMaker::Renderer::Vulkan::PipelineCompiler::gQueue{};
+std::vector<CoffeeMaker::Renderer::Vulkan::PipelineCompiler::Finished>
+    CoffeeMaker::Renderer::Vulkan::PipelineCompiler::gCompleted{};
+std::deque<CoffeeMaker::Renderer::Vulkan::PipelineCompiler::Retired>
+    CoffeeMaker::Renderer::Vulkan::PipelineCompiler::gRetired{};
+std::vector<CoffeeMaker::Renderer::Vulkan::PipelineCompiler::Rebuild>
+    CoffeeMaker::Renderer::Vulkan::PipelineCompiler::gRebuilds{};
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCompiler::Start(size_t threadCount) {
+  if (!gWorkers.empty()) {
+    return;
+  }
+
+  if (threadCount == 0) {
+    // NOTE: leave a core for the render thread, driver compiles rarely scale past a handful of threads
+    size_t hardwareThreads = std::thread::hardware_concurrency();
+    threadCount = std::clamp<size_t>(hardwareThreads > 1 ? hardwareThreads - 1 : 1, 1, 4);
+  }
+
+  gStopping = false;
+  for (size_t i = 0; i < threadCount; i++) {
+    gWorkers.emplace_back(WorkerLoop);
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCompiler::Stop() {
+  {
+    std::lock_guard<std::mutex> lock{gMutex};
+    gStopping = true;
+    gPending -= gQueue.size();
+    gQueue.clear();
+  }
+  gCondition.notify_all();
+
+  for (auto& worker : gWorkers) {
+    worker.join();
+  }
+  gWorkers.clear();
+  gStopping = false;
+
+  Update();
+  gRebuilds.clear();
+
+  // NOTE: only called once the device is idle, nothing can still be using the retired pipelines
+  DestroyRetired();
+}
+
+std::shared_future<void> CoffeeMaker::Renderer::Vulkan::PipelineCompiler::Submit(
+    std::shared_ptr<CoffeeMaker::Renderer::Vulkan::Pipeline> pipeline) {
+  Job job{.pipeline = std::move(pipeline), .promise = std::promise<void>{}};
+  std::shared_future<void> future = job.promise.get_future().share();
+  job.pipeline->compiled = future;
+
+  if (gWorkers.empty()) {
+    job.pipeline->Compile();
+    job.promise.set_value();
+    Record(*job.pipeline);
+    if (job.pipeline->needsOptimization) {
+      SubmitOptimization(job.pipeline);
+    }
+    return future;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{gMutex};
+    job.pipeline->jobs++;
+    gQueue.push_back(std::move(job));
+    gPending++;
+  }
+  gCondition.notify_one();
+
+  return future;
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCompiler::SubmitOptimization(
+    std::shared_ptr<CoffeeMaker::Renderer::Vulkan::Pipeline> pipeline) {
+  if (gWorkers.empty()) {
+    pipeline->Optimize();
+    Promote(*pipeline);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{gMutex};
+    pipeline->jobs++;
+    gQueue.push_back(Job{.pipeline = std::move(pipeline), .promise = std::promise<void>{}, .optimize = true});
+    gPending++;
+  }
+  gCondition.notify_one();
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCompiler::SubmitRebuild(
+    std::shared_ptr<CoffeeMaker::Renderer::Vulkan::Pipeline> target,
+    std::shared_ptr<CoffeeMaker::Renderer::Vulkan::Pipeline> replacement) {
+  if (gWorkers.empty()) {
+    replacement->Compile();
+    Record(*replacement);
+    Swap(target, *replacement);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{gMutex};
+    replacement->jobs++;
+    gQueue.push_back(
+        Job{.pipeline = std::move(replacement), .promise = std::promise<void>{}, .target = std::move(target)});
+    gPending++;
+  }
+  gCondition.notify_one();
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCompiler::Retire(VkPipeline pipeline) {
+  using Synchronization = CoffeeMaker::Renderer::Vulkan::Synchronization;
+
+  if (pipeline != VK_NULL_HANDLE) {
+    gRetired.push_back(Retired{.pipeline = pipeline, .value = Synchronization::PendingValue()});
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCompiler::DestroyRetired() {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  for (const auto& retired : gRetired) {
+    vkDestroyPipeline(LogicalDevice::GetLogicalDevice(), retired.pipeline, nullptr);
+  }
+  gRetired.clear();
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCompiler::Update() {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+  using Synchronization = CoffeeMaker::Renderer::Vulkan::Synchronization;
+
+  std::vector<Finished> completed{};
+  {
+    std::lock_guard<std::mutex> lock{gMutex};
+    completed.swap(gCompleted);
+  }
+
+  // NOTE: the workers hand their references back here so the last one is always released on the render thread
+  for (const auto& finished : completed) {
+    finished.pipeline->jobs--;
+    if (finished.optimize) {
+      Promote(*finished.pipeline);
+    } else {
+      Record(*finished.pipeline);
+    }
+    if (finished.target != nullptr) {
+      gRebuilds.push_back(Rebuild{.target = finished.target, .replacement = finished.pipeline});
+    }
+  }
+
+  // NOTE: a queued job may still read the target's state (or promote an optimized link of the old shaders)
+  for (auto rebuild = gRebuilds.begin(); rebuild != gRebuilds.end();) {
+    if (rebuild->target->jobs.load() == 0) {
+      Swap(rebuild->target, *rebuild->replacement);
+      rebuild = gRebuilds.erase(rebuild);
+    } else {
+      rebuild++;
+    }
+  }
+
+  // NOTE: retired in submission order, the front is always the oldest
+  uint64_t completed = Synchronization::CompletedValue();
+  while (!gRetired.empty() && gRetired.front().value <= completed) {
+    vkDestroyPipeline(LogicalDevice::GetLogicalDevice(), gRetired.front().pipeline, nullptr);
+    gRetired.pop_front();
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCompiler::WaitIdle() {
+  std::unique_lock<std::mutex> lock{gMutex};
+  gIdleCondition.wait(lock, [] { return gPending == 0; });
+}
+
+size_t CoffeeMaker::Renderer::Vulkan::PipelineCompiler::PendingCount() {
+  std::lock_guard<std::mutex> lock{gMutex};
+  return gPending;
+}
+
+bool CoffeeMaker::Renderer::Vulkan::PipelineCompiler::Idle() {
+  std::lock_guard<std::mutex> lock{gMutex};
+  return gPending == 0 && gCompleted.empty() && gRebuilds.empty();
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCompiler::WorkerLoop() {
+  while (true) {
+    Job job{};
+    {
+      std::unique_lock<std::mutex> lock{gMutex};
+      gCondition.wait(lock, [] { return gStopping || !gQueue.empty(); });
+      if (gStopping) {
+        return;
+      }
+      job = std::move(gQueue.front());
+      gQueue.pop_front();
+    }
+
+    if (job.optimize) {
+      job.pipeline->Optimize();
+    } else {
+      job.pipeline->Compile();
+      job.promise.set_value();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock{gMutex};
+      // NOTE: optimized links go to the back of the queue so they never hold up a pipeline that can't draw yet
+      // NOTE: a rebuild is optimized once it has been swapped into its target, see Swap
+      if (!job.optimize && job.target == nullptr && job.pipeline->needsOptimization) {
+        job.pipeline->jobs++;
+        gQueue.push_back(Job{.pipeline = job.pipeline, .promise = std::promise<void>{}, .optimize = true});
+        gPending++;
+        gCondition.notify_one();
+      }
+      gCompleted.push_back(
+          Finished{.pipeline = std::move(job.pipeline), .optimize = job.optimize, .target = std::move(job.target)});
+      gPending--;
+    }
+    gIdleCondition.notify_all();
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCompiler::Promote(CoffeeMaker::Renderer::Vulkan::Pipeline& pipeline) {
+  if (pipeline.optimizedPipeline == VK_NULL_HANDLE) {
+    return;
+  }
+
+  Retire(pipeline.pPipeline);
+  pipeline.pPipeline = pipeline.optimizedPipeline;
+  pipeline.optimizedPipeline = VK_NULL_HANDLE;
+  PipelinesOptimized++;
+
+  fmt::print("Pipeline {:016x} optimized link in {:.3f} ms\n", pipeline.key, pipeline.optimizeMs);
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCompiler::Swap(
+    const std::shared_ptr<CoffeeMaker::Renderer::Vulkan::Pipeline>& target,
+    CoffeeMaker::Renderer::Vulkan::Pipeline& replacement) {
+  // NOTE: frames in flight may still be using the old pipeline, retiring defers its destruction instead of waiting
+  Retire(target->pPipeline);
+  Retire(target->optimizedPipeline);
+  target->pPipeline = replacement.pPipeline;
+  target->optimizedPipeline = VK_NULL_HANDLE;
+  replacement.pPipeline = VK_NULL_HANDLE;
+
+  target->info.vertexShader = replacement.info.vertexShader;
+  target->info.fragmentShader = replacement.info.fragmentShader;
+  target->info.vertexShaderId = replacement.info.vertexShaderId;
+  target->info.fragmentShaderId = replacement.info.fragmentShaderId;
+  for (auto& stage : target->shaderStages) {
+    stage.module = stage.stage == VK_SHADER_STAGE_VERTEX_BIT ? target->info.vertexShader : target->info.fragmentShader;
+  }
+  target->key = replacement.key;
+  target->compileMs = replacement.compileMs;
+  target->needsOptimization = replacement.needsOptimization;
+  PipelinesRebuilt++;
+
+  fmt::print("Pipeline {:016x} rebuilt in {:.3f} ms\n", target->key, replacement.compileMs);
+
+  if (target->needsOptimization) {
+    SubmitOptimization(target);
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineCompiler::Record(const CoffeeMaker::Renderer::Vulkan::Pipeline& pipeline) {
+  using PipelineCache = CoffeeMaker::Renderer::Vulkan::PipelineCache;
+
+  PipelineCache::RecordPipelineCreation(pipeline.compileMs);
+  PipelinesCompiled++;
+  SlowestCompileMs = std::max(SlowestCompileMs, pipeline.compileMs);
+
+  if (pipeline.compileMs >= SlowPipelineMs) {
+    SDL_LogWarn(0, "Slow pipeline %016llx compiled in %.3f ms", (unsigned long long)pipeline.key,
+                pipeline.compileMs);
+  } else {
+    fmt::print("Pipeline {:016x} compiled in {:.3f} ms\n", pipeline.key, pipeline.compileMs);
+  }
+}
@@ -0,0 +1,283 @@
+#include "Renderer/Vulkan/PipelineLibrary.hpp"
+
+#include <SDL2/SDL.h>
+#include <fmt/core.h>
+
+#include <array>
+#include <utility>
+
+#include "Renderer/Vulkan/DynamicRendering.hpp"
+#include "Renderer/Vulkan/DynamicState.hpp"
+#include "Renderer/Vulkan/LogicalDevice.hpp"
+#include "Renderer/Vulkan/PhysicalDevice.hpp"
+#include "Renderer/Vulkan/PipelineCache.hpp"
+#include "Renderer/Vulkan/PipelineCompiler.hpp"
+#include "Renderer/Vulkan/RenderPass.hpp"
+
+bool CoffeeMaker::Renderer::Vulkan::PipelineLibrary::Enabled{false};
+bool CoffeeMaker::Renderer::Vulkan::PipelineLibrary::FastLinking{false};
+VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT CoffeeMaker::Renderer::Vulkan::PipelineLibrary::gFeatures{};
+std::unordered_map<CoffeeMaker::Renderer::Vulkan::PipelineKey, CoffeeMaker::Renderer::Vulkan::PipelineLibrary::Part,
+                   CoffeeMaker::Renderer::Vulkan::PipelineKeyHasher>
+    CoffeeMaker::Renderer::Vulkan::PipelineLibrary::gParts{};
+std::mutex CoffeeMaker::Renderer::Vulkan::PipelineLibrary::gMutex{};
+
+void CoffeeMaker::Renderer::Vulkan::PipelineLibrary::EnableIfSupported(std::vector<const char*>& deviceExtensions) {
+  using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  PhysicalDevice* device = PhysicalDevice::GetPhysicalDeviceInUse();
+
+  if (!device->IsExtensionSupported(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) ||
+      !device->IsExtensionSupported(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)) {
+    return;
+  }
+
+  gFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+  gFeatures.pNext = nullptr;
+  if (!device->QueryFeatures2(&gFeatures) || gFeatures.graphicsPipelineLibrary != VK_TRUE) {
+    return;
+  }
+
+  VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT properties{};
+  properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+  device->QueryProperties2(&properties);
+
+  Enabled = true;
+  FastLinking = properties.graphicsPipelineLibraryFastLinking == VK_TRUE;
+
+  deviceExtensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+  deviceExtensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+  gFeatures = {};
+  gFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+  gFeatures.graphicsPipelineLibrary = VK_TRUE;
+  LogicalDevice::AddFeatures(&gFeatures);
+
+  fmt::print("Graphics pipeline library: on, fast linking: {}\n", FastLinking ? "on" : "off");
+}
+
+VkPipeline CoffeeMaker::Renderer::Vulkan::PipelineLibrary::Link(const CoffeeMaker::Renderer::Vulkan::Pipeline& pipeline,
+                                                                bool optimize) {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+  using PipelineCache = CoffeeMaker::Renderer::Vulkan::PipelineCache;
+
+  std::array<VkPipeline, 4> libraries{
+      GetPart(pipeline, VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT),
+      GetPart(pipeline, VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT),
+      GetPart(pipeline, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT),
+      GetPart(pipeline, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT)};
+
+  VkPipelineLibraryCreateInfoKHR linkInfo{};
+  linkInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+  linkInfo.pNext = nullptr;
+  linkInfo.libraryCount = static_cast<uint32_t>(libraries.size());
+  linkInfo.pLibraries = libraries.data();
+
+  VkGraphicsPipelineCreateInfo pipelineInfo{};
+  pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+  pipelineInfo.pNext = &linkInfo;
+  // NOTE: without link time optimization the driver only stitches the parts together
+  pipelineInfo.flags = optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+  pipelineInfo.layout = pipeline.layout;
+  pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+  pipelineInfo.basePipelineIndex = -1;
+
+  VkPipeline linked{VK_NULL_HANDLE};
+  VkResult result = vkCreateGraphicsPipelines(LogicalDevice::GetLogicalDevice(), PipelineCache::GetPipelineCache(),
+                                              1, &pipelineInfo, nullptr, &linked);
+  if (result != VK_SUCCESS) {
+    SDL_LogError(0, "Unable to link Vulkan Graphics Pipeline Library.\nVulkan Error Code: [%d]", result);
+    exit(12);
+  }
+
+  return linked;
+}
+
+size_t CoffeeMaker::Renderer::Vulkan::PipelineLibrary::PartCount() {
+  std::lock_guard<std::mutex> lock{gMutex};
+  return gParts.size();
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineLibrary::ForgetModule(uint64_t moduleId) {
+  using PipelineCompiler = CoffeeMaker::Renderer::Vulkan::PipelineCompiler;
+
+  std::lock_guard<std::mutex> lock{gMutex};
+  for (auto elem = gParts.begin(); elem != gParts.end();) {
+    if (elem->second.moduleId == moduleId) {
+      PipelineCompiler::Retire(elem->second.pipeline);
+      elem = gParts.erase(elem);
+    } else {
+      elem++;
+    }
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineLibrary::Clear() {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  std::lock_guard<std::mutex> lock{gMutex};
+  for (auto& [key, part] : gParts) {
+    vkDestroyPipeline(LogicalDevice::GetLogicalDevice(), part.pipeline, nullptr);
+  }
+  gParts.clear();
+}
+
+VkPipeline CoffeeMaker::Renderer::Vulkan::PipelineLibrary::GetPart(
+    const CoffeeMaker::Renderer::Vulkan::Pipeline& pipeline, VkGraphicsPipelineLibraryFlagsEXT part) {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  PipelineKey key = MakePartKey(pipeline, part);
+  {
+    std::lock_guard<std::mutex> lock{gMutex};
+    auto elem = gParts.find(key);
+    if (elem != gParts.end()) {
+      return elem->second.pipeline;
+    }
+  }
+
+  // NOTE: compile outside the lock, two threads racing on the same part keep whichever finished first
+  VkPipeline created = CreatePart(pipeline, part);
+
+  std::lock_guard<std::mutex> lock{gMutex};
+  auto [elem, inserted] =
+      gParts.try_emplace(std::move(key), Part{.pipeline = created, .moduleId = PartModuleId(pipeline, part)});
+  if (!inserted) {
+    vkDestroyPipeline(LogicalDevice::GetLogicalDevice(), created, nullptr);
+  }
+
+  return elem->second.pipeline;
+}
+
+VkPipeline CoffeeMaker::Renderer::Vulkan::PipelineLibrary::CreatePart(
+    const CoffeeMaker::Renderer::Vulkan::Pipeline& pipeline, VkGraphicsPipelineLibraryFlagsEXT part) {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+  using PipelineCache = CoffeeMaker::Renderer::Vulkan::PipelineCache;
+  using RenderPass = CoffeeMaker::Renderer::Vulkan::RenderPass;
+  using DynamicRendering = CoffeeMaker::Renderer::Vulkan::DynamicRendering;
+
+  // NOTE: the parts that would name the render pass take the attachment formats instead
+  VkPipelineRenderingCreateInfo renderingInfo = DynamicRendering::PipelineRenderingInfo();
+  VkRenderPass renderPass = DynamicRendering::Supported ? VK_NULL_HANDLE : RenderPass::GetRenderPass();
+
+  VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo{};
+  libraryInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+  libraryInfo.pNext = DynamicRendering::Supported ? &renderingInfo : nullptr;
+  libraryInfo.flags = part;
+
+  VkGraphicsPipelineCreateInfo pipelineInfo{};
+  pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+  pipelineInfo.pNext = &libraryInfo;
+  // NOTE: retaining the link time info is what allows the optimized link later on
+  pipelineInfo.flags =
+      VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+  pipelineInfo.pDynamicState = &pipeline.dynamicState;
+  pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+  pipelineInfo.basePipelineIndex = -1;
+
+  switch (part) {
+    case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+      pipelineInfo.pVertexInputState = &pipeline.vertexInputInfo;
+      pipelineInfo.pInputAssemblyState = &pipeline.inputAssembly;
+      break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+      pipelineInfo.stageCount = 1;
+      pipelineInfo.pStages = &pipeline.shaderStages[0];
+      pipelineInfo.pViewportState = &pipeline.viewportState;
+      pipelineInfo.pRasterizationState = &pipeline.rasterizer;
+      pipelineInfo.layout = pipeline.layout;
+      pipelineInfo.renderPass = renderPass;
+      pipelineInfo.subpass = 0;
+      break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+      pipelineInfo.stageCount = 1;
+      pipelineInfo.pStages = &pipeline.shaderStages[1];
+      pipelineInfo.pDepthStencilState = &pipeline.depthStencil;
+      pipelineInfo.pMultisampleState = &pipeline.multisampling;
+      pipelineInfo.layout = pipeline.layout;
+      pipelineInfo.renderPass = renderPass;
+      pipelineInfo.subpass = 0;
+      break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT:
+      pipelineInfo.pColorBlendState = &pipeline.colorBlending;
+      pipelineInfo.pMultisampleState = &pipeline.multisampling;
+      pipelineInfo.renderPass = renderPass;
+      pipelineInfo.subpass = 0;
+      break;
+    default:
+      break;
+  }
+
+  VkPipeline created{VK_NULL_HANDLE};
+  VkResult result = vkCreateGraphicsPipelines(LogicalDevice::GetLogicalDevice(), PipelineCache::GetPipelineCache(),
+                                              1, &pipelineInfo, nullptr, &created);
+  if (result != VK_SUCCESS) {
+    SDL_LogError(0, "Unable to create Vulkan Graphics Pipeline Library part.\nVulkan Error Code: [%d]", result);
+    exit(12);
+  }
+
+  return created;
+}
+
+CoffeeMaker::Renderer::Vulkan::PipelineKey CoffeeMaker::Renderer::Vulkan::PipelineLibrary::MakePartKey(
+    const CoffeeMaker::Renderer::Vulkan::Pipeline& pipeline, VkGraphicsPipelineLibraryFlagsEXT part) {
+  using DynamicState = CoffeeMaker::Renderer::Vulkan::DynamicState;
+
+  const RenderState& state = pipeline.info.renderState;
+  PipelineKey key{};
+
+  key.Add(part);
+  for (VkDynamicState dynamic : pipeline.dynamicStates) {
+    key.Add(dynamic);
+  }
+
+  switch (part) {
+    case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+      key.Append(MakeVertexInputKey(pipeline.info.vertexInputs));
+      key.Add(DynamicState::ExtendedDynamicState ? DynamicState::TopologyClass(state.topology) : state.topology);
+      break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+      key.Add(pipeline.info.vertexShaderId);
+      key.Append(MakeSpecializationKey(pipeline.info.specializationConstants, VK_SHADER_STAGE_VERTEX_BIT));
+      key.Append(MakePipelineLayoutKey(pipeline.layoutInfo));
+      if (!DynamicState::ExtendedDynamicState) {
+        key.Add(state.cullMode);
+        key.Add(state.frontFace);
+      }
+      if (!DynamicState::ExtendedDynamicState3PolygonMode) {
+        key.Add(state.polygonMode);
+      }
+      key.Append(MakeRenderPassKey());
+      break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+      key.Add(pipeline.info.fragmentShaderId);
+      key.Append(MakeSpecializationKey(pipeline.info.specializationConstants, VK_SHADER_STAGE_FRAGMENT_BIT));
+      key.Append(MakePipelineLayoutKey(pipeline.layoutInfo));
+      if (!DynamicState::ExtendedDynamicState) {
+        key.Add(state.depthTest);
+        key.Add(state.depthWrite);
+        key.Add(state.depthCompareOp);
+      }
+      key.Append(MakeRenderPassKey());
+      break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT:
+      // NOTE: blend and multisample state are fixed for now, only the attachments vary
+      key.Append(MakeRenderPassKey());
+      break;
+    default:
+      break;
+  }
+
+  return key;
+}
+
+uint64_t CoffeeMaker::Renderer::Vulkan::PipelineLibrary::PartModuleId(
+    const CoffeeMaker::Renderer::Vulkan::Pipeline& pipeline, VkGraphicsPipelineLibraryFlagsEXT part) {
+  switch (part) {
+    case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+      return pipeline.info.vertexShaderId;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+      return pipeline.info.fragmentShaderId;
+    default:
+      return 0;
+  }
+}
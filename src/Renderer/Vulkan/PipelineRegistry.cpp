@@ -0,0 +1,391 @@
+#include "Renderer/Vulkan/PipelineRegistry.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <utility>
+
+#include "Renderer/Vulkan/DynamicRendering.hpp"
+#include "Renderer/Vulkan/DynamicState.hpp"
+#include "Renderer/Vulkan/LogicalDevice.hpp"
+#include "Renderer/Vulkan/PipelineCompiler.hpp"
+#include "Renderer/Vulkan/Swapchain.hpp"
+
+std::unordered_map<CoffeeMaker::Renderer::Vulkan::PipelineKey,
+                   std::weak_ptr<CoffeeMaker::Renderer::Vulkan::Pipeline>,
+                   CoffeeMaker::Renderer::Vulkan::PipelineKeyHasher>
+    CoffeeMaker::Renderer::Vulkan::PipelineRegistry::gPipelines{};
+std::unordered_map<CoffeeMaker::Renderer::Vulkan::PipelineKey,
+                   std::weak_ptr<CoffeeMaker::Renderer::Vulkan::PipelineLayout>,
+                   CoffeeMaker::Renderer::Vulkan::PipelineKeyHasher>
+    CoffeeMaker::Renderer::Vulkan::PipelineRegistry::gPipelineLayouts{};
+std::unordered_map<CoffeeMaker::Renderer::Vulkan::PipelineKey,
+                   std::weak_ptr<CoffeeMaker::Renderer::Vulkan::DescriptorSetLayout>,
+                   CoffeeMaker::Renderer::Vulkan::PipelineKeyHasher>
+    CoffeeMaker::Renderer::Vulkan::PipelineRegistry::gDescriptorSetLayouts{};
+std::shared_ptr<CoffeeMaker::Renderer::Vulkan::Pipeline>
+    CoffeeMaker::Renderer::Vulkan::PipelineRegistry::gFallbackPipeline{nullptr};
+std::unordered_map<uint64_t, CoffeeMaker::Renderer::Vulkan::PipelineRegistry::ReplacedModule>
+    CoffeeMaker::Renderer::Vulkan::PipelineRegistry::gReplacedModules{};
+size_t CoffeeMaker::Renderer::Vulkan::PipelineRegistry::Hits{0};
+size_t CoffeeMaker::Renderer::Vulkan::PipelineRegistry::Misses{0};
+std::atomic<size_t> CoffeeMaker::Renderer::Vulkan::PipelineRegistry::FallbackDraws{0};
+std::atomic<size_t> CoffeeMaker::Renderer::Vulkan::PipelineRegistry::SkippedDraws{0};
+
+void CoffeeMaker::Renderer::Vulkan::PipelineKey::Add(uint64_t value) {
+  words.push_back(value);
+  // NOTE: FNV-1a over the 64 bit word
+  hash ^= value;
+  hash *= 1099511628211ull;
+}
+
+bool CoffeeMaker::Renderer::Vulkan::PipelineKey::operator==(const PipelineKey& rhs) const {
+  return hash == rhs.hash && words == rhs.words;
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineKey::Append(const PipelineKey& other) {
+  for (uint64_t word : other.words) {
+    Add(word);
+  }
+}
+
+CoffeeMaker::Renderer::Vulkan::PipelineKey CoffeeMaker::Renderer::Vulkan::MakeVertexInputKey(
+    const VertexInputDescription& inputs) {
+  PipelineKey key{};
+
+  key.Add(inputs.flags);
+  key.Add(inputs.bindings.size());
+  for (const auto& binding : inputs.bindings) {
+    key.Add(binding.binding);
+    key.Add(binding.stride);
+    key.Add(binding.inputRate);
+  }
+  key.Add(inputs.attributes.size());
+  for (const auto& attribute : inputs.attributes) {
+    key.Add(attribute.location);
+    key.Add(attribute.binding);
+    key.Add(attribute.format);
+    key.Add(attribute.offset);
+  }
+
+  return key;
+}
+
+CoffeeMaker::Renderer::Vulkan::PipelineKey CoffeeMaker::Renderer::Vulkan::MakeRenderPassKey() {
+  using Swapchain = CoffeeMaker::Renderer::Vulkan::Swapchain;
+  using DynamicRendering = CoffeeMaker::Renderer::Vulkan::DynamicRendering;
+
+  PipelineKey key{};
+
+  // NOTE: render pass compatibility only depends on the attachment formats, and on whether there is a render pass
+  key.Add(DynamicRendering::Supported);
+  key.Add(Swapchain::GetSwapchain()->surfaceFormat.format);
+  key.Add(Swapchain::GetSwapchain()->depthFormat);
+
+  return key;
+}
+
+CoffeeMaker::Renderer::Vulkan::PipelineKey CoffeeMaker::Renderer::Vulkan::MakePipelineKey(
+    const PipelineCreateInfo& info) {
+  PipelineKey key{};
+
+  key.Add(info.vertexShaderId);
+  key.Add(info.fragmentShaderId);
+  key.Append(MakeVertexInputKey(info.vertexInputs));
+
+  key.Add(info.pushConstantRangeCount);
+  if (info.pushConstantRangeCount > 0) {
+    key.Add(info.pushConstants.stageFlags);
+    key.Add(info.pushConstants.offset);
+    key.Add(info.pushConstants.size);
+  }
+
+  key.Add(info.descriptorSets.size());
+  for (const auto& bindings : info.descriptorSets) {
+    key.Append(MakeDescriptorSetLayoutKey(bindings));
+  }
+
+  key.Add(info.permutation);
+  key.Append(MakeSpecializationKey(info.specializationConstants, VK_SHADER_STAGE_ALL_GRAPHICS));
+
+  // NOTE: dynamic render state is set per draw, so it must not split pipelines into permutations
+  const RenderState& state = info.renderState;
+  if (DynamicState::ExtendedDynamicState) {
+    key.Add(DynamicState::TopologyClass(state.topology));
+  } else {
+    key.Add(state.topology);
+    key.Add(state.cullMode);
+    key.Add(state.frontFace);
+    key.Add(state.depthTest);
+    key.Add(state.depthWrite);
+    key.Add(state.depthCompareOp);
+  }
+  if (!DynamicState::ExtendedDynamicState3PolygonMode) {
+    key.Add(state.polygonMode);
+  }
+
+  key.Append(MakeRenderPassKey());
+
+  return key;
+}
+
+CoffeeMaker::Renderer::Vulkan::PipelineKey CoffeeMaker::Renderer::Vulkan::MakePipelineLayoutKey(
+    const VkPipelineLayoutCreateInfo& layoutInfo) {
+  PipelineKey key{};
+
+  key.Add(layoutInfo.flags);
+  key.Add(layoutInfo.setLayoutCount);
+  for (uint32_t i = 0; i < layoutInfo.setLayoutCount; i++) {
+    key.Add((uint64_t)layoutInfo.pSetLayouts[i]);
+  }
+  key.Add(layoutInfo.pushConstantRangeCount);
+  for (uint32_t i = 0; i < layoutInfo.pushConstantRangeCount; i++) {
+    key.Add(layoutInfo.pPushConstantRanges[i].stageFlags);
+    key.Add(layoutInfo.pPushConstantRanges[i].offset);
+    key.Add(layoutInfo.pPushConstantRanges[i].size);
+  }
+
+  return key;
+}
+
+CoffeeMaker::Renderer::Vulkan::PipelineKey CoffeeMaker::Renderer::Vulkan::MakeDescriptorSetLayoutKey(
+    const std::vector<VkDescriptorSetLayoutBinding>& bindings) {
+  PipelineKey key{};
+
+  key.Add(bindings.size());
+  for (const auto& binding : bindings) {
+    key.Add(binding.binding);
+    key.Add(binding.descriptorType);
+    key.Add(binding.descriptorCount);
+    key.Add(binding.stageFlags);
+  }
+
+  return key;
+}
+
+CoffeeMaker::Renderer::Vulkan::PipelineKey CoffeeMaker::Renderer::Vulkan::MakeSpecializationKey(
+    const std::vector<SpecializationConstant>& constants, VkShaderStageFlags stages) {
+  PipelineKey key{};
+
+  for (const auto& constant : constants) {
+    if ((constant.stages & stages) == 0) {
+      continue;
+    }
+    key.Add(constant.id);
+    key.Add(constant.value);
+    key.Add(constant.stages & stages);
+  }
+
+  return key;
+}
+
+std::shared_ptr<CoffeeMaker::Renderer::Vulkan::Pipeline> CoffeeMaker::Renderer::Vulkan::PipelineRegistry::GetPipeline(
+    const PipelineCreateInfo& info) {
+  using PipelineCompiler = CoffeeMaker::Renderer::Vulkan::PipelineCompiler;
+
+  PipelineKey key = MakePipelineKey(info);
+
+  auto elem = gPipelines.find(key);
+  if (elem != gPipelines.end()) {
+    if (auto pipeline = elem->second.lock()) {
+      Hits++;
+      // NOTE: the same state may still be compiling in the background, waiting would stall the calling thread
+      return pipeline;
+    }
+  }
+
+  Misses++;
+  auto pipeline = std::make_shared<Pipeline>();
+  pipeline->key = key.hash;
+  pipeline->CreatePipeline(info);
+  gPipelines.insert_or_assign(std::move(key), pipeline);
+  if (pipeline->needsOptimization) {
+    PipelineCompiler::SubmitOptimization(pipeline);
+  }
+
+  return pipeline;
+}
+
+std::shared_ptr<CoffeeMaker::Renderer::Vulkan::Pipeline>
+CoffeeMaker::Renderer::Vulkan::PipelineRegistry::GetPipelineAsync(const PipelineCreateInfo& info) {
+  using PipelineCompiler = CoffeeMaker::Renderer::Vulkan::PipelineCompiler;
+
+  PipelineKey key = MakePipelineKey(info);
+
+  auto elem = gPipelines.find(key);
+  if (elem != gPipelines.end()) {
+    if (auto pipeline = elem->second.lock()) {
+      Hits++;
+      return pipeline;
+    }
+  }
+
+  Misses++;
+  auto pipeline = std::make_shared<Pipeline>();
+  pipeline->key = key.hash;
+  pipeline->Prepare(info);
+  gPipelines.insert_or_assign(std::move(key), pipeline);
+  PipelineCompiler::Submit(pipeline);
+
+  return pipeline;
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineRegistry::CreateFallbackPipeline(const PipelineCreateInfo& info) {
+  using PipelineCompiler = CoffeeMaker::Renderer::Vulkan::PipelineCompiler;
+
+  auto pipeline = std::make_shared<Pipeline>();
+  pipeline->key = MakePipelineKey(info).hash;
+  pipeline->CreatePipeline(info);
+  if (pipeline->needsOptimization) {
+    PipelineCompiler::SubmitOptimization(pipeline);
+  }
+  gFallbackPipeline = std::move(pipeline);
+}
+
+CoffeeMaker::Renderer::Vulkan::Pipeline* CoffeeMaker::Renderer::Vulkan::PipelineRegistry::ResolveForDraw(
+    const std::shared_ptr<Pipeline>& pipeline, bool allowFallback) {
+  if (pipeline != nullptr && pipeline->IsReady()) {
+    return pipeline.get();
+  }
+
+  // NOTE: push constants are recorded against the resolved layout, so the fallback must share it
+  if (allowFallback && pipeline != nullptr && gFallbackPipeline != nullptr && gFallbackPipeline->IsReady() &&
+      gFallbackPipeline->layout == pipeline->layout) {
+    FallbackDraws.fetch_add(1, std::memory_order_relaxed);
+    return gFallbackPipeline.get();
+  }
+
+  SkippedDraws.fetch_add(1, std::memory_order_relaxed);
+  return nullptr;
+}
+
+std::shared_ptr<CoffeeMaker::Renderer::Vulkan::PipelineLayout>
+CoffeeMaker::Renderer::Vulkan::PipelineRegistry::GetPipelineLayout(const VkPipelineLayoutCreateInfo& layoutInfo) {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  PipelineKey key = MakePipelineLayoutKey(layoutInfo);
+
+  auto elem = gPipelineLayouts.find(key);
+  if (elem != gPipelineLayouts.end()) {
+    if (auto layout = elem->second.lock()) {
+      return layout;
+    }
+  }
+
+  auto layout = std::make_shared<PipelineLayout>();
+  VkResult result = vkCreatePipelineLayout(LogicalDevice::GetLogicalDevice(), &layoutInfo, nullptr, &layout->layout);
+  if (result != VK_SUCCESS) {
+    SDL_LogError(0, "Unable to create Vulkan Pipeline Layout.\nVulkan Error Code: [%d]", result);
+    abort();
+  }
+  gPipelineLayouts.insert_or_assign(std::move(key), layout);
+
+  return layout;
+}
+
+std::shared_ptr<CoffeeMaker::Renderer::Vulkan::DescriptorSetLayout>
+CoffeeMaker::Renderer::Vulkan::PipelineRegistry::GetDescriptorSetLayout(
+    const std::vector<VkDescriptorSetLayoutBinding>& bindings) {
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  PipelineKey key = MakeDescriptorSetLayoutKey(bindings);
+
+  auto elem = gDescriptorSetLayouts.find(key);
+  if (elem != gDescriptorSetLayouts.end()) {
+    if (auto layout = elem->second.lock()) {
+      return layout;
+    }
+  }
+
+  VkDescriptorSetLayoutCreateInfo layoutInfo{};
+  layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  layoutInfo.pNext = nullptr;
+  layoutInfo.flags = 0;
+  layoutInfo.bindingCount = bindings.size();
+  layoutInfo.pBindings = bindings.empty() ? nullptr : bindings.data();
+
+  auto layout = std::make_shared<DescriptorSetLayout>();
+  VkResult result =
+      vkCreateDescriptorSetLayout(LogicalDevice::GetLogicalDevice(), &layoutInfo, nullptr, &layout->layout);
+  if (result != VK_SUCCESS) {
+    SDL_LogError(0, "Unable to create Vulkan Descriptor Set Layout.\nVulkan Error Code: [%d]", result);
+    abort();
+  }
+  gDescriptorSetLayouts.insert_or_assign(std::move(key), layout);
+
+  return layout;
+}
+
+size_t CoffeeMaker::Renderer::Vulkan::PipelineRegistry::RebuildPipelinesUsing(uint64_t previousId,
+                                                                              VkShaderModule module,
+                                                                              uint64_t moduleId) {
+  using PipelineCompiler = CoffeeMaker::Renderer::Vulkan::PipelineCompiler;
+
+  // NOTE: a pipeline may still have an earlier rebuild in flight, so compare against the newest modules. Ids only
+  // grow along the chain, an entry that would step back is ignored so the walk always ends
+  auto resolve = [](VkShaderModule shader, uint64_t id) {
+    for (auto elem = gReplacedModules.find(id); elem != gReplacedModules.end() && elem->second.id > id;
+         elem = gReplacedModules.find(id)) {
+      shader = elem->second.module;
+      id = elem->second.id;
+    }
+    return ReplacedModule{.module = shader, .id = id};
+  };
+  auto uses = [&](const PipelineCreateInfo& info) {
+    return resolve(info.vertexShader, info.vertexShaderId).id == previousId ||
+           resolve(info.fragmentShader, info.fragmentShaderId).id == previousId;
+  };
+
+  std::vector<std::shared_ptr<Pipeline>> targets{};
+  for (auto elem = gPipelines.begin(); elem != gPipelines.end();) {
+    auto pipeline = elem->second.lock();
+    if (pipeline != nullptr && uses(pipeline->info)) {
+      targets.push_back(std::move(pipeline));
+      elem = gPipelines.erase(elem);
+    } else {
+      elem++;
+    }
+  }
+  gReplacedModules.insert_or_assign(previousId, ReplacedModule{.module = module, .id = moduleId});
+
+  // NOTE: not in gPipelines, it is rebuilt like the others but never shared
+  if (gFallbackPipeline != nullptr && uses(gFallbackPipeline->info)) {
+    targets.push_back(gFallbackPipeline);
+  }
+
+  for (auto& target : targets) {
+    PipelineCreateInfo info = target->info;
+    ReplacedModule vertex = resolve(info.vertexShader, info.vertexShaderId);
+    ReplacedModule fragment = resolve(info.fragmentShader, info.fragmentShaderId);
+    info.vertexShader = vertex.module;
+    info.vertexShaderId = vertex.id;
+    info.fragmentShader = fragment.module;
+    info.fragmentShaderId = fragment.id;
+
+    PipelineKey key = MakePipelineKey(info);
+    auto replacement = std::make_shared<Pipeline>();
+    replacement->key = key.hash;
+    replacement->Prepare(info);
+
+    // NOTE: re-keyed right away so requests for the new state share the pipeline being rebuilt
+    if (target != gFallbackPipeline) {
+      gPipelines.insert_or_assign(std::move(key), target);
+    }
+    PipelineCompiler::SubmitRebuild(target, std::move(replacement));
+  }
+
+  return targets.size();
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineRegistry::ForgetModule(uint64_t id) {
+  // NOTE: only called once every rebuild has been swapped in, so no pipeline still names the module
+  gReplacedModules.erase(id);
+  std::erase_if(gReplacedModules, [id](const auto& elem) { return elem.second.id == id; });
+}
+
+void CoffeeMaker::Renderer::Vulkan::PipelineRegistry::Clear() {
+  gFallbackPipeline = nullptr;
+  gReplacedModules.clear();
+  gPipelines.clear();
+  gPipelineLayouts.clear();
+  gDescriptorSetLayouts.clear();
+}
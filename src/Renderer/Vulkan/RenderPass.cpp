@@ -31,20 +31,20 @@ void CoffeeMaker::Renderer::Vulkan::RenderPass::CreateRenderPass() {
 void CoffeeMaker::Renderer::Vulkan::RenderPass::Destroy() {
   using LogicDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
 
+  // NOTE: never created on the dynamic rendering path
+  if (gRenderPass == nullptr) {
+    return;
+  }
+
   vkDestroyRenderPass(LogicalDevice::GetLogicalDevice(), gRenderPass->vkpRenderPass, nullptr);
   delete gRenderPass;
+  gRenderPass = nullptr;
 }
 
 void CoffeeMaker::Renderer::Vulkan::RenderPass::InitCreateSubpassDependency() {
-  VkSubpassDependency dependency{};
-  dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-  dependency.dstSubpass = 0;
-  dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-  dependency.srcAccessMask = 0;
-  dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-  dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-  subpassDependencies.push_back(dependency);
+  // NOTE: no external dependencies, the render graph records the barriers around the pass and does every layout
+  // transition, the attachments stay in their attachment layouts for the whole pass
+  subpassDependencies.clear();
 }
 
 void CoffeeMaker::Renderer::Vulkan::RenderPass::InitCreateColorAttachmentDes() {
@@ -53,25 +53,35 @@ void CoffeeMaker::Renderer::Vulkan::RenderPass::InitCreateColorAttachmentDes() {
   colorAttachmentDescription.format = Swapchain::GetSwapchain()->surfaceFormat.format;
   colorAttachmentDescription.samples = VK_SAMPLE_COUNT_1_BIT;
 
-  colorAttachmentDescription.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-  colorAttachmentDescription.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+  colorAttachmentDescription.loadOp = ChooseLoadOp(Swapchain::GetSwapchain()->colorUsage);
+  colorAttachmentDescription.storeOp = ChooseStoreOp(Swapchain::GetSwapchain()->colorUsage);
 
   colorAttachmentDescription.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
   colorAttachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 
-  colorAttachmentDescription.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-  colorAttachmentDescription.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+  colorAttachmentDescription.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  colorAttachmentDescription.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 }
 
 void CoffeeMaker::Renderer::Vulkan::RenderPass::InitCreateDepthAttachmentDes() {
+  using Swapchain = CoffeeMaker::Renderer::Vulkan::Swapchain;
+
+  const AttachmentUsage& usage = Swapchain::GetSwapchain()->depthUsage;
+
   depthAttachmentDescription.flags = 0;
   depthAttachmentDescription.format = depthFormat;
   depthAttachmentDescription.samples = VK_SAMPLE_COUNT_1_BIT;
-  depthAttachmentDescription.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-  depthAttachmentDescription.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-  depthAttachmentDescription.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-  depthAttachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-  depthAttachmentDescription.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  depthAttachmentDescription.loadOp = ChooseLoadOp(usage);
+  depthAttachmentDescription.storeOp = ChooseStoreOp(usage);
+  // NOTE: stencil follows depth when the format has it, otherwise it does not exist
+  if (FormatHasStencil(depthFormat)) {
+    depthAttachmentDescription.stencilLoadOp = ChooseLoadOp(usage);
+    depthAttachmentDescription.stencilStoreOp = ChooseStoreOp(usage);
+  } else {
+    depthAttachmentDescription.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    depthAttachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  }
+  depthAttachmentDescription.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
   depthAttachmentDescription.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 }
 
@@ -0,0 +1,455 @@
+#include "Renderer/Vulkan/ShaderCompiler.hpp"
+
+#include <SDL2/SDL.h>
+#include <fmt/core.h>
+#include <shaderc/shaderc.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+namespace {
+  // NOTE: "CMSC" - CoffeeMaker Shader Cache
+  constexpr uint32_t SHADER_CACHE_MAGIC = 0x43534d43;
+  constexpr uint32_t SHADER_CACHE_VERSION = 2;
+
+  uint64_t Hash(uint64_t hash, const void* data, size_t size) {
+    // NOTE: FNV-1a, same as the pipeline keys
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+      hash ^= bytes[i];
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  uint64_t Hash(uint64_t hash, std::string_view text) {
+    // NOTE: hash the length as well so "ab" + "c" and "a" + "bc" differ
+    uint64_t length = text.size();
+    return Hash(Hash(hash, &length, sizeof(length)), text.data(), text.size());
+  }
+
+  constexpr uint64_t HASH_SEED = 14695981039346656037ull;
+
+  bool ReadSource(const std::string& path, std::string& out) {
+    std::ifstream file{path, std::ios::binary};
+    if (!file.is_open()) {
+      return false;
+    }
+    std::ostringstream stream{};
+    stream << file.rdbuf();
+    out = stream.str();
+    return true;
+  }
+
+  constexpr std::pair<std::string_view, shaderc_shader_kind> SHADER_KINDS[] = {
+      {".vert", shaderc_vertex_shader},       {".frag", shaderc_fragment_shader},
+      {".comp", shaderc_compute_shader},      {".geom", shaderc_geometry_shader},
+      {".tesc", shaderc_tess_control_shader}, {".tese", shaderc_tess_evaluation_shader}};
+
+  shaderc_shader_kind ShaderKind(const std::string& path) {
+    std::string extension = std::filesystem::path{path}.extension().string();
+    for (const auto& [stageExtension, kind] : SHADER_KINDS) {
+      if (extension == stageExtension) {
+        return kind;
+      }
+    }
+    return shaderc_glsl_infer_from_source;
+  }
+
+  struct Dependency {
+    std::string path{};
+    uint64_t hash{0};
+  };
+
+  /**
+   * Resolves #include "file" relative to the including file and #include <file> relative to the main source,
+   * recording every file it hands to the compiler.
+   */
+  class FileIncluder : public shaderc::CompileOptions::IncluderInterface {
+    public:
+    FileIncluder(std::string root, std::vector<Dependency>& dependencies)
+        : root(std::move(root)), dependencies(dependencies) {}
+
+    shaderc_include_result* GetInclude(const char* requestedSource, shaderc_include_type type,
+                                       const char* requestingSource, size_t includeDepth) override {
+      std::filesystem::path base =
+          type == shaderc_include_type_relative ? std::filesystem::path{requestingSource}.parent_path() : root;
+
+      auto* include = new Include{};
+      include->name = (base / requestedSource).lexically_normal().string();
+      if (ReadSource(include->name, include->content)) {
+        dependencies.push_back({include->name, Hash(HASH_SEED, include->content)});
+      } else {
+        // NOTE: shaderc reports an include failure through an empty name, the content carries the message
+        include->content = fmt::format("Unable to open include {}", include->name);
+        include->name.clear();
+      }
+
+      include->result.source_name = include->name.c_str();
+      include->result.source_name_length = include->name.size();
+      include->result.content = include->content.c_str();
+      include->result.content_length = include->content.size();
+      include->result.user_data = include;
+      return &include->result;
+    }
+
+    void ReleaseInclude(shaderc_include_result* data) override { delete static_cast<Include*>(data->user_data); }
+
+    private:
+    struct Include {
+      std::string name{};
+      std::string content{};
+      shaderc_include_result result{};
+    };
+
+    std::string root;
+    std::vector<Dependency>& dependencies;
+  };
+
+  /**
+   * Every setting the compiles run with. All of them are part of the cache key, so changing one here invalidates
+   * the entries built with the old value.
+   */
+  struct CompileSettings {
+    shaderc_target_env targetEnvironment{shaderc_target_env_vulkan};
+    // NOTE: matches the instance's apiVersion
+    uint32_t environmentVersion{shaderc_env_version_vulkan_1_1};
+    shaderc_optimization_level optimizationLevel{shaderc_optimization_level_performance};
+    bool debugInfo{false};
+  };
+
+  constexpr CompileSettings COMPILE_SETTINGS{};
+
+  shaderc::CompileOptions MakeCompileOptions() {
+    shaderc::CompileOptions options{};
+    options.SetTargetEnvironment(COMPILE_SETTINGS.targetEnvironment, COMPILE_SETTINGS.environmentVersion);
+    options.SetOptimizationLevel(COMPILE_SETTINGS.optimizationLevel);
+    if (COMPILE_SETTINGS.debugInfo) {
+      options.SetGenerateDebugInfo();
+    }
+    return options;
+  }
+
+  constexpr const char* PROBE_SOURCE = R"(#version 450
+layout(local_size_x = 1) in;
+layout(std430, binding = 0) buffer Data { float values[]; };
+void main() { values[gl_GlobalInvocationID.x] = sqrt(values[gl_GlobalInvocationID.x]) * 2.0; }
+)";
+
+  uint64_t CompilerFingerprint() {
+    // NOTE: shaderc has no version string, so a probe is compiled once. Its SPIR-V carries the glslang generator
+    // version and changes with whatever the optimizer does differently, next to the SPIR-V version shaderc reports.
+    static const uint64_t fingerprint = []() {
+      unsigned int spirvVersion = 0;
+      unsigned int spirvRevision = 0;
+      shaderc_get_spv_version(&spirvVersion, &spirvRevision);
+
+      uint64_t hash = HASH_SEED;
+      uint64_t versions[] = {spirvVersion, spirvRevision};
+      hash = Hash(hash, versions, sizeof(versions));
+
+      shaderc::Compiler compiler{};
+      shaderc::SpvCompilationResult probe =
+          compiler.CompileGlslToSpv(PROBE_SOURCE, shaderc_compute_shader, "probe.comp", MakeCompileOptions());
+      if (probe.GetCompilationStatus() == shaderc_compilation_status_success) {
+        std::vector<uint32_t> spirv(probe.cbegin(), probe.cend());
+        hash = Hash(hash, spirv.data(), spirv.size() * sizeof(uint32_t));
+      }
+      return hash;
+    }();
+
+    return fingerprint;
+  }
+
+  uint64_t MakeCacheKey(const std::string& source, shaderc_shader_kind kind,
+                        const std::vector<CoffeeMaker::Renderer::Vulkan::ShaderDefine>& defines) {
+    uint64_t key = HASH_SEED;
+    // NOTE: field by field, the struct's padding bytes are not guaranteed to be zero
+    uint64_t header[] = {SHADER_CACHE_VERSION,
+                         CompilerFingerprint(),
+                         static_cast<uint64_t>(COMPILE_SETTINGS.targetEnvironment),
+                         COMPILE_SETTINGS.environmentVersion,
+                         static_cast<uint64_t>(COMPILE_SETTINGS.optimizationLevel),
+                         COMPILE_SETTINGS.debugInfo,
+                         static_cast<uint64_t>(kind)};
+    key = Hash(key, header, sizeof(header));
+    key = Hash(key, source);
+    for (const auto& define : defines) {
+      key = Hash(key, define.name);
+      key = Hash(key, define.value);
+    }
+    return key;
+  }
+
+  bool LoadFromCache(const std::string& cachePath, uint64_t key, CoffeeMaker::Renderer::Vulkan::CompiledShader& out) {
+    using ShaderCacheFileHeader = CoffeeMaker::Renderer::Vulkan::ShaderCacheFileHeader;
+
+    std::ifstream file{cachePath, std::ios::binary};
+    if (!file.is_open()) {
+      return false;
+    }
+
+    ShaderCacheFileHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != SHADER_CACHE_MAGIC || header.version != SHADER_CACHE_VERSION || header.key != key) {
+      return false;
+    }
+
+    std::vector<std::string> dependencies{};
+    for (uint32_t i = 0; i < header.dependencyCount; i++) {
+      uint64_t hash = 0;
+      uint32_t length = 0;
+      file.read(reinterpret_cast<char*>(&hash), sizeof(hash));
+      file.read(reinterpret_cast<char*>(&length), sizeof(length));
+      std::string path(length, '\0');
+      file.read(path.data(), length);
+      if (!file) {
+        return false;
+      }
+
+      // NOTE: the source itself is part of the key, only includes need checking
+      std::string content{};
+      if (i > 0 && (!ReadSource(path, content) || Hash(HASH_SEED, content) != hash)) {
+        return false;
+      }
+      dependencies.push_back(std::move(path));
+    }
+
+    std::vector<uint32_t> spirv(header.wordCount);
+    file.read(reinterpret_cast<char*>(spirv.data()), spirv.size() * sizeof(uint32_t));
+    if (!file || spirv.empty()) {
+      return false;
+    }
+
+    out.spirv = std::move(spirv);
+    out.dependencies = std::move(dependencies);
+    return true;
+  }
+
+  void SaveToCache(const std::string& cachePath, uint64_t key, const std::vector<Dependency>& dependencies,
+                   const std::vector<uint32_t>& spirv) {
+    using ShaderCacheFileHeader = CoffeeMaker::Renderer::Vulkan::ShaderCacheFileHeader;
+
+    ShaderCacheFileHeader header{.magic = SHADER_CACHE_MAGIC,
+                                 .version = SHADER_CACHE_VERSION,
+                                 .key = key,
+                                 .dependencyCount = static_cast<uint32_t>(dependencies.size()),
+                                 .wordCount = static_cast<uint32_t>(spirv.size())};
+
+    // NOTE: written aside and renamed into place, several workers may race to store the same entry
+    size_t threadId = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    std::string tempPath = fmt::format("{}.{}.tmp", cachePath, threadId);
+    {
+      std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+      if (!file.is_open()) {
+        SDL_LogWarn(0, "Unable to write shader cache entry %s", tempPath.c_str());
+        return;
+      }
+      file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      for (const auto& dependency : dependencies) {
+        uint32_t length = static_cast<uint32_t>(dependency.path.size());
+        file.write(reinterpret_cast<const char*>(&dependency.hash), sizeof(dependency.hash));
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(dependency.path.data(), length);
+      }
+      file.write(reinterpret_cast<const char*>(spirv.data()), spirv.size() * sizeof(uint32_t));
+    }
+
+    std::error_code error{};
+    std::filesystem::rename(tempPath, cachePath, error);
+    if (error) {
+      std::filesystem::remove(tempPath, error);
+    }
+  }
+
+  std::shared_ptr<const CoffeeMaker::Renderer::Vulkan::CompiledShader> Run(
+      shaderc::Compiler& compiler, const std::string& cacheDirectory, const std::string& path,
+      const std::vector<CoffeeMaker::Renderer::Vulkan::ShaderDefine>& defines) {
+    using CompiledShader = CoffeeMaker::Renderer::Vulkan::CompiledShader;
+    using ShaderCompiler = CoffeeMaker::Renderer::Vulkan::ShaderCompiler;
+
+    auto start = std::chrono::steady_clock::now();
+    auto shader = std::make_shared<CompiledShader>();
+
+    std::string source{};
+    if (!ReadSource(path, source)) {
+      shader->log = fmt::format("Could not open shader source {}", path);
+      ShaderCompiler::CompileFailures++;
+      return shader;
+    }
+
+    shaderc_shader_kind kind = ShaderKind(path);
+    uint64_t key = MakeCacheKey(source, kind, defines);
+    std::string cachePath = fmt::format("{}{:016x}.spv", cacheDirectory, key);
+
+    if (LoadFromCache(cachePath, key, *shader)) {
+      ShaderCompiler::CacheHits++;
+      shader->success = true;
+      shader->fromCache = true;
+      shader->compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      return shader;
+    }
+    ShaderCompiler::CacheMisses++;
+
+    std::vector<Dependency> dependencies{{path, Hash(HASH_SEED, source)}};
+
+    shaderc::CompileOptions options = MakeCompileOptions();
+    options.SetIncluder(
+        std::make_unique<FileIncluder>(std::filesystem::path{path}.parent_path().string(), dependencies));
+    for (const auto& define : defines) {
+      options.AddMacroDefinition(define.name, define.value);
+    }
+
+    shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(source, kind, path.c_str(), options);
+    shader->log = result.GetErrorMessage();
+    if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
+      ShaderCompiler::CompileFailures++;
+      return shader;
+    }
+
+    shader->spirv.assign(result.cbegin(), result.cend());
+    shader->success = true;
+    for (const auto& dependency : dependencies) {
+      shader->dependencies.push_back(dependency.path);
+    }
+    SaveToCache(cachePath, key, dependencies, shader->spirv);
+
+    shader->compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return shader;
+  }
+}  // namespace
+
+std::vector<std::thread> CoffeeMaker::Renderer::Vulkan::ShaderCompiler::gWorkers{};
+std::mutex CoffeeMaker::Renderer::Vulkan::ShaderCompiler::gMutex{};
+std::condition_variable CoffeeMaker::Renderer::Vulkan::ShaderCompiler::gCondition{};
+bool CoffeeMaker::Renderer::Vulkan::ShaderCompiler::gStopping{false};
+std::string CoffeeMaker::Renderer::Vulkan::ShaderCompiler::gCacheDirectory{};
+std::atomic<size_t> CoffeeMaker::Renderer::Vulkan::ShaderCompiler::CacheHits{0};
+std::atomic<size_t> CoffeeMaker::Renderer::Vulkan::ShaderCompiler::CacheMisses{0};
+std::atomic<size_t> CoffeeMaker::Renderer::Vulkan::ShaderCompiler::CompileFailures{0};
+std::deque<CoffeeMaker::Renderer::Vulkan::ShaderCompiler::Job>
+    CoffeeMaker::Renderer::Vulkan::ShaderCompiler::gQueue{};
+
+void CoffeeMaker::Renderer::Vulkan::ShaderCompiler::Start(size_t threadCount) {
+  if (!gWorkers.empty()) {
+    return;
+  }
+
+  CacheDirectory();
+
+  if (threadCount == 0) {
+    // NOTE: shader compiles are pure CPU work and independent of each other, use every core but ours
+    size_t hardwareThreads = std::thread::hardware_concurrency();
+    threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+  }
+
+  gStopping = false;
+  for (size_t i = 0; i < threadCount; i++) {
+    gWorkers.emplace_back(WorkerLoop);
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::ShaderCompiler::Stop() {
+  std::deque<Job> dropped{};
+  {
+    std::lock_guard<std::mutex> lock{gMutex};
+    gStopping = true;
+    dropped.swap(gQueue);
+  }
+  gCondition.notify_all();
+
+  for (auto& job : dropped) {
+    auto shader = std::make_shared<CompiledShader>();
+    shader->log = "Compile dropped on shutdown";
+    job.promise.set_value(std::move(shader));
+  }
+
+  for (auto& worker : gWorkers) {
+    worker.join();
+  }
+  gWorkers.clear();
+  gStopping = false;
+}
+
+std::shared_future<std::shared_ptr<const CoffeeMaker::Renderer::Vulkan::CompiledShader>>
+CoffeeMaker::Renderer::Vulkan::ShaderCompiler::CompileAsync(const std::string& path,
+                                                           const std::vector<ShaderDefine>& defines) {
+  Job job{.path = path, .defines = defines};
+  auto future = job.promise.get_future().share();
+
+  if (gWorkers.empty()) {
+    shaderc::Compiler compiler{};
+    job.promise.set_value(Run(compiler, CacheDirectory(), job.path, job.defines));
+    return future;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{gMutex};
+    gQueue.push_back(std::move(job));
+  }
+  gCondition.notify_one();
+
+  return future;
+}
+
+std::shared_ptr<const CoffeeMaker::Renderer::Vulkan::CompiledShader>
+CoffeeMaker::Renderer::Vulkan::ShaderCompiler::Compile(const std::string& path,
+                                                      const std::vector<ShaderDefine>& defines) {
+  return CompileAsync(path, defines).get();
+}
+
+bool CoffeeMaker::Renderer::Vulkan::ShaderCompiler::IsSource(std::string_view filename) {
+  return std::any_of(std::begin(SHADER_KINDS), std::end(SHADER_KINDS), [&](const auto& stage) {
+    std::string_view extension = stage.first;
+    return filename.size() > extension.size() && filename.substr(filename.size() - extension.size()) == extension;
+  });
+}
+
+void CoffeeMaker::Renderer::Vulkan::ShaderCompiler::WorkerLoop() {
+  // NOTE: one compiler per worker, shaderc compilers are cheap and this avoids sharing one across threads
+  shaderc::Compiler compiler{};
+
+  while (true) {
+    Job job{};
+    {
+      std::unique_lock<std::mutex> lock{gMutex};
+      gCondition.wait(lock, []() { return gStopping || !gQueue.empty(); });
+      if (gStopping) {
+        return;
+      }
+      job = std::move(gQueue.front());
+      gQueue.pop_front();
+    }
+
+    job.promise.set_value(Run(compiler, gCacheDirectory, job.path, job.defines));
+  }
+}
+
+const std::string& CoffeeMaker::Renderer::Vulkan::ShaderCompiler::CacheDirectory() {
+  static std::once_flag once{};
+
+  std::call_once(once, []() {
+    // NOTE: same writable location as the pipeline cache
+    char* prefPath = SDL_GetPrefPath("obscurelyme", "CoffeeRender");
+    if (prefPath != nullptr) {
+      gCacheDirectory = fmt::format("{}shader_cache/", prefPath);
+      SDL_free(prefPath);
+    } else {
+      char* basePath = SDL_GetBasePath();
+      gCacheDirectory = fmt::format("{}shader_cache/", basePath != nullptr ? basePath : "");
+      SDL_free(basePath);
+    }
+
+    std::error_code error{};
+    std::filesystem::create_directories(gCacheDirectory, error);
+    if (error) {
+      SDL_LogWarn(0, "Unable to create shader cache directory %s", gCacheDirectory.c_str());
+    }
+  });
+
+  return gCacheDirectory;
+}
@@ -0,0 +1,113 @@
+#include "Renderer/Vulkan/ShaderPermutation.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <utility>
+
+#include "Renderer/Vulkan/ShaderReflection.hpp"
+#include "VulkanShaderManager.hpp"
+
+CoffeeMaker::Renderer::Vulkan::ShaderPermutation::ShaderPermutation(std::string vertexShader,
+                                                                    std::string fragmentShader,
+                                                                    std::vector<ShaderFeature> features)
+    : vertexShader(std::move(vertexShader)),
+      fragmentShader(std::move(fragmentShader)),
+      features(std::move(features)) {
+  if (this->features.size() > 64) {
+    SDL_LogError(0, "Shader %s has %zu features, a permutation mask holds at most 64.", this->vertexShader.c_str(),
+                 this->features.size());
+    exit(6);
+  }
+
+  for (size_t i = 0; i < this->features.size(); i++) {
+    validMask |= 1ull << i;
+  }
+}
+
+std::vector<CoffeeMaker::Renderer::Vulkan::ShaderDefine> CoffeeMaker::Renderer::Vulkan::ShaderPermutation::Defines(
+    uint64_t mask, VkShaderStageFlagBits stage) const {
+  std::vector<ShaderDefine> defines{};
+
+  for (size_t i = 0; i < features.size(); i++) {
+    const ShaderFeature& feature = features[i];
+    if ((mask & (1ull << i)) == 0 || feature.binding != ShaderFeatureBinding::Define ||
+        (feature.stages & stage) == 0) {
+      continue;
+    }
+    defines.push_back(ShaderDefine{.name = feature.name, .value = "1"});
+  }
+
+  return defines;
+}
+
+std::vector<CoffeeMaker::Renderer::Vulkan::SpecializationConstant>
+CoffeeMaker::Renderer::Vulkan::ShaderPermutation::Constants(uint64_t mask) const {
+  std::vector<SpecializationConstant> constants{};
+
+  for (size_t i = 0; i < features.size(); i++) {
+    const ShaderFeature& feature = features[i];
+    if (feature.binding != ShaderFeatureBinding::SpecializationConstant) {
+      continue;
+    }
+    constants.push_back(SpecializationConstant{.id = feature.constantId, .value = (mask & (1ull << i)) != 0 ? 1u : 0u});
+  }
+
+  return constants;
+}
+
+CoffeeMaker::Renderer::Vulkan::PipelineCreateInfo
+CoffeeMaker::Renderer::Vulkan::ShaderPermutation::MakePipelineCreateInfo(
+    uint64_t mask, const VertexInputDescription& vertexLayout) const {
+  mask &= validMask;
+  std::vector<ShaderDefine> vertexDefines = Defines(mask, VK_SHADER_STAGE_VERTEX_BIT);
+  std::vector<ShaderDefine> fragmentDefines = Defines(mask, VK_SHADER_STAGE_FRAGMENT_BIT);
+
+  const ShaderReflection& vertex = VulkanShaderManager::Reflection(vertexShader, vertexDefines);
+  const ShaderReflection& fragment = VulkanShaderManager::Reflection(fragmentShader, fragmentDefines);
+  PipelineCreateInfo info = CoffeeMaker::Renderer::Vulkan::MakePipelineCreateInfo(
+      VulkanShaderManager::ShaderModule(vertexShader, vertexDefines),
+      vertex,
+      VulkanShaderManager::ShaderModule(fragmentShader, fragmentDefines),
+      fragment,
+      vertexLayout);
+  info.vertexShaderId = VulkanShaderManager::ModuleId(info.vertexShader);
+  info.fragmentShaderId = VulkanShaderManager::ModuleId(info.fragmentShader);
+  info.permutation = mask;
+
+  for (SpecializationConstant constant : Constants(mask)) {
+    // NOTE: only hand a constant to the stages that declare it, so a stage's library part is shared across values
+    constant.stages = 0;
+    for (const ShaderReflection* stage : {&vertex, &fragment}) {
+      for (const auto& declared : stage->specializationConstants) {
+        if (declared.id == constant.id) {
+          constant.stages |= stage->stage;
+        }
+      }
+    }
+
+    if (constant.stages == 0) {
+      SDL_LogWarn(0, "Neither %s nor %s declare constant_id %u, the feature has no effect.", vertexShader.c_str(),
+                  fragmentShader.c_str(), constant.id);
+      continue;
+    }
+    info.specializationConstants.push_back(constant);
+  }
+
+  return info;
+}
+
+void CoffeeMaker::Renderer::Vulkan::ShaderPermutation::Prefetch(uint64_t mask) const {
+  mask &= validMask;
+  VulkanShaderManager::Prefetch(vertexShader, Defines(mask, VK_SHADER_STAGE_VERTEX_BIT));
+  VulkanShaderManager::Prefetch(fragmentShader, Defines(mask, VK_SHADER_STAGE_FRAGMENT_BIT));
+}
+
+uint64_t CoffeeMaker::Renderer::Vulkan::ShaderPermutation::Bit(std::string_view name) const {
+  for (size_t i = 0; i < features.size(); i++) {
+    if (features[i].name == name) {
+      return 1ull << i;
+    }
+  }
+
+  return 0;
+}
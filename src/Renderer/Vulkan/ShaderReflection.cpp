@@ -0,0 +1,555 @@
+#include "Renderer/Vulkan/ShaderReflection.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+
+namespace {
+  // NOTE: the handful of SPIR-V opcodes, decorations and storage classes that matter for layouts
+  constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+  constexpr uint32_t OP_ENTRY_POINT = 15;
+  constexpr uint32_t OP_EXECUTION_MODE = 16;
+  constexpr uint32_t OP_TYPE_BOOL = 20;
+  constexpr uint32_t OP_TYPE_INT = 21;
+  constexpr uint32_t OP_TYPE_FLOAT = 22;
+  constexpr uint32_t OP_TYPE_VECTOR = 23;
+  constexpr uint32_t OP_TYPE_MATRIX = 24;
+  constexpr uint32_t OP_TYPE_IMAGE = 25;
+  constexpr uint32_t OP_TYPE_SAMPLER = 26;
+  constexpr uint32_t OP_TYPE_SAMPLED_IMAGE = 27;
+  constexpr uint32_t OP_TYPE_ARRAY = 28;
+  constexpr uint32_t OP_TYPE_RUNTIME_ARRAY = 29;
+  constexpr uint32_t OP_TYPE_STRUCT = 30;
+  constexpr uint32_t OP_TYPE_POINTER = 32;
+  constexpr uint32_t OP_CONSTANT = 43;
+  constexpr uint32_t OP_SPEC_CONSTANT_TRUE = 48;
+  constexpr uint32_t OP_SPEC_CONSTANT_FALSE = 49;
+  constexpr uint32_t OP_SPEC_CONSTANT = 50;
+  constexpr uint32_t OP_VARIABLE = 59;
+  constexpr uint32_t OP_DECORATE = 71;
+  constexpr uint32_t OP_MEMBER_DECORATE = 72;
+
+  constexpr uint32_t EXECUTION_MODE_LOCAL_SIZE = 17;
+
+  constexpr uint32_t DECORATION_SPEC_ID = 1;
+  constexpr uint32_t DECORATION_BLOCK = 2;
+  constexpr uint32_t DECORATION_BUFFER_BLOCK = 3;
+  constexpr uint32_t DECORATION_ARRAY_STRIDE = 6;
+  constexpr uint32_t DECORATION_MATRIX_STRIDE = 7;
+  constexpr uint32_t DECORATION_BUILT_IN = 11;
+  constexpr uint32_t DECORATION_LOCATION = 30;
+  constexpr uint32_t DECORATION_BINDING = 33;
+  constexpr uint32_t DECORATION_DESCRIPTOR_SET = 34;
+  constexpr uint32_t DECORATION_OFFSET = 35;
+
+  constexpr uint32_t STORAGE_UNIFORM_CONSTANT = 0;
+  constexpr uint32_t STORAGE_INPUT = 1;
+  constexpr uint32_t STORAGE_UNIFORM = 2;
+  constexpr uint32_t STORAGE_PUSH_CONSTANT = 9;
+  constexpr uint32_t STORAGE_STORAGE_BUFFER = 12;
+
+  constexpr uint32_t DIM_BUFFER = 5;
+  constexpr uint32_t DIM_SUBPASS_DATA = 6;
+
+  struct Decorations {
+    std::unordered_map<uint32_t, uint32_t> values{};
+    // NOTE: member index -> decoration -> value
+    std::unordered_map<uint32_t, std::unordered_map<uint32_t, uint32_t>> members{};
+
+    bool Has(uint32_t decoration) const { return values.find(decoration) != values.end(); }
+    uint32_t Get(uint32_t decoration, uint32_t fallback = 0) const {
+      auto elem = values.find(decoration);
+      return elem != values.end() ? elem->second : fallback;
+    }
+    uint32_t GetMember(uint32_t member, uint32_t decoration, uint32_t fallback = 0) const {
+      auto elem = members.find(member);
+      if (elem == members.end()) {
+        return fallback;
+      }
+      auto value = elem->second.find(decoration);
+      return value != elem->second.end() ? value->second : fallback;
+    }
+  };
+
+  struct Module {
+    // NOTE: result id -> the instruction's words, opcode included
+    std::unordered_map<uint32_t, std::vector<uint32_t>> types{};
+    std::unordered_map<uint32_t, uint32_t> constants{};
+    std::unordered_map<uint32_t, Decorations> decorations{};
+    std::vector<std::vector<uint32_t>> variables{};
+    std::vector<std::vector<uint32_t>> specConstants{};
+    uint32_t executionModel{0};
+    std::string entryPoint{"main"};
+    std::array<uint32_t, 3> localSize{1, 1, 1};
+
+    const std::vector<uint32_t>* Type(uint32_t id) const {
+      auto elem = types.find(id);
+      return elem != types.end() ? &elem->second : nullptr;
+    }
+
+    const Decorations& Decoration(uint32_t id) const {
+      static const Decorations empty{};
+      auto elem = decorations.find(id);
+      return elem != decorations.end() ? elem->second : empty;
+    }
+
+    uint32_t ArrayLength(const std::vector<uint32_t>& arrayType) const {
+      auto elem = constants.find(arrayType[3]);
+      return elem != constants.end() ? elem->second : 1;
+    }
+
+    /**
+     * Byte size of a type as laid out in a block, relies on the Offset/ArrayStride/MatrixStride decorations.
+     */
+    uint32_t SizeOf(uint32_t typeId, uint32_t matrixStride = 0) const {
+      const std::vector<uint32_t>* type = Type(typeId);
+      if (type == nullptr) {
+        return 0;
+      }
+
+      switch ((*type)[0] & 0xffff) {
+        case OP_TYPE_BOOL:
+          return 4;
+        case OP_TYPE_INT:
+        case OP_TYPE_FLOAT:
+          return (*type)[2] / 8;
+        case OP_TYPE_VECTOR:
+          return SizeOf((*type)[2]) * (*type)[3];
+        case OP_TYPE_MATRIX:
+          return (matrixStride != 0 ? matrixStride : SizeOf((*type)[2])) * (*type)[3];
+        case OP_TYPE_ARRAY: {
+          uint32_t stride = Decoration((*type)[1]).Get(DECORATION_ARRAY_STRIDE, SizeOf((*type)[2]));
+          return stride * ArrayLength(*type);
+        }
+        case OP_TYPE_STRUCT: {
+          const Decorations& members = Decoration((*type)[1]);
+          uint32_t size = 0;
+          for (uint32_t i = 2; i < type->size(); i++) {
+            uint32_t member = i - 2;
+            uint32_t offset = members.GetMember(member, DECORATION_OFFSET);
+            uint32_t memberSize = SizeOf((*type)[i], members.GetMember(member, DECORATION_MATRIX_STRIDE));
+            size = std::max(size, offset + memberSize);
+          }
+          return size;
+        }
+        default:
+          return 0;
+      }
+    }
+  };
+
+  VkShaderStageFlagBits StageFromExecutionModel(uint32_t executionModel) {
+    switch (executionModel) {
+      case 0:
+        return VK_SHADER_STAGE_VERTEX_BIT;
+      case 1:
+        return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+      case 2:
+        return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+      case 3:
+        return VK_SHADER_STAGE_GEOMETRY_BIT;
+      case 4:
+        return VK_SHADER_STAGE_FRAGMENT_BIT;
+      case 5:
+        return VK_SHADER_STAGE_COMPUTE_BIT;
+      default:
+        return VK_SHADER_STAGE_ALL;
+    }
+  }
+
+  VkFormat VertexFormat(const Module& spirv, uint32_t scalarTypeId, uint32_t components) {
+    const std::vector<uint32_t>* scalar = spirv.Type(scalarTypeId);
+    if (scalar == nullptr || components == 0 || components > 4) {
+      return VK_FORMAT_UNDEFINED;
+    }
+
+    uint32_t op = (*scalar)[0] & 0xffff;
+    uint32_t width = (*scalar)[2];
+    if (op == OP_TYPE_FLOAT && width == 32) {
+      constexpr VkFormat formats[] = {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT,
+                                      VK_FORMAT_R32G32B32A32_SFLOAT};
+      return formats[components - 1];
+    }
+    if (op == OP_TYPE_FLOAT && width == 64) {
+      constexpr VkFormat formats[] = {VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT,
+                                      VK_FORMAT_R64G64B64A64_SFLOAT};
+      return formats[components - 1];
+    }
+    if (op == OP_TYPE_INT && width == 32) {
+      bool isSigned = (*scalar)[3] == 1;
+      constexpr VkFormat sint[] = {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT,
+                                   VK_FORMAT_R32G32B32A32_SINT};
+      constexpr VkFormat uint[] = {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT,
+                                   VK_FORMAT_R32G32B32A32_UINT};
+      return isSigned ? sint[components - 1] : uint[components - 1];
+    }
+
+    return VK_FORMAT_UNDEFINED;
+  }
+
+  void ReflectVertexInput(const Module& spirv, uint32_t typeId, uint32_t location,
+                          std::vector<CoffeeMaker::Renderer::Vulkan::ReflectedVertexInput>& inputs) {
+    const std::vector<uint32_t>* type = spirv.Type(typeId);
+    if (type == nullptr) {
+      return;
+    }
+
+    switch ((*type)[0] & 0xffff) {
+      case OP_TYPE_INT:
+      case OP_TYPE_FLOAT:
+        inputs.push_back({location, VertexFormat(spirv, typeId, 1), spirv.SizeOf(typeId)});
+        break;
+      case OP_TYPE_VECTOR:
+        inputs.push_back({location, VertexFormat(spirv, (*type)[2], (*type)[3]), spirv.SizeOf(typeId)});
+        break;
+      case OP_TYPE_MATRIX:
+        // NOTE: a matrix input takes up one location per column
+        for (uint32_t column = 0; column < (*type)[3]; column++) {
+          ReflectVertexInput(spirv, (*type)[2], location + column, inputs);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  bool ReflectDescriptorType(const Module& spirv, uint32_t typeId, uint32_t storageClass, VkDescriptorType& out,
+                             uint32_t& count) {
+    const std::vector<uint32_t>* type = spirv.Type(typeId);
+    count = 1;
+
+    // NOTE: arrays of resources become a single binding with a descriptor count
+    while (type != nullptr) {
+      uint32_t op = (*type)[0] & 0xffff;
+      if (op != OP_TYPE_ARRAY && op != OP_TYPE_RUNTIME_ARRAY) {
+        break;
+      }
+      if (op == OP_TYPE_ARRAY) {
+        count *= spirv.ArrayLength(*type);
+      }
+      typeId = (*type)[2];
+      type = spirv.Type(typeId);
+    }
+    if (type == nullptr) {
+      return false;
+    }
+
+    uint32_t op = (*type)[0] & 0xffff;
+    if (storageClass == STORAGE_STORAGE_BUFFER) {
+      out = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      return true;
+    }
+    if (storageClass == STORAGE_UNIFORM) {
+      out = spirv.Decoration(typeId).Has(DECORATION_BUFFER_BLOCK) ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                                                                   : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+      return true;
+    }
+    if (storageClass != STORAGE_UNIFORM_CONSTANT) {
+      return false;
+    }
+
+    switch (op) {
+      case OP_TYPE_SAMPLER:
+        out = VK_DESCRIPTOR_TYPE_SAMPLER;
+        return true;
+      case OP_TYPE_SAMPLED_IMAGE:
+        out = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        return true;
+      case OP_TYPE_IMAGE: {
+        uint32_t dim = (*type)[3];
+        bool storage = (*type)[7] == 2;
+        if (dim == DIM_SUBPASS_DATA) {
+          out = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+        } else if (dim == DIM_BUFFER) {
+          out = storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+        } else {
+          out = storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        }
+        return true;
+      }
+      default:
+        return false;
+    }
+  }
+}  // namespace
+
+CoffeeMaker::Renderer::Vulkan::ShaderReflection CoffeeMaker::Renderer::Vulkan::ReflectShader(const uint32_t* code,
+                                                                                            size_t wordCount) {
+  if (code == nullptr || wordCount < 5 || code[0] != SPIRV_MAGIC) {
+    SDL_LogError(0, "Unable to reflect shader, the code is not SPIR-V.");
+    exit(4);
+  }
+
+  Module spirv{};
+  bool foundEntryPoint = false;
+
+  size_t i = 5;
+  while (i < wordCount) {
+    uint32_t opcode = code[i] & 0xffff;
+    uint32_t length = code[i] >> 16;
+    if (length == 0 || i + length > wordCount) {
+      SDL_LogError(0, "Unable to reflect shader, the SPIR-V is truncated.");
+      exit(4);
+    }
+    const uint32_t* words = code + i;
+
+    switch (opcode) {
+      case OP_ENTRY_POINT:
+        // NOTE: modules with several entry points are reflected as the first one
+        if (!foundEntryPoint) {
+          foundEntryPoint = true;
+          spirv.executionModel = words[1];
+          spirv.entryPoint = std::string{reinterpret_cast<const char*>(words + 3)};
+        }
+        break;
+      case OP_EXECUTION_MODE:
+        if (length >= 6 && words[2] == EXECUTION_MODE_LOCAL_SIZE) {
+          spirv.localSize = {words[3], words[4], words[5]};
+        }
+        break;
+      case OP_DECORATE:
+        if (length >= 3) {
+          spirv.decorations[words[1]].values[words[2]] = length >= 4 ? words[3] : 1;
+        }
+        break;
+      case OP_MEMBER_DECORATE:
+        if (length >= 4) {
+          spirv.decorations[words[1]].members[words[2]][words[3]] = length >= 5 ? words[4] : 1;
+        }
+        break;
+      case OP_TYPE_BOOL:
+      case OP_TYPE_INT:
+      case OP_TYPE_FLOAT:
+      case OP_TYPE_VECTOR:
+      case OP_TYPE_MATRIX:
+      case OP_TYPE_IMAGE:
+      case OP_TYPE_SAMPLER:
+      case OP_TYPE_SAMPLED_IMAGE:
+      case OP_TYPE_ARRAY:
+      case OP_TYPE_RUNTIME_ARRAY:
+      case OP_TYPE_STRUCT:
+      case OP_TYPE_POINTER:
+        spirv.types[words[1]] = std::vector<uint32_t>(words, words + length);
+        break;
+      case OP_CONSTANT:
+        if (length >= 4) {
+          spirv.constants[words[2]] = words[3];
+        }
+        break;
+      case OP_SPEC_CONSTANT_TRUE:
+      case OP_SPEC_CONSTANT_FALSE:
+      case OP_SPEC_CONSTANT:
+        spirv.specConstants.emplace_back(words, words + length);
+        if (opcode == OP_SPEC_CONSTANT && length >= 4) {
+          // NOTE: default value, array lengths may be sized by a specialization constant
+          spirv.constants[words[2]] = words[3];
+        }
+        break;
+      case OP_VARIABLE:
+        spirv.variables.emplace_back(words, words + length);
+        break;
+      default:
+        break;
+    }
+
+    i += length;
+  }
+
+  ShaderReflection reflection{};
+  reflection.stage = StageFromExecutionModel(spirv.executionModel);
+  reflection.entryPoint = spirv.entryPoint;
+  reflection.localSize = spirv.localSize;
+
+  for (const auto& variable : spirv.variables) {
+    uint32_t pointerTypeId = variable[1];
+    uint32_t id = variable[2];
+    uint32_t storageClass = variable[3];
+
+    const std::vector<uint32_t>* pointer = spirv.Type(pointerTypeId);
+    if (pointer == nullptr || ((*pointer)[0] & 0xffff) != OP_TYPE_POINTER) {
+      continue;
+    }
+    uint32_t typeId = (*pointer)[3];
+    const Decorations& decorations = spirv.Decoration(id);
+
+    if (storageClass == STORAGE_INPUT && reflection.stage == VK_SHADER_STAGE_VERTEX_BIT) {
+      if (decorations.Has(DECORATION_BUILT_IN) || !decorations.Has(DECORATION_LOCATION)) {
+        continue;
+      }
+      ReflectVertexInput(spirv, typeId, decorations.Get(DECORATION_LOCATION), reflection.vertexInputs);
+    } else if (storageClass == STORAGE_PUSH_CONSTANT) {
+      const std::vector<uint32_t>* block = spirv.Type(typeId);
+      uint32_t offset = UINT32_MAX;
+      if (block != nullptr) {
+        for (uint32_t member = 0; member + 2 < block->size(); member++) {
+          offset = std::min(offset, spirv.Decoration(typeId).GetMember(member, DECORATION_OFFSET));
+        }
+      }
+      reflection.hasPushConstants = true;
+      reflection.pushConstants.stageFlags = reflection.stage;
+      reflection.pushConstants.offset = offset == UINT32_MAX ? 0 : offset;
+      reflection.pushConstants.size = spirv.SizeOf(typeId) - reflection.pushConstants.offset;
+    } else if (decorations.Has(DECORATION_BINDING)) {
+      ReflectedDescriptorBinding binding{};
+      binding.set = decorations.Get(DECORATION_DESCRIPTOR_SET);
+      binding.binding = decorations.Get(DECORATION_BINDING);
+      if (ReflectDescriptorType(spirv, typeId, storageClass, binding.type, binding.count)) {
+        reflection.descriptorBindings.push_back(binding);
+      }
+    }
+  }
+
+  for (const auto& constant : spirv.specConstants) {
+    const Decorations& decorations = spirv.Decoration(constant[2]);
+    if (decorations.Has(DECORATION_SPEC_ID)) {
+      uint32_t size = (constant[0] & 0xffff) == OP_SPEC_CONSTANT ? spirv.SizeOf(constant[1]) : sizeof(VkBool32);
+      reflection.specializationConstants.push_back({decorations.Get(DECORATION_SPEC_ID), size});
+    }
+  }
+
+  std::sort(reflection.vertexInputs.begin(), reflection.vertexInputs.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.location < rhs.location; });
+  std::sort(reflection.descriptorBindings.begin(), reflection.descriptorBindings.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return lhs.set != rhs.set ? lhs.set < rhs.set : lhs.binding < rhs.binding;
+            });
+
+  return reflection;
+}
+
+CoffeeMaker::Renderer::Vulkan::VertexInputDescription CoffeeMaker::Renderer::Vulkan::MakeVertexInputDescription(
+    const ShaderReflection& vertex, const VertexInputDescription& layout) {
+  VertexInputDescription description{};
+
+  if (!layout.attributes.empty()) {
+    // NOTE: optimized SPIR-V drops inputs a permutation never reads, so offsets must come from the vertex itself
+    for (const auto& input : vertex.vertexInputs) {
+      auto attribute = std::find_if(layout.attributes.begin(), layout.attributes.end(),
+                                    [&input](const auto& elem) { return elem.location == input.location; });
+      if (attribute == layout.attributes.end()) {
+        SDL_LogError(0, "Vertex shader reads location %u which the vertex does not provide.", input.location);
+        exit(6);
+      }
+      if (attribute->format != input.format) {
+        SDL_LogWarn(0, "Vertex shader reads location %u as format %d but the vertex provides format %d.",
+                    input.location, input.format, attribute->format);
+      }
+      description.attributes.push_back(*attribute);
+    }
+
+    // NOTE: only the bindings the picked attributes read from, e.g. no instance binding for a per vertex shader
+    for (const auto& binding : layout.bindings) {
+      if (std::any_of(description.attributes.begin(), description.attributes.end(),
+                      [&binding](const auto& attribute) { return attribute.binding == binding.binding; })) {
+        description.bindings.push_back(binding);
+      }
+    }
+    description.flags = layout.flags;
+    return description;
+  }
+
+  uint32_t offset = 0;
+  for (const auto& input : vertex.vertexInputs) {
+    VkVertexInputAttributeDescription attribute{};
+    attribute.binding = 0;
+    attribute.location = input.location;
+    attribute.format = input.format;
+    attribute.offset = offset;
+    description.attributes.push_back(attribute);
+    offset += input.size;
+  }
+
+  if (!description.attributes.empty()) {
+    VkVertexInputBindingDescription binding{};
+    binding.binding = 0;
+    binding.stride = offset;
+    binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    description.bindings.push_back(binding);
+  }
+
+  return description;
+}
+
+CoffeeMaker::Renderer::Vulkan::PipelineCreateInfo CoffeeMaker::Renderer::Vulkan::MakePipelineCreateInfo(
+    VkShaderModule vertexShader, const ShaderReflection& vertex, VkShaderModule fragmentShader,
+    const ShaderReflection& fragment, const VertexInputDescription& vertexLayout) {
+  PipelineCreateInfo info{};
+
+  info.vertexShader = vertexShader;
+  info.fragmentShader = fragmentShader;
+  info.vertexInputs = MakeVertexInputDescription(vertex, vertexLayout);
+
+  // NOTE: one range visible to every stage that declares the block, covering all of their members
+  for (const ShaderReflection* stage : {&vertex, &fragment}) {
+    if (!stage->hasPushConstants) {
+      continue;
+    }
+    if (info.pushConstantRangeCount == 0) {
+      info.pushConstants = stage->pushConstants;
+      info.pushConstantRangeCount = 1;
+      continue;
+    }
+    uint32_t begin = std::min(info.pushConstants.offset, stage->pushConstants.offset);
+    uint32_t end = std::max(info.pushConstants.offset + info.pushConstants.size,
+                            stage->pushConstants.offset + stage->pushConstants.size);
+    info.pushConstants.stageFlags |= stage->pushConstants.stageFlags;
+    info.pushConstants.offset = begin;
+    info.pushConstants.size = end - begin;
+  }
+
+  for (const ShaderReflection* stage : {&vertex, &fragment}) {
+    for (const auto& reflected : stage->descriptorBindings) {
+      if (info.descriptorSets.size() <= reflected.set) {
+        info.descriptorSets.resize(reflected.set + 1);
+      }
+      auto& bindings = info.descriptorSets[reflected.set];
+      auto elem = std::find_if(bindings.begin(), bindings.end(),
+                               [&](const auto& binding) { return binding.binding == reflected.binding; });
+      if (elem != bindings.end()) {
+        elem->stageFlags |= stage->stage;
+        continue;
+      }
+
+      VkDescriptorSetLayoutBinding binding{};
+      binding.binding = reflected.binding;
+      binding.descriptorType = reflected.type;
+      binding.descriptorCount = reflected.count;
+      binding.stageFlags = stage->stage;
+      binding.pImmutableSamplers = nullptr;
+      bindings.push_back(binding);
+    }
+  }
+
+  return info;
+}
+
+CoffeeMaker::Renderer::Vulkan::ComputePipelineCreateInfo CoffeeMaker::Renderer::Vulkan::MakeComputePipelineCreateInfo(
+    VkShaderModule computeShader, const ShaderReflection& compute) {
+  ComputePipelineCreateInfo info{};
+
+  info.computeShader = computeShader;
+  info.localSize = compute.localSize;
+
+  if (compute.hasPushConstants) {
+    info.pushConstants = compute.pushConstants;
+    info.pushConstantRangeCount = 1;
+  }
+
+  for (const auto& reflected : compute.descriptorBindings) {
+    if (info.descriptorSets.size() <= reflected.set) {
+      info.descriptorSets.resize(reflected.set + 1);
+    }
+
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = reflected.binding;
+    binding.descriptorType = reflected.type;
+    binding.descriptorCount = reflected.count;
+    binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    binding.pImmutableSamplers = nullptr;
+    info.descriptorSets[reflected.set].push_back(binding);
+  }
+
+  return info;
+}
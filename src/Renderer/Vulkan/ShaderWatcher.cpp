@@ -0,0 +1,161 @@
+#include "Renderer/Vulkan/ShaderWatcher.hpp"
+
+#include <SDL2/SDL.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+std::string CoffeeMaker::Renderer::Vulkan::ShaderWatcher::gDirectory{};
+const uint32_t CoffeeMaker::Renderer::Vulkan::ShaderWatcher::PollIntervalMs{500};
+#ifdef __linux__
+int CoffeeMaker::Renderer::Vulkan::ShaderWatcher::gFileDescriptor{-1};
+std::unordered_map<int, std::string> CoffeeMaker::Renderer::Vulkan::ShaderWatcher::gWatches{};
+#else
+std::unordered_map<std::string, std::filesystem::file_time_type>
+    CoffeeMaker::Renderer::Vulkan::ShaderWatcher::gWriteTimes{};
+uint32_t CoffeeMaker::Renderer::Vulkan::ShaderWatcher::gLastPollTicks{0};
+#endif
+
+void CoffeeMaker::Renderer::Vulkan::ShaderWatcher::Start(const std::string& directory) {
+  if (IsRunning()) {
+    return;
+  }
+
+  std::error_code error{};
+  if (!std::filesystem::is_directory(directory, error)) {
+    SDL_LogWarn(0, "Unable to watch shader directory %s, hot reload is off.", directory.c_str());
+    return;
+  }
+  gDirectory = std::filesystem::path{directory}.lexically_normal().string();
+
+#ifdef __linux__
+  gFileDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (gFileDescriptor < 0) {
+    SDL_LogWarn(0, "Unable to create an inotify instance, shader hot reload is off.");
+    return;
+  }
+
+  AddWatch(gDirectory);
+  for (const auto& entry : std::filesystem::recursive_directory_iterator{gDirectory, error}) {
+    if (entry.is_directory()) {
+      AddWatch(entry.path().lexically_normal().string());
+    }
+  }
+#else
+  for (const auto& entry : std::filesystem::recursive_directory_iterator{gDirectory, error}) {
+    if (entry.is_regular_file()) {
+      gWriteTimes.insert_or_assign(entry.path().lexically_normal().string(), entry.last_write_time());
+    }
+  }
+  gLastPollTicks = SDL_GetTicks();
+#endif
+
+  fmt::print("Watching {} for shader changes\n", gDirectory);
+}
+
+void CoffeeMaker::Renderer::Vulkan::ShaderWatcher::Stop() {
+#ifdef __linux__
+  if (gFileDescriptor >= 0) {
+    // NOTE: closing the instance removes every watch on it
+    close(gFileDescriptor);
+    gFileDescriptor = -1;
+  }
+  gWatches.clear();
+#else
+  gWriteTimes.clear();
+#endif
+  gDirectory.clear();
+}
+
+bool CoffeeMaker::Renderer::Vulkan::ShaderWatcher::IsRunning() {
+#ifdef __linux__
+  return gFileDescriptor >= 0;
+#else
+  return !gDirectory.empty();
+#endif
+}
+
+std::vector<std::string> CoffeeMaker::Renderer::Vulkan::ShaderWatcher::Poll() {
+  std::vector<std::string> changed{};
+  if (!IsRunning()) {
+    return changed;
+  }
+
+  auto addChanged = [&changed](std::string path) {
+    // NOTE: editors often write a file several times in a row, report it once
+    if (std::find(changed.begin(), changed.end(), path) == changed.end()) {
+      changed.push_back(std::move(path));
+    }
+  };
+
+#ifdef __linux__
+  alignas(inotify_event) char buffer[4096];
+  while (true) {
+    ssize_t length = read(gFileDescriptor, buffer, sizeof(buffer));
+    if (length <= 0) {
+      break;
+    }
+
+    size_t offset = 0;
+    while (offset < static_cast<size_t>(length)) {
+      const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+      offset += sizeof(inotify_event) + event->len;
+
+      auto watch = gWatches.find(event->wd);
+      if (event->len == 0 || watch == gWatches.end()) {
+        continue;
+      }
+
+      std::string path = (std::filesystem::path{watch->second} / event->name).lexically_normal().string();
+      if (event->mask & IN_ISDIR) {
+        if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+          AddWatch(path);
+        }
+      } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+        // NOTE: IN_CREATE on a file fires before anything is written, wait for the write to finish
+        addChanged(std::move(path));
+      }
+    }
+  }
+#else
+  uint32_t ticks = SDL_GetTicks();
+  if (ticks - gLastPollTicks < PollIntervalMs) {
+    return changed;
+  }
+  gLastPollTicks = ticks;
+
+  std::error_code error{};
+  for (const auto& entry : std::filesystem::recursive_directory_iterator{gDirectory, error}) {
+    if (!entry.is_regular_file()) {
+      continue;
+    }
+
+    std::string path = entry.path().lexically_normal().string();
+    auto writeTime = entry.last_write_time();
+    auto elem = gWriteTimes.find(path);
+    if (elem == gWriteTimes.end() || elem->second != writeTime) {
+      gWriteTimes.insert_or_assign(path, writeTime);
+      addChanged(std::move(path));
+    }
+  }
+#endif
+
+  return changed;
+}
+
+#ifdef __linux__
+void CoffeeMaker::Renderer::Vulkan::ShaderWatcher::AddWatch(const std::string& directory) {
+  // NOTE: editors that save by renaming a temporary file over the original only raise IN_MOVED_TO
+  int watch = inotify_add_watch(gFileDescriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+  if (watch < 0) {
+    SDL_LogWarn(0, "Unable to watch %s for shader changes.", directory.c_str());
+    return;
+  }
+  gWatches.insert_or_assign(watch, directory);
+}
+#endif
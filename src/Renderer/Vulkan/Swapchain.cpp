@@ -2,15 +2,21 @@
 
 #include <SDL2/SDL.h>
 
+#include <algorithm>
 #include <array>
+#include <utility>
 
+#include "Renderer/Vulkan/DynamicRendering.hpp"
 #include "Renderer/Vulkan/LogicalDevice.hpp"
 #include "Renderer/Vulkan/PhysicalDevice.hpp"
 #include "Renderer/Vulkan/Surface.hpp"
+#include "Renderer/Vulkan/Synchronization.hpp"
 #include "Renderer/Vulkan/Utilities.hpp"
 
 CoffeeMaker::Renderer::Vulkan::Swapchain* CoffeeMaker::Renderer::Vulkan::Swapchain::gSwapchain{nullptr};
 CoffeeMaker::Renderer::Vulkan::Swapchain* CoffeeMaker::Renderer::Vulkan::Swapchain::gPrevSwapchain{nullptr};
+uint32_t CoffeeMaker::Renderer::Vulkan::Swapchain::gDepthPrecisionBits{24};
+std::vector<CoffeeMaker::Renderer::Vulkan::Swapchain::Retired> CoffeeMaker::Renderer::Vulkan::Swapchain::gRetired{};
 
 void CoffeeMaker::Renderer::Vulkan::Swapchain::CreateSwapchain() {
   gSwapchain = new Swapchain();
@@ -19,9 +25,36 @@ void CoffeeMaker::Renderer::Vulkan::Swapchain::CreateSwapchain() {
   gSwapchain->InitChooseSwapExtent();
   gSwapchain->InitCreateSwapchainKHR();
   gSwapchain->InitCreateImageViews();
+  gSwapchain->InitChooseDepthFormat();
   gSwapchain->InitCreateDepthImageView();
 }
 
+void CoffeeMaker::Renderer::Vulkan::Swapchain::Recreate(uint64_t lastUse) {
+  gPrevSwapchain = gSwapchain;
+  CreateSwapchain();
+  // NOTE: the old swapchain is retired by the create call, its images stay valid for the frames still in flight
+  gRetired.push_back({.value = lastUse, .swapchain = gPrevSwapchain});
+  gPrevSwapchain = nullptr;
+}
+
+void CoffeeMaker::Renderer::Vulkan::Swapchain::DestroyRetired(bool all) {
+  using Synchronization = CoffeeMaker::Renderer::Vulkan::Synchronization;
+
+  // NOTE: everything goes when destroying, the timeline may already be gone by then
+  uint64_t completed = all ? 0 : Synchronization::CompletedValue();
+  auto expired = [&](const Retired& entry) { return all || entry.value <= completed; };
+  for (Retired& entry : gRetired) {
+    if (!expired(entry)) {
+      continue;
+    }
+    entry.swapchain->Release();
+    delete entry.swapchain;
+  }
+  gRetired.erase(std::remove_if(gRetired.begin(), gRetired.end(), expired), gRetired.end());
+}
+
+void CoffeeMaker::Renderer::Vulkan::Swapchain::SetDepthPrecision(uint32_t bits) { gDepthPrecisionBits = bits; }
+
 VkSwapchainKHR CoffeeMaker::Renderer::Vulkan::Swapchain::GetVkpSwapchain() { return gSwapchain->pSwapchain; }
 
 CoffeeMaker::Renderer::Vulkan::Swapchain* CoffeeMaker::Renderer::Vulkan::Swapchain::GetSwapchain() {
@@ -29,18 +62,24 @@ CoffeeMaker::Renderer::Vulkan::Swapchain* CoffeeMaker::Renderer::Vulkan::Swapcha
 }
 
 void CoffeeMaker::Renderer::Vulkan::Swapchain::Destroy() {
+  DestroyRetired(true);
+  gSwapchain->Release();
+  delete gSwapchain;
+  gSwapchain = nullptr;
+}
+
+void CoffeeMaker::Renderer::Vulkan::Swapchain::Release() {
   using LogicDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
   using MemAlloc = CoffeeMaker::Renderer::Vulkan::MemoryAllocator;
 
-  for (auto imageView : gSwapchain->swapChainImageViews) {
+  for (auto imageView : swapChainImageViews) {
     vkDestroyImageView(LogicDevice::GetLogicalDevice(), imageView, nullptr);
   }
   // Destroy Depth Image Views and Image
-  vkDestroyImageView(LogicDevice::GetLogicalDevice(), gSwapchain->depthImageView, nullptr);
-  vmaDestroyImage(MemAlloc::GetAllocator(), gSwapchain->depthImage.image, gSwapchain->depthImage.allocation);
+  vkDestroyImageView(LogicDevice::GetLogicalDevice(), depthImageView, nullptr);
+  vmaDestroyImage(MemAlloc::GetAllocator(), depthImage.image, depthImage.allocation);
   // Destroy Swapchain
-  vkDestroySwapchainKHR(LogicDevice::GetLogicalDevice(), gSwapchain->pSwapchain, nullptr);
-  gSwapchain = VK_NULL_HANDLE;
+  vkDestroySwapchainKHR(LogicDevice::GetLogicalDevice(), pSwapchain, nullptr);
 }
 
 void CoffeeMaker::Renderer::Vulkan::Swapchain::InitChooseSwapSurfaceFormat() {
@@ -119,17 +158,65 @@ void CoffeeMaker::Renderer::Vulkan::Swapchain::InitCreateImageViews() {
   }
 }
 
+void CoffeeMaker::Renderer::Vulkan::Swapchain::InitChooseDepthFormat() {
+  using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
+
+  // NOTE: ordered from cheapest to most expensive, formats with stencil only as a fallback
+  const std::array<std::pair<VkFormat, uint32_t>, 5> depthFormats{{{VK_FORMAT_D16_UNORM, 16},
+                                                                   {VK_FORMAT_X8_D24_UNORM_PACK32, 24},
+                                                                   {VK_FORMAT_D24_UNORM_S8_UINT, 24},
+                                                                   {VK_FORMAT_D32_SFLOAT, 32},
+                                                                   {VK_FORMAT_D32_SFLOAT_S8_UINT, 32}}};
+
+  std::vector<VkFormat> candidates{};
+  for (const auto& [format, bits] : depthFormats) {
+    if (bits >= gDepthPrecisionBits) {
+      candidates.push_back(format);
+    }
+  }
+
+  VkFormat format = PhysicalDevice::GetPhysicalDeviceInUse()->FindSupportedFormat(
+      candidates, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+
+  if (format == VK_FORMAT_UNDEFINED) {
+    SDL_LogError(0, "Unable to find a depth format with at least %u bits of precision.", gDepthPrecisionBits);
+    exit(6666);
+  }
+
+  depthFormat = format;
+}
+
 void CoffeeMaker::Renderer::Vulkan::Swapchain::InitCreateDepthImageView() {
   using LogicDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
   using MemAlloc = CoffeeMaker::Renderer::Vulkan::MemoryAllocator;
+  using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
+  using DynamicRendering = CoffeeMaker::Renderer::Vulkan::DynamicRendering;
+
+  VkImageUsageFlags depthImageUsage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+  bool transient = IsTransientAttachment(depthUsage);
+  if (transient) {
+    depthImageUsage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+  }
+  // NOTE: tile-based GPUs can keep a transient attachment on-chip and never back it with real memory
+  depthLazilyAllocated = transient && PhysicalDevice::GetPhysicalDeviceInUse()->SupportsLazilyAllocatedMemory();
+
+  // NOTE: without framebuffers the depth attachment is a transient of the frame graph, see Vulkan::Draw
+  if (DynamicRendering::Supported) {
+    return;
+  }
 
   VkExtent3D depthImageExtent = {.width = extent.width, .height = extent.height, .depth = 1};
-  VkImageCreateInfo depthInfo = CoffeeMaker::Renderer::Vulkan::CreateImageInfo(
-      depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, depthImageExtent);
+  VkImageCreateInfo depthInfo =
+      CoffeeMaker::Renderer::Vulkan::CreateImageInfo(depthFormat, depthImageUsage, depthImageExtent);
 
   VmaAllocationCreateInfo dimgAllocInfo = {};
-  dimgAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
-  dimgAllocInfo.requiredFlags = VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  if (depthLazilyAllocated) {
+    dimgAllocInfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+    dimgAllocInfo.requiredFlags = VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+  } else {
+    dimgAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    dimgAllocInfo.requiredFlags = VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  }
 
   // allocate and create the image
   VkResult r = vmaCreateImage(MemAlloc::GetAllocator(), &depthInfo, &dimgAllocInfo, &depthImage.image,
@@ -187,12 +274,12 @@ void CoffeeMaker::Renderer::Vulkan::Swapchain::InitCreateSwapchainKHR() {
     createInfo.queueFamilyIndexCount = 0;      // Optional
     createInfo.pQueueFamilyIndices = nullptr;  // Optional
   }
-  // OldHandle = Handle != VK_NULL_HANDLE ? Handle : VK_NULL_HANDLE;
   createInfo.preTransform = details.capabilities.currentTransform;
   createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
   createInfo.presentMode = presentMode;
   createInfo.clipped = VK_TRUE;
-  createInfo.oldSwapchain = VK_NULL_HANDLE;
+  // NOTE: hands the window over from the previous swapchain, the surface is never without one while resizing
+  createInfo.oldSwapchain = gPrevSwapchain != nullptr ? gPrevSwapchain->pSwapchain : VK_NULL_HANDLE;
 
   VkResult result = vkCreateSwapchainKHR(LogicDevice::GetLogicalDevice(), &createInfo, nullptr, &pSwapchain);
 
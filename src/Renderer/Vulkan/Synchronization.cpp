@@ -1,7 +1,16 @@
 #include "Renderer/Vulkan/Synchronization.hpp"
 
+#include <SDL2/SDL.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+
+#include "CpuProfiler.hpp"
 #include "Renderer/Vulkan/LogicalDevice.hpp"
-#include "Renderer/Vulkan/Swapchain.hpp"
+#include "Renderer/Vulkan/PhysicalDevice.hpp"
+
+bool CoffeeMaker::Renderer::Vulkan::Synchronization::TimelineSupported{false};
+VkPhysicalDeviceTimelineSemaphoreFeatures CoffeeMaker::Renderer::Vulkan::Synchronization::gFeatures{};
 
 VkSemaphoreCreateInfo CoffeeMaker::Renderer::Vulkan::Synchronization::semaphoreCreateInfo{};
 VkFenceCreateInfo CoffeeMaker::Renderer::Vulkan::Synchronization::fenceCreateInfo{};
@@ -9,64 +18,222 @@ VkFenceCreateInfo CoffeeMaker::Renderer::Vulkan::Synchronization::fenceCreateInf
 std::vector<VkSemaphore> CoffeeMaker::Renderer::Vulkan::Synchronization::imageAvailableSemaphores{};
 std::vector<VkSemaphore> CoffeeMaker::Renderer::Vulkan::Synchronization::imageRenderSemaphores{};
 std::vector<VkFence> CoffeeMaker::Renderer::Vulkan::Synchronization::inFlightFences{};
-std::vector<VkFence> CoffeeMaker::Renderer::Vulkan::Synchronization::imagesInFlight{};
+VkSemaphore CoffeeMaker::Renderer::Vulkan::Synchronization::gTimeline{VK_NULL_HANDLE};
+std::vector<uint64_t> CoffeeMaker::Renderer::Vulkan::Synchronization::frameValues{};
+uint64_t CoffeeMaker::Renderer::Vulkan::Synchronization::gSubmitted{0};
+uint64_t CoffeeMaker::Renderer::Vulkan::Synchronization::gCompleted{0};
+PFN_vkWaitSemaphoresKHR CoffeeMaker::Renderer::Vulkan::Synchronization::gWaitSemaphores{nullptr};
+PFN_vkGetSemaphoreCounterValueKHR CoffeeMaker::Renderer::Vulkan::Synchronization::gGetSemaphoreCounterValue{nullptr};
+
+void CoffeeMaker::Renderer::Vulkan::Synchronization::EnableIfSupported(std::vector<const char*>& deviceExtensions) {
+  using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  PhysicalDevice* device = PhysicalDevice::GetPhysicalDeviceInUse();
+
+  gFeatures = {};
+  gFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+  if (!device->IsExtensionSupported(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) || !device->QueryFeatures2(&gFeatures)) {
+    fmt::print("Timeline semaphores: off\n");
+    return;
+  }
+
+  TimelineSupported = gFeatures.timelineSemaphore == VK_TRUE;
+  if (TimelineSupported) {
+    deviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    gFeatures = {};
+    gFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    gFeatures.timelineSemaphore = VK_TRUE;
+    LogicalDevice::AddFeatures(&gFeatures);
+  }
+
+  fmt::print("Timeline semaphores: {}\n", TimelineSupported ? "on" : "off");
+}
+
+void CoffeeMaker::Renderer::Vulkan::Synchronization::LoadFunctions(VkDevice device) {
+  if (!TimelineSupported) {
+    return;
+  }
 
-void CoffeeMaker::Renderer::Vulkan::Synchronization::CreateSyncTools() {
+  gWaitSemaphores = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(device, "vkWaitSemaphoresKHR");
+  gGetSemaphoreCounterValue =
+      (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(device, "vkGetSemaphoreCounterValueKHR");
+  if (gWaitSemaphores == nullptr || gGetSemaphoreCounterValue == nullptr) {
+    SDL_LogWarn(0, "Unable to load the timeline semaphore functions, using fences.");
+    TimelineSupported = false;
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::Synchronization::CreateSyncTools(size_t framesInFlight) {
   using LogicDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
-  using Swapchain = CoffeeMaker::Renderer::Vulkan::Swapchain;
 
-  imageAvailableSemaphores.resize(2);
-  imageRenderSemaphores.resize(2);
-  inFlightFences.resize(2);
-  imagesInFlight.resize(Swapchain::GetSwapchain()->swapChainImages.size(), VK_NULL_HANDLE);
+  imageAvailableSemaphores.resize(framesInFlight);
+  imageRenderSemaphores.resize(framesInFlight);
+  frameValues.assign(framesInFlight, 0);
+  gSubmitted = 0;
+  gCompleted = 0;
 
   // NOTE: semaphores don't need any flags
   semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
   semaphoreCreateInfo.pNext = nullptr;
   semaphoreCreateInfo.flags = 0;
 
+  // NOTE: the fences start unsignaled, a slot with value 0 has never been submitted and is not waited on
   fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-  /**
-   * NOTE: we want to create the fence with the Create Signaled flag,
-   * so we can wait on it before using it on a GPU command
-   * (for the first frame)
-   */
-  fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+  fenceCreateInfo.flags = 0;
   fenceCreateInfo.pNext = nullptr;
 
-  for (int i = 0; i < 2; i++) {
+  for (size_t i = 0; i < framesInFlight; i++) {
     vkCreateSemaphore(LogicDevice::GetLogicalDevice(), &semaphoreCreateInfo, nullptr, &imageAvailableSemaphores[i]);
     vkCreateSemaphore(LogicDevice::GetLogicalDevice(), &semaphoreCreateInfo, nullptr, &imageRenderSemaphores[i]);
-    vkCreateFence(LogicDevice::GetLogicalDevice(), &fenceCreateInfo, nullptr, &inFlightFences[i]);
+  }
+
+  if (!TimelineSupported) {
+    inFlightFences.resize(framesInFlight);
+    for (size_t i = 0; i < framesInFlight; i++) {
+      vkCreateFence(LogicDevice::GetLogicalDevice(), &fenceCreateInfo, nullptr, &inFlightFences[i]);
+    }
+    return;
+  }
+
+  VkSemaphoreTypeCreateInfo typeInfo{};
+  typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+  typeInfo.pNext = nullptr;
+  typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+  typeInfo.initialValue = 0;
+
+  VkSemaphoreCreateInfo timelineInfo = semaphoreCreateInfo;
+  timelineInfo.pNext = &typeInfo;
+  VkResult result = vkCreateSemaphore(LogicDevice::GetLogicalDevice(), &timelineInfo, nullptr, &gTimeline);
+  if (result != VK_SUCCESS) {
+    SDL_LogError(0, "Unable to create the frame timeline semaphore.\nVulkan Error Code: [%d]", result);
+    exit(16);
   }
 }
 
 void CoffeeMaker::Renderer::Vulkan::Synchronization::DestroySyncTools() {
   using LogicDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
 
-  for (int i = 0; i < 2; i++) {
+  for (size_t i = 0; i < imageAvailableSemaphores.size(); i++) {
     vkDestroySemaphore(LogicDevice::GetLogicalDevice(), imageRenderSemaphores[i], nullptr);
     vkDestroySemaphore(LogicDevice::GetLogicalDevice(), imageAvailableSemaphores[i], nullptr);
-    vkDestroyFence(LogicDevice::GetLogicalDevice(), inFlightFences[i], nullptr);
   }
+  for (VkFence fence : inFlightFences) {
+    vkDestroyFence(LogicDevice::GetLogicalDevice(), fence, nullptr);
+  }
+  if (gTimeline != VK_NULL_HANDLE) {
+    vkDestroySemaphore(LogicDevice::GetLogicalDevice(), gTimeline, nullptr);
+  }
+
+  imageAvailableSemaphores.clear();
+  imageRenderSemaphores.clear();
+  inFlightFences.clear();
+  gTimeline = VK_NULL_HANDLE;
 }
 
-void CoffeeMaker::Renderer::Vulkan::Synchronization::WaitForFence(size_t currentFrame) {
+void CoffeeMaker::Renderer::Vulkan::Synchronization::WaitForFrame(size_t frame) { WaitForValue(frameValues[frame]); }
+
+uint64_t CoffeeMaker::Renderer::Vulkan::Synchronization::SubmitFrame(VkQueue queue, const VkSubmitInfo& submitInfo,
+                                                                      size_t frame) {
   using LogicDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
 
-  vkWaitForFences(LogicDevice::GetLogicalDevice(), 1, &inFlightFences[currentFrame], true, 1000000000);
+  uint64_t value = gSubmitted + 1;
+
+  if (!TimelineSupported) {
+    vkResetFences(LogicDevice::GetLogicalDevice(), 1, &inFlightFences[frame]);
+    CPU_SCOPE("vkQueueSubmit");
+    vkQueueSubmit(queue, 1, &submitInfo, inFlightFences[frame]);
+    gSubmitted = value;
+    frameValues[frame] = value;
+    return value;
+  }
+
+  // NOTE: binary semaphores ignore their values, they only have to be there to line up with the semaphores
+  std::vector<VkSemaphore> signalSemaphores(submitInfo.pSignalSemaphores,
+                                            submitInfo.pSignalSemaphores + submitInfo.signalSemaphoreCount);
+  std::vector<uint64_t> signalValues(submitInfo.signalSemaphoreCount, 0);
+  signalSemaphores.push_back(gTimeline);
+  signalValues.push_back(value);
+  std::vector<uint64_t> waitValues(submitInfo.waitSemaphoreCount, 0);
+
+  VkTimelineSemaphoreSubmitInfo timelineInfo{};
+  timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+  timelineInfo.pNext = submitInfo.pNext;
+  timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+  timelineInfo.pWaitSemaphoreValues = waitValues.data();
+  timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+  timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+  VkSubmitInfo timelineSubmit = submitInfo;
+  timelineSubmit.pNext = &timelineInfo;
+  timelineSubmit.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+  timelineSubmit.pSignalSemaphores = signalSemaphores.data();
+
+  CPU_SCOPE("vkQueueSubmit");
+  vkQueueSubmit(queue, 1, &timelineSubmit, VK_NULL_HANDLE);
+  gSubmitted = value;
+  frameValues[frame] = value;
+  return value;
 }
 
-void CoffeeMaker::Renderer::Vulkan::Synchronization::ResetFence(size_t currentFrame) {
+void CoffeeMaker::Renderer::Vulkan::Synchronization::WaitForValue(uint64_t value) {
   using LogicDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
 
-  vkResetFences(LogicDevice::GetLogicalDevice(), 1, &inFlightFences[currentFrame]);
+  if (value == 0 || value <= gCompleted) {
+    return;
+  }
+
+  CPU_SCOPE("Synchronization::WaitForValue");
+  VkResult result = VK_SUCCESS;
+  if (TimelineSupported) {
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &gTimeline;
+    waitInfo.pValues = &value;
+    result = gWaitSemaphores(LogicDevice::GetLogicalDevice(), &waitInfo, UINT64_MAX);
+  } else {
+    // NOTE: submissions complete in order, the oldest slot that reaches the value covers it
+    size_t slot = frameValues.size();
+    for (size_t i = 0; i < frameValues.size(); i++) {
+      if (frameValues[i] >= value && (slot == frameValues.size() || frameValues[i] < frameValues[slot])) {
+        slot = i;
+      }
+    }
+    if (slot == frameValues.size()) {
+      SDL_LogError(0, "Waiting on frame value %llu that was never submitted.", static_cast<unsigned long long>(value));
+      exit(16);
+    }
+    result = vkWaitForFences(LogicDevice::GetLogicalDevice(), 1, &inFlightFences[slot], VK_TRUE, UINT64_MAX);
+    value = frameValues[slot];
+  }
+
+  if (result != VK_SUCCESS) {
+    SDL_LogError(0, "Unable to wait for frame value %llu.\nVulkan Error Code: [%d]",
+                 static_cast<unsigned long long>(value), result);
+    exit(16);
+  }
+  gCompleted = std::max(gCompleted, value);
 }
 
-// void CoffeeMaker::Renderer::Vulkan::Synchronization::WaitForImageAvailable(size_t imageIndex) {
-//   using LogicDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
-// }
+uint64_t CoffeeMaker::Renderer::Vulkan::Synchronization::CompletedValue() {
+  using LogicDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  if (TimelineSupported) {
+    uint64_t value = 0;
+    if (gGetSemaphoreCounterValue(LogicDevice::GetLogicalDevice(), gTimeline, &value) == VK_SUCCESS) {
+      gCompleted = std::max(gCompleted, value);
+    }
+    return gCompleted;
+  }
+
+  for (size_t i = 0; i < inFlightFences.size(); i++) {
+    bool signaled = vkGetFenceStatus(LogicDevice::GetLogicalDevice(), inFlightFences[i]) == VK_SUCCESS;
+    if (signaled && frameValues[i] > gCompleted) {
+      gCompleted = frameValues[i];
+    }
+  }
+  return gCompleted;
+}
 
-// void CoffeeMaker::Renderer::Vulkan::Synchronization::WaitForImageRender(size_t imageIndex) {
-//   using LogicDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
-// }
+uint64_t CoffeeMaker::Renderer::Vulkan::Synchronization::PendingValue() { return gSubmitted + 1; }
@@ -0,0 +1,126 @@
+#include "Renderer/Vulkan/Synchronization2.hpp"
+
+#include <SDL2/SDL.h>
+#include <fmt/core.h>
+
+#include "Renderer/Vulkan/LogicalDevice.hpp"
+#include "Renderer/Vulkan/PhysicalDevice.hpp"
+
+bool CoffeeMaker::Renderer::Vulkan::Synchronization2::Supported{false};
+VkPhysicalDeviceSynchronization2Features CoffeeMaker::Renderer::Vulkan::Synchronization2::gFeatures{};
+PFN_vkCmdPipelineBarrier2KHR CoffeeMaker::Renderer::Vulkan::Synchronization2::gCmdPipelineBarrier2{nullptr};
+PFN_vkCmdWriteTimestamp2KHR CoffeeMaker::Renderer::Vulkan::Synchronization2::gCmdWriteTimestamp2{nullptr};
+
+void CoffeeMaker::Renderer::Vulkan::Synchronization2::EnableIfSupported(std::vector<const char*>& deviceExtensions) {
+  using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
+  using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+
+  PhysicalDevice* device = PhysicalDevice::GetPhysicalDeviceInUse();
+
+  gFeatures = {};
+  gFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
+  if (!device->IsExtensionSupported(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME) || !device->QueryFeatures2(&gFeatures)) {
+    fmt::print("Synchronization2: off\n");
+    return;
+  }
+
+  Supported = gFeatures.synchronization2 == VK_TRUE;
+  if (Supported) {
+    deviceExtensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+    gFeatures = {};
+    gFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
+    gFeatures.synchronization2 = VK_TRUE;
+    LogicalDevice::AddFeatures(&gFeatures);
+  }
+
+  fmt::print("Synchronization2: {}\n", Supported ? "on" : "off");
+}
+
+void CoffeeMaker::Renderer::Vulkan::Synchronization2::LoadFunctions(VkDevice device) {
+  if (!Supported) {
+    return;
+  }
+
+  gCmdPipelineBarrier2 = (PFN_vkCmdPipelineBarrier2KHR)vkGetDeviceProcAddr(device, "vkCmdPipelineBarrier2KHR");
+  gCmdWriteTimestamp2 = (PFN_vkCmdWriteTimestamp2KHR)vkGetDeviceProcAddr(device, "vkCmdWriteTimestamp2KHR");
+  if (gCmdPipelineBarrier2 == nullptr || gCmdWriteTimestamp2 == nullptr) {
+    SDL_LogWarn(0, "Unable to load the synchronization2 commands, using vkCmdPipelineBarrier.");
+    Supported = false;
+  }
+}
+
+void CoffeeMaker::Renderer::Vulkan::Synchronization2::PipelineBarrier(VkCommandBuffer cmd,
+                                                                      const VkDependencyInfo& dependency) {
+  if (Supported) {
+    gCmdPipelineBarrier2(cmd, &dependency);
+    return;
+  }
+
+  // NOTE: the original bits have the same values in the 64 bit flags, every stage is merged into one barrier
+  VkPipelineStageFlags srcStages = 0;
+  VkPipelineStageFlags dstStages = 0;
+
+  std::vector<VkMemoryBarrier> memoryBarriers(dependency.memoryBarrierCount);
+  for (uint32_t i = 0; i < dependency.memoryBarrierCount; i++) {
+    const VkMemoryBarrier2& barrier = dependency.pMemoryBarriers[i];
+    srcStages |= static_cast<VkPipelineStageFlags>(barrier.srcStageMask);
+    dstStages |= static_cast<VkPipelineStageFlags>(barrier.dstStageMask);
+    memoryBarriers[i].sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarriers[i].srcAccessMask = static_cast<VkAccessFlags>(barrier.srcAccessMask);
+    memoryBarriers[i].dstAccessMask = static_cast<VkAccessFlags>(barrier.dstAccessMask);
+  }
+
+  std::vector<VkBufferMemoryBarrier> bufferBarriers(dependency.bufferMemoryBarrierCount);
+  for (uint32_t i = 0; i < dependency.bufferMemoryBarrierCount; i++) {
+    const VkBufferMemoryBarrier2& barrier = dependency.pBufferMemoryBarriers[i];
+    srcStages |= static_cast<VkPipelineStageFlags>(barrier.srcStageMask);
+    dstStages |= static_cast<VkPipelineStageFlags>(barrier.dstStageMask);
+    bufferBarriers[i].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarriers[i].srcAccessMask = static_cast<VkAccessFlags>(barrier.srcAccessMask);
+    bufferBarriers[i].dstAccessMask = static_cast<VkAccessFlags>(barrier.dstAccessMask);
+    bufferBarriers[i].srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+    bufferBarriers[i].dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+    bufferBarriers[i].buffer = barrier.buffer;
+    bufferBarriers[i].offset = barrier.offset;
+    bufferBarriers[i].size = barrier.size;
+  }
+
+  std::vector<VkImageMemoryBarrier> imageBarriers(dependency.imageMemoryBarrierCount);
+  for (uint32_t i = 0; i < dependency.imageMemoryBarrierCount; i++) {
+    const VkImageMemoryBarrier2& barrier = dependency.pImageMemoryBarriers[i];
+    srcStages |= static_cast<VkPipelineStageFlags>(barrier.srcStageMask);
+    dstStages |= static_cast<VkPipelineStageFlags>(barrier.dstStageMask);
+    imageBarriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarriers[i].srcAccessMask = static_cast<VkAccessFlags>(barrier.srcAccessMask);
+    imageBarriers[i].dstAccessMask = static_cast<VkAccessFlags>(barrier.dstAccessMask);
+    imageBarriers[i].oldLayout = barrier.oldLayout;
+    imageBarriers[i].newLayout = barrier.newLayout;
+    imageBarriers[i].srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+    imageBarriers[i].dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+    imageBarriers[i].image = barrier.image;
+    imageBarriers[i].subresourceRange = barrier.subresourceRange;
+  }
+
+  // NOTE: an empty stage mask is only valid with synchronization2
+  if (srcStages == 0) {
+    srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+  }
+  if (dstStages == 0) {
+    dstStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+  }
+
+  vkCmdPipelineBarrier(cmd, srcStages, dstStages, dependency.dependencyFlags,
+                       static_cast<uint32_t>(memoryBarriers.size()), memoryBarriers.data(),
+                       static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+                       static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+}
+
+void CoffeeMaker::Renderer::Vulkan::Synchronization2::WriteTimestamp(VkCommandBuffer cmd, VkPipelineStageFlags2 stage,
+                                                                     VkQueryPool pool, uint32_t query) {
+  if (Supported) {
+    gCmdWriteTimestamp2(cmd, stage, pool, query);
+    return;
+  }
+
+  vkCmdWriteTimestamp(cmd, static_cast<VkPipelineStageFlagBits>(stage), pool, query);
+}
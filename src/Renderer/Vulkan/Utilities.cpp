@@ -40,3 +40,31 @@ VkImageViewCreateInfo CoffeeMaker::Renderer::Vulkan::CreateImageViewInfo(VkForma
 
   return info;
 }
+
+VkAttachmentLoadOp CoffeeMaker::Renderer::Vulkan::ChooseLoadOp(const AttachmentUsage& usage) {
+  if (usage.clearOnLoad) {
+    return VK_ATTACHMENT_LOAD_OP_CLEAR;
+  }
+
+  return usage.readsPreviousContents ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+}
+
+VkAttachmentStoreOp CoffeeMaker::Renderer::Vulkan::ChooseStoreOp(const AttachmentUsage& usage) {
+  return usage.readAfterPass ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+}
+
+bool CoffeeMaker::Renderer::Vulkan::IsTransientAttachment(const AttachmentUsage& usage) {
+  return !usage.readsPreviousContents && !usage.readAfterPass;
+}
+
+bool CoffeeMaker::Renderer::Vulkan::FormatHasStencil(VkFormat format) {
+  switch (format) {
+    case VK_FORMAT_S8_UINT:
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+      return true;
+    default:
+      return false;
+  }
+}
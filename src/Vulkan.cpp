@@ -4,13 +4,17 @@
 #include <fmt/core.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <iostream>
 #include <set>
 #include <vector>
 
 #include "Camera.hpp"
+#include "CpuProfiler.hpp"
 #include "SimpleMessageBox.hpp"
+#include "VkImGui.hpp"
 #include "VkInitializers.hpp"
 #include "imgui.h"
 #include "imgui_impl_vulkan.h"
@@ -36,7 +40,8 @@ std::string VkPresentModeKHRString(VkPresentModeKHR mode) {
   }
 }
 
-int Vulkan::MAX_FRAMES_IN_FLIGHT = 2;
+// NOTE: per-frame resource slots, the FramePacer decides how many frames are actually in flight
+int Vulkan::MAX_FRAMES_IN_FLIGHT = static_cast<int>(CoffeeMaker::Renderer::Vulkan::FramePacer::MaxFramesInFlight);
 
 Vulkan *Vulkan::_mainRenderer = nullptr;
 
@@ -62,9 +67,23 @@ Vulkan::Vulkan(const std::string &applicationName, SDL_Window *window) :
   CreateRenderPass();
   CreateFramebuffer();
   CreateCommands();
+  batcher.Create(MAX_FRAMES_IN_FLIGHT);
   CreateUploadCommands();
   CreateSemaphores();
   InitSyncStructures();
+  CoffeeMaker::Renderer::Vulkan::ShaderCompiler::Start();
+  // NOTE: queue every shader up front so they compile (or load from the cache) in parallel
+  CoffeeMaker::Renderer::MeshShaders().Prefetch(0);
+  CoffeeMaker::Renderer::MeshShaders().Prefetch(CoffeeMaker::Renderer::MeshShowNormals);
+  CoffeeMaker::Renderer::MeshShaders().Prefetch(CoffeeMaker::Renderer::MeshInstanced);
+#ifdef COFFEEMAKER_SHADER_ROOT
+  VulkanShaderManager::EnableHotReload();
+#endif
+  CoffeeMaker::Renderer::Vulkan::PipelineCompiler::Start();
+  CreateFallbackPipeline();
+  if (CoffeeMaker::Renderer::Vulkan::IndirectDraw::Supported) {
+    gpuScene.Create(MAX_FRAMES_IN_FLIGHT);
+  }
   _mainRenderer = this;
   rectangle = new CoffeeMaker::Primitives::Rectangle();
   triangle = new Triangle();
@@ -77,6 +96,10 @@ Vulkan::~Vulkan() {
   using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
 
   vkDeviceWaitIdle(LogicalDevice::GetLogicalDevice());
+  CoffeeMaker::Renderer::Vulkan::PipelineCompiler::Stop();
+  CoffeeMaker::Renderer::Vulkan::ShaderCompiler::Stop();
+  CoffeeMaker::Renderer::Vulkan::ShaderWatcher::Stop();
+  CoffeeMaker::Renderer::Vulkan::CommandRecorder::Stop();
 
   if (enableValidationLayers) {
     DestroyDebugUtilsMessengerEXT(nullptr);
@@ -90,10 +113,20 @@ Vulkan::~Vulkan() {
   delete triangle;
   delete rectangle;
   // delete suzanne;
+  CoffeeMaker::Renderer::Vulkan::PipelineRegistry::Clear();
+  CoffeeMaker::Renderer::Vulkan::PipelineLibrary::Clear();
+  // NOTE: the pipelines released above were retired, the device is idle so they can go right away
+  CoffeeMaker::Renderer::Vulkan::PipelineCompiler::DestroyRetired();
 
   Synchronization::DestroySyncTools();
-  Commands::DestroyCommandPool();
+  CoffeeMaker::Renderer::Vulkan::FrameContext::Destroy();
+  CoffeeMaker::Renderer::Vulkan::GpuProfiler::Destroy();
+  CoffeeMaker::Renderer::Vulkan::FrameCounters::Destroy();
+  batcher.Destroy();
+  gpuScene.Destroy();
+  frameGraph.Destroy();
   VulkanShaderManager::CleanAllShaders();
+  CoffeeMaker::Renderer::Vulkan::PipelineCache::Destroy();
   CoffeeMaker::Renderer::Vulkan::MemoryAllocator::DestroyAllocator();
   LogicalDevice::Destroy();
   PhysicalDevice::ClearAllPhysicalDevices();
@@ -118,16 +151,48 @@ void Vulkan::EditorUpdate() {
       ImGui::EndTabItem();
     }
     if (ImGui::BeginTabItem("Swapchain")) {
-      ImGui::Text("swapchain info...!");
+      Editor_SwapchainInformation();
       ImGui::EndTabItem();
     }
     if (ImGui::BeginTabItem("Framebuffer")) {
       ImGui::Text("swapchain info...!");
       ImGui::EndTabItem();
     }
+    if (ImGui::BeginTabItem("Pipelines")) {
+      Editor_PipelineInformation();
+      ImGui::EndTabItem();
+    }
+    if (ImGui::BeginTabItem("Frame Pacing")) {
+      Editor_FramePacingInformation();
+      ImGui::EndTabItem();
+    }
+    if (ImGui::BeginTabItem("CPU Profiler")) {
+      Editor_CpuProfilerInformation();
+      ImGui::EndTabItem();
+    }
+    if (ImGui::BeginTabItem("GPU Profiler")) {
+      Editor_GpuProfilerInformation();
+      ImGui::EndTabItem();
+    }
+    if (ImGui::BeginTabItem("Counters")) {
+      Editor_CountersInformation();
+      ImGui::EndTabItem();
+    }
+    if (ImGui::BeginTabItem("Render Graph")) {
+      Editor_RenderGraphInformation();
+      ImGui::EndTabItem();
+    }
+    if (ImGui::BeginTabItem("Recording")) {
+      Editor_RecordingInformation();
+      ImGui::EndTabItem();
+    }
     ImGui::EndTabBar();
   }
   ImGui::End();
+
+  if (countersOverlay) {
+    Editor_CountersOverlay();
+  }
 }
 
 void Vulkan::Editor_PhysicalDeviceSelection() {
@@ -207,42 +272,432 @@ void Vulkan::Editor_PhysicalDeviceInformation() {
   }
 }
 
+void Vulkan::Editor_SwapchainInformation() {
+  using Swapchain = CoffeeMaker::Renderer::Vulkan::Swapchain;
+
+  Swapchain *swapchain = Swapchain::GetSwapchain();
+  ImGui::BulletText("Extent: %ux%u, %u images", swapchain->extent.width, swapchain->extent.height,
+                    swapchain->imageCount);
+  ImGui::BulletText("Depth Format: %d%s", static_cast<int>(swapchain->depthFormat),
+                    swapchain->depthLazilyAllocated ? " (lazily allocated)" : "");
+
+  // NOTE: the smallest supported format with at least this many bits is picked when the swapchain is recreated
+  const std::array<uint32_t, 3> precisions{16, 24, 32};
+  int selected = 0;
+  for (size_t i = 0; i < precisions.size(); i++) {
+    if (precisions[i] == Swapchain::gDepthPrecisionBits) {
+      selected = static_cast<int>(i);
+    }
+  }
+  if (ImGui::Combo("Depth Precision", &selected, "16 bits\0" "24 bits\0" "32 bits\0")) {
+    Swapchain::SetDepthPrecision(precisions[static_cast<size_t>(selected)]);
+    // NOTE: recreated at the start of the next frame, a format change rebuilds the render pass as well
+    framebufferResized = true;
+  }
+}
+
+void Vulkan::Editor_PipelineInformation() {
+  using PipelineCache = CoffeeMaker::Renderer::Vulkan::PipelineCache;
+  using PipelineRegistry = CoffeeMaker::Renderer::Vulkan::PipelineRegistry;
+  using PipelineCompiler = CoffeeMaker::Renderer::Vulkan::PipelineCompiler;
+  using DynamicState = CoffeeMaker::Renderer::Vulkan::DynamicState;
+  using PipelineLibrary = CoffeeMaker::Renderer::Vulkan::PipelineLibrary;
+  using ShaderCompiler = CoffeeMaker::Renderer::Vulkan::ShaderCompiler;
+  using ShaderWatcher = CoffeeMaker::Renderer::Vulkan::ShaderWatcher;
+
+  ImGui::BulletText("Pipeline Cache: %s", PipelineCache::IsWarm() ? "warm" : "cold");
+  ImGui::BulletText("Rendering: %s",
+                    CoffeeMaker::Renderer::Vulkan::DynamicRendering::Supported ? "Dynamic Rendering" : "Render Pass");
+  ImGui::BulletText("Extended Dynamic State: %s", DynamicState::ExtendedDynamicState ? "On" : "Off");
+  ImGui::BulletText("Dynamic Polygon Mode: %s", DynamicState::ExtendedDynamicState3PolygonMode ? "On" : "Off");
+  ImGui::BulletText("Pipeline Library: %s%s", PipelineLibrary::Enabled ? "On" : "Off",
+                    PipelineLibrary::FastLinking ? " (fast linking)" : "");
+  ImGui::BulletText("Library Parts: %zu", PipelineLibrary::PartCount());
+  ImGui::BulletText("Optimized Links: %zu", PipelineCompiler::PipelinesOptimized);
+  ImGui::BulletText("Shader Hot Reload: %s", ShaderWatcher::IsRunning() ? "On" : "Off");
+  ImGui::BulletText("Pipelines Rebuilt: %zu", PipelineCompiler::PipelinesRebuilt);
+  ImGui::BulletText("Pipelines Created: %u (%.3f ms)", PipelineCache::gPipelinesCreated,
+                    PipelineCache::gPipelineCreationMs);
+  ImGui::BulletText("Registry Hits: %zu", PipelineRegistry::Hits);
+  ImGui::BulletText("Registry Misses: %zu", PipelineRegistry::Misses);
+  ImGui::BulletText("Descriptor Set Layouts: %zu", PipelineRegistry::gDescriptorSetLayouts.size());
+  ImGui::BulletText("Shader Cache Hits: %zu", ShaderCompiler::CacheHits.load());
+  ImGui::BulletText("Shader Compiles: %zu (%zu failed)", ShaderCompiler::CacheMisses.load(),
+                    ShaderCompiler::CompileFailures.load());
+  ImGui::BulletText("Pipelines Compiling: %zu", PipelineCompiler::PendingCount());
+  ImGui::BulletText("Slowest Compile: %.3f ms", PipelineCompiler::SlowestCompileMs);
+  ImGui::BulletText("Fallback Draws: %zu", PipelineRegistry::FallbackDraws.load());
+  ImGui::BulletText("Skipped Draws: %zu", PipelineRegistry::SkippedDraws.load());
+}
+
+void Vulkan::Editor_FramePacingInformation() {
+  using FramePacer = CoffeeMaker::Renderer::Vulkan::FramePacer;
+
+  int framesInFlight = static_cast<int>(FramePacer::FramesInFlight);
+  if (ImGui::SliderInt("Frames In Flight", &framesInFlight, 1, static_cast<int>(FramePacer::MaxFramesInFlight))) {
+    FramePacer::FramesInFlight = static_cast<size_t>(framesInFlight);
+  }
+  ImGui::Checkbox("Low Latency", &FramePacer::LowLatency);
+  float safetyMargin = static_cast<float>(FramePacer::SafetyMarginMs);
+  if (ImGui::SliderFloat("Safety Margin (ms)", &safetyMargin, 0.0f, 8.0f)) {
+    FramePacer::SafetyMarginMs = safetyMargin;
+  }
+  ImGui::BulletText("Present Wait: %s", FramePacer::PresentWaitSupported ? "On" : "Off");
+  ImGui::BulletText("Refresh Interval: %.2f ms", FramePacer::RefreshIntervalMs);
+  ImGui::BulletText("Input To %s: %.2f ms (last %.2f ms)", FramePacer::PresentWaitSupported ? "Present" : "GPU Done",
+                    FramePacer::LatencyMs, FramePacer::LastLatencyMs);
+  ImGui::BulletText("CPU Frame: %.2f ms, GPU Frame: %.2f ms", FramePacer::CpuMs, FramePacer::GpuMs);
+  ImGui::BulletText("Pacing Wait: %.2f ms (slept %.2f ms)", FramePacer::LastWaitMs, FramePacer::LastSleepMs);
+}
+
+void Vulkan::Editor_CpuProfilerInformation() {
+  using CpuProfiler = CoffeeMaker::CpuProfiler;
+
+#ifdef COFFEEMAKER_PROFILING
+  bool enabled = CpuProfiler::Enabled.load(std::memory_order_relaxed);
+  if (ImGui::Checkbox("Enabled", &enabled)) {
+    CpuProfiler::Enabled.store(enabled, std::memory_order_relaxed);
+  }
+  for (const CpuProfiler::ThreadInfo &thread : CpuProfiler::Threads()) {
+    ImGui::BulletText("%s: %llu scopes", thread.name.empty() ? "Unnamed" : thread.name.c_str(),
+                      static_cast<unsigned long long>(thread.recorded));
+  }
+#else
+  ImGui::Text("CPU scopes are compiled out, build with COFFEEMAKER_PROFILING.");
+#endif
+  // NOTE: the GPU frames are exported either way
+  if (ImGui::Button("Export Chrome Trace")) {
+    traceWritten = CpuProfiler::ExportChromeTrace("frame_trace.json");
+  }
+  if (traceWritten) {
+    ImGui::SameLine();
+    ImGui::Text("frame_trace.json");
+  }
+}
+
+void Vulkan::Editor_GpuProfilerInformation() {
+  using GpuProfiler = CoffeeMaker::Renderer::Vulkan::GpuProfiler;
+
+  if (!GpuProfiler::Supported) {
+    ImGui::Text("The graphics queue has no timestamps.");
+    return;
+  }
+
+  ImGui::Checkbox("Enabled", &GpuProfiler::Enabled);
+  ImGui::SameLine();
+  if (ImGui::Button("Reset")) {
+    GpuProfiler::ResetStats();
+  }
+  bool logging = !GpuProfiler::LogPath.empty();
+  if (ImGui::Checkbox("Log to gpu_profile.jsonl", &logging)) {
+    GpuProfiler::SetLogPath(logging ? "gpu_profile.jsonl" : "");
+  }
+  ImGui::BulletText("GPU Frame: %.3f ms", GpuProfiler::FrameMs);
+
+  if (ImGui::BeginTable("GPU Scopes", 5, ImGuiTableFlags_ScrollY, ImVec2(0.f, 300.f), 300.f)) {
+    ImGui::TableNextRow();
+    ImGui::TableSetColumnIndex(0);
+    ImGui::Text("Scope");
+    ImGui::TableSetColumnIndex(1);
+    ImGui::Text("Last");
+    ImGui::TableSetColumnIndex(2);
+    ImGui::Text("Average");
+    ImGui::TableSetColumnIndex(3);
+    ImGui::Text("Min");
+    ImGui::TableSetColumnIndex(4);
+    ImGui::Text("Max");
+    for (const GpuProfiler::ScopeStats *stats : GpuProfiler::LastFrameScopes()) {
+      ImGui::TableNextRow();
+      ImGui::TableSetColumnIndex(0);
+      ImGui::Text("%*s%s", static_cast<int>(stats->depth * 2), "", stats->name.c_str());
+      ImGui::TableSetColumnIndex(1);
+      ImGui::Text("%.3f ms", stats->lastMs);
+      ImGui::TableSetColumnIndex(2);
+      ImGui::Text("%.3f ms", stats->averageMs);
+      ImGui::TableSetColumnIndex(3);
+      ImGui::Text("%.3f ms", stats->minMs);
+      ImGui::TableSetColumnIndex(4);
+      ImGui::Text("%.3f ms", stats->maxMs);
+    }
+    ImGui::EndTable();
+  }
+}
+
+void Vulkan::Editor_CountersInformation() {
+  using FrameCounters = CoffeeMaker::Renderer::Vulkan::FrameCounters;
+
+  ImGui::Checkbox("Overlay", &countersOverlay);
+  if (FrameCounters::Supported) {
+    ImGui::SameLine();
+    ImGui::Checkbox("Pipeline Statistics", &FrameCounters::Enabled);
+  }
+  bool csv = FrameCounters::LogPath == "frame_counters.csv";
+  if (ImGui::Checkbox("Log to frame_counters.csv", &csv)) {
+    FrameCounters::SetLogPath(csv ? "frame_counters.csv" : "");
+  }
+  bool jsonLines = FrameCounters::LogPath == "frame_counters.jsonl";
+  if (ImGui::Checkbox("Log to frame_counters.jsonl", &jsonLines)) {
+    FrameCounters::SetLogPath(jsonLines ? "frame_counters.jsonl" : "");
+  }
+
+  const FrameCounters::Counters &counters = FrameCounters::Last;
+  ImGui::BulletText("Draw Calls: %llu, Instances: %llu", static_cast<unsigned long long>(counters.drawCalls),
+                    static_cast<unsigned long long>(counters.instances));
+  ImGui::BulletText("Triangles: %llu direct, up to %llu indirect", static_cast<unsigned long long>(counters.triangles),
+                    static_cast<unsigned long long>(counters.indirectTriangles));
+  ImGui::BulletText("Triangles After Culling: %llu", static_cast<unsigned long long>(counters.visibleTriangles));
+  ImGui::BulletText("Binds: %llu pipelines, %llu descriptor sets",
+                    static_cast<unsigned long long>(counters.pipelineBinds),
+                    static_cast<unsigned long long>(counters.descriptorBinds));
+  ImGui::BulletText("Push Constants: %llu bytes", static_cast<unsigned long long>(counters.pushConstantBytes));
+  ImGui::BulletText("Uploaded: %.1f KiB", static_cast<double>(counters.uploadedBytes) / 1024.0);
+  ImGui::BulletText("Command Buffers: %llu", static_cast<unsigned long long>(counters.commandBuffers));
+
+  if (!FrameCounters::Supported) {
+    ImGui::Text("Pipeline statistics need pipelineStatisticsQuery and inheritedQueries.");
+    return;
+  }
+  const FrameCounters::Statistics &statistics = FrameCounters::LastStatistics;
+  ImGui::BulletText("Statistics of Frame %llu", static_cast<unsigned long long>(statistics.frame));
+  ImGui::BulletText("Input Primitives: %llu, After Clipping: %llu",
+                    static_cast<unsigned long long>(statistics.inputPrimitives),
+                    static_cast<unsigned long long>(statistics.clippingPrimitives));
+  ImGui::BulletText("Vertex Invocations: %llu", static_cast<unsigned long long>(statistics.vertexInvocations));
+  ImGui::BulletText("Fragment Invocations: %llu", static_cast<unsigned long long>(statistics.fragmentInvocations));
+}
+
+void Vulkan::Editor_CountersOverlay() {
+  using FrameCounters = CoffeeMaker::Renderer::Vulkan::FrameCounters;
+
+  // NOTE: pinned to the top right corner of the window, above the scene and out of the editor's way
+  const ImGuiViewport *viewport = ImGui::GetMainViewport();
+  ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + viewport->WorkSize.x - 10.f, viewport->WorkPos.y + 10.f),
+                          ImGuiCond_Always, ImVec2(1.f, 0.f));
+  ImGui::SetNextWindowBgAlpha(0.35f);
+  ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+                           ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing |
+                           ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoMove;
+  if (ImGui::Begin("Frame Counters", &countersOverlay, flags)) {
+    const FrameCounters::Counters &counters = FrameCounters::Last;
+    ImGui::Text("Draws %llu  Instances %llu", static_cast<unsigned long long>(counters.drawCalls),
+                static_cast<unsigned long long>(counters.instances));
+    ImGui::Text("Triangles %llu  Visible %llu", static_cast<unsigned long long>(counters.triangles),
+                static_cast<unsigned long long>(counters.visibleTriangles));
+    ImGui::Text("Pipelines %llu  Sets %llu", static_cast<unsigned long long>(counters.pipelineBinds),
+                static_cast<unsigned long long>(counters.descriptorBinds));
+    ImGui::Text("Push %llu B  Upload %.1f KiB", static_cast<unsigned long long>(counters.pushConstantBytes),
+                static_cast<double>(counters.uploadedBytes) / 1024.0);
+    ImGui::Text("Command Buffers %llu", static_cast<unsigned long long>(counters.commandBuffers));
+    if (FrameCounters::Supported && FrameCounters::Enabled) {
+      const FrameCounters::Statistics &statistics = FrameCounters::LastStatistics;
+      ImGui::Separator();
+      ImGui::Text("VS %llu  FS %llu", static_cast<unsigned long long>(statistics.vertexInvocations),
+                  static_cast<unsigned long long>(statistics.fragmentInvocations));
+      ImGui::Text("Primitives %llu  After Clip %llu", static_cast<unsigned long long>(statistics.inputPrimitives),
+                  static_cast<unsigned long long>(statistics.clippingPrimitives));
+    }
+  }
+  ImGui::End();
+}
+
+void Vulkan::Editor_RenderGraphInformation() {
+  using Synchronization2 = CoffeeMaker::Renderer::Vulkan::Synchronization2;
+
+  const CoffeeMaker::Renderer::RenderGraph::Statistics &stats = frameGraph.Stats();
+  ImGui::BulletText("Barriers: %s", Synchronization2::Supported ? "vkCmdPipelineBarrier2" : "vkCmdPipelineBarrier");
+  ImGui::BulletText("Passes: %zu (%zu culled)", stats.passes, stats.culledPasses);
+  ImGui::BulletText("Barriers Last Frame: %zu in %zu batches", stats.barriers, stats.barrierBatches);
+  ImGui::BulletText("Transient Images: %zu, %.2f MiB in %.2f MiB of memory", stats.transientImages,
+                    static_cast<double>(stats.transientBytes) / (1024.0 * 1024.0),
+                    static_cast<double>(stats.allocatedBytes) / (1024.0 * 1024.0));
+  ImGui::BulletText("Compiles: %zu (last %.3f ms), cache hits: %zu", stats.compiles, stats.compileMs,
+                    stats.cacheHits);
+  if (ImGui::Button("Dump Graphviz")) {
+    graphDumpWritten = frameGraph.DumpGraphviz("render_graph.dot");
+  }
+  if (graphDumpWritten) {
+    ImGui::SameLine();
+    ImGui::Text("render_graph.dot");
+  }
+}
+
+void Vulkan::Editor_RecordingInformation() {
+  using CommandRecorder = CoffeeMaker::Renderer::Vulkan::CommandRecorder;
+  using FrameContext = CoffeeMaker::Renderer::Vulkan::FrameContext;
+  using Synchronization = CoffeeMaker::Renderer::Vulkan::Synchronization;
+
+  ImGui::Checkbox("Parallel Recording", &CommandRecorder::Enabled);
+  if (ImGui::InputInt("Stress Draws", &stressDrawCount, 1000, 10000)) {
+    stressDrawCount = std::clamp(stressDrawCount, 0, 200000);
+  }
+  if (ImGui::InputInt("Instanced Props", &propCount, 1000, 10000)) {
+    propCount = std::clamp(propCount, 0, 200000);
+  }
+  ImGui::BulletText("Instanced: %zu instances in %zu draws", batcher.InstanceCount(), batcher.BatchCount());
+  Editor_GpuDrivenInformation();
+  Editor_SortInformation();
+  ImGui::BulletText("Recording Threads: %zu (+ render thread)", CommandRecorder::gWorkers.size());
+  ImGui::BulletText("Chunks: %zu", CommandRecorder::LastChunkCount);
+  ImGui::BulletText("Record Time: %.3f ms", CommandRecorder::LastRecordMs);
+  Editor_EncoderInformation();
+  ImGui::Separator();
+#ifdef COFFEEMAKER_PER_BUFFER_RESET
+  ImGui::BulletText("Command Reset: per buffer");
+#else
+  ImGui::BulletText("Command Reset: per frame pool");
+#endif
+  ImGui::BulletText("Average Reset: %.4f ms", FrameContext::ResetMs);
+  ImGui::BulletText("Average Frame Recording: %.3f ms", FrameContext::RecordMs);
+  ImGui::BulletText("Frame Sync: %s", Synchronization::TimelineSupported ? "timeline semaphore" : "fences");
+  ImGui::BulletText("Frame Values: %llu submitted, %llu completed",
+                    static_cast<unsigned long long>(Synchronization::gSubmitted),
+                    static_cast<unsigned long long>(Synchronization::CompletedValue()));
+}
+
+void Vulkan::Editor_EncoderInformation() {
+  using CommandEncoder = CoffeeMaker::Renderer::Vulkan::CommandEncoder;
+  using EncodedCall = CoffeeMaker::Renderer::Vulkan::EncodedCall;
+
+  size_t issued = 0;
+  size_t elided = 0;
+  for (size_t i = 0; i < CommandEncoder::CALL_COUNT; i++) {
+    issued += CommandEncoder::LastIssued[i];
+    elided += CommandEncoder::LastElided[i];
+  }
+  ImGui::BulletText("State Calls: %zu recorded, %zu elided", issued, elided);
+  if (ImGui::TreeNode("Elided State Calls")) {
+    for (size_t i = 0; i < CommandEncoder::CALL_COUNT; i++) {
+      ImGui::BulletText("%s: %zu recorded, %zu elided", CommandEncoder::CallName(static_cast<EncodedCall>(i)),
+                        CommandEncoder::LastIssued[i], CommandEncoder::LastElided[i]);
+    }
+    ImGui::TreePop();
+  }
+}
+
+void Vulkan::Editor_SortInformation() {
+  using DrawList = CoffeeMaker::Renderer::DrawList;
+
+  ImGui::BulletText("Draw List: %zu draws sorted in %.3f ms", drawList.Size(), drawList.LastSortMs);
+  if (ImGui::InputInt("Sort Benchmark Keys", &sortBenchmarkCount, 1000000, 1000000)) {
+    sortBenchmarkCount = std::clamp(sortBenchmarkCount, 1, 64000000);
+  }
+  if (ImGui::Button("Benchmark Sort")) {
+    sortBenchmark = DrawList::Benchmark(static_cast<size_t>(sortBenchmarkCount));
+  }
+  if (sortBenchmark.count > 0) {
+    double keys = static_cast<double>(sortBenchmark.count) / 1000000.0;
+    ImGui::BulletText("Radix Sort: %.3f ms (%.1f Mkeys/s)", sortBenchmark.radixMs,
+                      keys / (sortBenchmark.radixMs / 1000.0));
+    ImGui::BulletText("std::sort: %.3f ms (%.1f Mkeys/s)", sortBenchmark.stdSortMs,
+                      keys / (sortBenchmark.stdSortMs / 1000.0));
+  }
+}
+
+void Vulkan::Editor_GpuDrivenInformation() {
+  using IndirectDraw = CoffeeMaker::Renderer::Vulkan::IndirectDraw;
+
+  ImGui::Separator();
+  if (!IndirectDraw::Supported) {
+    ImGui::BulletText("GPU Driven: not supported");
+    return;
+  }
+
+  if (ImGui::InputInt("GPU Driven Objects", &gpuObjectCount, 1000, 10000)) {
+    gpuObjectCount = std::clamp(gpuObjectCount, 0, 1000000);
+    BuildGpuScene();
+  }
+  ImGui::BulletText("Draw Count: %s, Multi Draw: %s", IndirectDraw::DrawCount ? "On" : "Off",
+                    IndirectDraw::MultiDraw ? "On" : "Off");
+  ImGui::BulletText("GPU Objects: %zu in %zu indirect draws", gpuScene.ObjectCount(), gpuScene.GroupCount());
+  ImGui::BulletText("Visible After Culling: %u", gpuScene.VisibleCount());
+}
+
+void Vulkan::BuildGpuScene() {
+  gpuScene.Clear();
+  if (gpuObjectCount == 0) {
+    return;
+  }
+
+  // NOTE: a wide grid around the origin, most of it falls outside the frustum once the camera moves
+  uint32_t group = gpuScene.AddGroup(triangle->GetMesh(), triangle->InstancedMaterial());
+  size_t columns = std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(gpuObjectCount))));
+  float half = static_cast<float>(columns) * 0.75f;
+  for (size_t i = 0; i < static_cast<size_t>(gpuObjectCount); i++) {
+    glm::vec3 translation{static_cast<float>(i % columns) * 1.5f - half,
+                          static_cast<float>(i / columns) * 1.5f - half, -3.0f};
+    gpuScene.AddObject(group, glm::translate(glm::mat4{1.0f}, translation), 0.75f);
+  }
+}
+
 Vulkan *Vulkan::GetRenderer() { return _mainRenderer; }
 
 void Vulkan::CleanupSwapChain() {
   CoffeeMaker::Renderer::Vulkan::Framebuffer::ClearFramebuffers();
-  CoffeeMaker::Renderer::Vulkan::Commands::FreeCommandBuffers();
   CoffeeMaker::Renderer::Vulkan::RenderPass::Destroy();
   CoffeeMaker::Renderer::Vulkan::Swapchain::Destroy();
 }
 
 /**
- * @brief Non-negotiably recreate the swapchain.
- * Typically, tutorials will have one set a flag on window resize and wait for a non VK_SUCCESS
- * result from either vkAcquireNextImageKHR or vkQueuePresentKHR, and then recreate the swapchain.
- * There can be an odd issue with this with SDL2 in that the window surface is still being used
- * due to the resize taking place, and in addition to this we are trying to change up a swapchain.
- * The result is an odd race condition where you can see VK_ERROR_NATIVE_WINDOW_IN_USE_KHR.
- * The result is a failure to create the swapchain with the new window size. So in order to get
- * around this complete is to just recreate the swapchain, no questions asked.
+ * @brief Flags the swapchain for recreation, any number of resize events between two frames recreate it once.
+ * The new swapchain is created with the current one as oldSwapchain, so the window is handed over instead of being
+ * torn down mid-resize, which is what used to fail with VK_ERROR_NATIVE_WINDOW_IN_USE_KHR.
  */
-void Vulkan::FramebufferResize() { RecreateSwapChain(); }
+void Vulkan::FramebufferResize() { framebufferResized = true; }
 
-void Vulkan::RecreateSwapChain() {
+bool Vulkan::RecreateSwapChain() {
   using PhysicalDevice = CoffeeMaker::Renderer::Vulkan::PhysicalDevice;
-  vkDeviceWaitIdle(CoffeeMaker::Renderer::Vulkan::LogicalDevice::GetLogicalDevice());
+  using Swapchain = CoffeeMaker::Renderer::Vulkan::Swapchain;
+  using Synchronization = CoffeeMaker::Renderer::Vulkan::Synchronization;
+  using Framebuffer = CoffeeMaker::Renderer::Vulkan::Framebuffer;
+  using DynamicRendering = CoffeeMaker::Renderer::Vulkan::DynamicRendering;
+
+  PhysicalDevice::GetPhysicalDeviceInUse()->QuerySwapchainSupport();
+  VkExtent2D extent = PhysicalDevice::GetPhysicalDeviceInUse()->SwapChainSupport.capabilities.currentExtent;
+  // NOTE: a minimized window has nothing to present to, try again once it has an area
+  if (extent.width == 0 || extent.height == 0) {
+    framebufferResized = true;
+    return false;
+  }
+  framebufferResized = false;
+
+  // NOTE: no device wait, everything the old swapchain owns is retired behind the last submitted frame
+  uint64_t lastUse = Synchronization::gSubmitted;
+  VkFormat colorFormat = Swapchain::GetSwapchain()->surfaceFormat.format;
+  VkFormat depthFormat = Swapchain::GetSwapchain()->depthFormat;
+  Swapchain::Recreate(lastUse);
+  bool formatChanged = Swapchain::GetSwapchain()->surfaceFormat.format != colorFormat ||
+                       Swapchain::GetSwapchain()->depthFormat != depthFormat;
+
+  if (!DynamicRendering::Supported) {
+    Framebuffer::RetireFramebuffers(lastUse);
+    if (formatChanged) {
+      // NOTE: only a format change needs a new render pass, that waits for the frames still using the old one
+      Synchronization::WaitForValue(lastUse);
+      CoffeeMaker::Renderer::Vulkan::PipelineCompiler::WaitIdle();
+      CoffeeMaker::Renderer::Vulkan::RenderPass::Destroy();
+      CreateRenderPass();
+    }
+    CreateFramebuffer();
+  }
 
-  CleanupSwapChain();
+  CoffeeMaker::Renderer::Vulkan::FramePacer::SwapchainRecreated();
+  SetRefreshRate();
+  SetAttachmentFormats();
+
+  if (formatChanged) {
+    // NOTE: the UI pipeline is built for the old render pass or color format, with or without dynamic rendering
+    Synchronization::WaitForValue(lastUse);
+    VulkanImGui::AttachmentsChanged();
+    // NOTE: the attachment formats are part of every graphics pipeline, the old ones cannot draw to the new images
+    CreateFallbackPipeline();
+    rectangle->MakeMeshPipeline();
+    triangle->MakeMeshPipeline();
+  }
 
-  CoffeeMaker::Renderer::Vulkan::PhysicalDevice::GetPhysicalDeviceInUse()->QuerySwapchainSupport();
-  CoffeeMaker::Renderer::Vulkan::Swapchain::CreateSwapchain();
-  CoffeeMaker::Renderer::Vulkan::RenderPass::CreateRenderPass();
-  CoffeeMaker::Renderer::Vulkan::Framebuffer::CreateFramebuffers();
-  CoffeeMaker::Renderer::Vulkan::Commands::CreateCommandBuffers();
+  Camera::SetMainCameraDimensions(Swapchain::GetSwapchain()->extent.width, Swapchain::GetSwapchain()->extent.height);
 
-  Camera::SetMainCameraDimensions(
-      PhysicalDevice::GetPhysicalDeviceInUse()->SwapChainSupport.capabilities.currentExtent.width,
-      PhysicalDevice::GetPhysicalDeviceInUse()->SwapChainSupport.capabilities.currentExtent.height);
+  // NOTE: the UI of this frame was built with the old font texture, it is only drawn again from the next frame on
+  return !formatChanged;
 }
 
 void BeginRender() {
@@ -253,76 +708,216 @@ void EndRender() {
   // TODO: End render process here...
 }
 
+void Vulkan::WaitForNextFrame() { CoffeeMaker::Renderer::Vulkan::FramePacer::WaitForNextFrame(); }
+
 void Vulkan::Draw() {
   using Synchronization = CoffeeMaker::Renderer::Vulkan::Synchronization;
   using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
   using Swapchain = CoffeeMaker::Renderer::Vulkan::Swapchain;
   using Commands = CoffeeMaker::Renderer::Vulkan::Commands;
-
+  using CommandRecorder = CoffeeMaker::Renderer::Vulkan::CommandRecorder;
+  using RenderPass = CoffeeMaker::Renderer::Vulkan::RenderPass;
+  using Framebuffer = CoffeeMaker::Renderer::Vulkan::Framebuffer;
+  using FrameContext = CoffeeMaker::Renderer::Vulkan::FrameContext;
+  using CommandEncoder = CoffeeMaker::Renderer::Vulkan::CommandEncoder;
+  using RenderGraph = CoffeeMaker::Renderer::RenderGraph;
+  using ResourceAccess = CoffeeMaker::Renderer::ResourceAccess;
+  using GpuScene = CoffeeMaker::Renderer::GpuScene;
+  using DynamicRendering = CoffeeMaker::Renderer::Vulkan::DynamicRendering;
+  using FramePacer = CoffeeMaker::Renderer::Vulkan::FramePacer;
+  using GpuProfiler = CoffeeMaker::Renderer::Vulkan::GpuProfiler;
+  using FrameCounters = CoffeeMaker::Renderer::Vulkan::FrameCounters;
+  using PipelineCompiler = CoffeeMaker::Renderer::Vulkan::PipelineCompiler;
+  using PipelineCache = CoffeeMaker::Renderer::Vulkan::PipelineCache;
+  using PipelineRegistry = CoffeeMaker::Renderer::Vulkan::PipelineRegistry;
+
+  CPU_SCOPE("Vulkan::Draw");
   triangle->Update();
 
-  Synchronization::WaitForFence(currentFrame);
-  Synchronization::ResetFence(currentFrame);
+  Synchronization::WaitForFrame(currentFrame);
+  // NOTE: the slot's last timeline value has been reached, the GPU is done with everything recorded for this frame
+  FrameContext &frame = FrameContext::Begin(currentFrame);
 
-  ImGui::Render();
+  {
+    CPU_SCOPE("ImGui::Render");
+    ImGui::Render();
+  }
 
-  uint32_t imageIndex;
-  VkResult nxtImageResult =
-      vkAcquireNextImageKHR(LogicalDevice::GetLogicalDevice(), Swapchain::GetVkpSwapchain(), 1000000000,
-                            Synchronization::imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
-
-  // Check if a previous frame is using this image (i.e. there is its fence to wait on)
-  if (Synchronization::imagesInFlight[imageIndex] != VK_NULL_HANDLE) {
-#ifdef COFFEEMAKER_STANDARD_WAIT_FOR_FENCE
-    // NOTE: This is what the line should be for all systems, with timeout set to UINT32_MAX
-    VkResult r = vkWaitForFences(LogicalDevice::GetLogicalDevice(), 1, &Synchronization::imagesInFlight[imageIndex],
-                                 VK_TRUE, UINT32_MAX);
-#else
-    // TODO: Figure out why on Linux w/ integrated chips, this will deadlock the whole application.
-    VkResult r =
-        vkWaitForFences(LogicalDevice::GetLogicalDevice(), 1, &Synchronization::imagesInFlight[imageIndex], VK_TRUE, 0);
-#endif
-    if (r != VK_SUCCESS && r != VK_TIMEOUT) {
-      std::cout << r << std::endl;
-      abort();
+  // NOTE: resize events only set the flag, so a drag recreates at most once per frame
+  if (framebufferResized) {
+    if (!RecreateSwapChain()) {
+      return;
     }
   }
-  // Mark the image as now being in use by this frame
-  Synchronization::imagesInFlight[imageIndex] = Synchronization::inFlightFences[currentFrame];
-  // syncUtils.RenderFence2(currentFrame);
+
+  uint32_t imageIndex;
+  VkResult nxtImageResult;
+  {
+    CPU_SCOPE("vkAcquireNextImageKHR");
+    nxtImageResult =
+        vkAcquireNextImageKHR(LogicalDevice::GetLogicalDevice(), Swapchain::GetVkpSwapchain(), 1000000000,
+                              Synchronization::imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+  }
+  // NOTE: no per image wait, an image is only handed out again once its present finished, and the present waited
+  // on the rendering of the frame that last drew to it
 
   if (nxtImageResult == VK_ERROR_OUT_OF_DATE_KHR) {
+    // NOTE: nothing was acquired and nothing is signaled, the frame is skipped
     RecreateSwapChain();
+    return;
+  }
+  if (nxtImageResult == VK_SUBOPTIMAL_KHR) {
+    framebufferResized = true;
   } else if (nxtImageResult != VK_SUCCESS && nxtImageResult != VK_SUBOPTIMAL_KHR) {
     SimpleMessageBox::ShowError("Drawing Error", fmt::format("Vulkan Error Code: [{}]", nxtImageResult));
   }
 
-  Commands::CurrentCmdBufferIndex = imageIndex;
-  Commands::ResetCommandBuffers(imageIndex);
-
-  Commands::BeginRecording(imageIndex);
-  // vkCmd* stuff...
-
-  VkViewport viewport{};
-  viewport.x = 0.0f;
-  viewport.y = 0.0f;
-  viewport.width = static_cast<float>(Swapchain::GetSwapchain()->extent.width);
-  viewport.height = static_cast<float>(Swapchain::GetSwapchain()->extent.height);
-  viewport.minDepth = 0.0f;
-  viewport.maxDepth = 1.0f;
-  VkRect2D scissor{{
-                       0,
-                       0,
-                   },
-                   Swapchain::GetSwapchain()->extent};
-  vkCmdSetViewport(Commands::GetCurrentBuffer(), 0, 1, &viewport);
-  vkCmdSetScissor(Commands::GetCurrentBuffer(), 0, 1, &scissor);
-
-  triangle->Draw();
-  rectangle->Draw();
+  auto recordStart = std::chrono::steady_clock::now();
+  // NOTE: camera matrices are resolved up front, the record function runs on several threads at once
+  glm::mat4 viewProjection = Camera::MainCamera()->ViewProjection();
+
+  Commands::BeginBuffer(frame.RenderArena().Allocate(VK_COMMAND_BUFFER_LEVEL_PRIMARY));
+  GpuProfiler::BeginFrame(Commands::GetCurrentBuffer(), currentFrame);
+  FrameCounters::BeginFrame(Commands::GetCurrentBuffer(), currentFrame);
+  gpuScene.Prepare(currentFrame);
+
+  glm::vec3 trianglePosition = triangle->Position();
+  size_t stressColumns = std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(stressDrawCount))));
+
+  // NOTE: individual draws are sorted by state so neighbouring draws rebind as little as possible
+  drawList.Begin(viewProjection);
+  drawList.Submit(triangle->Object(trianglePosition));
+  drawList.Submit(rectangle->Object());
+  for (size_t i = 0; i < static_cast<size_t>(stressDrawCount); i++) {
+    // NOTE: stress draws, a grid of triangles behind the scene
+    glm::vec3 offset{static_cast<float>(i % stressColumns) * 1.5f, static_cast<float>(i / stressColumns) * 1.5f,
+                     -1.0f};
+    drawList.Submit(triangle->Object(trianglePosition + offset));
+  }
+  drawList.Sort();
+
+  // NOTE: props are repeated meshes, the batcher folds them into one draw per mesh and material
+  size_t propColumns = std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(propCount))));
+  for (size_t i = 0; i < static_cast<size_t>(propCount); i++) {
+    glm::vec3 offset{static_cast<float>(i % propColumns) * 1.5f, -static_cast<float>(i / propColumns + 1) * 1.5f,
+                     -2.0f};
+    batcher.Submit(triangle->Instance(trianglePosition + offset));
+  }
+  batcher.Prepare(currentFrame);
+
+  size_t sceneCount = drawList.Size();
+  size_t batchEnd = sceneCount + batcher.BatchCount();
+  // NOTE: the GPU driven objects are one item however many there are
+  size_t itemCount = batchEnd + (gpuScene.ObjectCount() > 0 ? 1 : 0);
+  auto recordScene = [&](VkCommandBuffer cmd, size_t begin, size_t end) {
+    // NOTE: one encoder per chunk, state is tracked across the three kinds of draws
+    CommandEncoder encoder{cmd};
+    drawList.Draw(encoder, begin, std::min(end, sceneCount));
+    // NOTE: items past the scene are instance batches, one draw each
+    if (end > sceneCount) {
+      batcher.Draw(encoder, viewProjection, std::max(begin, sceneCount) - sceneCount,
+                   std::min(end, batchEnd) - sceneCount);
+    }
+    if (end > batchEnd) {
+      gpuScene.Draw(encoder, viewProjection);
+    }
+  };
+
+  auto recordUi = [](VkCommandBuffer cmd) {
+    VkCommandBuffer uiCmd = CommandRecorder::BeginSecondary();
+    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), uiCmd);
+    vkEndCommandBuffer(uiCmd);
+    vkCmdExecuteCommands(cmd, 1, &uiCmd);
+  };
+
+  // NOTE: the frame is declared as a graph, the barriers between passes and around the swapchain image come from it
+  frameGraph.BeginFrame();
+  RenderGraph::ResourceHandle backbuffer =
+      frameGraph.ImportImage("Swapchain", RenderGraph::ImportedImage{
+                                              .image = Swapchain::GetSwapchain()->swapChainImages[imageIndex],
+                                              .view = Swapchain::GetSwapchain()->swapChainImageViews[imageIndex],
+                                              .aspect = VK_IMAGE_ASPECT_COLOR_BIT,
+                                              // NOTE: the acquire semaphore is waited on at this stage
+                                              .previousAccess = ResourceAccess::ColorAttachment,
+                                              .finalAccess = ResourceAccess::Present});
+  // NOTE: layout transitions of combined formats have to cover the stencil aspect as well
+  VkImageAspectFlags depthAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+  if (CoffeeMaker::Renderer::Vulkan::FormatHasStencil(Swapchain::GetSwapchain()->depthFormat)) {
+    depthAspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+  }
+  RenderGraph::ResourceHandle depth{};
+  if (DynamicRendering::Supported) {
+    // NOTE: only used within the frame, so the graph owns it and may share its memory with other transients
+    VkImageUsageFlags depthUsage =
+        CoffeeMaker::Renderer::Vulkan::IsTransientAttachment(Swapchain::GetSwapchain()->depthUsage)
+            ? VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT
+            : 0;
+    depth = frameGraph.CreateImage("Depth", RenderGraph::ImageDesc{.format = Swapchain::GetSwapchain()->depthFormat,
+                                                                   .extent = Swapchain::GetSwapchain()->extent,
+                                                                   .aspect = depthAspect,
+                                                                   .usage = depthUsage});
+  } else {
+    // NOTE: the framebuffers are built around the swapchain's depth image
+    depth = frameGraph.ImportImage("Depth",
+                                   RenderGraph::ImportedImage{.image = Swapchain::GetSwapchain()->depthImage.image,
+                                                              .view = Swapchain::GetSwapchain()->depthImageView,
+                                                              .aspect = depthAspect,
+                                                              .previousAccess = ResourceAccess::DepthAttachment});
+  }
+  // NOTE: culling writes the draws of the GPU driven objects, it has to finish before the pass reads them
+  GpuScene::CullOutputs cullOutputs = gpuScene.AddCullPasses(frameGraph, viewProjection);
+
+  frameGraph.AddPass(
+      "Forward",
+      [&](RenderGraph::PassBuilder &pass) {
+        pass.Write(backbuffer, ResourceAccess::ColorAttachment);
+        pass.Write(depth, ResourceAccess::DepthAttachment);
+        if (cullOutputs.commands.Valid()) {
+          pass.Read(cullOutputs.commands, ResourceAccess::IndirectRead);
+          pass.Read(cullOutputs.counts, ResourceAccess::IndirectRead);
+        }
+      },
+      [&](VkCommandBuffer cmd) {
+        // NOTE: the pass only executes secondaries, the scene and the UI are both recorded into them
+        Commands::BeginRenderPass(imageIndex, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS,
+                                  frameGraph.ImageView(depth));
+        if (DynamicRendering::Supported) {
+          CommandRecorder::SetRenderingTarget(Swapchain::GetSwapchain()->extent);
+        } else {
+          CommandRecorder::SetTarget(RenderPass::GetRenderPass(), Framebuffer::framebuffers[imageIndex],
+                                     Swapchain::GetSwapchain()->extent);
+        }
+        CommandRecorder::Record(cmd, itemCount, recordScene);
+        if (!DynamicRendering::Supported) {
+          recordUi(cmd);
+        }
+        Commands::EndRenderPass();
+      });
+
+  if (DynamicRendering::Supported) {
+    // NOTE: the UI pipeline has no depth format, so it gets a color only rendering of its own
+    frameGraph.AddPass(
+        "UI", [&](RenderGraph::PassBuilder &pass) { pass.Write(backbuffer, ResourceAccess::ColorAttachment); },
+        [&](VkCommandBuffer cmd) {
+          Commands::BeginOverlayRendering(imageIndex);
+          CommandRecorder::SetRenderingTarget(Swapchain::GetSwapchain()->extent, false);
+          recordUi(cmd);
+          Commands::EndRenderPass();
+        });
+  }
 
-  ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), Commands::GetCurrentBuffer());
-  Commands::EndRecording(imageIndex);
+  frameGraph.Compile();
+  {
+    GPU_SCOPE(Commands::GetCurrentBuffer(), "Frame");
+    FrameCounters::BeginQuery(Commands::GetCurrentBuffer());
+    frameGraph.Execute(Commands::GetCurrentBuffer());
+    FrameCounters::EndQuery(Commands::GetCurrentBuffer());
+  }
+  CommandEncoder::EndFrame();
+  FrameCounters::EndFrame(gpuScene.VisibleTriangles());
+  Commands::EndBuffer();
+  FrameContext::ReportRecording(
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordStart).count());
 
   VkCommandBuffer cmd = Commands::GetCurrentBuffer();
 
@@ -342,8 +937,9 @@ void Vulkan::Draw() {
   submitInfo.signalSemaphoreCount = 1;
   submitInfo.pSignalSemaphores = &Synchronization::imageRenderSemaphores[currentFrame];
 
-  vkResetFences(LogicalDevice::GetLogicalDevice(), 1, &Synchronization::inFlightFences[currentFrame]);
-  vkQueueSubmit(LogicalDevice::GraphicsQueue, 1, &submitInfo, Synchronization::inFlightFences[currentFrame]);
+  uint64_t frameValue = Synchronization::SubmitFrame(LogicalDevice::GraphicsQueue, submitInfo, currentFrame);
+  FramePacer::FrameSubmitted(frameValue);
+  GpuProfiler::FrameSubmitted(currentFrame);
 
   VkPresentInfoKHR presentInfo{};
   presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -356,16 +952,28 @@ void Vulkan::Draw() {
   presentInfo.pImageIndices = &imageIndex;
   presentInfo.pResults = nullptr;  // Optional
 
-  VkResult presentResult = vkQueuePresentKHR(LogicalDevice::PresentQueue, &presentInfo);
+  VkResult presentResult = FramePacer::Present(LogicalDevice::PresentQueue, presentInfo, frameValue);
 
-  if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR || framebufferResized) {
-    framebufferResized = false;
-    RecreateSwapChain();
+  if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR) {
+    framebufferResized = true;
   } else if (presentResult != VK_SUCCESS) {
     throw std::runtime_error("failed to present swap chain image!");
   }
   framecount++;
-  currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;  // Forced alternating value of 0 and 1
+  currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+
+  VulkanShaderManager::Update();
+  // NOTE: checked before the compiler hands back what it finished, so every startup compile is in the report
+  bool startupCompiled = !pipelineStartupReported && PipelineCompiler::PendingCount() == 0;
+  PipelineCompiler::Update();
+  if (startupCompiled) {
+    PipelineCache::ReportStartup();
+    fmt::print("Pipeline registry: {} hits, {} misses\n", PipelineRegistry::Hits, PipelineRegistry::Misses);
+    pipelineStartupReported = true;
+  }
+  PipelineCache::Update();
+  CoffeeMaker::Renderer::Vulkan::Swapchain::DestroyRetired(false);
+  CoffeeMaker::Renderer::Vulkan::Framebuffer::DestroyRetired(false);
 }
 
 void Vulkan::InitVulkan() {
@@ -387,7 +995,8 @@ void Vulkan::InitVulkan() {
   vulkanAppInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
   vulkanAppInfo.applicationVersion = VK_MAKE_API_VERSION(0, 1, 0, 0);
   vulkanAppInfo.engineVersion = VK_MAKE_API_VERSION(0, 1, 0, 0);
-  vulkanAppInfo.apiVersion = VK_API_VERSION_1_0;
+  // NOTE: 1.1 for vkGetPhysicalDeviceFeatures2, optional device features are queried through it
+  vulkanAppInfo.apiVersion = VK_API_VERSION_1_1;
 
   // Required Extensions
   GetRequiredExtensions();
@@ -577,12 +1186,39 @@ bool Vulkan::IsDeviceSuitable(CoffeeMaker::Renderer::Vulkan::PhysicalDevice *dev
 
 void Vulkan::CreateLogicalDevice() {
   using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
+  using DynamicState = CoffeeMaker::Renderer::Vulkan::DynamicState;
+  using PipelineLibrary = CoffeeMaker::Renderer::Vulkan::PipelineLibrary;
+  using IndirectDraw = CoffeeMaker::Renderer::Vulkan::IndirectDraw;
+  using Synchronization2 = CoffeeMaker::Renderer::Vulkan::Synchronization2;
+  using DynamicRendering = CoffeeMaker::Renderer::Vulkan::DynamicRendering;
+  using Synchronization = CoffeeMaker::Renderer::Vulkan::Synchronization;
+  using FramePacer = CoffeeMaker::Renderer::Vulkan::FramePacer;
+  using FrameCounters = CoffeeMaker::Renderer::Vulkan::FrameCounters;
 
+#ifndef IMGUI_IMPL_VULKAN_HAS_DYNAMIC_RENDERING
+  // NOTE: the UI backend could not draw without a render pass
+  DynamicRendering::Requested = false;
+#endif
+  DynamicState::EnableIfSupported(deviceExtensions);
+  PipelineLibrary::EnableIfSupported(deviceExtensions);
+  IndirectDraw::EnableIfSupported(deviceExtensions);
+  Synchronization2::EnableIfSupported(deviceExtensions);
+  DynamicRendering::EnableIfSupported(deviceExtensions);
+  Synchronization::EnableIfSupported(deviceExtensions);
+  FramePacer::EnableIfSupported(deviceExtensions);
+  FrameCounters::EnableIfSupported();
   LogicalDevice::SetExentions(deviceExtensions);
   LogicalDevice::SetLayers(VULKAN_LAYERS);
   LogicalDevice::CreateLogicalDevice(true);
+  DynamicState::LoadFunctions(LogicalDevice::GetLogicalDevice());
+  IndirectDraw::LoadFunctions(LogicalDevice::GetLogicalDevice());
+  Synchronization2::LoadFunctions(LogicalDevice::GetLogicalDevice());
+  DynamicRendering::LoadFunctions(LogicalDevice::GetLogicalDevice());
+  Synchronization::LoadFunctions(LogicalDevice::GetLogicalDevice());
+  FramePacer::LoadFunctions(LogicalDevice::GetLogicalDevice());
 
   VulkanShaderManager::AssignLogicalDevice(LogicalDevice::GetLogicalDevice());
+  CoffeeMaker::Renderer::Vulkan::PipelineCache::CreatePipelineCache();
 }
 
 void Vulkan::CreateMemoryAllocator() {
@@ -594,6 +1230,17 @@ void Vulkan::CreateMemoryAllocator() {
                             vulkanInstance);
 }
 
+void Vulkan::CreateFallbackPipeline() {
+  using PipelineCreateInfo = CoffeeMaker::Renderer::Vulkan::PipelineCreateInfo;
+  using PipelineRegistry = CoffeeMaker::Renderer::Vulkan::PipelineRegistry;
+  using Vertex = CoffeeMaker::Renderer::Vertex;
+
+  // NOTE: every feature off, the modules are compiled here and the pipeline is built before anything draws with it
+  PipelineCreateInfo info = CoffeeMaker::Renderer::MeshShaders().MakePipelineCreateInfo(0, Vertex::Description());
+
+  PipelineRegistry::CreateFallbackPipeline(info);
+}
+
 void Vulkan::CreateSurface() { CoffeeMaker::Renderer::Vulkan::Surface::CreateSurface(windowHandle, vulkanInstance); }
 
 void Vulkan::AddRequiredDeviceExtensionSupport(VkPhysicalDevice device) {
@@ -618,18 +1265,49 @@ void Vulkan::CreateSwapChain() {
   using Swapchain = CoffeeMaker::Renderer::Vulkan::Swapchain;
 
   Swapchain::CreateSwapchain();
+  SetRefreshRate();
+  SetAttachmentFormats();
 
   Camera::SetMainCameraDimensions(Swapchain::GetSwapchain()->extent.width, Swapchain::GetSwapchain()->extent.height);
 }
 
-void Vulkan::CreateRenderPass() { CoffeeMaker::Renderer::Vulkan::RenderPass::CreateRenderPass(); }
+void Vulkan::SetRefreshRate() {
+  SDL_DisplayMode mode{};
+  if (SDL_GetWindowDisplayMode(windowHandle, &mode) == 0) {
+    CoffeeMaker::Renderer::Vulkan::FramePacer::SetRefreshRate(mode.refresh_rate);
+  }
+}
 
-void Vulkan::CreateFramebuffer() { CoffeeMaker::Renderer::Vulkan::Framebuffer::CreateFramebuffers(); }
+void Vulkan::SetAttachmentFormats() {
+  using Swapchain = CoffeeMaker::Renderer::Vulkan::Swapchain;
+
+  CoffeeMaker::Renderer::Vulkan::DynamicRendering::SetAttachmentFormats(Swapchain::GetSwapchain()->surfaceFormat.format,
+                                                                      Swapchain::GetSwapchain()->depthFormat);
+}
+
+void Vulkan::CreateRenderPass() {
+  // NOTE: dynamic rendering begins on the image views directly, there is nothing to rebuild on a resize
+  if (CoffeeMaker::Renderer::Vulkan::DynamicRendering::Supported) {
+    return;
+  }
+  CoffeeMaker::Renderer::Vulkan::RenderPass::CreateRenderPass();
+}
+
+void Vulkan::CreateFramebuffer() {
+  if (CoffeeMaker::Renderer::Vulkan::DynamicRendering::Supported) {
+    return;
+  }
+  CoffeeMaker::Renderer::Vulkan::Framebuffer::CreateFramebuffers();
+}
 
 void Vulkan::CreateCommands(bool recreation) {
+  using CommandRecorder = CoffeeMaker::Renderer::Vulkan::CommandRecorder;
+  using FrameContext = CoffeeMaker::Renderer::Vulkan::FrameContext;
+
   CoffeeMaker::Renderer::Vulkan::Commands::SetClearValues();
-  CoffeeMaker::Renderer::Vulkan::Commands::CreateCommandPool();
-  CoffeeMaker::Renderer::Vulkan::Commands::CreateCommandBuffers();
+  CommandRecorder::Start();
+  // NOTE: per frame in flight rather than per swapchain image, a frame's pools are free once its fence signals
+  FrameContext::Create(MAX_FRAMES_IN_FLIGHT, CommandRecorder::ThreadSlots());
 }
 
 void Vulkan::CreateUploadCommands() {
@@ -641,7 +1319,11 @@ void Vulkan::CreateUploadCommands() {
   vkCreateCommandPool(LogicalDevice::GetLogicalDevice(), &uploadCommandPoolInfo, nullptr, &_uploadContext.commandPool);
 }
 
-void Vulkan::CreateSemaphores() { CoffeeMaker::Renderer::Vulkan::Synchronization::CreateSyncTools(); }
+void Vulkan::CreateSemaphores() {
+  CoffeeMaker::Renderer::Vulkan::Synchronization::CreateSyncTools(MAX_FRAMES_IN_FLIGHT);
+  CoffeeMaker::Renderer::Vulkan::GpuProfiler::Create(MAX_FRAMES_IN_FLIGHT);
+  CoffeeMaker::Renderer::Vulkan::FrameCounters::Create(MAX_FRAMES_IN_FLIGHT);
+}
 
 void Vulkan::ImmediateSubmit(std::function<void(VkCommandBuffer cmd)> &&function) {
   using LogicalDevice = CoffeeMaker::Renderer::Vulkan::LogicalDevice;
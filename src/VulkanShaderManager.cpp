@@ -1,5 +1,279 @@
 #include "VulkanShaderManager.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Renderer/Vulkan/PipelineCompiler.hpp"
+#include "Renderer/Vulkan/PipelineLibrary.hpp"
+#include "Renderer/Vulkan/PipelineRegistry.hpp"
+#include "Renderer/Vulkan/ShaderWatcher.hpp"
+#include "Renderer/Vulkan/Synchronization.hpp"
+
+namespace {
+  /**
+   * Pipelines keep their layout and vertex input across a reload, so the new code must declare the same interface.
+   */
+  bool HasSameInterface(const CoffeeMaker::Renderer::Vulkan::ShaderReflection &lhs,
+                        const CoffeeMaker::Renderer::Vulkan::ShaderReflection &rhs) {
+    if (lhs.stage != rhs.stage || lhs.hasPushConstants != rhs.hasPushConstants ||
+        lhs.vertexInputs.size() != rhs.vertexInputs.size() ||
+        lhs.descriptorBindings.size() != rhs.descriptorBindings.size()) {
+      return false;
+    }
+
+    if (lhs.hasPushConstants &&
+        (lhs.pushConstants.offset != rhs.pushConstants.offset || lhs.pushConstants.size != rhs.pushConstants.size)) {
+      return false;
+    }
+
+    for (size_t i = 0; i < lhs.vertexInputs.size(); i++) {
+      if (lhs.vertexInputs[i].location != rhs.vertexInputs[i].location ||
+          lhs.vertexInputs[i].format != rhs.vertexInputs[i].format) {
+        return false;
+      }
+    }
+
+    for (size_t i = 0; i < lhs.descriptorBindings.size(); i++) {
+      const auto &a = lhs.descriptorBindings[i];
+      const auto &b = rhs.descriptorBindings[i];
+      if (a.set != b.set || a.binding != b.binding || a.type != b.type || a.count != b.count) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+}  // namespace
+
 VkDevice VulkanShaderManager::logicalDevice = VK_NULL_HANDLE;
-std::map<std::string, std::vector<char>> VulkanShaderManager::shaderByteCodes{};
-std::map<std::string, VkShaderModule> VulkanShaderManager::shaders{};
\ No newline at end of file
+std::unordered_map<std::string, VkShaderModule, ShaderNameHasher, std::equal_to<>> VulkanShaderManager::shaders{};
+std::unordered_map<std::string, CoffeeMaker::Renderer::Vulkan::ShaderReflection, ShaderNameHasher, std::equal_to<>>
+    VulkanShaderManager::reflections{};
+std::unordered_map<std::string,
+                   std::shared_future<std::shared_ptr<const CoffeeMaker::Renderer::Vulkan::CompiledShader>>,
+                   ShaderNameHasher, std::equal_to<>>
+    VulkanShaderManager::pending{};
+std::unordered_map<std::string,
+                   std::shared_future<std::shared_ptr<const CoffeeMaker::Renderer::Vulkan::CompiledShader>>,
+                   ShaderNameHasher, std::equal_to<>>
+    VulkanShaderManager::reloading{};
+std::unordered_map<std::string, VulkanShaderManager::ShaderSource, ShaderNameHasher, std::equal_to<>>
+    VulkanShaderManager::sources{};
+std::unordered_map<std::string, std::vector<std::string>, ShaderNameHasher, std::equal_to<>>
+    VulkanShaderManager::dependents{};
+std::deque<VulkanShaderManager::RetiredModule> VulkanShaderManager::retiredModules{};
+std::unordered_map<VkShaderModule, uint64_t> VulkanShaderManager::moduleIds{};
+uint64_t VulkanShaderManager::nextModuleId{1};
+
+VkShaderModule VulkanShaderManager::AddShaderModule(const std::string &name, std::string_view filename,
+                                                    const ShaderDefines &defines, const uint32_t *code,
+                                                    size_t wordCount, const std::vector<std::string> &dependencies) {
+  VkShaderModule module = CreateShaderModule(logicalDevice, code, wordCount * sizeof(uint32_t));
+
+  moduleIds.insert_or_assign(module, nextModuleId++);
+  shaders.try_emplace(name, module);
+  // NOTE: reflect while the code is at hand so pipelines can derive their layouts from it
+  reflections.try_emplace(name, CoffeeMaker::Renderer::Vulkan::ReflectShader(code, wordCount));
+  sources.try_emplace(name, ShaderSource{.filename = std::string{filename}, .defines = defines});
+  IndexDependencies(name, dependencies);
+
+  return module;
+}
+
+void VulkanShaderManager::EnableHotReload() {
+  using ShaderWatcher = CoffeeMaker::Renderer::Vulkan::ShaderWatcher;
+
+  ShaderWatcher::Start(fmt::format("{}shaders", ShaderRoot()));
+}
+
+void VulkanShaderManager::Update() {
+  using ShaderWatcher = CoffeeMaker::Renderer::Vulkan::ShaderWatcher;
+  using PipelineCompiler = CoffeeMaker::Renderer::Vulkan::PipelineCompiler;
+  using PipelineLibrary = CoffeeMaker::Renderer::Vulkan::PipelineLibrary;
+  using PipelineRegistry = CoffeeMaker::Renderer::Vulkan::PipelineRegistry;
+  using Synchronization = CoffeeMaker::Renderer::Vulkan::Synchronization;
+
+  for (const std::string &path : ShaderWatcher::Poll()) {
+    auto elem = dependents.find(path);
+    if (elem == dependents.end()) {
+      continue;
+    }
+
+    // NOTE: copied, reloading a binary inline re-indexes its dependencies
+    std::vector<std::string> names = elem->second;
+    for (const std::string &name : names) {
+      const ShaderSource &source = sources.at(name);
+      std::string fullPath = fmt::format("{}{}", ShaderRoot(), source.filename);
+
+      if (ShaderCompiler::IsSource(source.filename)) {
+        // NOTE: a compile already in flight is superseded, it read the file before this change
+        reloading.insert_or_assign(name, ShaderCompiler::CompileAsync(fullPath, source.defines));
+        continue;
+      }
+
+      ShaderBinary binary{fullPath};
+      if (binary.IsOpen()) {
+        Reload(name, binary.Code(), binary.WordCount(), {fullPath});
+      }
+    }
+  }
+
+  for (auto elem = reloading.begin(); elem != reloading.end();) {
+    if (elem->second.wait_for(std::chrono::seconds{0}) != std::future_status::ready) {
+      elem++;
+      continue;
+    }
+
+    auto compiled = elem->second.get();
+    if (compiled->success) {
+      Reload(elem->first, compiled->spirv.data(), compiled->spirv.size(), compiled->dependencies);
+    } else {
+      SDL_LogWarn(0, "Shader %s failed to compile, keeping the previous version.\n%s", elem->first.c_str(),
+                  compiled->log.c_str());
+    }
+    elem = reloading.erase(elem);
+  }
+
+  // NOTE: a compile still queued may have been handed a retired module, those only go once the compiler drained
+  if (!retiredModules.empty() && PipelineCompiler::Idle()) {
+    uint64_t completed = Synchronization::CompletedValue();
+    while (!retiredModules.empty() && retiredModules.front().value <= completed) {
+      // NOTE: the driver may hand the handle out again, so nothing may look the module up by it afterwards
+      VkShaderModule module = retiredModules.front().module;
+      PipelineRegistry::ForgetModule(ModuleId(module));
+      PipelineLibrary::ForgetModule(ModuleId(module));
+      moduleIds.erase(module);
+      vkDestroyShaderModule(logicalDevice, module, nullptr);
+      retiredModules.pop_front();
+    }
+  }
+}
+
+void VulkanShaderManager::Reload(const std::string &name, const uint32_t *code, size_t wordCount,
+                                 const std::vector<std::string> &dependencies) {
+  using PipelineRegistry = CoffeeMaker::Renderer::Vulkan::PipelineRegistry;
+  using Synchronization = CoffeeMaker::Renderer::Vulkan::Synchronization;
+
+  CoffeeMaker::Renderer::Vulkan::ShaderReflection reflection =
+      CoffeeMaker::Renderer::Vulkan::ReflectShader(code, wordCount);
+  auto previousReflection = reflections.find(name);
+  if (previousReflection != reflections.end() && !HasSameInterface(previousReflection->second, reflection)) {
+    SDL_LogWarn(0, "Shader %s changed its inputs, push constants or descriptors, restart to pick it up.",
+                name.c_str());
+    return;
+  }
+
+  VkShaderModule previous = shaders.at(name);
+  VkShaderModule module = CreateShaderModule(logicalDevice, code, wordCount * sizeof(uint32_t));
+  uint64_t moduleId = nextModuleId++;
+  moduleIds.insert_or_assign(module, moduleId);
+  shaders.insert_or_assign(name, module);
+  reflections.insert_or_assign(name, std::move(reflection));
+  IndexDependencies(name, dependencies);
+
+  size_t rebuilt = PipelineRegistry::RebuildPipelinesUsing(ModuleId(previous), module, moduleId);
+  retiredModules.push_back(RetiredModule{.module = previous, .value = Synchronization::PendingValue()});
+
+  fmt::print("Reloaded shader {}, rebuilding {} pipeline(s)\n", name, rebuilt);
+}
+
+void VulkanShaderManager::IndexDependencies(const std::string &name, const std::vector<std::string> &dependencies) {
+  ShaderSource &source = sources.at(name);
+
+  for (const std::string &path : source.dependencies) {
+    auto elem = dependents.find(path);
+    if (elem != dependents.end()) {
+      std::erase(elem->second, name);
+    }
+  }
+
+  source.dependencies.clear();
+  for (const std::string &dependency : dependencies) {
+    std::string path = std::filesystem::path{dependency}.lexically_normal().string();
+    dependents[path].push_back(name);
+    source.dependencies.push_back(std::move(path));
+  }
+}
+
+ShaderBinary::ShaderBinary(const std::string &path) {
+#ifdef _WIN32
+  HANDLE fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (fileHandle != INVALID_HANDLE_VALUE) {
+    LARGE_INTEGER fileSize{};
+    GetFileSizeEx(fileHandle, &fileSize);
+    HANDLE mappingHandle = fileSize.QuadPart > 0
+                               ? CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr)
+                               : nullptr;
+    void *view = mappingHandle != nullptr ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (view != nullptr) {
+      file = fileHandle;
+      mapping = mappingHandle;
+      code = static_cast<const uint32_t *>(view);
+      size = static_cast<size_t>(fileSize.QuadPart);
+    } else {
+      if (mappingHandle != nullptr) {
+        CloseHandle(mappingHandle);
+      }
+      CloseHandle(fileHandle);
+    }
+  }
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    struct stat info {};
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+      void *view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (view != MAP_FAILED) {
+        mapped = view;
+        code = static_cast<const uint32_t *>(view);
+        size = static_cast<size_t>(info.st_size);
+      }
+    }
+    // NOTE: the mapping stays valid after the descriptor is closed
+    close(fd);
+  }
+#endif
+
+  if (code == nullptr) {
+    // NOTE: filesystems that cannot be mapped still get an aligned buffer, read directly into place
+    std::ifstream stream{path, std::ios::ate | std::ios::binary};
+    if (stream.is_open()) {
+      size = static_cast<size_t>(stream.tellg());
+      fallback.resize((size + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+      stream.seekg(0);
+      stream.read(reinterpret_cast<char *>(fallback.data()), size);
+      code = size > 0 ? fallback.data() : nullptr;
+    }
+  }
+
+  if (code != nullptr && size % sizeof(uint32_t) != 0) {
+    SDL_LogWarn(0, "Shader binary %s is %zu bytes, SPIR-V must be a multiple of 4.", path.c_str(), size);
+  }
+}
+
+ShaderBinary::~ShaderBinary() {
+#ifdef _WIN32
+  if (mapping != nullptr) {
+    UnmapViewOfFile(code);
+    CloseHandle(mapping);
+    CloseHandle(file);
+  }
+#else
+  if (mapped != nullptr) {
+    munmap(mapped, size);
+  }
+#endif
+}